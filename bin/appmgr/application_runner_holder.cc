@@ -6,6 +6,7 @@
 
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <trace/event.h>
 #include <unistd.h>
 
 #include <utility>
@@ -29,6 +30,7 @@ void ApplicationRunnerHolder::StartApplication(
     std::unique_ptr<archive::FileSystem> file_system,
     fxl::RefPtr<ApplicationNamespace> application_namespace,
     fidl::InterfaceRequest<ApplicationController> controller) {
+  TRACE_DURATION("appmgr", "ApplicationRunnerHolder::StartApplication");
   file_systems_.push_back(std::move(file_system));
   namespaces_.push_back(std::move(application_namespace));
   runner_->StartApplication(std::move(package), std::move(startup_info),
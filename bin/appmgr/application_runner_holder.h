@@ -31,6 +31,8 @@ class ApplicationRunnerHolder {
       fxl::RefPtr<ApplicationNamespace> application_namespace,
       fidl::InterfaceRequest<ApplicationController> controller);
 
+  bool has_started_applications() const { return !namespaces_.empty(); }
+
  private:
   Services services_;
   ApplicationControllerPtr controller_;
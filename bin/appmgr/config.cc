@@ -16,6 +16,8 @@ namespace {
 constexpr char kInitialApps[] = "initial-apps";
 constexpr char kPath[] = "path";
 constexpr char kInclude[] = "include";
+constexpr char kPrestartRunners[] = "prestart-runners";
+constexpr char kRunnerIdleTimeout[] = "runner-idle-timeout";
 
 }  // namespace
 
@@ -80,6 +82,26 @@ bool Config::Parse(const std::string& string) {
     }
   }
 
+  auto prestart_runners_it = document.FindMember(kPrestartRunners);
+  if (prestart_runners_it != document.MemberEnd()) {
+    const auto& value = prestart_runners_it->value;
+    if (!value.IsArray())
+      return false;
+    for (const auto& runner : value.GetArray()) {
+      if (!runner.IsString())
+        return false;
+      prestart_runners_.push_back(runner.GetString());
+    }
+  }
+
+  auto runner_idle_timeout_it = document.FindMember(kRunnerIdleTimeout);
+  if (runner_idle_timeout_it != document.MemberEnd()) {
+    const auto& value = runner_idle_timeout_it->value;
+    if (!value.IsUint())
+      return false;
+    runner_idle_timeout_ = fxl::TimeDelta::FromSeconds(value.GetUint());
+  }
+
   auto include_it = document.FindMember(kInclude);
   if (include_it != document.MemberEnd()) {
     const auto& value = include_it->value;
@@ -104,4 +126,8 @@ std::vector<ApplicationLaunchInfoPtr> Config::TakeInitialApps() {
   return std::move(initial_apps_);
 }
 
+std::vector<std::string> Config::TakePrestartRunners() {
+  return std::move(prestart_runners_);
+}
+
 }  // namespace app
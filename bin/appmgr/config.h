@@ -10,6 +10,7 @@
 
 #include "lib/app/fidl/application_launcher.fidl.h"
 #include "lib/fxl/macros.h"
+#include "lib/fxl/time/time_delta.h"
 
 namespace app {
 
@@ -24,8 +25,21 @@ namespace app {
 //   ],
 //   "include": [
 //     "/system/data/appmgr/startup.config"
-//   ]
+//   ],
+//   "prestart-runners": [
+//     "dart_runner"
+//   ],
+//   "runner-idle-timeout": 300
 // }
+//
+// The runners in "prestart-runners" are launched in the root environment when
+// appmgr starts, so that the first application to use one does not wait for
+// it to start, and are launched again if they exit, backing off and
+// eventually giving up if they keep exiting soon after starting. A prestarted
+// runner that has run no applications after "runner-idle-timeout" seconds is
+// shut down; without a timeout, prestarted runners are kept. A runner that was
+// shut down or given up on is kept running again once an application uses it.
+// Nested environments launch runners of their own and do not use these.
 
 class Config {
  public:
@@ -40,12 +54,21 @@ class Config {
   // Gets initial apps to launch.
   std::vector<ApplicationLaunchInfoPtr> TakeInitialApps();
 
+  // Gets the runners to launch ahead of the applications that use them.
+  std::vector<std::string> TakePrestartRunners();
+
+  // How long prestarted runners are kept without running any applications,
+  // or zero to keep them.
+  fxl::TimeDelta runner_idle_timeout() const { return runner_idle_timeout_; }
+
  private:
   bool Parse(const std::string& string);
   bool ReadFromIfExists(const std::string& config_file);
 
   std::vector<std::string> path_;
   std::vector<ApplicationLaunchInfoPtr> initial_apps_;
+  std::vector<std::string> prestart_runners_;
+  fxl::TimeDelta runner_idle_timeout_;
 
   FXL_DISALLOW_COPY_AND_ASSIGN(Config);
 };
@@ -0,0 +1,85 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/appmgr/directory_watcher.h"
+
+#include <fcntl.h>
+#include <fdio/io.h>
+#include <zircon/device/vfs.h>
+
+#include <utility>
+
+#include "lib/fsl/tasks/message_loop.h"
+#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/logging.h"
+
+namespace app {
+
+DirectoryWatcher::DirectoryWatcher(zx::channel dir_watch,
+                                   fxl::Closure callback)
+    : dir_watch_(std::move(dir_watch)),
+      callback_(std::move(callback)),
+      wait_(fsl::MessageLoop::GetCurrent()->async(),
+            dir_watch_.get(),
+            ZX_CHANNEL_READABLE | ZX_CHANNEL_PEER_CLOSED) {
+  wait_.set_handler(fbl::BindMember(this, &DirectoryWatcher::Handler));
+  auto status = wait_.Begin();
+  FXL_DCHECK(status == ZX_OK);
+}
+
+DirectoryWatcher::~DirectoryWatcher() = default;
+
+std::unique_ptr<DirectoryWatcher> DirectoryWatcher::Create(
+    const std::string& path,
+    fxl::Closure callback) {
+  fxl::UniqueFD dir_fd(open(path.c_str(), O_DIRECTORY | O_RDONLY));
+  if (!dir_fd.is_valid())
+    return nullptr;
+
+  vfs_watch_dir_t wd;
+  wd.mask =
+      VFS_WATCH_MASK_ADDED | VFS_WATCH_MASK_REMOVED | VFS_WATCH_MASK_DELETED;
+  wd.options = 0;
+  zx_handle_t dir_watch_handle;
+  if (zx_channel_create(0, &wd.channel, &dir_watch_handle) < 0)
+    return nullptr;
+  ssize_t ioctl_result = ioctl_vfs_watch_dir(dir_fd.get(), &wd);
+  if (ioctl_result < 0) {
+    zx_handle_close(wd.channel);
+    zx_handle_close(dir_watch_handle);
+    FXL_LOG(WARNING) << "Failed to watch " << path
+                     << ", result=" << ioctl_result;
+    return nullptr;
+  }
+
+  return std::unique_ptr<DirectoryWatcher>(new DirectoryWatcher(
+      zx::channel(dir_watch_handle), std::move(callback)));
+}
+
+async_wait_result_t DirectoryWatcher::Handler(async_t* async,
+                                              zx_status_t status,
+                                              const zx_packet_signal* signal) {
+  if (signal->observed & ZX_CHANNEL_READABLE) {
+    // Which entries changed does not matter, only that some did.
+    uint32_t size;
+    uint8_t buf[VFS_WATCH_MSG_MAX];
+    zx_status_t status =
+        dir_watch_.read(0, buf, sizeof(buf), &size, nullptr, 0, nullptr);
+    FXL_CHECK(status == ZX_OK)
+        << "Failed to read from directory watch channel";
+    callback_();
+    return ASYNC_WAIT_AGAIN;
+  }
+
+  if (signal->observed & ZX_CHANNEL_PEER_CLOSED) {
+    dir_watch_.reset();
+    callback_();
+    return ASYNC_WAIT_FINISHED;
+  }
+
+  FXL_CHECK(false);
+  return ASYNC_WAIT_FINISHED;
+}
+
+}  // namespace app
@@ -0,0 +1,52 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_APPMGR_DIRECTORY_WATCHER_H_
+#define GARNET_BIN_APPMGR_DIRECTORY_WATCHER_H_
+
+#include <async/auto_wait.h>
+#include <zx/channel.h>
+
+#include <memory>
+#include <string>
+
+#include "lib/fxl/functional/closure.h"
+#include "lib/fxl/macros.h"
+
+namespace app {
+
+// Watches a directory for entries being added or removed, in the manner of
+// fsl::DeviceWatcher, which only reports additions.
+class DirectoryWatcher {
+ public:
+  ~DirectoryWatcher();
+
+  // Creates a watcher associated with the current message loop, or returns
+  // null if |path| cannot be watched.
+  //
+  // |callback| is invoked after entries are added to or removed from the
+  // directory, and once more if the directory stops being watchable, after
+  // which |is_closed| returns true.
+  static std::unique_ptr<DirectoryWatcher> Create(const std::string& path,
+                                                  fxl::Closure callback);
+
+  bool is_closed() const { return !dir_watch_; }
+
+ private:
+  DirectoryWatcher(zx::channel dir_watch, fxl::Closure callback);
+
+  async_wait_result_t Handler(async_t* async,
+                              zx_status_t status,
+                              const zx_packet_signal* signal);
+
+  zx::channel dir_watch_;
+  fxl::Closure callback_;
+  async::AutoWait wait_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(DirectoryWatcher);
+};
+
+}  // namespace app
+
+#endif  // GARNET_BIN_APPMGR_DIRECTORY_WATCHER_H_
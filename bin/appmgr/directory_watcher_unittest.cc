@@ -0,0 +1,70 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/appmgr/directory_watcher.h"
+
+#include <unistd.h>
+
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "lib/fsl/tasks/message_loop.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+#include "lib/fxl/strings/concatenate.h"
+#include "lib/fxl/time/time_delta.h"
+
+namespace app {
+namespace {
+
+class DirectoryWatcherTest : public ::testing::Test {
+ protected:
+  // Runs the message loop until the watcher's callback is invoked, or a
+  // timeout. Returns whether the callback was invoked.
+  bool WaitForChange() {
+    int expected_changes = changes_ + 1;
+    auto timed_out = std::make_shared<bool>(false);
+    message_loop_.task_runner()->PostDelayedTask(
+        [this, timed_out] {
+          *timed_out = true;
+          message_loop_.QuitNow();
+        },
+        fxl::TimeDelta::FromSeconds(5));
+    while (changes_ < expected_changes && !*timed_out)
+      message_loop_.Run();
+    return changes_ >= expected_changes;
+  }
+
+  std::unique_ptr<DirectoryWatcher> Watch(const std::string& path) {
+    return DirectoryWatcher::Create(path, [this] {
+      ++changes_;
+      message_loop_.QuitNow();
+    });
+  }
+
+  fsl::MessageLoop message_loop_;
+  files::ScopedTempDir temp_dir_;
+  int changes_ = 0;
+};
+
+TEST_F(DirectoryWatcherTest, MissingDirectory) {
+  EXPECT_FALSE(Watch(fxl::Concatenate({temp_dir_.path(), "/missing"})));
+}
+
+TEST_F(DirectoryWatcherTest, ReportsAddedAndRemovedEntries) {
+  std::unique_ptr<DirectoryWatcher> watcher = Watch(temp_dir_.path());
+  ASSERT_TRUE(watcher);
+  EXPECT_FALSE(watcher->is_closed());
+
+  std::string path = fxl::Concatenate({temp_dir_.path(), "/file"});
+  ASSERT_TRUE(files::WriteFile(path, "x", 1));
+  EXPECT_TRUE(WaitForChange());
+
+  ASSERT_EQ(0, unlink(path.c_str()));
+  EXPECT_TRUE(WaitForChange());
+  EXPECT_FALSE(watcher->is_closed());
+}
+
+}  // namespace
+}  // namespace app
@@ -12,6 +12,7 @@
 #include <zircon/process.h>
 #include <zircon/processargs.h>
 #include <zircon/status.h>
+#include <trace/event.h>
 #include <zx/process.h>
 
 #include <utility>
@@ -23,6 +24,7 @@
 #include "lib/app/cpp/connect.h"
 #include "lib/fsl/handles/object_info.h"
 #include "lib/fsl/io/fd.h"
+#include "lib/fsl/tasks/message_loop.h"
 #include "lib/fsl/vmo/file.h"
 #include "lib/fxl/files/file.h"
 #include "lib/fxl/functional/auto_call.h"
@@ -44,6 +46,14 @@ constexpr char kAppArv0[] = "/pkg/bin/app";
 constexpr char kRuntimePath[] = "meta/runtime";
 constexpr char kSandboxPath[] = "meta/sandbox";
 constexpr char kInfoDirPath[] = "/info_experimental";
+// How long to wait before launching a prestarted runner again after it exits.
+// So that a runner that fails on startup does not spin, the delay doubles
+// each time it exits within kRunnerStableTime of being launched, and after
+// kMaxRunnerFailures such exits in a row it is left alone until an
+// application needs it.
+constexpr fxl::TimeDelta kRunnerRestartDelay = fxl::TimeDelta::FromSeconds(1);
+constexpr fxl::TimeDelta kRunnerStableTime = fxl::TimeDelta::FromSeconds(60);
+constexpr int kMaxRunnerFailures = 6;
 
 enum class LaunchType {
   kProcess,
@@ -228,9 +238,12 @@ JobHolder::JobHolder(JobHolder* parent,
                      const fidl::String& label)
     : parent_(parent),
       vfs_(vfs),
+      metadata_cache_(parent ? parent->metadata_cache_
+                             : std::make_shared<PackageMetadataCache>()),
       default_namespace_(
           fxl::MakeRefCounted<ApplicationNamespace>(nullptr, this, nullptr)),
-      info_dir_(fbl::AdoptRef(new fs::PseudoDir())) {
+      info_dir_(fbl::AdoptRef(new fs::PseudoDir())),
+      weak_ptr_factory_(this) {
   host_.Bind(std::move(host));
 
   // parent_ is null if this is the root application environment. if so, we
@@ -295,11 +308,16 @@ void JobHolder::CreateApplication(
 
   // launch_info is moved before LoadApplication() gets at its first argument.
   fidl::String url = launch_info->url;
+  // Several loads may be in flight at once, so each gets its own id.
+  trace_async_id_t trace_id = TRACE_NONCE();
+  TRACE_ASYNC_BEGIN("appmgr", "JobHolder::LoadApplication", trace_id);
   loader_->LoadApplication(
       url, fxl::MakeCopyable([
-        this, launch_info = std::move(launch_info),
+        this, trace_id, launch_info = std::move(launch_info),
         controller = std::move(controller)
       ](ApplicationPackagePtr package) mutable {
+        TRACE_ASYNC_END("appmgr", "JobHolder::LoadApplication", trace_id);
+        TRACE_DURATION("appmgr", "JobHolder::StartApplication");
         fxl::RefPtr<ApplicationNamespace> application_namespace =
             default_namespace_;
         if (!launch_info->additional_services.is_null()) {
@@ -461,49 +479,62 @@ void JobHolder::CreateApplicationFromPackage(
   std::string runtime_data;
   fsl::SizedVmo app_data;
 
-  if (package->data) {
-    pkg_fs = std::make_unique<archive::FileSystem>(std::move(package->data->vmo));
-    pkg = pkg_fs->OpenAsDirectory();
-    pkg_fs->GetFileAsString(kSandboxPath, &sandbox_data);
-    if (!pkg_fs->GetFileAsString(kRuntimePath, &runtime_data))
-      app_data = pkg_fs->GetFileAsVMO(kAppPath);
-  } else if (package->directory) {
-    fxl::UniqueFD fd = fsl::OpenChannelAsFileDescriptor(std::move(package->directory));
-    files::ReadFileToStringAt(fd.get(), kSandboxPath, &sandbox_data);
-    if (!files::ReadFileToStringAt(fd.get(), kRuntimePath, &runtime_data))
-      VmoFromFilenameAt(fd.get(), kAppPath, &app_data);
-    // TODO(abarth): We shouldn't need to clone the channel here. Instead, we
-    // should be able to tear down the file descriptor in a way that gives us
-    // the channel back.
-    pkg = fsl::CloneChannelFromFileDescriptor(fd.get());
+  {
+    TRACE_DURATION("appmgr", "JobHolder::ReadPackage");
+    if (package->data) {
+      pkg_fs =
+          std::make_unique<archive::FileSystem>(std::move(package->data->vmo));
+      pkg = pkg_fs->OpenAsDirectory();
+      pkg_fs->GetFileAsString(kSandboxPath, &sandbox_data);
+      if (!pkg_fs->GetFileAsString(kRuntimePath, &runtime_data))
+        app_data = pkg_fs->GetFileAsVMO(kAppPath);
+    } else if (package->directory) {
+      fxl::UniqueFD fd =
+          fsl::OpenChannelAsFileDescriptor(std::move(package->directory));
+      files::ReadFileToStringAt(fd.get(), kSandboxPath, &sandbox_data);
+      if (!files::ReadFileToStringAt(fd.get(), kRuntimePath, &runtime_data))
+        VmoFromFilenameAt(fd.get(), kAppPath, &app_data);
+      // TODO(abarth): We shouldn't need to clone the channel here. Instead, we
+      // should be able to tear down the file descriptor in a way that gives us
+      // the channel back.
+      pkg = fsl::CloneChannelFromFileDescriptor(fd.get());
+    }
   }
   if (!pkg)
     return;
 
+  std::shared_ptr<const PackageMetadata> metadata;
+  {
+    TRACE_DURATION("appmgr", "JobHolder::ParseMetadata");
+    metadata = metadata_cache_->Get(sandbox_data, runtime_data);
+  }
+  if (!metadata) {
+    FXL_LOG(ERROR) << "Failed to parse package metadata for "
+                   << launch_info->url;
+    return;
+  }
+
   // Note that |builder| is only used in the else block below. It is left here
   // because we would like to use it everywhere once US-313 is fixed.
   NamespaceBuilder builder;
-  builder.AddPackage(std::move(pkg));
-  builder.AddServices(std::move(svc));
-  AddInfoDir(&builder);
-
-  if (!sandbox_data.empty()) {
-    SandboxMetadata sandbox;
-    if (!sandbox.Parse(sandbox_data)) {
-      FXL_LOG(ERROR) << "Failed to parse sandbox metadata for "
-                     << launch_info->url;
-      return;
-    }
-    builder.AddSandbox(sandbox);
+  {
+    TRACE_DURATION("appmgr", "JobHolder::BuildNamespace");
+    builder.AddPackage(std::move(pkg));
+    builder.AddServices(std::move(svc));
+    AddInfoDir(&builder);
+
+    if (metadata->has_sandbox)
+      builder.AddDirectories(metadata->sandbox_directories);
+
+    // Add the custom namespace.
+    // Note that this must be the last |builder| step adding entries to the
+    // namespace so that we can filter out entries already added in previous
+    // steps.
+    builder.AddFlatNamespace(std::move(launch_info->flat_namespace));
   }
 
-  // Add the custom namespace.
-  // Note that this must be the last |builder| step adding entries to the
-  // namespace so that we can filter out entries already added in previous
-  // steps.
-  builder.AddFlatNamespace(std::move(launch_info->flat_namespace));
-
   if (app_data) {
+    TRACE_DURATION("appmgr", "JobHolder::CreateProcess");
     const std::string url = launch_info->url;  // Keep a copy before moving it.
     zx::channel service_dir_channel = BindServiceDirectory(launch_info.get());
     zx::process process = CreateProcess(job_for_child_, std::move(app_data),
@@ -519,12 +550,12 @@ void JobHolder::CreateApplicationFromPackage(
       applications_.emplace(key, std::move(application));
     }
   } else {
-    RuntimeMetadata runtime;
-    if (!runtime.Parse(runtime_data)) {
+    if (!metadata->has_runtime) {
       FXL_LOG(ERROR) << "Failed to parse runtime metadata for "
                      << launch_info->url;
       return;
     }
+    const RuntimeMetadata& runtime = metadata->runtime;
 
     auto inner_package = ApplicationPackage::New();
     inner_package->resolved_url = package->resolved_url;
@@ -545,12 +576,61 @@ void JobHolder::CreateApplicationFromPackage(
   }
 }
 
+JobHolder::PrestartedRunner::PrestartedRunner()
+    : backoff(kRunnerRestartDelay, kRunnerStableTime, kMaxRunnerFailures) {}
+
+void JobHolder::PrestartRunners(std::vector<std::string> runners,
+                                fxl::TimeDelta idle_timeout) {
+  runner_idle_timeout_ = idle_timeout;
+  for (const auto& runner : runners) {
+    if (prestart_runners_.emplace(runner, PrestartedRunner()).second)
+      PrestartRunner(runner);
+  }
+}
+
+void JobHolder::PrestartRunner(const std::string& runner) {
+  TRACE_DURATION("appmgr", "JobHolder::PrestartRunner", "runner",
+                 runner.c_str());
+  if (GetOrCreateRunner(runner) == nullptr) {
+    FXL_LOG(ERROR) << "Could not prestart runner " << runner;
+    prestart_runners_.erase(runner);
+    return;
+  }
+  if (runner_idle_timeout_ <= fxl::TimeDelta::Zero())
+    return;
+
+  auto prestart = prestart_runners_.find(runner);
+  if (prestart == prestart_runners_.end())
+    return;
+  uint64_t exit_count = prestart->second.exit_count;
+  fsl::MessageLoop::GetCurrent()->task_runner()->PostDelayedTask(
+      [weak = weak_ptr_factory_.GetWeakPtr(), runner, exit_count] {
+        if (!weak)
+          return;
+        // A runner that exited and was started again gets a timer of its own.
+        auto prestart = weak->prestart_runners_.find(runner);
+        if (prestart == weak->prestart_runners_.end() ||
+            prestart->second.exit_count != exit_count)
+          return;
+        auto it = weak->runners_.find(runner);
+        if (it == weak->runners_.end() || !it->second ||
+            it->second->has_started_applications())
+          return;
+        FXL_LOG(INFO) << "Shutting down idle runner " << runner;
+        prestart->second.dormant = true;
+        weak->runners_.erase(it);
+      },
+      runner_idle_timeout_);
+}
+
 ApplicationRunnerHolder* JobHolder::GetOrCreateRunner(
     const std::string& runner) {
   // We create the entry in |runners_| before calling ourselves
   // recursively to detect cycles.
   auto result = runners_.emplace(runner, nullptr);
   if (result.second) {
+    TRACE_DURATION("appmgr", "JobHolder::CreateRunner", "runner",
+                   runner.c_str());
     Services runner_services;
     ApplicationControllerPtr runner_controller;
     auto runner_launch_info = ApplicationLaunchInfo::New();
@@ -559,8 +639,43 @@ ApplicationRunnerHolder* JobHolder::GetOrCreateRunner(
     CreateApplication(std::move(runner_launch_info),
                       runner_controller.NewRequest());
 
-    runner_controller.set_connection_error_handler(
-        [this, runner] { runners_.erase(runner); });
+    runner_controller.set_connection_error_handler([this, runner] {
+      // Erasing the runner destroys this handler along with its captures, so
+      // copy what is needed afterwards first.
+      std::string url = runner;
+      fxl::WeakPtr<JobHolder> weak = weak_ptr_factory_.GetWeakPtr();
+      weak->runners_.erase(url);
+      auto prestart = weak->prestart_runners_.find(url);
+      if (prestart == weak->prestart_runners_.end())
+        return;
+      ++prestart->second.exit_count;
+      fxl::TimeDelta delay;
+      if (!prestart->second.backoff.OnExited(fxl::TimePoint::Now(), &delay)) {
+        FXL_LOG(ERROR) << "Runner " << url << " exited "
+                       << prestart->second.backoff.failures()
+                       << " times in a row soon after starting; not "
+                          "restarting it until an application needs it";
+        prestart->second.dormant = true;
+        return;
+      }
+      fsl::MessageLoop::GetCurrent()->task_runner()->PostDelayedTask(
+          [weak, url] {
+            if (!weak || weak->runners_.count(url))
+              return;
+            auto it = weak->prestart_runners_.find(url);
+            if (it != weak->prestart_runners_.end() && !it->second.dormant)
+              weak->PrestartRunner(url);
+          },
+          delay);
+    });
+
+    // A prestarted runner that was shut down or given up on is kept running
+    // again once an application needs it.
+    auto prestart = prestart_runners_.find(runner);
+    if (prestart != prestart_runners_.end()) {
+      prestart->second.dormant = false;
+      prestart->second.backoff.OnLaunched(fxl::TimePoint::Now());
+    }
 
     result.first->second = std::make_unique<ApplicationRunnerHolder>(
         std::move(runner_services), std::move(runner_controller));
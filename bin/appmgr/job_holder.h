@@ -9,6 +9,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <fs/pseudo-dir.h>
 #include <fs/vfs.h>
@@ -17,12 +18,16 @@
 #include "garnet/bin/appmgr/application_environment_controller_impl.h"
 #include "garnet/bin/appmgr/application_namespace.h"
 #include "garnet/bin/appmgr/application_runner_holder.h"
+#include "garnet/bin/appmgr/package_metadata_cache.h"
+#include "garnet/bin/appmgr/restart_backoff.h"
 #include "lib/app/fidl/application_environment.fidl.h"
 #include "lib/app/fidl/application_loader.fidl.h"
 #include "lib/fidl/cpp/bindings/binding_set.h"
 #include "lib/fxl/macros.h"
 #include "lib/fxl/memory/ref_ptr.h"
+#include "lib/fxl/memory/weak_ptr.h"
 #include "lib/fxl/strings/string_view.h"
+#include "lib/fxl/time/time_delta.h"
 #include "lib/svc/cpp/service_provider_bridge.h"
 
 namespace app {
@@ -52,6 +57,19 @@ class JobHolder {
       ApplicationLaunchInfoPtr launch_info,
       fidl::InterfaceRequest<ApplicationController> controller);
 
+  // Launches the given runners before any application needs them, and again
+  // whenever they exit, backing off if they keep exiting soon after being
+  // launched and eventually giving up. A runner that has started no
+  // applications after |idle_timeout| is shut down, unless |idle_timeout| is
+  // zero. A runner that was shut down or given up on is kept running again
+  // once an application needs it.
+  //
+  // Only applications launched in this environment use these runners: nested
+  // environments launch runners of their own, which run in their jobs and
+  // with their services.
+  void PrestartRunners(std::vector<std::string> runners,
+                       fxl::TimeDelta idle_timeout);
+
   // Removes the child job holder from this job holder and returns the owning
   // reference to the child's controller. The caller of this function typically
   // destroys the controller (and hence the environment) shortly after calling
@@ -72,6 +90,7 @@ class JobHolder {
   static uint32_t next_numbered_label_;
 
   ApplicationRunnerHolder* GetOrCreateRunner(const std::string& runner);
+  void PrestartRunner(const std::string& runner);
 
   void CreateApplicationWithRunner(
       ApplicationPackagePtr package,
@@ -98,6 +117,8 @@ class JobHolder {
 
   JobHolder* const parent_;
   fs::Vfs* const vfs_;
+  // Shared by every environment.
+  const std::shared_ptr<PackageMetadataCache> metadata_cache_;
   ApplicationEnvironmentHostPtr host_;
   ApplicationLoaderPtr loader_;
   std::string label_;
@@ -122,6 +143,23 @@ class JobHolder {
   std::unordered_map<std::string, std::unique_ptr<ApplicationRunnerHolder>>
       runners_;
 
+  // A runner to keep running; see PrestartRunners().
+  struct PrestartedRunner {
+    PrestartedRunner();
+
+    // The number of times the runner has exited, so that an idle timer can
+    // tell whether the runner it was set for is still the one running.
+    uint64_t exit_count = 0u;
+    // Set while the runner is not kept running, because it was idle or kept
+    // exiting, until an application needs it again.
+    bool dormant = false;
+    RestartBackoff backoff;
+  };
+  std::unordered_map<std::string, PrestartedRunner> prestart_runners_;
+  fxl::TimeDelta runner_idle_timeout_;
+
+  fxl::WeakPtrFactory<JobHolder> weak_ptr_factory_;
+
   FXL_DISALLOW_COPY_AND_ASSIGN(JobHolder);
 };
 
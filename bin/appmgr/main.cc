@@ -9,6 +9,7 @@
 #include <vector>
 
 #include <fs/vfs.h>
+#include <trace-provider/provider.h>
 #include <zircon/process.h>
 #include <zircon/processargs.h>
 
@@ -46,6 +47,7 @@ int main(int argc, char** argv) {
   }
 
   fsl::MessageLoop message_loop;
+  trace::TraceProvider trace_provider(message_loop.async());
   fs::ManagedVfs vfs(message_loop.async());
 
   app::RootEnvironmentHost root(config.TakePath(), &vfs);
@@ -58,6 +60,16 @@ int main(int argc, char** argv) {
     });
   }
 
+  // Posted after the initial apps so that prestarting does not delay them.
+  auto prestart_runners = config.TakePrestartRunners();
+  if (!prestart_runners.empty()) {
+    message_loop.task_runner()->PostTask(
+        [&root, &prestart_runners, &config] {
+          root.job_holder()->PrestartRunners(std::move(prestart_runners),
+                                             config.runner_idle_timeout());
+        });
+  }
+
   message_loop.Run();
   return 0;
 }
@@ -53,33 +53,49 @@ void NamespaceBuilder::AddDev() {
 }
 
 void NamespaceBuilder::AddSandbox(const SandboxMetadata& sandbox) {
+  AddDirectories(GetSandboxDirectories(sandbox));
+}
+
+void NamespaceBuilder::AddDirectories(const DirectoryList& directories) {
+  for (const auto& directory : directories)
+    PushDirectoryFromPathAs(directory.first, directory.second);
+}
+
+NamespaceBuilder::DirectoryList NamespaceBuilder::GetSandboxDirectories(
+    const SandboxMetadata& sandbox) {
+  DirectoryList directories;
+  auto add = [&directories](std::string path) {
+    directories.emplace_back(path, path);
+  };
+
   for (const auto& path : sandbox.dev())
-    PushDirectoryFromPath("/dev/" + path);
+    add("/dev/" + path);
 
   for (const auto& path : sandbox.system())
-    PushDirectoryFromPath("/system/" + path);
+    add("/system/" + path);
 
   for (const auto& feature : sandbox.features()) {
     if (feature == "persistent-storage") {
       // TODO(flowerhack): Make this feature more fine-grained.
-      PushDirectoryFromPath("/data");
+      add("/data");
     } else if (feature == "root-ssl-certificates") {
-      PushDirectoryFromPath("/system/data/boringssl");
-      PushDirectoryFromPathAs("/system/data/boringssl", "/etc/ssl");
+      add("/system/data/boringssl");
+      directories.emplace_back("/system/data/boringssl", "/etc/ssl");
     } else if (feature == "shell") {
       // TODO(abarth): These permissions should depend on the envionment
       // in some way so that a shell running at a user-level scope doesn't
       // have access to all the device drivers and such.
-      AddRoot();
-      AddDev();
+      add("/");
+      add("/dev");
     } else if (feature == "system-temp") {
-      PushDirectoryFromPath("/tmp");
+      add("/tmp");
     } else if (feature == "vulkan") {
-      PushDirectoryFromPath("/dev/class/display");
-      PushDirectoryFromPath("/dev/class/gpu");
-      PushDirectoryFromPath("/system/data/vulkan");
+      add("/dev/class/display");
+      add("/dev/class/gpu");
+      add("/system/data/vulkan");
     }
   }
+  return directories;
 }
 
 void NamespaceBuilder::AddDeprecatedDefaultDirectories() {
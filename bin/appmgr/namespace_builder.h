@@ -8,6 +8,8 @@
 #include <zx/channel.h>
 #include <fdio/namespace.h>
 
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "lib/app/fidl/flat_namespace.fidl.h"
@@ -18,6 +20,10 @@ namespace app {
 
 class NamespaceBuilder {
  public:
+  // Directories to add to a namespace, as pairs of their path in appmgr's
+  // namespace and the path to give them in the new one.
+  using DirectoryList = std::vector<std::pair<std::string, std::string>>;
+
   NamespaceBuilder();
   ~NamespaceBuilder();
 
@@ -28,6 +34,11 @@ class NamespaceBuilder {
   void AddServices(zx::channel services);
   void AddDev();
   void AddSandbox(const SandboxMetadata& sandbox);
+  void AddDirectories(const DirectoryList& directories);
+
+  // Returns the directories that AddSandbox() adds for |sandbox|, so that
+  // launches sharing a sandbox need only work them out once.
+  static DirectoryList GetSandboxDirectories(const SandboxMetadata& sandbox);
 
   // This function grants access to a number of directories to processes that
   // lack a sandbox policy. Once every application has a proper sandbox policy
@@ -0,0 +1,55 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/appmgr/package_metadata_cache.h"
+
+#include <utility>
+
+#include "lib/fxl/strings/concatenate.h"
+
+namespace app {
+namespace {
+
+// Launches of distinct packages are what fill the cache, so this is
+// generous.
+constexpr size_t kMaxEntries = 128;
+
+}  // namespace
+
+PackageMetadataCache::PackageMetadataCache() = default;
+
+PackageMetadataCache::~PackageMetadataCache() = default;
+
+std::shared_ptr<const PackageMetadata> PackageMetadataCache::Get(
+    const std::string& sandbox_data,
+    const std::string& runtime_data) {
+  // The files are small, so key by their contents, with the length of the
+  // first keeping the boundary between them unambiguous.
+  std::string key = fxl::Concatenate(
+      {std::to_string(sandbox_data.size()), ":", sandbox_data, runtime_data});
+  auto it = entries_.find(key);
+  if (it != entries_.end())
+    return it->second;
+
+  auto metadata = std::make_shared<PackageMetadata>();
+  if (!sandbox_data.empty()) {
+    if (!metadata->sandbox.Parse(sandbox_data))
+      return nullptr;
+    metadata->has_sandbox = true;
+    metadata->sandbox_directories =
+        NamespaceBuilder::GetSandboxDirectories(metadata->sandbox);
+  }
+  if (!runtime_data.empty()) {
+    if (!metadata->runtime.Parse(runtime_data))
+      return nullptr;
+    metadata->has_runtime = true;
+  }
+
+  if (entries_.size() >= kMaxEntries)
+    entries_.clear();
+  entries_.emplace(std::move(key), metadata);
+  return metadata;
+}
+
+}  // namespace app
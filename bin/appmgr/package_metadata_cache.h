@@ -0,0 +1,53 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_APPMGR_PACKAGE_METADATA_CACHE_H_
+#define GARNET_BIN_APPMGR_PACKAGE_METADATA_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "garnet/bin/appmgr/namespace_builder.h"
+#include "garnet/bin/appmgr/runtime_metadata.h"
+#include "garnet/bin/appmgr/sandbox_metadata.h"
+#include "lib/fxl/macros.h"
+
+namespace app {
+
+// The parsed contents of a package's meta/sandbox and meta/runtime files.
+struct PackageMetadata {
+  bool has_sandbox = false;
+  SandboxMetadata sandbox;
+  // The directories |sandbox| grants access to.
+  NamespaceBuilder::DirectoryList sandbox_directories;
+
+  bool has_runtime = false;
+  RuntimeMetadata runtime;
+};
+
+// Remembers the parsed metadata of the packages that have been launched,
+// keyed by the contents of their metadata files, so that launching a package
+// again, or one with the same metadata, does not parse it again.
+class PackageMetadataCache {
+ public:
+  PackageMetadataCache();
+  ~PackageMetadataCache();
+
+  // Returns the parsed form of the given metadata, either of which is empty
+  // if the package lacks that file, or null if either fails to parse. The
+  // result remains valid after the cache has dropped it.
+  std::shared_ptr<const PackageMetadata> Get(const std::string& sandbox_data,
+                                             const std::string& runtime_data);
+
+ private:
+  std::unordered_map<std::string, std::shared_ptr<const PackageMetadata>>
+      entries_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(PackageMetadataCache);
+};
+
+}  // namespace app
+
+#endif  // GARNET_BIN_APPMGR_PACKAGE_METADATA_CACHE_H_
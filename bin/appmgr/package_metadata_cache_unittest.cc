@@ -0,0 +1,58 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/appmgr/package_metadata_cache.h"
+
+#include "gtest/gtest.h"
+
+namespace app {
+namespace {
+
+constexpr char kSandbox[] = R"JSON({
+  "dev": [ "class/input" ],
+  "features": [ "root-ssl-certificates" ]
+})JSON";
+constexpr char kRuntime[] = R"JSON({ "runner": "dart_runner" })JSON";
+
+TEST(PackageMetadataCache, Parse) {
+  PackageMetadataCache cache;
+  auto metadata = cache.Get(kSandbox, kRuntime);
+  ASSERT_TRUE(metadata);
+  EXPECT_TRUE(metadata->has_sandbox);
+  EXPECT_TRUE(metadata->has_runtime);
+  EXPECT_EQ("dart_runner", metadata->runtime.runner());
+
+  NamespaceBuilder::DirectoryList expected = {
+      {"/dev/class/input", "/dev/class/input"},
+      {"/system/data/boringssl", "/system/data/boringssl"},
+      {"/system/data/boringssl", "/etc/ssl"},
+  };
+  EXPECT_EQ(expected, metadata->sandbox_directories);
+}
+
+TEST(PackageMetadataCache, Missing) {
+  PackageMetadataCache cache;
+  auto metadata = cache.Get("", "");
+  ASSERT_TRUE(metadata);
+  EXPECT_FALSE(metadata->has_sandbox);
+  EXPECT_FALSE(metadata->has_runtime);
+  EXPECT_TRUE(metadata->sandbox_directories.empty());
+}
+
+TEST(PackageMetadataCache, Invalid) {
+  PackageMetadataCache cache;
+  EXPECT_FALSE(cache.Get("{", ""));
+  EXPECT_FALSE(cache.Get("", R"JSON({ "runner": 10 })JSON"));
+}
+
+TEST(PackageMetadataCache, Reuse) {
+  PackageMetadataCache cache;
+  auto metadata = cache.Get(kSandbox, kRuntime);
+  EXPECT_EQ(metadata, cache.Get(kSandbox, kRuntime));
+  EXPECT_NE(metadata, cache.Get(kSandbox, ""));
+  EXPECT_NE(metadata, cache.Get("", kRuntime));
+}
+
+}  // namespace
+}  // namespace app
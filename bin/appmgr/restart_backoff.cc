@@ -0,0 +1,32 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/appmgr/restart_backoff.h"
+
+namespace app {
+
+RestartBackoff::RestartBackoff(fxl::TimeDelta initial_delay,
+                               fxl::TimeDelta stable_time,
+                               int max_failures)
+    : initial_delay_(initial_delay),
+      stable_time_(stable_time),
+      max_failures_(max_failures) {}
+
+void RestartBackoff::OnLaunched(fxl::TimePoint now) {
+  launch_time_ = now;
+}
+
+bool RestartBackoff::OnExited(fxl::TimePoint now, fxl::TimeDelta* delay) {
+  if (now - launch_time_ >= stable_time_) {
+    failures_ = 0;
+    *delay = initial_delay_;
+    return true;
+  }
+  if (++failures_ >= max_failures_)
+    return false;
+  *delay = initial_delay_ * (int64_t{1} << (failures_ - 1));
+  return true;
+}
+
+}  // namespace app
@@ -0,0 +1,45 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_APPMGR_RESTART_BACKOFF_H_
+#define GARNET_BIN_APPMGR_RESTART_BACKOFF_H_
+
+#include "lib/fxl/time/time_delta.h"
+#include "lib/fxl/time/time_point.h"
+
+namespace app {
+
+// Decides when to launch a process again after it exits. The delay starts at
+// |initial_delay| and doubles each time the process exits within
+// |stable_time| of being launched, until it has done so |max_failures| times
+// in a row, after which it is not launched again. Running for |stable_time|
+// starts over.
+class RestartBackoff {
+ public:
+  RestartBackoff(fxl::TimeDelta initial_delay,
+                 fxl::TimeDelta stable_time,
+                 int max_failures);
+
+  // Notes that the process was launched at |now|.
+  void OnLaunched(fxl::TimePoint now);
+
+  // Notes that the process exited at |now|. Returns false if it should not be
+  // launched again, and otherwise sets |delay| to how long to wait first.
+  bool OnExited(fxl::TimePoint now, fxl::TimeDelta* delay);
+
+  int failures() const { return failures_; }
+
+ private:
+  fxl::TimeDelta initial_delay_;
+  fxl::TimeDelta stable_time_;
+  int max_failures_;
+
+  fxl::TimePoint launch_time_;
+  // Exits in a row that came within |stable_time_| of a launch.
+  int failures_ = 0;
+};
+
+}  // namespace app
+
+#endif  // GARNET_BIN_APPMGR_RESTART_BACKOFF_H_
@@ -0,0 +1,60 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/appmgr/restart_backoff.h"
+
+#include "gtest/gtest.h"
+
+namespace app {
+namespace {
+
+constexpr fxl::TimeDelta kInitialDelay = fxl::TimeDelta::FromSeconds(1);
+constexpr fxl::TimeDelta kStableTime = fxl::TimeDelta::FromSeconds(60);
+constexpr int kMaxFailures = 4;
+
+TEST(RestartBackoff, BacksOffAndGivesUp) {
+  RestartBackoff backoff(kInitialDelay, kStableTime, kMaxFailures);
+  fxl::TimePoint now = fxl::TimePoint::FromEpochDelta(
+      fxl::TimeDelta::FromSeconds(1000));
+  fxl::TimeDelta delay;
+
+  for (int64_t expected : {1, 2, 4}) {
+    backoff.OnLaunched(now);
+    now = now + fxl::TimeDelta::FromSeconds(1);
+    ASSERT_TRUE(backoff.OnExited(now, &delay));
+    EXPECT_EQ(fxl::TimeDelta::FromSeconds(expected), delay);
+    now = now + delay;
+  }
+
+  backoff.OnLaunched(now);
+  EXPECT_FALSE(backoff.OnExited(now + fxl::TimeDelta::FromSeconds(1), &delay));
+  EXPECT_EQ(kMaxFailures, backoff.failures());
+}
+
+TEST(RestartBackoff, StableRunStartsOver) {
+  RestartBackoff backoff(kInitialDelay, kStableTime, kMaxFailures);
+  fxl::TimePoint now = fxl::TimePoint::FromEpochDelta(
+      fxl::TimeDelta::FromSeconds(1000));
+  fxl::TimeDelta delay;
+
+  for (int i = 0; i < kMaxFailures - 1; ++i) {
+    backoff.OnLaunched(now);
+    ASSERT_TRUE(backoff.OnExited(now, &delay));
+  }
+  EXPECT_EQ(kMaxFailures - 1, backoff.failures());
+
+  backoff.OnLaunched(now);
+  now = now + kStableTime;
+  ASSERT_TRUE(backoff.OnExited(now, &delay));
+  EXPECT_EQ(kInitialDelay, delay);
+  EXPECT_EQ(0, backoff.failures());
+
+  backoff.OnLaunched(now);
+  ASSERT_TRUE(backoff.OnExited(now, &delay));
+  EXPECT_EQ(kInitialDelay, delay);
+  EXPECT_EQ(1, backoff.failures());
+}
+
+}  // namespace
+}  // namespace app
@@ -5,72 +5,197 @@
 #include "garnet/bin/appmgr/root_application_loader.h"
 
 #include <fcntl.h>
+#include <trace/event.h>
 
 #include <utility>
 
 #include "garnet/bin/appmgr/url_resolver.h"
 #include "lib/fsl/io/fd.h"
 #include "lib/fsl/vmo/file.h"
-#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/files/directory.h"
+#include "lib/fxl/files/path.h"
 #include "lib/fxl/logging.h"
 #include "lib/fxl/strings/concatenate.h"
 
 namespace app {
+namespace {
+
+constexpr char kPackagesPath[] = "/pkgfs/packages";
+
+// The cache is keyed by names chosen by clients, so bound its size.
+constexpr size_t kMaxCachedResolutions = 256;
+
+// How often to retry watching search directories that could not be watched,
+// rather than doing so on every load.
+constexpr fxl::TimeDelta kWatchRetryInterval = fxl::TimeDelta::FromSeconds(5);
+
+bool IsSameFile(const struct stat& a, const struct stat& b) {
+  return a.st_ino == b.st_ino && a.st_size == b.st_size &&
+         a.st_mtim.tv_sec == b.st_mtim.tv_sec &&
+         a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+}
+
+}  // namespace
 
 RootApplicationLoader::RootApplicationLoader(std::vector<std::string> path)
-    : path_(std::move(path)) {}
+    : path_(std::move(path)) {
+  search_directories_.push_back({"."});
+  search_directories_.push_back({kPackagesPath});
+  for (const auto& entry : path_)
+    search_directories_.push_back({entry});
+}
 
 RootApplicationLoader::~RootApplicationLoader() {}
 
 void RootApplicationLoader::LoadApplication(
     const fidl::String& url,
     const ApplicationLoader::LoadApplicationCallback& callback) {
+  TRACE_DURATION("appmgr", "RootApplicationLoader::LoadApplication");
   std::string path = GetPathFromURL(url);
   if (path.empty()) {
     // TODO(abarth): Support URL schemes other than file:// by querying the host
     // for an application runner.
     FXL_LOG(ERROR) << "Cannot load " << url
                    << " because the scheme is not supported.";
-  } else {
-    fxl::UniqueFD fd(open(path.c_str(), O_RDONLY));
-    if (!fd.is_valid() && path[0] != '/') {
-      if (path.find('/') == std::string::npos) {
-        // TODO(abarth): We're currently hardcoding version 0 of the package,
-        // but we'll eventually need to do something smarter.
-        std::string pkg_path = fxl::Concatenate({"/pkgfs/packages/", path, "/0"});
-        fd.reset(open(pkg_path.c_str(), O_DIRECTORY | O_RDONLY));
-        if (fd.is_valid()) {
-          zx::channel directory = fsl::CloneChannelFromFileDescriptor(fd.get());
-          if (directory) {
-            ApplicationPackagePtr package = ApplicationPackage::New();
-            package->directory = std::move(directory);
-            package->resolved_url = fxl::Concatenate({"file://", pkg_path});
-            callback(std::move(package));
-            return;
-          }
-        }
+    callback(nullptr);
+    return;
+  }
+
+  // Names without slashes resolve only to entries of the search directories,
+  // so while those are watched, how they resolve can be remembered.
+  bool cacheable =
+      path.find('/') == std::string::npos && WatchSearchDirectories();
+  if (cacheable) {
+    auto it = cache_.find(path);
+    if (it != cache_.end()) {
+      const Resolution& resolution = it->second;
+      struct stat file_stat;
+      if (!resolution.data ||
+          (stat(resolution.path.c_str(), &file_stat) == 0 &&
+           IsSameFile(file_stat, resolution.file_stat))) {
+        ApplicationPackagePtr package = CreatePackage(resolution);
+        if (!package)
+          FXL_LOG(ERROR) << "Could not load url: " << url;
+        callback(std::move(package));
+        return;
       }
-      for (const auto& entry : path_) {
-        std::string qualified_path = fxl::Concatenate({entry, "/", path});
-        fd.reset(open(qualified_path.c_str(), O_RDONLY));
-        if (fd.is_valid()) {
-          path = qualified_path;
-          break;
-        }
+      cache_.erase(it);
+    }
+  }
+
+  Resolution resolution = Resolve(path);
+  ApplicationPackagePtr package = CreatePackage(resolution);
+  if (!package)
+    FXL_LOG(ERROR) << "Could not load url: " << url;
+  // Don't remember files that were found but could not be read.
+  if (cacheable && (package || resolution.path.empty())) {
+    if (cache_.size() >= kMaxCachedResolutions)
+      cache_.clear();
+    cache_.emplace(path, std::move(resolution));
+  }
+  callback(std::move(package));
+}
+
+RootApplicationLoader::Resolution RootApplicationLoader::Resolve(
+    const std::string& path) {
+  Resolution resolution;
+  std::string found_path = path;
+  fxl::UniqueFD fd(open(path.c_str(), O_RDONLY));
+  if (!fd.is_valid() && path[0] != '/') {
+    if (path.find('/') == std::string::npos) {
+      // TODO(abarth): We're currently hardcoding version 0 of the package,
+      // but we'll eventually need to do something smarter.
+      std::string pkg_path = fxl::Concatenate({kPackagesPath, "/", path, "/0"});
+      fd.reset(open(pkg_path.c_str(), O_DIRECTORY | O_RDONLY));
+      if (fd.is_valid()) {
+        resolution.path = pkg_path;
+        resolution.directory = std::move(fd);
+        return resolution;
       }
     }
-    fsl::SizedVmo data;
-    if (fd.is_valid() && fsl::VmoFromFd(std::move(fd), &data)) {
-      ApplicationPackagePtr package = ApplicationPackage::New();
-      package->data = std::move(data).ToTransport();
-      package->resolved_url = fxl::Concatenate({"file://", path});
-      callback(std::move(package));
-      return;
+    for (const auto& entry : path_) {
+      std::string qualified_path = fxl::Concatenate({entry, "/", path});
+      fd.reset(open(qualified_path.c_str(), O_RDONLY));
+      if (fd.is_valid()) {
+        found_path = qualified_path;
+        break;
+      }
     }
-    FXL_LOG(ERROR) << "Could not load url: " << url;
   }
+  if (fd.is_valid()) {
+    resolution.path = found_path;
+    if (fstat(fd.get(), &resolution.file_stat) != 0 ||
+        !fsl::VmoFromFd(std::move(fd), &resolution.data))
+      resolution.data = fsl::SizedVmo();
+  }
+  return resolution;
+}
+
+ApplicationPackagePtr RootApplicationLoader::CreatePackage(
+    const Resolution& resolution) {
+  if (resolution.directory.is_valid()) {
+    zx::channel directory =
+        fsl::CloneChannelFromFileDescriptor(resolution.directory.get());
+    if (!directory)
+      return nullptr;
+    ApplicationPackagePtr package = ApplicationPackage::New();
+    package->directory = std::move(directory);
+    package->resolved_url = fxl::Concatenate({"file://", resolution.path});
+    return package;
+  }
+
+  // Hand out a copy-on-write clone so that the contents can be used again.
+  zx_handle_t data;
+  if (!resolution.data ||
+      zx_vmo_clone(resolution.data.vmo().get(), ZX_VMO_CLONE_COPY_ON_WRITE, 0,
+                   resolution.data.size(), &data) != ZX_OK)
+    return nullptr;
+  ApplicationPackagePtr package = ApplicationPackage::New();
+  package->data =
+      fsl::SizedVmo(zx::vmo(data), resolution.data.size()).ToTransport();
+  package->resolved_url = fxl::Concatenate({"file://", resolution.path});
+  return package;
+}
+
+bool RootApplicationLoader::WatchSearchDirectories() {
+  if (!rewatch_needed_)
+    return true;
+  fxl::TimePoint now = fxl::TimePoint::Now();
+  if (now < next_watch_attempt_)
+    return false;
+
+  bool watching_all = true;
+  for (auto& directory : search_directories_) {
+    if (directory.watcher && !directory.watcher->is_closed() &&
+        directory.watched_path == directory.path)
+      continue;
+
+    directory.watcher.reset();
+    std::string path = directory.path;
+    for (;;) {
+      directory.watcher = DirectoryWatcher::Create(
+          path, [this] { OnSearchDirectoryChanged(); });
+      if (directory.watcher || files::IsDirectory(path))
+        break;
+      std::string parent = files::GetDirectoryName(path);
+      if (parent.empty() || parent == path)
+        break;
+      path = std::move(parent);
+    }
+    directory.watched_path = std::move(path);
+    watching_all = watching_all && directory.watcher;
+  }
+
+  rewatch_needed_ = !watching_all;
+  if (!watching_all)
+    next_watch_attempt_ = now + kWatchRetryInterval;
+  return watching_all;
+}
 
-  callback(nullptr);
+void RootApplicationLoader::OnSearchDirectoryChanged() {
+  cache_.clear();
+  // The watcher that called this cannot be replaced until it returns.
+  rewatch_needed_ = true;
 }
 
 }  // namespace app
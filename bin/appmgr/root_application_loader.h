@@ -5,15 +5,23 @@
 #ifndef GARNET_BIN_APPMGR_ROOT_APPLICATION_LOADER_H_
 #define GARNET_BIN_APPMGR_ROOT_APPLICATION_LOADER_H_
 
+#include <sys/stat.h>
+
 #include <functional>
+#include <memory>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include <zx/vmo.h>
 
+#include "garnet/bin/appmgr/directory_watcher.h"
 #include "lib/app/fidl/application_loader.fidl.h"
+#include "lib/fsl/vmo/sized_vmo.h"
+#include "lib/fxl/files/unique_fd.h"
 #include "lib/fxl/macros.h"
+#include "lib/fxl/time/time_point.h"
 
 namespace app {
 
@@ -27,7 +35,55 @@ class RootApplicationLoader : public ApplicationLoader {
       const ApplicationLoader::LoadApplicationCallback& callback) override;
 
  private:
+  // Where a path was found, if anywhere.
+  struct Resolution {
+    // The path that was found, or empty if none was.
+    std::string path;
+    // Set if |path| is a package directory.
+    fxl::UniqueFD directory;
+    // Otherwise, the contents of the file at |path| and the stat() results
+    // they were read with, to notice if the file is rewritten in place.
+    fsl::SizedVmo data;
+    struct stat file_stat;
+  };
+
+  // Searches for |path| as LoadApplication always has.
+  Resolution Resolve(const std::string& path);
+
+  // Returns a package for a resolution, cloning whatever it holds so that it
+  // can be used again.
+  ApplicationPackagePtr CreatePackage(const Resolution& resolution);
+
+  // A directory that names are searched for in.
+  struct SearchDirectory {
+    std::string path;
+    // Watches |path|, or if it does not exist, the nearest ancestor that
+    // does, which notices the entry that leads to |path| being created.
+    std::unique_ptr<DirectoryWatcher> watcher;
+    std::string watched_path;
+  };
+
+  // Returns whether every search directory is being watched, starting to
+  // watch those that are not yet. Does nothing between changes, and retries
+  // directories that could not be watched at most once per retry interval.
+  bool WatchSearchDirectories();
+
+  // Called when a watched directory changes or stops being watchable.
+  void OnSearchDirectoryChanged();
+
   std::vector<std::string> path_;
+  // The current directory, the package directory and |path_|.
+  std::vector<SearchDirectory> search_directories_;
+  // Whether some search directory is watched through an ancestor, or not at
+  // all, and a change may have made it watchable.
+  bool rewatch_needed_ = true;
+  // The earliest time to retry watching directories that could not be.
+  fxl::TimePoint next_watch_attempt_;
+
+  // Resolutions of the paths without slashes that have been loaded, which can
+  // be found or created only by changing the entries of the search
+  // directories. Any such change clears the cache.
+  std::unordered_map<std::string, Resolution> cache_;
 
   FXL_DISALLOW_COPY_AND_ASSIGN(RootApplicationLoader);
 };
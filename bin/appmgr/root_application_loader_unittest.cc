@@ -0,0 +1,135 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/appmgr/root_application_loader.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "garnet/bin/appmgr/url_resolver.h"
+#include "gtest/gtest.h"
+#include "lib/fsl/tasks/message_loop.h"
+#include "lib/fsl/vmo/strings.h"
+#include "lib/fxl/files/directory.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+#include "lib/fxl/strings/concatenate.h"
+#include "lib/fxl/time/time_delta.h"
+
+namespace app {
+namespace {
+
+// Unlikely to be found anywhere but the directories the tests create.
+constexpr char kName[] = "root_application_loader_unittest_app";
+
+class RootApplicationLoaderTest : public ::testing::Test {
+ protected:
+  RootApplicationLoaderTest()
+      : first_dir_(fxl::Concatenate({temp_dir_.path(), "/first"})),
+        second_dir_(fxl::Concatenate({temp_dir_.path(), "/second"})) {}
+
+  void CreateLoader() {
+    loader_ = std::make_unique<RootApplicationLoader>(
+        std::vector<std::string>{first_dir_, second_dir_});
+  }
+
+  // Returns the contents of the file |name| loads, or an empty string if it
+  // loads nothing.
+  std::string Load(const std::string& name) {
+    std::string contents;
+    loader_->LoadApplication(
+        GetURLFromPath(name), [&contents](ApplicationPackagePtr package) {
+          if (package && package->data)
+            EXPECT_TRUE(fsl::StringFromVmo(package->data, &contents));
+        });
+    return contents;
+  }
+
+  // Loads |name| until it has |contents|, running the message loop in
+  // between so that directory changes are noticed. Returns false on timeout.
+  bool WaitForContents(const std::string& name, const std::string& contents) {
+    for (int i = 0; i < 500; ++i) {
+      if (Load(name) == contents)
+        return true;
+      message_loop_.task_runner()->PostDelayedTask(
+          [this] { message_loop_.QuitNow(); },
+          fxl::TimeDelta::FromMilliseconds(10));
+      message_loop_.Run();
+    }
+    return false;
+  }
+
+  static bool WriteApp(const std::string& dir, const std::string& contents) {
+    return files::WriteFile(fxl::Concatenate({dir, "/", kName}),
+                            contents.data(), contents.size());
+  }
+
+  fsl::MessageLoop message_loop_;
+  files::ScopedTempDir temp_dir_;
+  std::string first_dir_;
+  std::string second_dir_;
+  std::unique_ptr<RootApplicationLoader> loader_;
+};
+
+TEST_F(RootApplicationLoaderTest, LoadsFromSearchPath) {
+  ASSERT_TRUE(files::CreateDirectory(first_dir_));
+  ASSERT_TRUE(files::CreateDirectory(second_dir_));
+  ASSERT_TRUE(WriteApp(second_dir_, "second"));
+  CreateLoader();
+
+  EXPECT_EQ("second", Load(kName));
+  // Served from the cache the second time.
+  EXPECT_EQ("second", Load(kName));
+  EXPECT_EQ("", Load("root_application_loader_unittest_missing"));
+}
+
+TEST_F(RootApplicationLoaderTest, NoticesAddedAndRemovedFiles) {
+  ASSERT_TRUE(files::CreateDirectory(first_dir_));
+  ASSERT_TRUE(files::CreateDirectory(second_dir_));
+  CreateLoader();
+
+  EXPECT_EQ("", Load(kName));
+  ASSERT_TRUE(WriteApp(second_dir_, "second"));
+  EXPECT_TRUE(WaitForContents(kName, "second"));
+
+  // A file earlier in the search path takes precedence once it appears.
+  ASSERT_TRUE(WriteApp(first_dir_, "first"));
+  EXPECT_TRUE(WaitForContents(kName, "first"));
+
+  ASSERT_EQ(0, unlink(fxl::Concatenate({first_dir_, "/", kName}).c_str()));
+  EXPECT_TRUE(WaitForContents(kName, "second"));
+  ASSERT_EQ(0, unlink(fxl::Concatenate({second_dir_, "/", kName}).c_str()));
+  EXPECT_TRUE(WaitForContents(kName, ""));
+}
+
+TEST_F(RootApplicationLoaderTest, NoticesFilesRewrittenInPlace) {
+  ASSERT_TRUE(files::CreateDirectory(first_dir_));
+  ASSERT_TRUE(WriteApp(first_dir_, "before"));
+  CreateLoader();
+
+  EXPECT_EQ("before", Load(kName));
+  ASSERT_TRUE(WriteApp(first_dir_, "after, and longer"));
+  EXPECT_EQ("after, and longer", Load(kName));
+}
+
+// A search directory that does not exist yet is watched through its parent,
+// so names can still be cached, and files in it are found once it is created.
+TEST_F(RootApplicationLoaderTest, NoticesCreatedSearchDirectory) {
+  ASSERT_TRUE(files::CreateDirectory(first_dir_));
+  CreateLoader();
+
+  EXPECT_EQ("", Load(kName));
+  ASSERT_TRUE(files::CreateDirectory(second_dir_));
+  ASSERT_TRUE(WriteApp(second_dir_, "second"));
+  EXPECT_TRUE(WaitForContents(kName, "second"));
+
+  ASSERT_EQ(0, unlink(fxl::Concatenate({second_dir_, "/", kName}).c_str()));
+  EXPECT_TRUE(WaitForContents(kName, ""));
+}
+
+}  // namespace
+}  // namespace app
@@ -19,7 +19,8 @@ std::string CanonicalizeURL(const std::string& url) {
 }
 
 std::string GetPathFromURL(const std::string& url) {
-  if (url.find(kFileUriPrefix) == 0)
+  // Compare only the prefix rather than searching the whole URL for it.
+  if (url.compare(0, kFileUriPrefixLength, kFileUriPrefix) == 0)
     return url.substr(kFileUriPrefixLength);
   return std::string();
 }
@@ -0,0 +1,60 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "garnet/bin/appmgr/url_resolver.h"
+#include "lib/url/gurl.h"
+#include "lib/url/url_canon_view.h"
+
+namespace app {
+namespace {
+
+// The forms of URL that applications are typically launched with.
+const char* const kLaunchURLs[] = {
+    "sysmgr",
+    "file:///system/apps/device_runner",
+    "file:///pkgfs/packages/netstack/0/bin/app",
+    "https://fuchsia.googlesource.com/garnet/+/master/README.md",
+};
+constexpr size_t kLaunchURLCount = sizeof(kLaunchURLs) / sizeof(kLaunchURLs[0]);
+
+void Appmgr_ResolveLaunchURL(benchmark::State& state) {
+  std::string url = kLaunchURLs[state.range(0)];
+  while (state.KeepRunning()) {
+    std::string canon_url = CanonicalizeURL(url);
+    benchmark::DoNotOptimize(GetPathFromURL(canon_url));
+  }
+}
+BENCHMARK(Appmgr_ResolveLaunchURL)->DenseRange(0, kLaunchURLCount - 1);
+
+void Url_CanonicalizeGURL(benchmark::State& state) {
+  std::string url = CanonicalizeURL(kLaunchURLs[state.range(0)]);
+  while (state.KeepRunning()) {
+    url::GURL gurl(url);
+    benchmark::DoNotOptimize(gurl.path());
+  }
+}
+BENCHMARK(Url_CanonicalizeGURL)->DenseRange(0, kLaunchURLCount - 1);
+
+void Url_CanonicalizeView(benchmark::State& state) {
+  std::string url = CanonicalizeURL(kLaunchURLs[state.range(0)]);
+  while (state.KeepRunning()) {
+    url::RawCanonOutput<> output;
+    url::CanonicalURLView view(url, &output);
+    benchmark::DoNotOptimize(view.path());
+  }
+}
+BENCHMARK(Url_CanonicalizeView)->DenseRange(0, kLaunchURLCount - 1);
+
+}  // namespace
+}  // namespace app
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
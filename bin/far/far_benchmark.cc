@@ -0,0 +1,200 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "garnet/lib/far/archive_reader.h"
+#include "garnet/lib/far/archive_writer.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/logging.h"
+
+namespace archive {
+namespace {
+
+// Creates |state.range(0)| files of |state.range(1)| KiB each in |dir|. Every
+// |duplicate_every|th file repeats the contents of the previous one, as with
+// the icons and locale files shared between the components of a package.
+std::vector<std::string> MakeInputs(const benchmark::State& state,
+                                    files::ScopedTempDir* dir,
+                                    int duplicate_every) {
+  std::vector<std::string> paths;
+  std::string contents(state.range(1) * 1024, '\0');
+  for (int i = 0; i < state.range(0); ++i) {
+    if (!duplicate_every || i % duplicate_every)
+      contents.replace(0, sizeof(i), reinterpret_cast<const char*>(&i),
+                       sizeof(i));
+    std::string path;
+    FXL_CHECK(dir->NewTempFile(&path));
+    FXL_CHECK(files::WriteFile(path, contents.data(), contents.size()));
+    paths.push_back(std::move(path));
+  }
+  return paths;
+}
+
+void WriteArchive(const std::vector<std::string>& inputs,
+                  const std::string& archive_path,
+                  size_t thread_count,
+                  bool deduplicate,
+                  bool compress = false) {
+  ArchiveWriter writer;
+  writer.set_copy_thread_count(thread_count);
+  writer.set_deduplicate_contents(deduplicate);
+  writer.set_compress_contents(compress);
+  for (size_t i = 0; i < inputs.size(); ++i)
+    writer.Add(ArchiveEntry(inputs[i], "data/" + std::to_string(i)));
+  fxl::UniqueFD fd(open(archive_path.c_str(), O_RDWR | O_CREAT | O_TRUNC,
+                        S_IRUSR | S_IWUSR));
+  FXL_CHECK(writer.Write(fd.get()));
+}
+
+void Far_Write(benchmark::State& state,
+               size_t thread_count,
+               bool deduplicate,
+               bool compress = false) {
+  files::ScopedTempDir dir;
+  std::vector<std::string> inputs = MakeInputs(state, &dir, 4);
+  std::string archive_path = dir.path() + "/archive.far";
+  while (state.KeepRunning())
+    WriteArchive(inputs, archive_path, thread_count, deduplicate, compress);
+
+  uint64_t archive_size = 0;
+  files::GetFileSize(archive_path, &archive_size);
+  state.counters["archive_bytes"] = archive_size;
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          state.range(1) * 1024);
+}
+
+void Far_WriteSerial(benchmark::State& state) {
+  Far_Write(state, 1u, false);
+}
+BENCHMARK(Far_WriteSerial)->UseRealTime()->Args({1000, 4})->Args({64, 1024});
+
+void Far_WriteParallel(benchmark::State& state) {
+  Far_Write(state, 8u, false);
+}
+BENCHMARK(Far_WriteParallel)->UseRealTime()->Args({1000, 4})->Args({64, 1024});
+
+void Far_WriteDeduplicated(benchmark::State& state) {
+  Far_Write(state, 8u, true);
+}
+BENCHMARK(Far_WriteDeduplicated)
+    ->UseRealTime()
+    ->Args({1000, 4})
+    ->Args({64, 1024});
+
+void Far_WriteCompressed(benchmark::State& state) {
+  Far_Write(state, 8u, false, true);
+}
+BENCHMARK(Far_WriteCompressed)
+    ->UseRealTime()
+    ->Args({1000, 4})
+    ->Args({64, 1024});
+
+void Far_OpenAndLookUp(benchmark::State& state) {
+  files::ScopedTempDir dir;
+  std::vector<std::string> inputs = MakeInputs(state, &dir, 0);
+  std::string archive_path = dir.path() + "/archive.far";
+  WriteArchive(inputs, archive_path, 1u, false);
+
+  std::string path = "data/" + std::to_string(state.range(0) / 2);
+  while (state.KeepRunning()) {
+    ArchiveReader reader(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+    FXL_CHECK(reader.Read());
+    DirectoryTableEntry entry;
+    FXL_CHECK(reader.GetDirectoryEntryByPath(path, &entry));
+  }
+}
+BENCHMARK(Far_OpenAndLookUp)->Args({16, 1})->Args({10000, 1});
+
+void Far_Extract(benchmark::State& state) {
+  files::ScopedTempDir dir;
+  std::vector<std::string> inputs = MakeInputs(state, &dir, 0);
+  std::string archive_path = dir.path() + "/archive.far";
+  WriteArchive(inputs, archive_path, 1u, false);
+
+  ArchiveReader reader(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+  FXL_CHECK(reader.Read());
+  std::string output_dir = dir.path() + "/out";
+  while (state.KeepRunning())
+    FXL_CHECK(reader.Extract(output_dir));
+  state.SetBytesProcessed(state.iterations() * state.range(0) *
+                          state.range(1) * 1024);
+}
+BENCHMARK(Far_Extract)->Args({1000, 4})->Args({64, 1024});
+
+// Reads 4 KiB from random offsets of a file, which for a compressed archive
+// decompresses only the frames that are touched.
+void Far_RandomRead(benchmark::State& state, bool compress) {
+  files::ScopedTempDir dir;
+  std::vector<std::string> inputs = MakeInputs(state, &dir, 0);
+  std::string archive_path = dir.path() + "/archive.far";
+  WriteArchive(inputs, archive_path, 1u, false, compress);
+
+  ArchiveReader reader(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+  FXL_CHECK(reader.Read());
+  DirectoryTableEntry entry;
+  FXL_CHECK(reader.GetDirectoryEntryByPath("data/0", &entry));
+  uint64_t length = 0;
+  FXL_CHECK(reader.GetContentLength(entry, &length));
+
+  std::vector<char> buffer(4096);
+  uint64_t offset = 0;
+  while (state.KeepRunning()) {
+    offset = (offset * 6364136223846793005u + 1442695040888963407u) %
+             (length - buffer.size());
+    FXL_CHECK(reader.ReadContents(entry, offset, buffer.size(),
+                                  buffer.data()));
+  }
+
+  uint64_t archive_size = 0;
+  files::GetFileSize(archive_path, &archive_size);
+  state.counters["archive_bytes"] = archive_size;
+  state.counters["stored_bytes"] = entry.data_length;
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+void Far_RandomReadStored(benchmark::State& state) {
+  Far_RandomRead(state, false);
+}
+BENCHMARK(Far_RandomReadStored)->Args({1, 1024})->Args({1, 16384});
+
+void Far_RandomReadCompressed(benchmark::State& state) {
+  Far_RandomRead(state, true);
+}
+BENCHMARK(Far_RandomReadCompressed)->Args({1, 1024})->Args({1, 16384});
+
+void Far_OpenCompressed(benchmark::State& state) {
+  files::ScopedTempDir dir;
+  std::vector<std::string> inputs = MakeInputs(state, &dir, 0);
+  std::string archive_path = dir.path() + "/archive.far";
+  WriteArchive(inputs, archive_path, 1u, false, true);
+
+  std::string path = "data/" + std::to_string(state.range(0) / 2);
+  char byte;
+  while (state.KeepRunning()) {
+    ArchiveReader reader(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+    FXL_CHECK(reader.Read());
+    DirectoryTableEntry entry;
+    FXL_CHECK(reader.GetDirectoryEntryByPath(path, &entry));
+    FXL_CHECK(reader.ReadContents(entry, 0, 1, &byte));
+  }
+}
+BENCHMARK(Far_OpenCompressed)->Args({16, 64})->Args({10000, 4});
+
+}  // namespace
+}  // namespace archive
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -40,17 +40,17 @@ MultiprocTaskRunner::~MultiprocTaskRunner() {
   }
 }
 
-void MultiprocTaskRunner::PostTask(fxl::Closure task) {
-  fxl::Closure* task_copy = new fxl::Closure(task);
+void MultiprocTaskRunner::PostTask(fxl::TaskClosure task) {
+  fxl::TaskClosure* task_copy = new fxl::TaskClosure(std::move(task));
   QueuePacket(kUpdateKey, task_copy);
 }
 
-void MultiprocTaskRunner::PostTaskForTime(fxl::Closure task,
+void MultiprocTaskRunner::PostTaskForTime(fxl::TaskClosure task,
                                           fxl::TimePoint target_time) {
   FXL_CHECK(false) << "MultiprocTaskRunner::PostTaskForTime not implemented";
 }
 
-void MultiprocTaskRunner::PostDelayedTask(fxl::Closure task,
+void MultiprocTaskRunner::PostDelayedTask(fxl::TaskClosure task,
                                           fxl::TimeDelta delay) {
   FXL_CHECK(false) << "MultiprocTaskRunner::PostDelayedTask not implemented";
 }
@@ -77,7 +77,8 @@ void MultiprocTaskRunner::Worker(uint32_t thread_number) {
       break;
     }
 
-    fxl::Closure* task = reinterpret_cast<fxl::Closure*>(packet.user.u64[0]);
+    fxl::TaskClosure* task =
+        reinterpret_cast<fxl::TaskClosure*>(packet.user.u64[0]);
     FXL_DCHECK(task);
     (*task)();
     delete task;
@@ -22,11 +22,12 @@ class MultiprocTaskRunner : public fxl::TaskRunner {
   ~MultiprocTaskRunner();
 
   // TaskRunner implementation.
-  void PostTask(fxl::Closure task) override;
+  void PostTask(fxl::TaskClosure task) override;
 
-  void PostTaskForTime(fxl::Closure task, fxl::TimePoint target_time) override;
+  void PostTaskForTime(fxl::TaskClosure task,
+                       fxl::TimePoint target_time) override;
 
-  void PostDelayedTask(fxl::Closure task, fxl::TimeDelta delay) override;
+  void PostDelayedTask(fxl::TaskClosure task, fxl::TimeDelta delay) override;
 
   bool RunsTasksOnCurrentThread() override;
 
@@ -21,6 +21,12 @@ void AddressResponder::Start(const std::string& host_full_name) {
   host_full_name_ = host_full_name;
 }
 
+bool AddressResponder::WantsRecord(DnsType type, uint32_t name_hash) {
+  return (type == DnsType::kA || type == DnsType::kAaaa ||
+          type == DnsType::kAny) &&
+         name_hash == DnsNameHash(host_full_name_);
+}
+
 void AddressResponder::ReceiveQuestion(const DnsQuestion& question,
                                        const ReplyAddress& reply_address) {
   if ((question.type_ == DnsType::kA || question.type_ == DnsType::kAaaa ||
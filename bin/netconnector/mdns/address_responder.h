@@ -25,6 +25,8 @@ class AddressResponder : public MdnsAgent {
   // MdnsAgent overrides.
   void Start(const std::string& host_full_name) override;
 
+  bool WantsRecord(DnsType type, uint32_t name_hash) override;
+
   void ReceiveQuestion(const DnsQuestion& question,
                        const ReplyAddress& reply_address) override;
 
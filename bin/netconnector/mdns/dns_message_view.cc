@@ -0,0 +1,341 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/netconnector/mdns/dns_message_view.h"
+
+#include <string.h>
+
+#include "garnet/bin/netconnector/mdns/dns_reading.h"
+#include "lib/fxl/logging.h"
+
+namespace netconnector {
+namespace mdns {
+namespace {
+
+// Max record count per section, as enforced when reading a |DnsMessage|.
+static constexpr uint16_t kMaxRecords = 1024;
+
+// 32-bit FNV-1a.
+static constexpr uint32_t kHashOffsetBasis = 2166136261u;
+static constexpr uint32_t kHashPrime = 16777619u;
+
+uint32_t HashBytes(uint32_t hash, const uint8_t* bytes, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kHashPrime;
+  }
+
+  return hash;
+}
+
+// Calls |label(bytes, size)| for each label of the name at |offset| in
+// |packet|, following compression pointers. Returns false if the name is
+// malformed. If |end| isn't null, it's set to the offset just past the name
+// as it appears at |offset|.
+template <typename LabelFunction>
+bool WalkName(const uint8_t* packet,
+              size_t packet_size,
+              size_t offset,
+              size_t* end,
+              LabelFunction label) {
+  size_t position = offset;
+  size_t start_position_of_current_run = offset;
+  size_t end_position_of_original_run = 0;
+
+  while (true) {
+    if (position >= packet_size) {
+      return false;
+    }
+
+    uint8_t label_size = packet[position++];
+
+    if (label_size & 0xc0) {
+      // We have an offset rather than the actual name. The offset is in the
+      // 14 bits following two 1's.
+      if (position >= packet_size) {
+        return false;
+      }
+
+      size_t target = ((label_size & 0x3f) << 8) | packet[position++];
+
+      if (target >= start_position_of_current_run) {
+        // This is an attempt to loop or point forward: bad in either case.
+        return false;
+      }
+
+      if (end_position_of_original_run == 0) {
+        end_position_of_original_run = position;
+      }
+
+      position = target;
+      start_position_of_current_run = target;
+      continue;
+    }
+
+    if (label_size == 0) {
+      // End of name.
+      break;
+    }
+
+    if (packet_size - position < label_size) {
+      return false;
+    }
+
+    label(packet + position, label_size);
+    position += label_size;
+  }
+
+  if (end != nullptr) {
+    *end = end_position_of_original_run != 0 ? end_position_of_original_run
+                                             : position;
+  }
+
+  return true;
+}
+
+}  // namespace
+
+uint32_t DnsNameHash(const std::string& dotted_string) {
+  return HashBytes(kHashOffsetBasis,
+                   reinterpret_cast<const uint8_t*>(dotted_string.data()),
+                   dotted_string.size());
+}
+
+uint32_t DnsNameView::Hash() const {
+  static constexpr uint8_t kDot = '.';
+  uint32_t hash = kHashOffsetBasis;
+  bool valid = WalkName(packet_, packet_size_, offset_, nullptr,
+                        [&hash](const uint8_t* bytes, size_t size) {
+                          hash = HashBytes(hash, bytes, size);
+                          hash = HashBytes(hash, &kDot, 1);
+                        });
+  FXL_DCHECK(valid);
+  return hash;
+}
+
+bool DnsNameView::Equals(const std::string& dotted_string) const {
+  size_t position = 0;
+  bool equal = true;
+  bool valid = WalkName(
+      packet_, packet_size_, offset_, nullptr,
+      [&dotted_string, &position, &equal](const uint8_t* bytes, size_t size) {
+        if (!equal || dotted_string.size() - position < size + 1 ||
+            memcmp(dotted_string.data() + position, bytes, size) != 0 ||
+            dotted_string[position + size] != '.') {
+          equal = false;
+          return;
+        }
+
+        position += size + 1;
+      });
+  FXL_DCHECK(valid);
+  return equal && position == dotted_string.size();
+}
+
+std::string DnsNameView::ToString() const {
+  std::string result;
+  bool valid = WalkName(packet_, packet_size_, offset_, nullptr,
+                        [&result](const uint8_t* bytes, size_t size) {
+                          result.append(reinterpret_cast<const char*>(bytes),
+                                        size);
+                          result.push_back('.');
+                        });
+  FXL_DCHECK(valid);
+  return result;
+}
+
+DnsMessageView::DnsMessageView() {}
+
+DnsMessageView::~DnsMessageView() {}
+
+bool DnsMessageView::Parse(const uint8_t* data, size_t size) {
+  FXL_DCHECK(data != nullptr || size == 0);
+
+  Clear();
+  packet_ = data;
+  packet_size_ = size;
+
+  PacketReader reader(data, size);
+  reader >> header_;
+
+  if (header_.question_count_ > kMaxRecords ||
+      header_.answer_count_ > kMaxRecords ||
+      header_.authority_count_ > kMaxRecords ||
+      header_.additional_count_ > kMaxRecords) {
+    FXL_DLOG(ERROR) << "Max record count exceeded; rejecting message.";
+    reader.MarkUnhealthy();
+  }
+
+  if (!reader.healthy() ||
+      !ReadQuestions(reader, header_.question_count_, &questions_) ||
+      !ReadResources(reader, header_.answer_count_, &answers_) ||
+      !ReadResources(reader, header_.authority_count_, &authorities_) ||
+      !ReadResources(reader, header_.additional_count_, &additionals_) ||
+      !reader.complete()) {
+    Clear();
+    return false;
+  }
+
+  return true;
+}
+
+std::shared_ptr<DnsQuestion> DnsMessageView::Materialize(
+    const DnsQuestionView& view) const {
+  PacketReader reader(packet_, packet_size_);
+  reader.SetBytesConsumed(view.offset_);
+
+  std::shared_ptr<DnsQuestion> question;
+  reader >> question;
+
+  return reader.healthy() ? question : nullptr;
+}
+
+std::shared_ptr<DnsResource> DnsMessageView::Materialize(
+    const DnsResourceView& view) const {
+  PacketReader reader(packet_, packet_size_);
+  reader.SetBytesConsumed(view.offset_);
+
+  std::shared_ptr<DnsResource> resource;
+  reader >> resource;
+
+  // The data must account for exactly |data_size_| bytes.
+  if (!reader.healthy() ||
+      reader.bytes_consumed() != view.data_offset_ + view.data_size_) {
+    return nullptr;
+  }
+
+  return resource;
+}
+
+std::unique_ptr<DnsMessage> DnsMessageView::ToMessage(
+    const DnsRecordFilter& filter) const {
+  std::unique_ptr<DnsMessage> message = std::make_unique<DnsMessage>();
+  message->header_ = header_;
+
+  for (const DnsQuestionView& view : questions_) {
+    if (filter && !filter(view.type_, view.name_.Hash())) {
+      continue;
+    }
+
+    std::shared_ptr<DnsQuestion> question = Materialize(view);
+    if (!question) {
+      return nullptr;
+    }
+
+    message->questions_.push_back(std::move(question));
+  }
+
+  if (!MaterializeResources(answers_, filter, &message->answers_) ||
+      !MaterializeResources(authorities_, filter, &message->authorities_) ||
+      !MaterializeResources(additionals_, filter, &message->additionals_)) {
+    return nullptr;
+  }
+
+  message->UpdateCounts();
+  return message;
+}
+
+void DnsMessageView::Clear() {
+  packet_ = nullptr;
+  packet_size_ = 0;
+  header_ = DnsHeader();
+  questions_.clear();
+  answers_.clear();
+  authorities_.clear();
+  additionals_.clear();
+}
+
+bool DnsMessageView::ReadName(PacketReader& reader, DnsNameView* name) {
+  FXL_DCHECK(name != nullptr);
+
+  size_t offset = reader.bytes_consumed();
+  size_t end;
+  if (!WalkName(packet_, packet_size_, offset, &end,
+                [](const uint8_t* bytes, size_t size) {})) {
+    reader.MarkUnhealthy();
+    return false;
+  }
+
+  *name = DnsNameView(packet_, packet_size_, offset);
+  return reader.SetBytesConsumed(end);
+}
+
+bool DnsMessageView::ReadQuestions(PacketReader& reader,
+                                   uint16_t count,
+                                   std::vector<DnsQuestionView>* questions) {
+  FXL_DCHECK(questions != nullptr);
+
+  for (uint16_t i = 0; i < count && reader.healthy(); ++i) {
+    DnsQuestionView question;
+    question.offset_ = reader.bytes_consumed();
+
+    DnsClassAndFlag class_and_flag;
+    if (!ReadName(reader, &question.name_) ||
+        !(reader >> question.type_ >> class_and_flag).healthy()) {
+      break;
+    }
+
+    question.class_ = class_and_flag.class_;
+    question.unicast_response_ = class_and_flag.flag_;
+    questions->push_back(question);
+  }
+
+  return reader.healthy();
+}
+
+bool DnsMessageView::ReadResources(PacketReader& reader,
+                                   uint16_t count,
+                                   std::vector<DnsResourceView>* resources) {
+  FXL_DCHECK(resources != nullptr);
+
+  for (uint16_t i = 0; i < count && reader.healthy(); ++i) {
+    DnsResourceView resource;
+    resource.offset_ = reader.bytes_consumed();
+
+    DnsClassAndFlag class_and_flag;
+    if (!ReadName(reader, &resource.name_) ||
+        !(reader >> resource.type_ >> class_and_flag >>
+          resource.time_to_live_ >> resource.data_size_)
+             .healthy()) {
+      break;
+    }
+
+    resource.class_ = class_and_flag.class_;
+    resource.cache_flush_ = class_and_flag.flag_;
+    resource.data_offset_ = reader.bytes_consumed();
+
+    // The data is decoded when the resource is materialized.
+    if (reader.Bytes(resource.data_size_) == nullptr) {
+      break;
+    }
+
+    resources->push_back(resource);
+  }
+
+  return reader.healthy();
+}
+
+bool DnsMessageView::MaterializeResources(
+    const std::vector<DnsResourceView>& views,
+    const DnsRecordFilter& filter,
+    std::vector<std::shared_ptr<DnsResource>>* resources) const {
+  FXL_DCHECK(resources != nullptr);
+
+  for (const DnsResourceView& view : views) {
+    if (filter && !filter(view.type_, view.name_.Hash())) {
+      continue;
+    }
+
+    std::shared_ptr<DnsResource> resource = Materialize(view);
+    if (!resource) {
+      return false;
+    }
+
+    resources->push_back(std::move(resource));
+  }
+
+  return true;
+}
+
+}  // namespace mdns
+}  // namespace netconnector
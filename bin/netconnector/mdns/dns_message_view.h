@@ -0,0 +1,159 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "garnet/bin/netconnector/mdns/dns_message.h"
+#include "garnet/bin/netconnector/mdns/packet_reader.h"
+#include "lib/fxl/macros.h"
+
+namespace netconnector {
+namespace mdns {
+
+// Decides whether a received record is of interest, given its type and the
+// hash of its name (see |DnsNameHash|).
+using DnsRecordFilter = std::function<bool(DnsType type, uint32_t name_hash)>;
+
+// Returns the hash of the domain name |dotted_string|, which ends with a '.',
+// as returned by |DnsNameView::Hash|.
+uint32_t DnsNameHash(const std::string& dotted_string);
+
+// Domain name in a received packet. The name isn't decoded until it's needed,
+// and compressed names are followed back through the packet rather than being
+// copied out of it.
+class DnsNameView {
+ public:
+  DnsNameView() {}
+
+  // Constructs a view of the name at |offset| in the |packet_size| bytes at
+  // |packet|. The name must have been validated by |DnsMessageView::Parse|.
+  DnsNameView(const uint8_t* packet, size_t packet_size, size_t offset)
+      : packet_(packet), packet_size_(packet_size), offset_(offset) {}
+
+  // Returns the hash of the name, which is the same as |DnsNameHash| returns
+  // for the dotted string. Doesn't allocate.
+  uint32_t Hash() const;
+
+  // Determines whether the name is |dotted_string|. Doesn't allocate.
+  bool Equals(const std::string& dotted_string) const;
+
+  // Returns the name as a dotted string, as it would appear in a |DnsName|.
+  std::string ToString() const;
+
+ private:
+  const uint8_t* packet_ = nullptr;
+  size_t packet_size_ = 0;
+  size_t offset_ = 0;
+};
+
+// Question record in a received packet.
+struct DnsQuestionView {
+  DnsNameView name_;
+  DnsType type_;
+  DnsClass class_;
+  bool unicast_response_;
+  // Offset of the record in the packet.
+  size_t offset_;
+};
+
+// Resource record in a received packet. The resource data isn't decoded.
+struct DnsResourceView {
+  DnsNameView name_;
+  DnsType type_;
+  DnsClass class_;
+  bool cache_flush_;
+  uint32_t time_to_live_;
+  // Offsets of the record and its data in the packet.
+  size_t offset_;
+  size_t data_offset_;
+  uint16_t data_size_;
+};
+
+// Parses received DNS messages without allocating. The records of a message
+// are presented as views into the packet, so they can be inspected (by type
+// and name, for example) before any of them are turned into |DnsQuestion| and
+// |DnsResource| objects. A |DnsMessageView| may be reused for many packets,
+// in which case its record vectors are only reallocated when a message has
+// more records than any message before it.
+class DnsMessageView {
+ public:
+  DnsMessageView();
+
+  ~DnsMessageView();
+
+  // Parses the |size| bytes at |data|, which must outlive the use of the
+  // records of this view. Returns false if the packet isn't a well-formed
+  // message, in which case the view is empty.
+  bool Parse(const uint8_t* data, size_t size);
+
+  const DnsHeader& header() const { return header_; }
+
+  const std::vector<DnsQuestionView>& questions() const { return questions_; }
+
+  const std::vector<DnsResourceView>& answers() const { return answers_; }
+
+  const std::vector<DnsResourceView>& authorities() const {
+    return authorities_;
+  }
+
+  const std::vector<DnsResourceView>& additionals() const {
+    return additionals_;
+  }
+
+  // Returns the question or resource described by |view|, which must be one
+  // of the records of this view. Returns nullptr if the record is malformed.
+  std::shared_ptr<DnsQuestion> Materialize(const DnsQuestionView& view) const;
+  std::shared_ptr<DnsResource> Materialize(const DnsResourceView& view) const;
+
+  // Returns a message containing the records accepted by |filter|, or all of
+  // them if |filter| is null. Returns nullptr if an accepted record is
+  // malformed.
+  std::unique_ptr<DnsMessage> ToMessage(
+      const DnsRecordFilter& filter = nullptr) const;
+
+ private:
+  void Clear();
+
+  // Reads the name at the read position of |reader| into |name|, leaving the
+  // reader positioned after the name. Returns the resulting value of
+  // |reader.healthy()|.
+  bool ReadName(PacketReader& reader, DnsNameView* name);
+
+  // Reads |count| records from |reader| into |questions| or |resources|.
+  // Returns the resulting value of |reader.healthy()|.
+  bool ReadQuestions(PacketReader& reader,
+                     uint16_t count,
+                     std::vector<DnsQuestionView>* questions);
+  bool ReadResources(PacketReader& reader,
+                     uint16_t count,
+                     std::vector<DnsResourceView>* resources);
+
+  // Appends the resources in |views| that are accepted by |filter| to
+  // |resources|. Returns false if an accepted resource is malformed.
+  bool MaterializeResources(
+      const std::vector<DnsResourceView>& views,
+      const DnsRecordFilter& filter,
+      std::vector<std::shared_ptr<DnsResource>>* resources) const;
+
+  const uint8_t* packet_ = nullptr;
+  size_t packet_size_ = 0;
+  DnsHeader header_;
+  std::vector<DnsQuestionView> questions_;
+  std::vector<DnsResourceView> answers_;
+  std::vector<DnsResourceView> authorities_;
+  std::vector<DnsResourceView> additionals_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(DnsMessageView);
+};
+
+}  // namespace mdns
+}  // namespace netconnector
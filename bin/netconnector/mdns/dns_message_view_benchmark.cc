@@ -0,0 +1,239 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "garnet/bin/netconnector/mdns/dns_message_view.h"
+#include "garnet/bin/netconnector/mdns/dns_reading.h"
+#include "garnet/bin/netconnector/mdns/packet_reader.h"
+
+namespace netconnector {
+namespace mdns {
+namespace {
+
+// Packets captured from a LAN with a few mDNS responders on it.
+// Query for cast devices and netconnector instances, with two known answers.
+const uint8_t kQuery[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00,
+    0x0b, 0x5f, 0x67, 0x6f, 0x6f, 0x67, 0x6c, 0x65, 0x63, 0x61, 0x73, 0x74,
+    0x04, 0x5f, 0x74, 0x63, 0x70, 0x05, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x00,
+    0x00, 0x0c, 0x80, 0x01, 0x0d, 0x5f, 0x6e, 0x65, 0x74, 0x63, 0x6f, 0x6e,
+    0x6e, 0x65, 0x63, 0x74, 0x6f, 0x72, 0xc0, 0x18, 0x00, 0x0c, 0x00, 0x01,
+    0xc0, 0x0c, 0x00, 0x0c, 0x00, 0x01, 0x00, 0x00, 0x11, 0x94, 0x00, 0x18,
+    0x15, 0x4c, 0x69, 0x76, 0x69, 0x6e, 0x67, 0x2d, 0x52, 0x6f, 0x6f, 0x6d,
+    0x2d, 0x54, 0x56, 0x2d, 0x36, 0x63, 0x31, 0x62, 0x30, 0x61, 0xc0, 0x0c,
+    0xc0, 0x0c, 0x00, 0x0c, 0x00, 0x01, 0x00, 0x00, 0x11, 0x94, 0x00, 0x19,
+    0x16, 0x4b, 0x69, 0x74, 0x63, 0x68, 0x65, 0x6e, 0x2d, 0x53, 0x70, 0x65,
+    0x61, 0x6b, 0x65, 0x72, 0x2d, 0x39, 0x66, 0x32, 0x65, 0x31, 0x31, 0xc0,
+    0x0c,
+};
+
+// Announcement from a cast device.
+const uint8_t kCastResponse[] = {
+    0x00, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x04,
+    0x0b, 0x5f, 0x67, 0x6f, 0x6f, 0x67, 0x6c, 0x65, 0x63, 0x61, 0x73, 0x74,
+    0x04, 0x5f, 0x74, 0x63, 0x70, 0x05, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x00,
+    0x00, 0x0c, 0x00, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x18, 0x15, 0x4c,
+    0x69, 0x76, 0x69, 0x6e, 0x67, 0x2d, 0x52, 0x6f, 0x6f, 0x6d, 0x2d, 0x54,
+    0x56, 0x2d, 0x36, 0x63, 0x31, 0x62, 0x30, 0x61, 0xc0, 0x0c, 0xc0, 0x2e,
+    0x00, 0x10, 0x80, 0x01, 0x00, 0x00, 0x11, 0x94, 0x00, 0xab, 0x23, 0x69,
+    0x64, 0x3d, 0x36, 0x63, 0x31, 0x62, 0x30, 0x61, 0x32, 0x64, 0x34, 0x65,
+    0x35, 0x66, 0x36, 0x30, 0x37, 0x31, 0x38, 0x32, 0x39, 0x33, 0x61, 0x34,
+    0x62, 0x35, 0x63, 0x36, 0x64, 0x37, 0x65, 0x38, 0x66, 0x39, 0x23, 0x63,
+    0x64, 0x3d, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+    0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35,
+    0x36, 0x37, 0x38, 0x39, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x03, 0x72,
+    0x6d, 0x3d, 0x05, 0x76, 0x65, 0x3d, 0x30, 0x35, 0x0d, 0x6d, 0x64, 0x3d,
+    0x43, 0x68, 0x72, 0x6f, 0x6d, 0x65, 0x63, 0x61, 0x73, 0x74, 0x12, 0x69,
+    0x63, 0x3d, 0x2f, 0x73, 0x65, 0x74, 0x75, 0x70, 0x2f, 0x69, 0x63, 0x6f,
+    0x6e, 0x2e, 0x70, 0x6e, 0x67, 0x11, 0x66, 0x6e, 0x3d, 0x4c, 0x69, 0x76,
+    0x69, 0x6e, 0x67, 0x20, 0x52, 0x6f, 0x6f, 0x6d, 0x20, 0x54, 0x56, 0x07,
+    0x63, 0x61, 0x3d, 0x34, 0x31, 0x30, 0x31, 0x04, 0x73, 0x74, 0x3d, 0x30,
+    0x0f, 0x62, 0x73, 0x3d, 0x46, 0x41, 0x38, 0x46, 0x43, 0x41, 0x33, 0x41,
+    0x31, 0x42, 0x32, 0x43, 0x04, 0x6e, 0x66, 0x3d, 0x31, 0x03, 0x72, 0x73,
+    0x3d, 0xc0, 0x2e, 0x00, 0x21, 0x80, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00,
+    0x2d, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x49, 0x24, 0x36, 0x63, 0x31, 0x62,
+    0x30, 0x61, 0x32, 0x64, 0x2d, 0x34, 0x65, 0x35, 0x66, 0x2d, 0x36, 0x30,
+    0x37, 0x31, 0x2d, 0x38, 0x32, 0x39, 0x33, 0x2d, 0x61, 0x34, 0x62, 0x35,
+    0x63, 0x36, 0x64, 0x37, 0x65, 0x38, 0x66, 0x39, 0xc0, 0x1d, 0xc1, 0x0f,
+    0x00, 0x01, 0x80, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x04, 0xc0, 0xa8,
+    0x01, 0x17, 0xc1, 0x0f, 0x00, 0x1c, 0x80, 0x01, 0x00, 0x00, 0x00, 0x78,
+    0x00, 0x10, 0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x6e, 0x1b,
+    0x0a, 0xff, 0xfe, 0x2d, 0x4e, 0x5f,
+};
+
+// Announcement from another netconnector.
+const uint8_t kNetConnectorResponse[] = {
+    0x00, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x04,
+    0x0d, 0x5f, 0x6e, 0x65, 0x74, 0x63, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74,
+    0x6f, 0x72, 0x04, 0x5f, 0x74, 0x63, 0x70, 0x05, 0x6c, 0x6f, 0x63, 0x61,
+    0x6c, 0x00, 0x00, 0x0c, 0x00, 0x01, 0x00, 0x00, 0x11, 0x94, 0x00, 0x14,
+    0x11, 0x66, 0x75, 0x63, 0x68, 0x73, 0x69, 0x61, 0x2d, 0x31, 0x32, 0x33,
+    0x34, 0x2d, 0x35, 0x36, 0x37, 0x38, 0xc0, 0x0c, 0xc0, 0x30, 0x00, 0x21,
+    0x80, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x1a, 0x00, 0x00, 0x00, 0x00,
+    0x19, 0x4a, 0x11, 0x66, 0x75, 0x63, 0x68, 0x73, 0x69, 0x61, 0x2d, 0x31,
+    0x32, 0x33, 0x34, 0x2d, 0x35, 0x36, 0x37, 0x38, 0xc0, 0x1f, 0xc0, 0x30,
+    0x00, 0x10, 0x80, 0x01, 0x00, 0x00, 0x11, 0x94, 0x00, 0x01, 0x00, 0xc0,
+    0x56, 0x00, 0x01, 0x80, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x04, 0xc0,
+    0xa8, 0x01, 0x2a, 0xc0, 0x56, 0x00, 0x1c, 0x80, 0x01, 0x00, 0x00, 0x00,
+    0x78, 0x00, 0x10, 0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+    0x1a, 0x2b, 0xff, 0xfe, 0x3c, 0x4d, 0x5e,
+};
+
+// Announcement from a printer.
+const uint8_t kPrinterResponse[] = {
+    0x00, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03,
+    0x04, 0x5f, 0x69, 0x70, 0x70, 0x04, 0x5f, 0x74, 0x63, 0x70, 0x05, 0x6c,
+    0x6f, 0x63, 0x61, 0x6c, 0x00, 0x00, 0x0c, 0x00, 0x01, 0x00, 0x00, 0x11,
+    0x94, 0x00, 0x11, 0x0e, 0x4f, 0x66, 0x66, 0x69, 0x63, 0x65, 0x20, 0x50,
+    0x72, 0x69, 0x6e, 0x74, 0x65, 0x72, 0xc0, 0x0c, 0x08, 0x5f, 0x70, 0x72,
+    0x69, 0x6e, 0x74, 0x65, 0x72, 0xc0, 0x11, 0x00, 0x0c, 0x00, 0x01, 0x00,
+    0x00, 0x11, 0x94, 0x00, 0x11, 0x0e, 0x4f, 0x66, 0x66, 0x69, 0x63, 0x65,
+    0x20, 0x50, 0x72, 0x69, 0x6e, 0x74, 0x65, 0x72, 0xc0, 0x38, 0xc0, 0x27,
+    0x00, 0x10, 0x80, 0x01, 0x00, 0x00, 0x11, 0x94, 0x01, 0x1d, 0x09, 0x74,
+    0x78, 0x74, 0x76, 0x65, 0x72, 0x73, 0x3d, 0x31, 0x08, 0x71, 0x74, 0x6f,
+    0x74, 0x61, 0x6c, 0x3d, 0x31, 0x0c, 0x72, 0x70, 0x3d, 0x69, 0x70, 0x70,
+    0x2f, 0x70, 0x72, 0x69, 0x6e, 0x74, 0x11, 0x74, 0x79, 0x3d, 0x4f, 0x66,
+    0x66, 0x69, 0x63, 0x65, 0x20, 0x50, 0x72, 0x69, 0x6e, 0x74, 0x65, 0x72,
+    0x18, 0x70, 0x72, 0x6f, 0x64, 0x75, 0x63, 0x74, 0x3d, 0x28, 0x4f, 0x66,
+    0x66, 0x69, 0x63, 0x65, 0x20, 0x50, 0x72, 0x69, 0x6e, 0x74, 0x65, 0x72,
+    0x29, 0x26, 0x61, 0x64, 0x6d, 0x69, 0x6e, 0x75, 0x72, 0x6c, 0x3d, 0x68,
+    0x74, 0x74, 0x70, 0x3a, 0x2f, 0x2f, 0x6f, 0x66, 0x66, 0x69, 0x63, 0x65,
+    0x2d, 0x70, 0x72, 0x69, 0x6e, 0x74, 0x65, 0x72, 0x2e, 0x6c, 0x6f, 0x63,
+    0x61, 0x6c, 0x2e, 0x2f, 0x11, 0x6e, 0x6f, 0x74, 0x65, 0x3d, 0x53, 0x65,
+    0x63, 0x6f, 0x6e, 0x64, 0x20, 0x66, 0x6c, 0x6f, 0x6f, 0x72, 0x0a, 0x70,
+    0x72, 0x69, 0x6f, 0x72, 0x69, 0x74, 0x79, 0x3d, 0x30, 0x28, 0x70, 0x64,
+    0x6c, 0x3d, 0x61, 0x70, 0x70, 0x6c, 0x69, 0x63, 0x61, 0x74, 0x69, 0x6f,
+    0x6e, 0x2f, 0x70, 0x64, 0x66, 0x2c, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x2f,
+    0x75, 0x72, 0x66, 0x2c, 0x69, 0x6d, 0x61, 0x67, 0x65, 0x2f, 0x6a, 0x70,
+    0x65, 0x67, 0x29, 0x55, 0x55, 0x49, 0x44, 0x3d, 0x32, 0x64, 0x36, 0x62,
+    0x31, 0x63, 0x34, 0x65, 0x2d, 0x38, 0x61, 0x33, 0x66, 0x2d, 0x34, 0x62,
+    0x37, 0x65, 0x2d, 0x39, 0x63, 0x31, 0x64, 0x2d, 0x30, 0x65, 0x35, 0x66,
+    0x36, 0x61, 0x37, 0x62, 0x38, 0x63, 0x39, 0x64, 0x07, 0x43, 0x6f, 0x6c,
+    0x6f, 0x72, 0x3d, 0x54, 0x08, 0x44, 0x75, 0x70, 0x6c, 0x65, 0x78, 0x3d,
+    0x54, 0x29, 0x55, 0x52, 0x46, 0x3d, 0x43, 0x50, 0x31, 0x2c, 0x49, 0x53,
+    0x31, 0x2d, 0x35, 0x2d, 0x37, 0x2c, 0x4d, 0x54, 0x31, 0x2d, 0x32, 0x2d,
+    0x33, 0x2d, 0x34, 0x2d, 0x35, 0x2d, 0x38, 0x2d, 0x39, 0x2c, 0x52, 0x53,
+    0x33, 0x30, 0x30, 0x2d, 0x36, 0x30, 0x30, 0xc0, 0x27, 0x00, 0x21, 0x80,
+    0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x17, 0x00, 0x00, 0x00, 0x00, 0x02,
+    0x77, 0x0e, 0x6f, 0x66, 0x66, 0x69, 0x63, 0x65, 0x2d, 0x70, 0x72, 0x69,
+    0x6e, 0x74, 0x65, 0x72, 0xc0, 0x16, 0xc1, 0x99, 0x00, 0x01, 0x80, 0x01,
+    0x00, 0x00, 0x00, 0x78, 0x00, 0x04, 0xc0, 0xa8, 0x01, 0x07,
+};
+
+struct Packet {
+  const uint8_t* data;
+  size_t size;
+};
+
+const Packet kPackets[] = {
+    {kQuery, sizeof(kQuery)},
+    {kCastResponse, sizeof(kCastResponse)},
+    {kNetConnectorResponse, sizeof(kNetConnectorResponse)},
+    {kPrinterResponse, sizeof(kPrinterResponse)},
+};
+constexpr size_t kPacketCount = sizeof(kPackets) / sizeof(kPackets[0]);
+
+int64_t PacketBytes() {
+  int64_t bytes = 0;
+  for (const Packet& packet : kPackets) {
+    bytes += packet.size;
+  }
+
+  return bytes;
+}
+
+// Reads every packet into a |DnsMessage|, the way received packets were read
+// before |DnsMessageView|.
+void Mdns_ReadDnsMessage(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    for (const Packet& packet : kPackets) {
+      PacketReader reader(packet.data, packet.size);
+      std::unique_ptr<DnsMessage> message = std::make_unique<DnsMessage>();
+      reader >> *message;
+      benchmark::DoNotOptimize(reader.complete());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * PacketBytes());
+}
+BENCHMARK(Mdns_ReadDnsMessage);
+
+// Parses every packet without materializing any records.
+void Mdns_ParseDnsMessageView(benchmark::State& state) {
+  DnsMessageView view;
+  while (state.KeepRunning()) {
+    for (const Packet& packet : kPackets) {
+      benchmark::DoNotOptimize(view.Parse(packet.data, packet.size));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * PacketBytes());
+}
+BENCHMARK(Mdns_ParseDnsMessageView);
+
+// Parses every packet and materializes only the records an agent browsing for
+// netconnector instances is interested in.
+void Mdns_ParseAndFilterDnsMessageView(benchmark::State& state) {
+  uint32_t service_hash = DnsNameHash("_netconnector._tcp.local.");
+  DnsRecordFilter filter = [service_hash](DnsType type, uint32_t name_hash) {
+    return type == DnsType::kPtr && name_hash == service_hash;
+  };
+
+  DnsMessageView view;
+  while (state.KeepRunning()) {
+    for (const Packet& packet : kPackets) {
+      view.Parse(packet.data, packet.size);
+      benchmark::DoNotOptimize(view.ToMessage(filter));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * PacketBytes());
+}
+BENCHMARK(Mdns_ParseAndFilterDnsMessageView);
+
+// Parses every packet and materializes all of its records.
+void Mdns_ParseAndMaterializeDnsMessageView(benchmark::State& state) {
+  DnsMessageView view;
+  while (state.KeepRunning()) {
+    for (const Packet& packet : kPackets) {
+      view.Parse(packet.data, packet.size);
+      benchmark::DoNotOptimize(view.ToMessage());
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * PacketBytes());
+}
+BENCHMARK(Mdns_ParseAndMaterializeDnsMessageView);
+
+// Hashes the name of every record in a parsed packet.
+void Mdns_HashNames(benchmark::State& state) {
+  const Packet& packet = kPackets[state.range(0)];
+  DnsMessageView view;
+  view.Parse(packet.data, packet.size);
+
+  while (state.KeepRunning()) {
+    uint32_t hash = 0;
+    for (const DnsQuestionView& question : view.questions()) {
+      hash ^= question.name_.Hash();
+    }
+    for (const DnsResourceView& resource : view.answers()) {
+      hash ^= resource.name_.Hash();
+    }
+    for (const DnsResourceView& resource : view.additionals()) {
+      hash ^= resource.name_.Hash();
+    }
+    benchmark::DoNotOptimize(hash);
+  }
+}
+BENCHMARK(Mdns_HashNames)->DenseRange(0, kPacketCount - 1);
+
+}  // namespace
+}  // namespace mdns
+}  // namespace netconnector
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
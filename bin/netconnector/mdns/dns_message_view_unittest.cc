@@ -0,0 +1,291 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/netconnector/mdns/dns_message_view.h"
+
+#include <string>
+#include <vector>
+
+#include "garnet/bin/netconnector/mdns/dns_reading.h"
+#include "garnet/bin/netconnector/mdns/packet_reader.h"
+#include "gtest/gtest.h"
+#include "lib/fxl/strings/split_string.h"
+
+namespace netconnector {
+namespace mdns {
+namespace {
+
+// Builds DNS packets a byte at a time.
+class PacketBuilder {
+ public:
+  PacketBuilder& U8(uint8_t value) {
+    packet_.push_back(value);
+    return *this;
+  }
+
+  PacketBuilder& U16(uint16_t value) {
+    return U8(value >> 8).U8(value & 0xff);
+  }
+
+  PacketBuilder& U32(uint32_t value) {
+    return U16(value >> 16).U16(value & 0xffff);
+  }
+
+  // Appends the labels of |dotted_string|, without the terminating zero.
+  PacketBuilder& Labels(const std::string& dotted_string) {
+    for (fxl::StringView label :
+         fxl::SplitString(dotted_string, ".", fxl::kKeepWhitespace,
+                          fxl::kSplitWantNonEmpty)) {
+      U8(label.size());
+      packet_.insert(packet_.end(), label.begin(), label.end());
+    }
+
+    return *this;
+  }
+
+  PacketBuilder& Name(const std::string& dotted_string) {
+    return Labels(dotted_string).U8(0);
+  }
+
+  // Appends a compression pointer to |offset|.
+  PacketBuilder& Pointer(uint16_t offset) { return U16(0xc000 | offset); }
+
+  PacketBuilder& Header(uint16_t flags,
+                        uint16_t questions,
+                        uint16_t answers,
+                        uint16_t authorities,
+                        uint16_t additionals) {
+    return U16(0).U16(flags).U16(questions).U16(answers).U16(authorities).U16(
+        additionals);
+  }
+
+  // Appends the fields of a resource that follow its name, up to its data.
+  // The data size is filled in by |EndData|.
+  PacketBuilder& BeginData(DnsType type, uint32_t time_to_live) {
+    U16(static_cast<uint16_t>(type)).U16(0x8001).U32(time_to_live).U16(0);
+    data_offset_ = packet_.size();
+    return *this;
+  }
+
+  PacketBuilder& EndData() {
+    size_t data_size = packet_.size() - data_offset_;
+    packet_[data_offset_ - 2] = data_size >> 8;
+    packet_[data_offset_ - 1] = data_size & 0xff;
+    return *this;
+  }
+
+  size_t size() const { return packet_.size(); }
+
+  const std::vector<uint8_t>& packet() const { return packet_; }
+
+ private:
+  std::vector<uint8_t> packet_;
+  size_t data_offset_ = 0;
+};
+
+static constexpr size_t kHeaderSize = 12;
+static constexpr char kServiceName[] = "_netconnector._tcp.local.";
+static constexpr char kInstanceName[] = "fuchsia._netconnector._tcp.local.";
+static constexpr char kHostName[] = "fuchsia.local.";
+
+// Returns a response announcing an instance of |kServiceName|, using name
+// compression the way responders do.
+std::vector<uint8_t> MakeResponse() {
+  PacketBuilder builder;
+  builder.Header(0x8400, 0, 1, 0, 3);
+
+  size_t service_offset = builder.size();
+  builder.Name(kServiceName).BeginData(DnsType::kPtr, 4500);
+  size_t instance_offset = builder.size();
+  builder.Labels("fuchsia").Pointer(service_offset).EndData();
+
+  builder.Pointer(instance_offset).BeginData(DnsType::kSrv, 120);
+  builder.U16(0).U16(0).U16(6474);
+  size_t host_offset = builder.size();
+  builder.Labels("fuchsia").Pointer(service_offset + 19).EndData();
+
+  builder.Pointer(instance_offset).BeginData(DnsType::kTxt, 4500);
+  builder.Labels("a=b").EndData();
+
+  builder.Pointer(host_offset).BeginData(DnsType::kA, 120);
+  builder.U8(192).U8(168).U8(1).U8(2).EndData();
+
+  return builder.packet();
+}
+
+TEST(DnsMessageViewTest, ParsesQuestion) {
+  PacketBuilder builder;
+  builder.Header(0, 1, 0, 0, 0).Name(kServiceName);
+  builder.U16(static_cast<uint16_t>(DnsType::kPtr)).U16(0x8001);
+
+  DnsMessageView view;
+  ASSERT_TRUE(view.Parse(builder.packet().data(), builder.size()));
+  EXPECT_EQ(0u, view.header().flags_);
+  ASSERT_EQ(1u, view.questions().size());
+  EXPECT_TRUE(view.answers().empty());
+
+  const DnsQuestionView& question = view.questions()[0];
+  EXPECT_EQ(DnsType::kPtr, question.type_);
+  EXPECT_EQ(DnsClass::kIn, question.class_);
+  EXPECT_TRUE(question.unicast_response_);
+  EXPECT_EQ(kServiceName, question.name_.ToString());
+}
+
+TEST(DnsMessageViewTest, FollowsCompressedNames) {
+  std::vector<uint8_t> packet = MakeResponse();
+  DnsMessageView view;
+  ASSERT_TRUE(view.Parse(packet.data(), packet.size()));
+  ASSERT_EQ(1u, view.answers().size());
+  ASSERT_EQ(3u, view.additionals().size());
+
+  EXPECT_EQ(kServiceName, view.answers()[0].name_.ToString());
+  EXPECT_EQ(kInstanceName, view.additionals()[0].name_.ToString());
+  EXPECT_EQ(kInstanceName, view.additionals()[1].name_.ToString());
+  EXPECT_EQ(kHostName, view.additionals()[2].name_.ToString());
+
+  EXPECT_TRUE(view.additionals()[0].name_.Equals(kInstanceName));
+  EXPECT_FALSE(view.additionals()[0].name_.Equals(kServiceName));
+  EXPECT_FALSE(view.additionals()[0].name_.Equals("fuchsia."));
+  EXPECT_FALSE(view.additionals()[2].name_.Equals(""));
+  EXPECT_FALSE(view.additionals()[2].name_.Equals("fuchsia.local.x"));
+}
+
+TEST(DnsMessageViewTest, HashMatchesDottedString) {
+  std::vector<uint8_t> packet = MakeResponse();
+  DnsMessageView view;
+  ASSERT_TRUE(view.Parse(packet.data(), packet.size()));
+
+  EXPECT_EQ(DnsNameHash(kServiceName), view.answers()[0].name_.Hash());
+  EXPECT_EQ(DnsNameHash(kInstanceName), view.additionals()[0].name_.Hash());
+  EXPECT_EQ(DnsNameHash(kHostName), view.additionals()[2].name_.Hash());
+  EXPECT_NE(DnsNameHash(kServiceName), DnsNameHash(kInstanceName));
+}
+
+TEST(DnsMessageViewTest, ToMessageMatchesPacketReader) {
+  std::vector<uint8_t> packet = MakeResponse();
+
+  DnsMessage expected;
+  PacketReader reader(packet);
+  reader >> expected;
+  ASSERT_TRUE(reader.complete());
+
+  DnsMessageView view;
+  ASSERT_TRUE(view.Parse(packet.data(), packet.size()));
+  std::unique_ptr<DnsMessage> message = view.ToMessage();
+  ASSERT_TRUE(message);
+
+  EXPECT_EQ(expected.header_.flags_, message->header_.flags_);
+  ASSERT_EQ(expected.answers_.size(), message->answers_.size());
+  ASSERT_EQ(expected.additionals_.size(), message->additionals_.size());
+  EXPECT_EQ(expected.answers_[0]->ptr_.pointer_domain_name_.dotted_string_,
+            message->answers_[0]->ptr_.pointer_domain_name_.dotted_string_);
+  EXPECT_EQ(kInstanceName,
+            message->answers_[0]->ptr_.pointer_domain_name_.dotted_string_);
+
+  const DnsResource& srv = *message->additionals_[0];
+  EXPECT_EQ(DnsType::kSrv, srv.type_);
+  EXPECT_TRUE(srv.cache_flush_);
+  EXPECT_EQ(120u, srv.time_to_live_);
+  EXPECT_EQ(IpPort::From_uint16_t(6474), srv.srv_.port_);
+  EXPECT_EQ(kHostName, srv.srv_.target_.dotted_string_);
+
+  const DnsResource& txt = *message->additionals_[1];
+  ASSERT_EQ(1u, txt.txt_.strings_.size());
+  EXPECT_EQ("a=b", txt.txt_.strings_[0]);
+
+  const DnsResource& a = *message->additionals_[2];
+  EXPECT_EQ(expected.additionals_[2]->a_.address_.address_,
+            a.a_.address_.address_);
+}
+
+TEST(DnsMessageViewTest, FilterSkipsRecords) {
+  std::vector<uint8_t> packet = MakeResponse();
+  DnsMessageView view;
+  ASSERT_TRUE(view.Parse(packet.data(), packet.size()));
+
+  uint32_t host_name_hash = DnsNameHash(kHostName);
+  size_t filter_calls = 0;
+  std::unique_ptr<DnsMessage> message =
+      view.ToMessage([host_name_hash, &filter_calls](DnsType type,
+                                                     uint32_t name_hash) {
+        ++filter_calls;
+        return type == DnsType::kA && name_hash == host_name_hash;
+      });
+  ASSERT_TRUE(message);
+
+  EXPECT_EQ(4u, filter_calls);
+  EXPECT_TRUE(message->answers_.empty());
+  ASSERT_EQ(1u, message->additionals_.size());
+  EXPECT_EQ(DnsType::kA, message->additionals_[0]->type_);
+  EXPECT_EQ(0u, message->header_.answer_count_);
+  EXPECT_EQ(1u, message->header_.additional_count_);
+}
+
+TEST(DnsMessageViewTest, RejectsTruncatedPackets) {
+  std::vector<uint8_t> packet = MakeResponse();
+  DnsMessageView view;
+  for (size_t size = 0; size < packet.size(); ++size) {
+    EXPECT_FALSE(view.Parse(packet.data(), size)) << size;
+    EXPECT_TRUE(view.additionals().empty());
+  }
+
+  packet.push_back(0);
+  EXPECT_FALSE(view.Parse(packet.data(), packet.size()));
+}
+
+TEST(DnsMessageViewTest, RejectsPointerLoops) {
+  DnsMessageView view;
+
+  // A name that points to itself.
+  PacketBuilder self;
+  self.Header(0, 1, 0, 0, 0).Pointer(kHeaderSize).U16(1).U16(1);
+  EXPECT_FALSE(view.Parse(self.packet().data(), self.size()));
+
+  // A name that points forward.
+  PacketBuilder forward;
+  forward.Header(0, 1, 0, 0, 0).Pointer(kHeaderSize + 2).Name("local.");
+  forward.U16(1).U16(1);
+  EXPECT_FALSE(view.Parse(forward.packet().data(), forward.size()));
+
+  // Names in resource data are checked when the resource is materialized.
+  PacketBuilder data;
+  data.Header(0x8400, 0, 1, 0, 0).Name(kServiceName);
+  data.BeginData(DnsType::kPtr, 120);
+  size_t data_offset = data.size();
+  data.Pointer(data_offset).EndData();
+  ASSERT_TRUE(view.Parse(data.packet().data(), data.size()));
+  EXPECT_FALSE(view.Materialize(view.answers()[0]));
+  EXPECT_FALSE(view.ToMessage());
+  EXPECT_TRUE(view.ToMessage([](DnsType type, uint32_t name_hash) {
+    return type != DnsType::kPtr;
+  }));
+}
+
+TEST(DnsMessageViewTest, RejectsBadResourceDataSize) {
+  PacketBuilder builder;
+  builder.Header(0x8400, 0, 1, 0, 0).Name(kHostName);
+  builder.BeginData(DnsType::kA, 120).U8(192).U8(168).U8(1).EndData();
+
+  DnsMessageView view;
+  ASSERT_TRUE(view.Parse(builder.packet().data(), builder.size()));
+  EXPECT_FALSE(view.Materialize(view.answers()[0]));
+}
+
+TEST(DnsMessageViewTest, CanBeReused) {
+  std::vector<uint8_t> response = MakeResponse();
+  DnsMessageView view;
+  ASSERT_TRUE(view.Parse(response.data(), response.size()));
+  EXPECT_EQ(3u, view.additionals().size());
+
+  PacketBuilder query;
+  query.Header(0, 1, 0, 0, 0).Name(kHostName).U16(1).U16(1);
+  ASSERT_TRUE(view.Parse(query.packet().data(), query.size()));
+  EXPECT_EQ(1u, view.questions().size());
+  EXPECT_TRUE(view.additionals().empty());
+  EXPECT_EQ(kHostName, view.questions()[0].name_.ToString());
+}
+
+}  // namespace
+}  // namespace mdns
+}  // namespace netconnector
@@ -44,6 +44,11 @@ void HostNameResolver::Start(const std::string& host_full_name) {
       timeout_);
 }
 
+bool HostNameResolver::WantsRecord(DnsType type, uint32_t name_hash) {
+  return (type == DnsType::kA || type == DnsType::kAaaa) &&
+         name_hash == DnsNameHash(host_full_name_);
+}
+
 void HostNameResolver::ReceiveResource(const DnsResource& resource,
                                        MdnsResourceSection section) {
   if (resource.name_.dotted_string_ != host_full_name_) {
@@ -29,6 +29,8 @@ class HostNameResolver : public MdnsAgent {
   // MdnsAgent overrides.
   void Start(const std::string& host_full_name) override;
 
+  bool WantsRecord(DnsType type, uint32_t name_hash) override;
+
   void ReceiveResource(const DnsResource& resource,
                        MdnsResourceSection section) override;
 
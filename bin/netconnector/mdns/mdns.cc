@@ -99,6 +99,9 @@ void Mdns::Start(const std::string& host_name, const fxl::Closure& callback) {
         DALLOW_AGENT_REMOVAL();
 
         SendMessages();
+      },
+      [this](DnsType type, uint32_t name_hash) {
+        return WantsRecord(type, name_hash);
       });
 
   if (transceiver_.has_interfaces()) {
@@ -454,6 +457,20 @@ void Mdns::SendMessages() {
   outbound_messages_by_reply_address_.clear();
 }
 
+bool Mdns::WantsRecord(DnsType type, uint32_t name_hash) {
+  if (resource_renewer_->WantsRecord(type, name_hash)) {
+    return true;
+  }
+
+  for (auto& pair : agents_) {
+    if (pair.second->WantsRecord(type, name_hash)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void Mdns::ReceiveQuestion(const DnsQuestion& question,
                            const ReplyAddress& reply_address) {
   // Renewer doesn't need questions.
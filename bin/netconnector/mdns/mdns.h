@@ -179,6 +179,11 @@ class Mdns : public MdnsAgent::Host {
   // clears |outbound_messages_by_reply_address_|.
   void SendMessages();
 
+  // Determines whether any of the agents, including the resource renewer, is
+  // interested in received records of type |type| whose names hash to
+  // |name_hash|.
+  bool WantsRecord(DnsType type, uint32_t name_hash);
+
   // Distributes questions to all the agents except the resource renewer.
   void ReceiveQuestion(const DnsQuestion& question,
                        const ReplyAddress& reply_address);
@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "garnet/bin/netconnector/mdns/dns_message.h"
+#include "garnet/bin/netconnector/mdns/dns_message_view.h"
 #include "garnet/bin/netconnector/mdns/mdns_addresses.h"
 #include "garnet/bin/netconnector/socket_address.h"
 #include "lib/fxl/functional/closure.h"
@@ -65,6 +66,13 @@ class MdnsAgent : public std::enable_shared_from_this<MdnsAgent> {
   // the agent is created, so |shared_from_this| is safe to call.
   virtual void Start(const std::string& host_full_name) {}
 
+  // Determines whether this agent is interested in received records of type
+  // |type| whose names hash to |name_hash| (see |DnsNameHash|). Records that
+  // no agent is interested in aren't decoded. Different names may have the
+  // same hash, so agents must still check the names of the records they
+  // receive. The default accepts all records.
+  virtual bool WantsRecord(DnsType type, uint32_t name_hash) { return true; }
+
   // Presents a received question. This agent must not call |RemoveSelf| during
   // a call to this method.
   virtual void ReceiveQuestion(const DnsQuestion& question,
@@ -12,7 +12,6 @@
 #include <iostream>
 
 #include "garnet/bin/netconnector/mdns/dns_formatting.h"
-#include "garnet/bin/netconnector/mdns/dns_reading.h"
 #include "garnet/bin/netconnector/mdns/dns_writing.h"
 #include "garnet/bin/netconnector/mdns/mdns_addresses.h"
 #include "garnet/bin/netconnector/mdns/mdns_interface_transceiver_v4.h"
@@ -52,7 +51,8 @@ MdnsInterfaceTransceiver::MdnsInterfaceTransceiver(
 
 MdnsInterfaceTransceiver::~MdnsInterfaceTransceiver() {}
 
-bool MdnsInterfaceTransceiver::Start(const InboundMessageCallback& callback) {
+bool MdnsInterfaceTransceiver::Start(const InboundMessageCallback& callback,
+                                     const DnsRecordFilter& record_filter) {
   FXL_DCHECK(callback);
   FXL_DCHECK(!socket_fd_.is_valid()) << "Start called when already started.";
 
@@ -76,6 +76,7 @@ bool MdnsInterfaceTransceiver::Start(const InboundMessageCallback& callback) {
   }
 
   inbound_message_callback_ = callback;
+  record_filter_ = record_filter;
 
   WaitForInbound();
   return true;
@@ -175,12 +176,14 @@ void MdnsInterfaceTransceiver::InboundReady(zx_status_t status,
 
   ReplyAddress reply_address(source_address_storage, index_);
 
-  PacketReader reader(inbound_buffer_);
-  reader.SetBytesRemaining(static_cast<size_t>(result));
-  std::unique_ptr<DnsMessage> message = std::make_unique<DnsMessage>();
-  reader >> *message.get();
+  // Only the records that pass the filter are copied out of the buffer.
+  std::unique_ptr<DnsMessage> message;
+  if (inbound_message_view_.Parse(inbound_buffer_.data(),
+                                  static_cast<size_t>(result))) {
+    message = inbound_message_view_.ToMessage(record_filter_);
+  }
 
-  if (reader.complete()) {
+  if (message) {
     FXL_DCHECK(inbound_message_callback_);
     inbound_message_callback_(std::move(message), reply_address);
   } else {
@@ -9,6 +9,7 @@
 
 #include "garnet/bin/netconnector/ip_address.h"
 #include "garnet/bin/netconnector/mdns/dns_message.h"
+#include "garnet/bin/netconnector/mdns/dns_message_view.h"
 #include "garnet/bin/netconnector/mdns/reply_address.h"
 #include "garnet/bin/netconnector/socket_address.h"
 #include "lib/fsl/tasks/fd_waiter.h"
@@ -44,8 +45,11 @@ class MdnsInterfaceTransceiver {
 
   const IpAddress& address() const { return address_; }
 
-  // Starts the interface transceiver.
-  bool Start(const InboundMessageCallback& callback);
+  // Starts the interface transceiver. Only the inbound records accepted by
+  // |record_filter| are delivered to |callback|. If |record_filter| is null,
+  // all records are delivered.
+  bool Start(const InboundMessageCallback& callback,
+             const DnsRecordFilter& record_filter);
 
   // Stops the interface transceiver.
   void Stop();
@@ -112,7 +116,9 @@ class MdnsInterfaceTransceiver {
   fsl::FDWaiter fd_waiter_;
   std::vector<uint8_t> inbound_buffer_;
   std::vector<uint8_t> outbound_buffer_;
+  DnsMessageView inbound_message_view_;
   InboundMessageCallback inbound_message_callback_;
+  DnsRecordFilter record_filter_;
   std::shared_ptr<DnsResource> address_resource_;
   std::shared_ptr<DnsResource> alternate_address_resource_;
 
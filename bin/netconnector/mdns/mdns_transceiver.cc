@@ -37,12 +37,14 @@ void MdnsTransceiver::EnableInterface(const std::string& name,
 
 void MdnsTransceiver::Start(
     const LinkChangeCallback& link_change_callback,
-    const InboundMessageCallback& inbound_message_callback) {
+    const InboundMessageCallback& inbound_message_callback,
+    const DnsRecordFilter& record_filter) {
   FXL_DCHECK(link_change_callback);
   FXL_DCHECK(inbound_message_callback);
 
   link_change_callback_ = link_change_callback;
   inbound_message_callback_ = inbound_message_callback;
+  record_filter_ = record_filter;
 
   fidl::InterfaceHandle<netstack::NotificationListener> listener_handle;
 
@@ -149,7 +151,7 @@ void MdnsTransceiver::FindNewInterfaces() {
                 MdnsInterfaceTransceiver::Create(if_info.get(),
                                                  interfaces_.size());
 
-            if (!interface->Start(inbound_message_callback_)) {
+            if (!interface->Start(inbound_message_callback_, record_filter_)) {
               continue;
             }
 
@@ -36,9 +36,12 @@ class MdnsTransceiver : public netstack::NotificationListener {
   // interfaces that have been enabled.
   void EnableInterface(const std::string& name, sa_family_t family);
 
-  // Starts the transceiver.
+  // Starts the transceiver. Only the inbound records accepted by
+  // |record_filter| are delivered to |inbound_message_callback|. If
+  // |record_filter| is null, all records are delivered.
   void Start(const LinkChangeCallback& link_change_callback,
-             const InboundMessageCallback& inbound_message_callback);
+             const InboundMessageCallback& inbound_message_callback,
+             const DnsRecordFilter& record_filter);
 
   // Stops the transceiver.
   void Stop();
@@ -84,6 +87,7 @@ class MdnsTransceiver : public netstack::NotificationListener {
   std::vector<InterfaceId> enabled_interfaces_;
   LinkChangeCallback link_change_callback_;
   InboundMessageCallback inbound_message_callback_;
+  DnsRecordFilter record_filter_;
   std::string host_full_name_;
   std::vector<std::unique_ptr<MdnsInterfaceTransceiver>> interfaces_;
   std::unique_ptr<app::ApplicationContext> application_context_;
@@ -11,8 +11,13 @@
 namespace netconnector {
 namespace mdns {
 
-PacketReader::PacketReader(std::vector<uint8_t> packet)
-    : packet_(std::move(packet)), packet_size_(packet_.size()) {}
+PacketReader::PacketReader(const uint8_t* data, size_t size)
+    : packet_(data), buffer_size_(size), packet_size_(size) {
+  FXL_DCHECK(data != nullptr || size == 0);
+}
+
+PacketReader::PacketReader(const std::vector<uint8_t>& packet)
+    : PacketReader(packet.data(), packet.size()) {}
 
 PacketReader::~PacketReader() {}
 
@@ -37,7 +42,7 @@ const uint8_t* PacketReader::Bytes(size_t count) {
     return nullptr;
   }
 
-  const uint8_t* result = packet_.data() + bytes_consumed_;
+  const uint8_t* result = packet_ + bytes_consumed_;
   bytes_consumed_ += count;
   return result;
 }
@@ -53,7 +58,7 @@ bool PacketReader::SetBytesConsumed(size_t bytes_consumed) {
 }
 
 bool PacketReader::SetBytesRemaining(size_t bytes_remaining) {
-  if (bytes_remaining + bytes_consumed_ > packet_.size()) {
+  if (bytes_remaining + bytes_consumed_ > buffer_size_) {
     healthy_ = false;
     return false;
   }
@@ -4,16 +4,23 @@
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <vector>
 
 namespace netconnector {
 namespace mdns {
 
-// Reads values from a binary packet buffer.
+// Reads values from a binary packet buffer. The reader doesn't copy the
+// buffer, which must outlive the reader.
 class PacketReader {
  public:
-  // Constructs a packet reader.
-  PacketReader(std::vector<uint8_t> packet);
+  // Constructs a packet reader for the |size| bytes at |data|.
+  PacketReader(const uint8_t* data, size_t size);
+
+  // Constructs a packet reader for the contents of |packet|.
+  explicit PacketReader(const std::vector<uint8_t>& packet);
 
   ~PacketReader();
 
@@ -67,7 +74,9 @@ class PacketReader {
 
  private:
   bool healthy_ = true;
-  std::vector<uint8_t> packet_;
+  const uint8_t* packet_;
+  // Size of the buffer supplied in the constructor.
+  size_t buffer_size_;
   size_t packet_size_;
   size_t bytes_consumed_ = 0;
 };
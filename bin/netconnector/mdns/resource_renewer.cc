@@ -42,6 +42,16 @@ void ResourceRenewer::Renew(const DnsResource& resource) {
   }
 }
 
+bool ResourceRenewer::WantsRecord(DnsType type, uint32_t name_hash) {
+  for (const Entry* entry : entries_) {
+    if (entry->type_ == type && entry->name_hash_ == name_hash) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void ResourceRenewer::ReceiveResource(const DnsResource& resource,
                                       MdnsResourceSection section) {
   FXL_DCHECK(section != MdnsResourceSection::kExpired);
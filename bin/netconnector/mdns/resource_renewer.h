@@ -46,6 +46,8 @@ class ResourceRenewer : public MdnsAgent {
   void Renew(const DnsResource& resource);
 
   // MdnsAgent overrides.
+  bool WantsRecord(DnsType type, uint32_t name_hash) override;
+
   void ReceiveResource(const DnsResource& resource,
                        MdnsResourceSection section) override;
 
@@ -61,9 +63,11 @@ class ResourceRenewer : public MdnsAgent {
     static constexpr uint32_t kQueryIntervalPerThousand = 50;
     static constexpr uint32_t kQueriesToAttempt = 4;
 
-    Entry(const std::string& name, DnsType type) : name_(name), type_(type) {}
+    Entry(const std::string& name, DnsType type)
+        : name_(name), name_hash_(DnsNameHash(name)), type_(type) {}
 
     std::string name_;
+    uint32_t name_hash_;
     DnsType type_;
 
     fxl::TimePoint time_;
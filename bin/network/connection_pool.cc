@@ -0,0 +1,108 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/connection_pool.h"
+
+#include <poll.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace network {
+namespace {
+
+// An idle connection should have nothing to read. If it does, the server has
+// either closed it or sent something we cannot make sense of.
+bool IsConnectionUsable(int fd) {
+  struct pollfd pfd = {fd, POLLIN, 0};
+  return poll(&pfd, 1, 0) == 0;
+}
+
+}  // namespace
+
+constexpr size_t ConnectionPool::kMaxIdleConnections;
+constexpr size_t ConnectionPool::kMaxIdleConnectionsPerOrigin;
+constexpr size_t ConnectionPool::kMaxSessions;
+constexpr fxl::TimeDelta ConnectionPool::kIdleTimeout;
+
+ConnectionPool::ConnectionPool() = default;
+
+ConnectionPool::~ConnectionPool() = default;
+
+fxl::UniqueFD ConnectionPool::TakeConnection(const std::string& origin) {
+  fxl::MutexLocker locker(&mutex_);
+  RemoveExpiredConnectionsLocked(fxl::TimePoint::Now());
+
+  // Prefer the most recently used connection, which the server is the least
+  // likely to have timed out.
+  while (true) {
+    auto it = std::find_if(idle_connections_.rbegin(), idle_connections_.rend(),
+                           [&origin](const IdleConnection& connection) {
+                             return connection.origin == origin;
+                           });
+    if (it == idle_connections_.rend())
+      return fxl::UniqueFD();
+    fxl::UniqueFD fd = std::move(it->fd);
+    idle_connections_.erase(std::next(it).base());
+    if (IsConnectionUsable(fd.get()))
+      return fd;
+  }
+}
+
+void ConnectionPool::ReturnConnection(const std::string& origin,
+                                      fxl::UniqueFD fd) {
+  if (!fd.is_valid())
+    return;
+
+  fxl::MutexLocker locker(&mutex_);
+  fxl::TimePoint now = fxl::TimePoint::Now();
+  RemoveExpiredConnectionsLocked(now);
+
+  size_t origin_count =
+      std::count_if(idle_connections_.begin(), idle_connections_.end(),
+                    [&origin](const IdleConnection& connection) {
+                      return connection.origin == origin;
+                    });
+  if (origin_count >= kMaxIdleConnectionsPerOrigin) {
+    idle_connections_.erase(
+        std::find_if(idle_connections_.begin(), idle_connections_.end(),
+                     [&origin](const IdleConnection& connection) {
+                       return connection.origin == origin;
+                     }));
+  } else if (idle_connections_.size() >= kMaxIdleConnections) {
+    idle_connections_.pop_front();
+  }
+
+  idle_connections_.push_back({origin, std::move(fd), now + kIdleTimeout});
+}
+
+bssl::UniquePtr<SSL_SESSION> ConnectionPool::GetSession(
+    const std::string& origin) {
+  fxl::MutexLocker locker(&mutex_);
+  auto it = sessions_.find(origin);
+  if (it == sessions_.end())
+    return nullptr;
+  SSL_SESSION_up_ref(it->second.get());
+  return bssl::UniquePtr<SSL_SESSION>(it->second.get());
+}
+
+void ConnectionPool::SetSession(const std::string& origin,
+                                bssl::UniquePtr<SSL_SESSION> session) {
+  if (!session)
+    return;
+
+  fxl::MutexLocker locker(&mutex_);
+  if (sessions_.size() >= kMaxSessions && sessions_.count(origin) == 0)
+    sessions_.clear();
+  sessions_[origin] = std::move(session);
+}
+
+void ConnectionPool::RemoveExpiredConnectionsLocked(fxl::TimePoint now) {
+  while (!idle_connections_.empty() &&
+         idle_connections_.front().expiry <= now) {
+    idle_connections_.pop_front();
+  }
+}
+
+}  // namespace network
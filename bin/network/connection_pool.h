@@ -0,0 +1,81 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_NETWORK_CONNECTION_POOL_H_
+#define GARNET_BIN_NETWORK_CONNECTION_POOL_H_
+
+#include <openssl/ssl.h>
+
+#include <list>
+#include <map>
+#include <string>
+
+#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/macros.h"
+#include "lib/fxl/synchronization/mutex.h"
+#include "lib/fxl/synchronization/thread_annotations.h"
+#include "lib/fxl/time/time_delta.h"
+#include "lib/fxl/time/time_point.h"
+
+namespace network {
+
+// Keeps connections and TLS sessions around between requests to the same
+// origin, so that they do not each pay for a connect and a full handshake.
+// Shared by the URL loaders of a network service, which run on their own
+// threads, so every method may be called on any thread.
+//
+// Idle HTTP connections are kept as bare file descriptors because each
+// request runs its own asio::io_service. HTTPS connections are not kept, but
+// their sessions are, so that the next connection to the origin resumes the
+// session instead of doing a full handshake.
+class ConnectionPool {
+ public:
+  // Upper bound on the number of idle connections, which all hold a file
+  // descriptor. See kMaxSlots in network_service_impl.cc.
+  static constexpr size_t kMaxIdleConnections = 16;
+  static constexpr size_t kMaxIdleConnectionsPerOrigin = 4;
+  static constexpr size_t kMaxSessions = 64;
+  static constexpr fxl::TimeDelta kIdleTimeout =
+      fxl::TimeDelta::FromSeconds(30);
+
+  ConnectionPool();
+  ~ConnectionPool();
+
+  // Returns an idle connection to |origin| that the server has not closed,
+  // or an invalid descriptor if there is none.
+  fxl::UniqueFD TakeConnection(const std::string& origin);
+
+  // Keeps |fd|, a connection to |origin| with no request in progress, for
+  // later requests to |origin|.
+  void ReturnConnection(const std::string& origin, fxl::UniqueFD fd);
+
+  // Returns the session last negotiated with |origin|, or null.
+  bssl::UniquePtr<SSL_SESSION> GetSession(const std::string& origin);
+
+  // Remembers |session|, negotiated with |origin|, for later connections.
+  void SetSession(const std::string& origin,
+                  bssl::UniquePtr<SSL_SESSION> session);
+
+ private:
+  struct IdleConnection {
+    std::string origin;
+    fxl::UniqueFD fd;
+    fxl::TimePoint expiry;
+  };
+
+  void RemoveExpiredConnectionsLocked(fxl::TimePoint now)
+      FXL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  fxl::Mutex mutex_;
+  // Ordered from least to most recently returned.
+  std::list<IdleConnection> idle_connections_ FXL_GUARDED_BY(mutex_);
+  std::map<std::string, bssl::UniquePtr<SSL_SESSION>> sessions_
+      FXL_GUARDED_BY(mutex_);
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(ConnectionPool);
+};
+
+}  // namespace network
+
+#endif  // GARNET_BIN_NETWORK_CONNECTION_POOL_H_
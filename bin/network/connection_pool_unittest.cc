@@ -0,0 +1,99 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/connection_pool.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace network {
+namespace {
+
+constexpr char kOrigin[] = "http://example.com:80";
+
+// A connected pair of sockets, standing in for a connection to a server.
+struct Connection {
+  Connection() {
+    int fds[2];
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    client.reset(fds[0]);
+    server.reset(fds[1]);
+  }
+
+  fxl::UniqueFD client;
+  fxl::UniqueFD server;
+};
+
+TEST(ConnectionPoolTest, ReturnedConnectionIsTaken) {
+  ConnectionPool pool;
+  EXPECT_FALSE(pool.TakeConnection(kOrigin).is_valid());
+
+  Connection connection;
+  int fd = connection.client.get();
+  pool.ReturnConnection(kOrigin, std::move(connection.client));
+  EXPECT_FALSE(pool.TakeConnection("http://example.com:8080").is_valid());
+  EXPECT_FALSE(pool.TakeConnection("https://example.com:80").is_valid());
+
+  fxl::UniqueFD taken = pool.TakeConnection(kOrigin);
+  EXPECT_EQ(fd, taken.get());
+  EXPECT_FALSE(pool.TakeConnection(kOrigin).is_valid());
+}
+
+TEST(ConnectionPoolTest, DropsConnectionClosedByServer) {
+  ConnectionPool pool;
+  Connection connection;
+  pool.ReturnConnection(kOrigin, std::move(connection.client));
+  connection.server.reset();
+  EXPECT_FALSE(pool.TakeConnection(kOrigin).is_valid());
+}
+
+TEST(ConnectionPoolTest, DropsConnectionWithUnreadData) {
+  ConnectionPool pool;
+  Connection connection;
+  pool.ReturnConnection(kOrigin, std::move(connection.client));
+  ASSERT_EQ(1, write(connection.server.get(), "x", 1));
+  EXPECT_FALSE(pool.TakeConnection(kOrigin).is_valid());
+}
+
+TEST(ConnectionPoolTest, SkipsUnusableConnections) {
+  ConnectionPool pool;
+  Connection usable;
+  Connection closed;
+  int fd = usable.client.get();
+  pool.ReturnConnection(kOrigin, std::move(usable.client));
+  pool.ReturnConnection(kOrigin, std::move(closed.client));
+  closed.server.reset();
+
+  EXPECT_EQ(fd, pool.TakeConnection(kOrigin).get());
+}
+
+TEST(ConnectionPoolTest, LimitsIdleConnectionsPerOrigin) {
+  ConnectionPool pool;
+  std::vector<Connection> connections(
+      ConnectionPool::kMaxIdleConnectionsPerOrigin + 1);
+  std::vector<int> fds;
+  for (Connection& connection : connections) {
+    fds.push_back(connection.client.get());
+    pool.ReturnConnection(kOrigin, std::move(connection.client));
+  }
+
+  // The most recently returned connections are kept, and taken first.
+  for (size_t i = fds.size() - 1; i > 0; --i)
+    EXPECT_EQ(fds[i], pool.TakeConnection(kOrigin).get());
+  EXPECT_FALSE(pool.TakeConnection(kOrigin).is_valid());
+}
+
+TEST(ConnectionPoolTest, IgnoresInvalidConnection) {
+  ConnectionPool pool;
+  pool.ReturnConnection(kOrigin, fxl::UniqueFD());
+  EXPECT_FALSE(pool.TakeConnection(kOrigin).is_valid());
+}
+
+}  // namespace
+}  // namespace network
@@ -0,0 +1,148 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/host_resolver_cache.h"
+
+#include <utility>
+
+#include <asio/error.hpp>
+
+#include "lib/fxl/logging.h"
+
+namespace network {
+namespace {
+
+constexpr fxl::TimeDelta kDefaultTTL = fxl::TimeDelta::FromSeconds(60);
+constexpr fxl::TimeDelta kDefaultNegativeTTL = fxl::TimeDelta::FromSeconds(5);
+
+// Whether |err| says the host has no addresses, as opposed to the lookup
+// having failed, which is worth trying again.
+bool IsNegativeResult(const asio::error_code& err) {
+  return err == asio::error::host_not_found || err == asio::error::no_data;
+}
+
+}  // namespace
+
+constexpr size_t HostResolverCache::kMaxEntries;
+
+HostResolverCache::HostResolverCache()
+    : HostResolverCache(kDefaultTTL, kDefaultNegativeTTL) {}
+
+HostResolverCache::HostResolverCache(fxl::TimeDelta ttl,
+                                     fxl::TimeDelta negative_ttl)
+    : ttl_(ttl), negative_ttl_(negative_ttl) {}
+
+HostResolverCache::~HostResolverCache() = default;
+
+void HostResolverCache::Resolve(const std::string& host,
+                                const std::string& port,
+                                Lookup lookup,
+                                ResolveCallback callback) {
+  std::string key = host + ":" + port;
+  bool hit = false;
+  asio::error_code err;
+  std::shared_ptr<const Endpoints> endpoints;
+  {
+    fxl::MutexLocker locker(&mutex_);
+    fxl::TimePoint now = fxl::TimePoint::Now();
+
+    auto it = entries_.find(key);
+    if (it != entries_.end() && !it->second.pending &&
+        it->second.expiry <= now) {
+      entries_.erase(it);
+      it = entries_.end();
+    }
+
+    if (it != entries_.end() && it->second.pending) {
+      ++coalesced_count_;
+      it->second.callbacks.push_back(std::move(callback));
+      return;
+    }
+
+    if (it == entries_.end()) {
+      ++miss_count_;
+      if (entries_.size() >= kMaxEntries)
+        RemoveExpiredEntriesLocked(now);
+      entries_[key].callbacks.push_back(std::move(callback));
+    } else {
+      ++hit_count_;
+      hit = true;
+      err = it->second.err;
+      endpoints = it->second.endpoints;
+    }
+  }
+
+  if (hit) {
+    callback(err, std::move(endpoints));
+    return;
+  }
+
+  lookup([this, key](const asio::error_code& err,
+                     std::shared_ptr<const Endpoints> endpoints) {
+    OnLookupComplete(key, err, std::move(endpoints));
+  });
+}
+
+size_t HostResolverCache::hit_count() const {
+  fxl::MutexLocker locker(&mutex_);
+  return hit_count_;
+}
+
+size_t HostResolverCache::miss_count() const {
+  fxl::MutexLocker locker(&mutex_);
+  return miss_count_;
+}
+
+size_t HostResolverCache::coalesced_count() const {
+  fxl::MutexLocker locker(&mutex_);
+  return coalesced_count_;
+}
+
+void HostResolverCache::OnLookupComplete(
+    const std::string& key,
+    const asio::error_code& err,
+    std::shared_ptr<const Endpoints> endpoints) {
+  std::vector<ResolveCallback> callbacks;
+  {
+    fxl::MutexLocker locker(&mutex_);
+    auto it = entries_.find(key);
+    FXL_DCHECK(it != entries_.end() && it->second.pending);
+    Entry& entry = it->second;
+    callbacks = std::move(entry.callbacks);
+
+    if (!err || IsNegativeResult(err)) {
+      entry.pending = false;
+      entry.err = err;
+      entry.endpoints = endpoints;
+      entry.expiry = fxl::TimePoint::Now() + (err ? negative_ttl_ : ttl_);
+      entry.callbacks.clear();
+    } else {
+      entries_.erase(it);
+    }
+  }
+
+  for (const auto& callback : callbacks)
+    callback(err, endpoints);
+}
+
+void HostResolverCache::RemoveExpiredEntriesLocked(fxl::TimePoint now) {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (!it->second.pending && it->second.expiry <= now)
+      it = entries_.erase(it);
+    else
+      ++it;
+  }
+
+  // Lookups in progress are kept, since requests are waiting on them.
+  if (entries_.size() >= kMaxEntries) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (!it->second.pending)
+        it = entries_.erase(it);
+      else
+        ++it;
+    }
+  }
+}
+
+}  // namespace network
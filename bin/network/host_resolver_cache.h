@@ -0,0 +1,97 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_NETWORK_HOST_RESOLVER_CACHE_H_
+#define GARNET_BIN_NETWORK_HOST_RESOLVER_CACHE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <asio/error_code.hpp>
+#include <asio/ip/tcp.hpp>
+
+#include "lib/fxl/macros.h"
+#include "lib/fxl/synchronization/mutex.h"
+#include "lib/fxl/synchronization/thread_annotations.h"
+#include "lib/fxl/time/time_delta.h"
+#include "lib/fxl/time/time_point.h"
+
+namespace network {
+
+// Caches the results of host name lookups for the URL loaders of a network
+// service, which run on their own threads, so every method may be called on
+// any thread.
+//
+// getaddrinfo() does not report the TTL of the records it returns, so
+// addresses are kept for a fixed time. Hosts that do not exist are remembered
+// too, for a shorter time. A lookup that is requested while the same lookup
+// is in progress waits for its result instead of starting another.
+class HostResolverCache {
+ public:
+  using Endpoints = std::vector<asio::ip::tcp::endpoint>;
+  using ResolveCallback =
+      std::function<void(const asio::error_code& err,
+                          std::shared_ptr<const Endpoints> endpoints)>;
+  // Resolves a host name and calls the given callback, on any thread.
+  using Lookup = std::function<void(ResolveCallback callback)>;
+
+  static constexpr size_t kMaxEntries = 256;
+
+  HostResolverCache();
+  // Keeps addresses for |ttl| and the absence of addresses for
+  // |negative_ttl|.
+  HostResolverCache(fxl::TimeDelta ttl, fxl::TimeDelta negative_ttl);
+  ~HostResolverCache();
+
+  // Calls |callback| with the addresses of |host| and |port|. If they are not
+  // cached and not being looked up, calls |lookup| to look them up.
+  //
+  // |callback| is called on this thread before Resolve() returns if the
+  // result is cached, and on the thread that completes the lookup otherwise.
+  void Resolve(const std::string& host,
+               const std::string& port,
+               Lookup lookup,
+               ResolveCallback callback);
+
+  // Number of requests answered from the cache, including those that found
+  // the host did not exist.
+  size_t hit_count() const;
+  // Number of requests that started a lookup.
+  size_t miss_count() const;
+  // Number of requests that waited for a lookup started by another request.
+  size_t coalesced_count() const;
+
+ private:
+  struct Entry {
+    bool pending = true;
+    asio::error_code err;
+    std::shared_ptr<const Endpoints> endpoints;
+    fxl::TimePoint expiry;
+    std::vector<ResolveCallback> callbacks;
+  };
+
+  void OnLookupComplete(const std::string& key,
+                        const asio::error_code& err,
+                        std::shared_ptr<const Endpoints> endpoints);
+  void RemoveExpiredEntriesLocked(fxl::TimePoint now)
+      FXL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const fxl::TimeDelta ttl_;
+  const fxl::TimeDelta negative_ttl_;
+
+  mutable fxl::Mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_ FXL_GUARDED_BY(mutex_);
+  size_t hit_count_ FXL_GUARDED_BY(mutex_) = 0;
+  size_t miss_count_ FXL_GUARDED_BY(mutex_) = 0;
+  size_t coalesced_count_ FXL_GUARDED_BY(mutex_) = 0;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(HostResolverCache);
+};
+
+}  // namespace network
+
+#endif  // GARNET_BIN_NETWORK_HOST_RESOLVER_CACHE_H_
@@ -0,0 +1,165 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/host_resolver_cache.h"
+
+#include <memory>
+#include <vector>
+
+#include <asio/error.hpp>
+
+#include "gtest/gtest.h"
+
+namespace network {
+namespace {
+
+using Endpoints = HostResolverCache::Endpoints;
+
+// Stands in for the system resolver, completing lookups when told to.
+class FakeResolver {
+ public:
+  HostResolverCache::Lookup Lookup() {
+    return [this](HostResolverCache::ResolveCallback callback) {
+      pending_.push_back(std::move(callback));
+    };
+  }
+
+  size_t pending_count() const { return pending_.size(); }
+
+  void Complete(const asio::error_code& err) {
+    auto endpoints = std::make_shared<Endpoints>();
+    if (!err) {
+      endpoints->emplace_back(asio::ip::address_v4::loopback(), 80);
+    }
+    auto callback = std::move(pending_.front());
+    pending_.erase(pending_.begin());
+    callback(err, std::move(endpoints));
+  }
+
+ private:
+  std::vector<HostResolverCache::ResolveCallback> pending_;
+};
+
+// Records the results a request was called back with.
+struct Result {
+  HostResolverCache::ResolveCallback Callback() {
+    return [this](const asio::error_code& err,
+                  std::shared_ptr<const Endpoints> endpoints) {
+      ++count;
+      this->err = err;
+      this->endpoints = std::move(endpoints);
+    };
+  }
+
+  int count = 0;
+  asio::error_code err;
+  std::shared_ptr<const Endpoints> endpoints;
+};
+
+TEST(HostResolverCache, CachesAddresses) {
+  HostResolverCache cache;
+  FakeResolver resolver;
+
+  Result first;
+  cache.Resolve("example.com", "80", resolver.Lookup(), first.Callback());
+  EXPECT_EQ(0, first.count);
+  ASSERT_EQ(1u, resolver.pending_count());
+  resolver.Complete(asio::error_code());
+  EXPECT_EQ(1, first.count);
+  EXPECT_FALSE(first.err);
+  ASSERT_TRUE(first.endpoints);
+  EXPECT_EQ(1u, first.endpoints->size());
+
+  Result second;
+  cache.Resolve("example.com", "80", resolver.Lookup(), second.Callback());
+  EXPECT_EQ(0u, resolver.pending_count());
+  EXPECT_EQ(1, second.count);
+  EXPECT_EQ(first.endpoints, second.endpoints);
+
+  EXPECT_EQ(1u, cache.hit_count());
+  EXPECT_EQ(1u, cache.miss_count());
+}
+
+TEST(HostResolverCache, KeysOnHostAndPort) {
+  HostResolverCache cache;
+  FakeResolver resolver;
+
+  Result result;
+  cache.Resolve("example.com", "80", resolver.Lookup(), result.Callback());
+  resolver.Complete(asio::error_code());
+  cache.Resolve("example.com", "443", resolver.Lookup(), result.Callback());
+  cache.Resolve("example.org", "80", resolver.Lookup(), result.Callback());
+  EXPECT_EQ(2u, resolver.pending_count());
+  EXPECT_EQ(3u, cache.miss_count());
+}
+
+TEST(HostResolverCache, CoalescesConcurrentLookups) {
+  HostResolverCache cache;
+  FakeResolver resolver;
+
+  Result first, second, third;
+  cache.Resolve("example.com", "80", resolver.Lookup(), first.Callback());
+  cache.Resolve("example.com", "80", resolver.Lookup(), second.Callback());
+  cache.Resolve("example.com", "80", resolver.Lookup(), third.Callback());
+  ASSERT_EQ(1u, resolver.pending_count());
+  EXPECT_EQ(0, second.count);
+
+  resolver.Complete(asio::error_code());
+  EXPECT_EQ(1, first.count);
+  EXPECT_EQ(1, second.count);
+  EXPECT_EQ(1, third.count);
+  EXPECT_EQ(first.endpoints, third.endpoints);
+
+  EXPECT_EQ(1u, cache.miss_count());
+  EXPECT_EQ(2u, cache.coalesced_count());
+  EXPECT_EQ(0u, cache.hit_count());
+}
+
+TEST(HostResolverCache, CachesHostNotFound) {
+  HostResolverCache cache;
+  FakeResolver resolver;
+
+  Result first;
+  cache.Resolve("nowhere.invalid", "80", resolver.Lookup(), first.Callback());
+  resolver.Complete(asio::error::host_not_found);
+  EXPECT_EQ(asio::error::host_not_found, first.err);
+
+  Result second;
+  cache.Resolve("nowhere.invalid", "80", resolver.Lookup(), second.Callback());
+  EXPECT_EQ(0u, resolver.pending_count());
+  EXPECT_EQ(1, second.count);
+  EXPECT_EQ(asio::error::host_not_found, second.err);
+  EXPECT_EQ(1u, cache.hit_count());
+}
+
+TEST(HostResolverCache, DoesNotCacheTransientFailures) {
+  HostResolverCache cache;
+  FakeResolver resolver;
+
+  Result first;
+  cache.Resolve("example.com", "80", resolver.Lookup(), first.Callback());
+  resolver.Complete(asio::error::host_not_found_try_again);
+  EXPECT_EQ(asio::error::host_not_found_try_again, first.err);
+
+  Result second;
+  cache.Resolve("example.com", "80", resolver.Lookup(), second.Callback());
+  EXPECT_EQ(1u, resolver.pending_count());
+  EXPECT_EQ(2u, cache.miss_count());
+}
+
+TEST(HostResolverCache, ExpiresEntries) {
+  HostResolverCache cache(fxl::TimeDelta::Zero(), fxl::TimeDelta::Zero());
+  FakeResolver resolver;
+
+  Result result;
+  cache.Resolve("example.com", "80", resolver.Lookup(), result.Callback());
+  resolver.Complete(asio::error_code());
+  cache.Resolve("example.com", "80", resolver.Lookup(), result.Callback());
+  EXPECT_EQ(1u, resolver.pending_count());
+  EXPECT_EQ(0u, cache.hit_count());
+  EXPECT_EQ(2u, cache.miss_count());
+}
+
+}  // namespace
+}  // namespace network
@@ -0,0 +1,538 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/http_cache.h"
+
+#include <dirent.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "lib/fxl/files/directory.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/path.h"
+#include "lib/fxl/logging.h"
+#include "lib/fxl/strings/ascii.h"
+#include "lib/fxl/strings/split_string.h"
+#include "lib/fxl/strings/string_number_conversions.h"
+#include "lib/fxl/strings/string_printf.h"
+#include "lib/fxl/strings/string_view.h"
+
+namespace network {
+namespace {
+
+// First line of every stored response, to recognize files written by another
+// version of the cache.
+constexpr char kMagic[] = "http-cache 1";
+
+// Length of the file names, which are hexadecimal hashes of the URLs.
+constexpr size_t kNameLength = 16;
+
+// Longest a response is considered fresh when its freshness is guessed from
+// its Last-Modified date.
+constexpr time_t kMaxHeuristicLifetime = 24 * 60 * 60;
+
+// Fields of a 304 response that describe its own message, which must not
+// replace those of the stored response.
+constexpr const char* kNotUpdatedHeaders[] = {
+    "Connection", "Content-Length", "Keep-Alive", "Transfer-Encoding",
+};
+
+struct CacheControl {
+  bool no_store = false;
+  bool no_cache = false;
+  bool is_private = false;
+  // -1 if absent.
+  int64_t max_age = -1;
+  int64_t s_maxage = -1;
+};
+
+// Returns the file name of the response to |url|, from its 64-bit FNV-1a hash.
+// The hash is stable across versions, unlike std::hash.
+std::string NameForUrl(const std::string& url) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : url) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return fxl::StringPrintf("%016" PRIx64, hash);
+}
+
+bool IsEntryName(const std::string& name) {
+  return name.size() == kNameLength &&
+         std::all_of(name.begin(), name.end(), [](char c) {
+           return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+         });
+}
+
+// Returns the URL without its fragment, which is never sent to the server.
+std::string KeyForUrl(const std::string& url) {
+  return url.substr(0, url.find('#'));
+}
+
+const std::string* FindHeader(const HttpCache::Headers& headers,
+                              fxl::StringView name) {
+  for (const auto& header : headers) {
+    if (fxl::EqualsCaseInsensitiveASCII(header.first, name))
+      return &header.second;
+  }
+  return nullptr;
+}
+
+bool ParseDeltaSeconds(fxl::StringView value, int64_t* seconds) {
+  if (value.size() >= 2 && value[0] == '"' && value[value.size() - 1] == '"')
+    value = value.substr(1, value.size() - 2);
+  return fxl::StringToNumberWithError(value, seconds) && *seconds >= 0;
+}
+
+CacheControl ParseCacheControl(const HttpCache::Headers& headers) {
+  CacheControl result;
+  for (const auto& header : headers) {
+    if (!fxl::EqualsCaseInsensitiveASCII(header.first, "Cache-Control"))
+      continue;
+    for (fxl::StringView directive :
+         fxl::SplitString(header.second, ",", fxl::kTrimWhitespace,
+                          fxl::kSplitWantNonEmpty)) {
+      size_t equals = directive.find('=');
+      fxl::StringView name = directive.substr(0, equals);
+      fxl::StringView value = equals == fxl::StringView::npos
+                                  ? fxl::StringView()
+                                  : directive.substr(equals + 1);
+      if (fxl::EqualsCaseInsensitiveASCII(name, "no-store")) {
+        result.no_store = true;
+      } else if (fxl::EqualsCaseInsensitiveASCII(name, "no-cache")) {
+        result.no_cache = true;
+      } else if (fxl::EqualsCaseInsensitiveASCII(name, "private")) {
+        result.is_private = true;
+      } else if (fxl::EqualsCaseInsensitiveASCII(name, "max-age")) {
+        // An invalid max-age makes the response stale.
+        if (!ParseDeltaSeconds(value, &result.max_age))
+          result.max_age = 0;
+      } else if (fxl::EqualsCaseInsensitiveASCII(name, "s-maxage")) {
+        if (!ParseDeltaSeconds(value, &result.s_maxage))
+          result.s_maxage = 0;
+      }
+    }
+  }
+  return result;
+}
+
+// Parses the three date formats HTTP/1.1 recipients must accept.
+bool ParseHttpDate(const std::string& value, time_t* time) {
+  static const char* const kFormats[] = {
+      "%a, %d %b %Y %H:%M:%S GMT",  // IMF-fixdate
+      "%A, %d-%b-%y %H:%M:%S GMT",  // RFC 850
+      "%a %b %e %H:%M:%S %Y",       // asctime
+  };
+  for (const char* format : kFormats) {
+    struct tm tm = {};
+    const char* end = strptime(value.c_str(), format, &tm);
+    if (end && *end == '\0') {
+      *time = timegm(&tm);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns how long, in seconds from when it was generated, |response| is
+// fresh for.
+time_t FreshnessLifetime(const HttpCache::Response& response,
+                         const CacheControl& cache_control,
+                         time_t response_time) {
+  if (cache_control.s_maxage >= 0)
+    return cache_control.s_maxage;
+  if (cache_control.max_age >= 0)
+    return cache_control.max_age;
+
+  time_t date = response_time;
+  const std::string* date_value = FindHeader(response.headers, "Date");
+  if (date_value)
+    ParseHttpDate(*date_value, &date);
+
+  const std::string* expires = FindHeader(response.headers, "Expires");
+  if (expires) {
+    // An invalid date, such as "0", is in the past.
+    time_t expiry;
+    if (!ParseHttpDate(*expires, &expiry))
+      return 0;
+    return std::max<time_t>(expiry - date, 0);
+  }
+
+  const std::string* last_modified =
+      FindHeader(response.headers, "Last-Modified");
+  time_t modified;
+  if (last_modified && ParseHttpDate(*last_modified, &modified) &&
+      modified < date) {
+    return std::min((date - modified) / 10, kMaxHeuristicLifetime);
+  }
+  return 0;
+}
+
+// Returns the age of |response| at |now|, following RFC 7234 section 4.2.3.
+time_t CurrentAge(const HttpCache::Response& response,
+                  time_t request_time,
+                  time_t response_time,
+                  time_t now) {
+  time_t apparent_age = 0;
+  time_t date;
+  const std::string* date_value = FindHeader(response.headers, "Date");
+  if (date_value && ParseHttpDate(*date_value, &date))
+    apparent_age = std::max<time_t>(response_time - date, 0);
+
+  int64_t age_value = 0;
+  const std::string* age = FindHeader(response.headers, "Age");
+  if (age && !ParseDeltaSeconds(*age, &age_value))
+    age_value = 0;
+  time_t corrected_age_value =
+      age_value + std::max<time_t>(response_time - request_time, 0);
+
+  return std::max(apparent_age, corrected_age_value) +
+         std::max<time_t>(now - response_time, 0);
+}
+
+bool IsUpdatedBy304(const std::string& name) {
+  return std::none_of(std::begin(kNotUpdatedHeaders),
+                      std::end(kNotUpdatedHeaders),
+                      [&name](const char* not_updated) {
+                        return fxl::EqualsCaseInsensitiveASCII(
+                            name, fxl::StringView(not_updated));
+                      });
+}
+
+bool IsStorable(const HttpCache::Response& response) {
+  if (response.status_code != 200)
+    return false;
+
+  CacheControl cache_control = ParseCacheControl(response.headers);
+  if (cache_control.no_store || cache_control.is_private)
+    return false;
+  // Responses are stored once per URL, so they cannot depend on the request
+  // fields named by Vary.
+  if (FindHeader(response.headers, "Vary"))
+    return false;
+
+  // Responses that can neither be fresh nor be revalidated are of no use.
+  return cache_control.max_age >= 0 || cache_control.s_maxage >= 0 ||
+         FindHeader(response.headers, "Expires") ||
+         FindHeader(response.headers, "ETag") ||
+         FindHeader(response.headers, "Last-Modified");
+}
+
+// Moves past the next line of |*data| and returns it.
+bool ReadLine(fxl::StringView* data, fxl::StringView* line) {
+  size_t end = data->find('\n');
+  if (end == fxl::StringView::npos)
+    return false;
+  *line = data->substr(0, end);
+  *data = data->substr(end + 1);
+  return true;
+}
+
+template <typename T>
+bool ReadNumber(fxl::StringView* data, T* number) {
+  fxl::StringView line;
+  return ReadLine(data, &line) && fxl::StringToNumberWithError(line, number);
+}
+
+}  // namespace
+
+constexpr uint64_t HttpCache::kDefaultMaxSize;
+
+HttpCache::HttpCache(std::string path, uint64_t max_size)
+    : HttpCache(std::move(path), max_size, [] { return time(nullptr); }) {}
+
+HttpCache::HttpCache(std::string path, uint64_t max_size, Clock clock)
+    : path_(std::move(path)), max_size_(max_size), clock_(std::move(clock)) {
+  if (!files::CreateDirectory(path_)) {
+    FXL_LOG(WARNING) << "Unable to create " << path_
+                     << ", responses will not be cached";
+    return;
+  }
+  enabled_ = true;
+  LoadIndex();
+}
+
+HttpCache::~HttpCache() = default;
+
+bool HttpCache::IsCacheableRequest(const std::string& method,
+                                   const Headers& headers) {
+  if (method != "GET")
+    return false;
+  for (const auto& header : headers) {
+    fxl::StringView name(header.first);
+    if (fxl::EqualsCaseInsensitiveASCII(name, "Authorization") ||
+        fxl::EqualsCaseInsensitiveASCII(name, "Range") ||
+        (name.size() > 3 &&
+         fxl::EqualsCaseInsensitiveASCII(name.substr(0, 3), "If-")))
+      return false;
+  }
+  return !ParseCacheControl(headers).no_store;
+}
+
+std::unique_ptr<HttpCache::Entry> HttpCache::Lookup(const std::string& url,
+                                                    const Headers& headers) {
+  if (!enabled_)
+    return nullptr;
+
+  std::string key = KeyForUrl(url);
+  std::string name = NameForUrl(key);
+  {
+    fxl::MutexLocker locker(&mutex_);
+    auto it = index_.find(name);
+    if (it == index_.end())
+      return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+  }
+
+  StoredResponse stored;
+  if (!ReadStoredResponse(name, key, &stored))
+    return nullptr;
+
+  auto entry = std::make_unique<Entry>();
+  entry->response = std::move(stored.response);
+
+  const Response& response = entry->response;
+  CacheControl cache_control = ParseCacheControl(response.headers);
+  CacheControl request_cache_control = ParseCacheControl(headers);
+  const std::string* pragma = FindHeader(headers, "Pragma");
+  bool revalidate = cache_control.no_cache || request_cache_control.no_cache ||
+                    request_cache_control.max_age == 0 ||
+                    (pragma && fxl::EqualsCaseInsensitiveASCII(*pragma,
+                                                               "no-cache"));
+  entry->fresh =
+      !revalidate &&
+      CurrentAge(response, stored.request_time, stored.response_time,
+                 clock_()) <
+          FreshnessLifetime(response, cache_control, stored.response_time);
+
+  const std::string* etag = FindHeader(response.headers, "ETag");
+  if (etag)
+    entry->etag = *etag;
+  const std::string* last_modified =
+      FindHeader(response.headers, "Last-Modified");
+  if (last_modified)
+    entry->last_modified = *last_modified;
+  return entry;
+}
+
+bool HttpCache::Store(const std::string& url,
+                      const Response& response,
+                      time_t request_time) {
+  if (!enabled_)
+    return false;
+
+  std::string key = KeyForUrl(url);
+  if (!IsStorable(response) || response.body.size() > max_entry_size()) {
+    // Whatever was stored before is now out of date.
+    Remove(key);
+    return false;
+  }
+
+  StoredResponse stored;
+  stored.url = key;
+  stored.request_time = request_time;
+  stored.response_time = clock_();
+  stored.response = response;
+  return WriteStoredResponse(NameForUrl(key), stored);
+}
+
+std::unique_ptr<HttpCache::Response> HttpCache::Update(
+    const std::string& url,
+    const Headers& headers,
+    time_t request_time) {
+  if (!enabled_)
+    return nullptr;
+
+  std::string key = KeyForUrl(url);
+  std::string name = NameForUrl(key);
+  StoredResponse stored;
+  if (!ReadStoredResponse(name, key, &stored))
+    return nullptr;
+
+  // Fields of the 304 response replace all the stored fields of that name.
+  Headers& stored_headers = stored.response.headers;
+  for (const auto& header : headers) {
+    if (!IsUpdatedBy304(header.first))
+      continue;
+    stored_headers.erase(
+        std::remove_if(stored_headers.begin(), stored_headers.end(),
+                       [&header](const Headers::value_type& stored_header) {
+                         return fxl::EqualsCaseInsensitiveASCII(
+                             stored_header.first, header.first);
+                       }),
+        stored_headers.end());
+  }
+  for (const auto& header : headers) {
+    if (IsUpdatedBy304(header.first))
+      stored_headers.push_back(header);
+  }
+  stored.request_time = request_time;
+  stored.response_time = clock_();
+
+  auto response = std::make_unique<Response>(stored.response);
+  if (IsStorable(stored.response))
+    WriteStoredResponse(name, stored);
+  else
+    Remove(key);
+  return response;
+}
+
+void HttpCache::Remove(const std::string& url) {
+  if (!enabled_)
+    return;
+
+  std::string name = NameForUrl(KeyForUrl(url));
+  fxl::MutexLocker locker(&mutex_);
+  if (index_.count(name)) {
+    RemoveFromIndexLocked(name);
+    unlink(FilePath(name).c_str());
+  }
+}
+
+uint64_t HttpCache::size() const {
+  fxl::MutexLocker locker(&mutex_);
+  return size_;
+}
+
+size_t HttpCache::entry_count() const {
+  fxl::MutexLocker locker(&mutex_);
+  return index_.size();
+}
+
+std::string HttpCache::FilePath(const std::string& name) const {
+  return path_ + "/" + name;
+}
+
+void HttpCache::LoadIndex() {
+  DIR* dir = opendir(path_.c_str());
+  if (!dir)
+    return;
+
+  std::vector<std::pair<time_t, std::string>> entries;
+  std::vector<std::string> leftovers;
+  while (struct dirent* dirent = readdir(dir)) {
+    std::string name = dirent->d_name;
+    if (name == "." || name == "..")
+      continue;
+    struct stat st;
+    if (!IsEntryName(name) || stat(FilePath(name).c_str(), &st) != 0 ||
+        !S_ISREG(st.st_mode)) {
+      // Left behind by a write that did not complete.
+      leftovers.push_back(std::move(name));
+      continue;
+    }
+    entries.emplace_back(st.st_mtime, std::move(name));
+  }
+  closedir(dir);
+
+  for (const auto& name : leftovers)
+    files::DeletePath(FilePath(name), true);
+
+  // Files are written when their response is stored or updated, which is
+  // the closest to their last use that survives a restart.
+  std::sort(entries.begin(), entries.end());
+  fxl::MutexLocker locker(&mutex_);
+  for (const auto& entry : entries) {
+    uint64_t size;
+    if (files::GetFileSize(FilePath(entry.second), &size))
+      AddToIndexLocked(entry.second, size);
+  }
+}
+
+bool HttpCache::ReadStoredResponse(const std::string& name,
+                                   const std::string& url,
+                                   StoredResponse* stored) {
+  std::string contents;
+  bool valid = files::ReadFileToString(FilePath(name), &contents);
+
+  fxl::StringView data(contents);
+  fxl::StringView line;
+  int64_t request_time = 0;
+  int64_t response_time = 0;
+  uint64_t header_count = 0;
+  valid = valid && ReadLine(&data, &line) && line == kMagic &&
+          ReadLine(&data, &line) && line == url &&
+          ReadNumber(&data, &request_time) &&
+          ReadNumber(&data, &response_time) &&
+          ReadNumber(&data, &stored->response.status_code) &&
+          ReadLine(&data, &line);
+  if (valid)
+    stored->response.status_line = line.ToString();
+  valid = valid && ReadNumber(&data, &header_count);
+  for (uint64_t i = 0; valid && i < header_count; ++i) {
+    fxl::StringView name, value;
+    valid = ReadLine(&data, &name) && ReadLine(&data, &value);
+    if (valid)
+      stored->response.headers.emplace_back(name.ToString(), value.ToString());
+  }
+
+  if (!valid) {
+    // The file is gone, or holds the response to another URL with the same
+    // hash, which is replaced once this URL's response is stored.
+    fxl::MutexLocker locker(&mutex_);
+    if (index_.count(name) && contents.empty())
+      RemoveFromIndexLocked(name);
+    return false;
+  }
+  stored->url = url;
+  stored->request_time = request_time;
+  stored->response_time = response_time;
+  stored->response.body = data.ToString();
+  return true;
+}
+
+bool HttpCache::WriteStoredResponse(const std::string& name,
+                                    const StoredResponse& stored) {
+  const Response& response = stored.response;
+  std::string contents = fxl::StringPrintf(
+      "%s\n%s\n%" PRId64 "\n%" PRId64 "\n%" PRIu32 "\n%s\n%" PRIu64 "\n",
+      kMagic, stored.url.c_str(), static_cast<int64_t>(stored.request_time),
+      static_cast<int64_t>(stored.response_time), response.status_code,
+      response.status_line.c_str(),
+      static_cast<uint64_t>(response.headers.size()));
+  for (const auto& header : response.headers) {
+    contents.append(header.first).append("\n");
+    contents.append(header.second).append("\n");
+  }
+  contents.append(response.body);
+
+  // The file is written whole under another name and then renamed, so that
+  // readers never see part of it.
+  if (!files::WriteFileInTwoPhases(FilePath(name), contents, path_)) {
+    FXL_VLOG(1) << "Unable to store the response to " << stored.url;
+    return false;
+  }
+
+  fxl::MutexLocker locker(&mutex_);
+  RemoveFromIndexLocked(name);
+  AddToIndexLocked(name, contents.size());
+  while (size_ > max_size_ && lru_.size() > 1) {
+    std::string evicted = lru_.back();
+    RemoveFromIndexLocked(evicted);
+    unlink(FilePath(evicted).c_str());
+  }
+  return true;
+}
+
+void HttpCache::AddToIndexLocked(const std::string& name, uint64_t size) {
+  lru_.push_front(name);
+  IndexEntry& entry = index_[name];
+  entry.size = size;
+  entry.lru_position = lru_.begin();
+  size_ += size;
+}
+
+void HttpCache::RemoveFromIndexLocked(const std::string& name) {
+  auto it = index_.find(name);
+  if (it == index_.end())
+    return;
+  size_ -= it->second.size;
+  lru_.erase(it->second.lru_position);
+  index_.erase(it);
+}
+
+}  // namespace network
@@ -0,0 +1,145 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_NETWORK_HTTP_CACHE_H_
+#define GARNET_BIN_NETWORK_HTTP_CACHE_H_
+
+#include <time.h>
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lib/fxl/macros.h"
+#include "lib/fxl/synchronization/mutex.h"
+#include "lib/fxl/synchronization/thread_annotations.h"
+
+namespace network {
+
+// Caches the responses to GET requests on disk, following the HTTP/1.1
+// caching rules for a shared cache. The URL loaders of a network service run
+// on their own threads, so every method may be called on any thread.
+//
+// Each response is kept in its own file under the cache directory, named
+// after a hash of its URL. The index of the files, ordered from the most to
+// the least recently used, is kept in memory and rebuilt from the directory
+// when the cache is created. Once the files take more than the maximum size,
+// the least recently used ones are removed.
+//
+// Only complete 200 responses without a Vary header are stored.
+class HttpCache {
+ public:
+  using Headers = std::vector<std::pair<std::string, std::string>>;
+  // Returns the current time, in seconds since the epoch.
+  using Clock = std::function<time_t()>;
+
+  struct Response {
+    uint32_t status_code = 0;
+    std::string status_line;
+    Headers headers;
+    std::string body;
+  };
+
+  // A stored response, as returned by Lookup().
+  struct Entry {
+    Response response;
+    // Whether |response| may be used without asking the server.
+    bool fresh = false;
+    // The validators to revalidate |response| with. Empty if the response
+    // does not have them.
+    std::string etag;
+    std::string last_modified;
+  };
+
+  static constexpr uint64_t kDefaultMaxSize = 32 * 1024 * 1024;
+
+  // Keeps up to |max_size| bytes of responses in the directory |path|, which
+  // is created if needed. If it cannot be, the cache stores nothing.
+  explicit HttpCache(std::string path, uint64_t max_size = kDefaultMaxSize);
+  HttpCache(std::string path, uint64_t max_size, Clock clock);
+  ~HttpCache();
+
+  // Whether a request with |method| and |headers| may be answered from the
+  // cache and its response stored. Requests that carry their own conditions
+  // or credentials are left to the server.
+  static bool IsCacheableRequest(const std::string& method,
+                                 const Headers& headers);
+
+  // The largest response that is stored.
+  uint64_t max_entry_size() const { return max_size_ / 8; }
+
+  // Returns the stored response to a GET of |url|, or nullptr. The response is
+  // not fresh if the request |headers| ask for it to be revalidated.
+  std::unique_ptr<Entry> Lookup(const std::string& url,
+                                const Headers& headers);
+
+  // Stores |response| to a GET of |url| if its headers allow it, replacing
+  // the response stored before. |request_time| is when the request was sent.
+  // Returns whether the response was stored.
+  bool Store(const std::string& url,
+             const Response& response,
+             time_t request_time);
+
+  // Refreshes the stored response to |url| with the |headers| of the 304
+  // response that revalidated it, and returns the updated response. Returns
+  // nullptr if the response is no longer stored.
+  std::unique_ptr<Response> Update(const std::string& url,
+                                   const Headers& headers,
+                                   time_t request_time);
+
+  // Removes the stored response to |url|, if any.
+  void Remove(const std::string& url);
+
+  // Number of bytes taken by the stored responses.
+  uint64_t size() const;
+  // Number of stored responses.
+  size_t entry_count() const;
+
+ private:
+  struct IndexEntry {
+    uint64_t size = 0;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  // A response as stored on disk.
+  struct StoredResponse {
+    std::string url;
+    time_t request_time = 0;
+    time_t response_time = 0;
+    Response response;
+  };
+
+  std::string FilePath(const std::string& name) const;
+  void LoadIndex();
+  bool ReadStoredResponse(const std::string& name,
+                          const std::string& url,
+                          StoredResponse* stored);
+  bool WriteStoredResponse(const std::string& name,
+                           const StoredResponse& stored);
+  void AddToIndexLocked(const std::string& name, uint64_t size)
+      FXL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void RemoveFromIndexLocked(const std::string& name)
+      FXL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const std::string path_;
+  const uint64_t max_size_;
+  const Clock clock_;
+  bool enabled_ = false;
+
+  mutable fxl::Mutex mutex_;
+  std::unordered_map<std::string, IndexEntry> index_ FXL_GUARDED_BY(mutex_);
+  // File names, from the most to the least recently used.
+  std::list<std::string> lru_ FXL_GUARDED_BY(mutex_);
+  uint64_t size_ FXL_GUARDED_BY(mutex_) = 0;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(HttpCache);
+};
+
+}  // namespace network
+
+#endif  // GARNET_BIN_NETWORK_HTTP_CACHE_H_
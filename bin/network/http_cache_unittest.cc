@@ -0,0 +1,344 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/http_cache.h"
+
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+
+namespace network {
+namespace {
+
+using Headers = HttpCache::Headers;
+using Response = HttpCache::Response;
+
+constexpr char kUrl[] = "http://example.com/resource";
+
+std::string HttpDate(time_t time) {
+  struct tm tm;
+  gmtime_r(&time, &tm);
+  char buffer[64];
+  strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  return buffer;
+}
+
+// Stands in for an HTTP server holding a single resource.
+class FakeOrigin {
+ public:
+  // Answers a GET of the resource, with a 304 if the request's validators
+  // match it.
+  Response Get(const Headers& request_headers, time_t now) {
+    ++request_count_;
+    Response response;
+    for (const auto& header : request_headers) {
+      if ((header.first == "If-None-Match" && header.second == etag_) ||
+          (header.first == "If-Modified-Since" &&
+           header.second == last_modified_)) {
+        response.status_code = 304;
+        response.status_line = "HTTP/1.1 304 Not Modified";
+      }
+    }
+    if (response.status_code == 0) {
+      response.status_code = 200;
+      response.status_line = "HTTP/1.1 200 OK";
+      response.body = body_;
+    }
+    response.headers.emplace_back("Date", HttpDate(now));
+    if (!etag_.empty())
+      response.headers.emplace_back("ETag", etag_);
+    if (!last_modified_.empty())
+      response.headers.emplace_back("Last-Modified", last_modified_);
+    for (const auto& header : extra_headers_)
+      response.headers.push_back(header);
+    return response;
+  }
+
+  void set_body(std::string body) { body_ = std::move(body); }
+  void set_etag(std::string etag) { etag_ = std::move(etag); }
+  void set_last_modified(std::string last_modified) {
+    last_modified_ = std::move(last_modified);
+  }
+  void AddHeader(std::string name, std::string value) {
+    extra_headers_.emplace_back(std::move(name), std::move(value));
+  }
+
+  int request_count() const { return request_count_; }
+
+ private:
+  std::string body_ = "body";
+  std::string etag_;
+  std::string last_modified_;
+  Headers extra_headers_;
+  int request_count_ = 0;
+};
+
+class HttpCacheTest : public ::testing::Test {
+ protected:
+  std::unique_ptr<HttpCache> MakeCache(
+      uint64_t max_size = HttpCache::kDefaultMaxSize) {
+    return std::make_unique<HttpCache>(temp_dir_.path(), max_size,
+                                       [this] { return now_; });
+  }
+
+  // Gets |url| the way the URL loader does, going to |origin| unless the
+  // cache has a fresh response.
+  Response Fetch(HttpCache* cache,
+                 FakeOrigin* origin,
+                 const std::string& url = kUrl,
+                 const Headers& request_headers = Headers()) {
+    std::unique_ptr<HttpCache::Entry> entry =
+        cache->Lookup(url, request_headers);
+    if (entry && entry->fresh)
+      return entry->response;
+
+    Headers headers = request_headers;
+    if (entry && !entry->etag.empty())
+      headers.emplace_back("If-None-Match", entry->etag);
+    if (entry && !entry->last_modified.empty())
+      headers.emplace_back("If-Modified-Since", entry->last_modified);
+    Response response = origin->Get(headers, now_);
+    if (entry && response.status_code == 304) {
+      std::unique_ptr<Response> updated =
+          cache->Update(url, response.headers, now_);
+      EXPECT_TRUE(updated);
+      return updated ? *updated : Response();
+    }
+    cache->Store(url, response, now_);
+    return response;
+  }
+
+  files::ScopedTempDir temp_dir_;
+  time_t now_ = 1500000000;
+};
+
+TEST_F(HttpCacheTest, ServesFreshResponse) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.AddHeader("Cache-Control", "max-age=60");
+
+  EXPECT_EQ("body", Fetch(cache.get(), &origin).body);
+  now_ += 30;
+  Response response = Fetch(cache.get(), &origin);
+  EXPECT_EQ(1, origin.request_count());
+  EXPECT_EQ(200u, response.status_code);
+  EXPECT_EQ("body", response.body);
+  EXPECT_EQ(1u, cache->entry_count());
+}
+
+TEST_F(HttpCacheTest, IgnoresFragment) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.AddHeader("Cache-Control", "max-age=60");
+
+  Fetch(cache.get(), &origin, "http://example.com/resource#a");
+  Fetch(cache.get(), &origin, "http://example.com/resource#b");
+  EXPECT_EQ(1, origin.request_count());
+}
+
+TEST_F(HttpCacheTest, FetchesAgainOnceStale) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.AddHeader("Cache-Control", "max-age=60");
+
+  Fetch(cache.get(), &origin);
+  now_ += 61;
+  origin.set_body("new body");
+  EXPECT_EQ("new body", Fetch(cache.get(), &origin).body);
+  EXPECT_EQ(2, origin.request_count());
+}
+
+TEST_F(HttpCacheTest, UsesExpires) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.AddHeader("Expires", HttpDate(now_ + 60));
+
+  Fetch(cache.get(), &origin);
+  now_ += 59;
+  Fetch(cache.get(), &origin);
+  EXPECT_EQ(1, origin.request_count());
+  now_ += 2;
+  Fetch(cache.get(), &origin);
+  EXPECT_EQ(2, origin.request_count());
+}
+
+TEST_F(HttpCacheTest, CountsAgeFromOtherCaches) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.AddHeader("Cache-Control", "max-age=60");
+  origin.AddHeader("Age", "50");
+
+  Fetch(cache.get(), &origin);
+  now_ += 20;
+  Fetch(cache.get(), &origin);
+  EXPECT_EQ(2, origin.request_count());
+}
+
+TEST_F(HttpCacheTest, RevalidatesWithETag) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.set_etag("\"v1\"");
+  origin.AddHeader("Cache-Control", "max-age=60");
+
+  Fetch(cache.get(), &origin);
+  now_ += 120;
+  Response response = Fetch(cache.get(), &origin);
+  EXPECT_EQ(2, origin.request_count());
+  EXPECT_EQ(200u, response.status_code);
+  EXPECT_EQ("body", response.body);
+
+  // The 304 response made the stored response fresh again.
+  now_ += 30;
+  Fetch(cache.get(), &origin);
+  EXPECT_EQ(2, origin.request_count());
+}
+
+TEST_F(HttpCacheTest, RevalidatesWithLastModified) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.set_last_modified(HttpDate(now_ - 1000));
+
+  // The response is fresh for a tenth of the time since it was modified.
+  Fetch(cache.get(), &origin);
+  now_ += 50;
+  Fetch(cache.get(), &origin);
+  EXPECT_EQ(1, origin.request_count());
+  now_ += 100;
+  EXPECT_EQ("body", Fetch(cache.get(), &origin).body);
+  EXPECT_EQ(2, origin.request_count());
+}
+
+TEST_F(HttpCacheTest, NoCacheAlwaysRevalidates) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.set_etag("\"v1\"");
+  origin.AddHeader("Cache-Control", "no-cache, max-age=60");
+
+  Fetch(cache.get(), &origin);
+  std::unique_ptr<HttpCache::Entry> entry = cache->Lookup(kUrl, Headers());
+  ASSERT_TRUE(entry);
+  EXPECT_FALSE(entry->fresh);
+  EXPECT_EQ("\"v1\"", entry->etag);
+}
+
+TEST_F(HttpCacheTest, RequestCanAskForRevalidation) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.AddHeader("Cache-Control", "max-age=60");
+
+  Fetch(cache.get(), &origin);
+  EXPECT_TRUE(cache->Lookup(kUrl, Headers())->fresh);
+  EXPECT_FALSE(cache->Lookup(kUrl, {{"Cache-Control", "no-cache"}})->fresh);
+  EXPECT_FALSE(cache->Lookup(kUrl, {{"Pragma", "no-cache"}})->fresh);
+}
+
+TEST_F(HttpCacheTest, DoesNotStoreUncacheableResponses) {
+  auto cache = MakeCache();
+  const Headers kUncacheable[] = {
+      {{"Cache-Control", "max-age=60, no-store"}},
+      {{"Cache-Control", "private, max-age=60"}},
+      {{"Cache-Control", "max-age=60"}, {"Vary", "Accept-Language"}},
+      // Neither fresh nor revalidatable.
+      {},
+  };
+  for (const auto& headers : kUncacheable) {
+    Response response;
+    response.status_code = 200;
+    response.headers = headers;
+    EXPECT_FALSE(cache->Store(kUrl, response, now_));
+  }
+
+  Response not_found;
+  not_found.status_code = 404;
+  not_found.headers = {{"Cache-Control", "max-age=60"}};
+  EXPECT_FALSE(cache->Store(kUrl, not_found, now_));
+  EXPECT_EQ(0u, cache->entry_count());
+}
+
+TEST_F(HttpCacheTest, UncacheableResponseReplacesStoredOne) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.set_etag("\"v1\"");
+
+  Fetch(cache.get(), &origin);
+  EXPECT_EQ(1u, cache->entry_count());
+  origin.set_etag("");
+  origin.AddHeader("Cache-Control", "no-store");
+  Fetch(cache.get(), &origin);
+  EXPECT_EQ(0u, cache->entry_count());
+}
+
+TEST_F(HttpCacheTest, IsCacheableRequest) {
+  EXPECT_TRUE(HttpCache::IsCacheableRequest("GET", Headers()));
+  EXPECT_TRUE(
+      HttpCache::IsCacheableRequest("GET", {{"Accept", "text/html"}}));
+  EXPECT_FALSE(HttpCache::IsCacheableRequest("POST", Headers()));
+  EXPECT_FALSE(HttpCache::IsCacheableRequest("HEAD", Headers()));
+  EXPECT_FALSE(
+      HttpCache::IsCacheableRequest("GET", {{"Authorization", "secret"}}));
+  EXPECT_FALSE(
+      HttpCache::IsCacheableRequest("GET", {{"If-None-Match", "\"v1\""}}));
+  EXPECT_FALSE(HttpCache::IsCacheableRequest("GET", {{"Range", "bytes=0-1"}}));
+  EXPECT_FALSE(
+      HttpCache::IsCacheableRequest("GET", {{"Cache-Control", "no-store"}}));
+}
+
+TEST_F(HttpCacheTest, EvictsLeastRecentlyUsed) {
+  // Leaves room for eight responses.
+  auto cache = MakeCache(8 * 1024);
+  FakeOrigin origin;
+  origin.AddHeader("Cache-Control", "max-age=60");
+  origin.set_body(std::string(900, 'x'));
+
+  Fetch(cache.get(), &origin, "http://example.com/a");
+  Fetch(cache.get(), &origin, "http://example.com/b");
+  Fetch(cache.get(), &origin, "http://example.com/c");
+  // Uses "a", so that "b" is the least recently used.
+  Fetch(cache.get(), &origin, "http://example.com/a");
+  EXPECT_EQ(3, origin.request_count());
+  for (char c = 'd'; c <= 'j'; ++c)
+    Fetch(cache.get(), &origin, std::string("http://example.com/") + c);
+  EXPECT_LE(cache->size(), 8u * 1024);
+
+  int request_count = origin.request_count();
+  Fetch(cache.get(), &origin, "http://example.com/b");
+  EXPECT_EQ(request_count + 1, origin.request_count());
+}
+
+TEST_F(HttpCacheTest, DoesNotStoreLargeResponses) {
+  auto cache = MakeCache(8 * 1024);
+  Response response;
+  response.status_code = 200;
+  response.headers = {{"Cache-Control", "max-age=60"}};
+  response.body = std::string(cache->max_entry_size() + 1, 'x');
+  EXPECT_FALSE(cache->Store(kUrl, response, now_));
+}
+
+TEST_F(HttpCacheTest, PersistsAcrossInstances) {
+  FakeOrigin origin;
+  origin.AddHeader("Cache-Control", "max-age=60");
+  Fetch(MakeCache().get(), &origin);
+
+  auto cache = MakeCache();
+  EXPECT_EQ(1u, cache->entry_count());
+  EXPECT_EQ("body", Fetch(cache.get(), &origin).body);
+  EXPECT_EQ(1, origin.request_count());
+}
+
+TEST_F(HttpCacheTest, Remove) {
+  auto cache = MakeCache();
+  FakeOrigin origin;
+  origin.AddHeader("Cache-Control", "max-age=60");
+
+  Fetch(cache.get(), &origin);
+  cache->Remove(kUrl);
+  EXPECT_EQ(0u, cache->entry_count());
+  EXPECT_EQ(0u, cache->size());
+  EXPECT_FALSE(cache->Lookup(kUrl, Headers()));
+}
+
+}  // namespace
+}  // namespace network
@@ -5,13 +5,25 @@
 #ifndef GARNET_BIN_NETWORK_HTTP_CLIENT_H_
 #define GARNET_BIN_NETWORK_HTTP_CLIENT_H_
 
+#include <sys/socket.h>
+#include <unistd.h>
 #include <zircon/status.h>
 
+#include <sstream>
+
+#include "garnet/bin/network/connection_pool.h"
+#include "garnet/bin/network/host_resolver_cache.h"
+#include "garnet/bin/network/http_cache.h"
 #include "garnet/bin/network/net_errors.h"
+#include "garnet/bin/network/response_body_decoder.h"
+#include "garnet/bin/network/stream_writer.h"
 #include "garnet/bin/network/upload_element_reader.h"
 #include "lib/fsl/vmo/sized_vmo.h"
+#include "lib/fxl/files/unique_fd.h"
 #include "lib/fxl/logging.h"
 #include "lib/fxl/strings/ascii.h"
+#include "lib/fxl/strings/string_view.h"
+#include "lib/fxl/time/time_delta.h"
 
 #include <asio.hpp>
 #include <asio/ssl.hpp>
@@ -49,26 +61,46 @@ class URLLoaderImpl::HTTPClient {
   void Start(const std::string& server, const std::string& port);
 
  private:
-  using TransferBuffer = char[64 * 1024];
-
+  // Most of the response body read from the network at a time. No more is
+  // read until it has been passed on, so that a slow consumer holds back the
+  // download instead of having it pile up in memory.
+  static constexpr size_t kBodyReadSize = 64 * 1024;
+  // How long a streamed response waits for its reader to make room before
+  // the request is abandoned. Until then the request keeps its thread, its
+  // network slot and its connection.
+  static constexpr fxl::TimeDelta kStreamStallTimeout =
+      fxl::TimeDelta::FromSeconds(60);
+
+  bool TakeIdleConnection();
+  bool RetryOnNewConnection();
+  void ReleaseConnection();
+  void Resolve();
   void OnResolve(const asio::error_code& err,
-                 tcp::resolver::iterator endpoint_iterator);
+                 std::shared_ptr<const HostResolverCache::Endpoints> endpoints);
   bool OnVerifyCertificate(bool preverified, asio::ssl::verify_context& ctx);
   void OnConnect(const asio::error_code& err);
   void OnHandShake(const asio::error_code& err);
+  void WriteRequestHeaders();
   void OnWriteRequestHeaders(const asio::error_code& err,
                              std::size_t transferred);
   void WriteRequestBody();
   void OnWriteRequestBody(const asio::error_code& err, std::size_t transferred);
   void OnReadStatusLine(const asio::error_code& err);
-  zx_status_t SendStreamedBody();
-  zx_status_t SendBufferedBody();
+  zx_status_t SendBody(const char* data, size_t size);
+  void StoreResponse();
+  zx_status_t SendStreamedBody(const char* data, size_t size);
+  zx_status_t ReserveBufferedBody(uint64_t capacity);
+  zx_status_t SendBufferedBody(const char* data, size_t size);
+  zx_status_t FinishBufferedBody();
   void ParseHeaderField(const std::string& header,
                         std::string* name,
                         std::string* value);
   void OnReadHeaders(const asio::error_code& err);
-  void OnStreamBody(const asio::error_code& err);
-  void OnBufferBody(const asio::error_code& err);
+  zx_status_t ConsumeBody();
+  void ContinueStreamBody();
+  void OnStreamBody(const asio::error_code& err, std::size_t transferred);
+  void ContinueBufferBody();
+  void OnBufferBody(const asio::error_code& err, std::size_t transferred);
 
   void SendResponse(URLResponsePtr response);
   void SendError(int error_code);
@@ -81,24 +113,49 @@ class URLLoaderImpl::HTTPClient {
   URLLoaderImpl* loader_;
 
   tcp::resolver resolver_;
+  std::unique_ptr<asio::io_service::work> resolve_work_;
+  std::shared_ptr<const HostResolverCache::Endpoints> endpoints_;
   T socket_;
+  std::string server_;
+  std::string port_;
+  // Identifies the connection and session in the connection pool.
+  std::string origin_;
+  // Whether the connection can be returned to the pool once the response has
+  // been read, as far as the request is concerned.
+  bool reusable_ = false;
+  bool reused_connection_ = false;
+
+  std::string method_;
+  std::string request_header_;
   asio::streambuf request_header_buf_;
   std::unique_ptr<UploadElementReader> request_body_reader_;
   asio::streambuf request_body_buf_;
   std::ostream request_body_stream_;
   asio::streambuf response_buf_;
 
+  ResponseBodyDecoder body_decoder_;
+
   std::string http_version_;
   std::string status_message_;
 
   URLResponsePtr response_;          // used for buffered responses
+  zx::vmo response_body_vmo_;        // used for buffered responses
+  uint64_t response_body_size_ = 0;
+  uint64_t response_body_capacity_ = 0;
   zx::socket response_body_stream_;  // used for streamed responses (default)
+
+  // Whether the response is stored in the cache once its body is complete.
+  bool store_response_ = false;
+  HttpCache::Response response_to_store_;
 };
 
 template <typename T>
 const std::set<std::string> URLLoaderImpl::HTTPClient<T>::ALLOWED_METHODS{
     "GET", "HEAD", "POST", "PUT", "DELETE", "TRACE", "CONNECT", "PATCH"};
 
+template <typename T>
+constexpr fxl::TimeDelta URLLoaderImpl::HTTPClient<T>::kStreamStallTimeout;
+
 template <typename T>
 bool URLLoaderImpl::HTTPClient<T>::IsMethodAllowed(const std::string& method) {
   return ALLOWED_METHODS.find(method) != ALLOWED_METHODS.end();
@@ -107,11 +164,11 @@ bool URLLoaderImpl::HTTPClient<T>::IsMethodAllowed(const std::string& method) {
 template <>
 void URLLoaderImpl::HTTPClient<ssl_socket_t>::OnResolve(
     const asio::error_code& err,
-    tcp::resolver::iterator endpoint_iterator);
+    std::shared_ptr<const HostResolverCache::Endpoints> endpoints);
 template <>
 void URLLoaderImpl::HTTPClient<nonssl_socket_t>::OnResolve(
     const asio::error_code& err,
-    tcp::resolver::iterator endpoint_iterator);
+    std::shared_ptr<const HostResolverCache::Endpoints> endpoints);
 template <>
 void URLLoaderImpl::HTTPClient<ssl_socket_t>::OnConnect(
     const asio::error_code& err);
@@ -150,13 +207,12 @@ zx_status_t URLLoaderImpl::HTTPClient<T>::CreateRequest(
     return ZX_ERR_INVALID_ARGS;
   }
 
-  std::ostream request_header_stream(&request_header_buf_);
+  method_ = method;
+  std::ostringstream request_header_stream;
 
   bool has_accept = false;
   request_header_stream << method << " " << path << " HTTP/1.1\r\n";
   request_header_stream << "Host: " << server << "\r\n";
-  // TODO(toshik): should we make this work without closing the connection?
-  request_header_stream << "Connection: close\r\n";
 
   for (auto it = extra_headers.begin(); it != extra_headers.end(); ++it) {
     request_header_stream << it->first << ": " << it->second << "\r\n";
@@ -166,6 +222,9 @@ zx_status_t URLLoaderImpl::HTTPClient<T>::CreateRequest(
   if (!has_accept)
     request_header_stream << "Accept: */*\r\n";
 
+  // TLS connections are not pooled; see ConnectionPool.
+  reusable_ = !std::is_same<T, ssl_socket_t>::value;
+
   request_body_reader_ = std::move(request_body_reader);
   if (request_body_reader_) {
     size_t content_length = request_body_reader_->size();
@@ -174,10 +233,18 @@ zx_status_t URLLoaderImpl::HTTPClient<T>::CreateRequest(
     }
     if (content_length != UploadElementReader::kUnknownSize) {
       request_header_stream << "Content-Length: " << content_length << "\r\n";
+    } else {
+      // The server can only find the end of the body when the connection is
+      // closed.
+      reusable_ = false;
     }
   }
 
+  if (!reusable_)
+    request_header_stream << "Connection: close\r\n";
+
   request_header_stream << "\r\n";
+  request_header_ = request_header_stream.str();
 
   return ZX_OK;
 }
@@ -185,16 +252,109 @@ zx_status_t URLLoaderImpl::HTTPClient<T>::CreateRequest(
 template <typename T>
 void URLLoaderImpl::HTTPClient<T>::Start(const std::string& server,
                                          const std::string& port) {
-  tcp::resolver::query query(server, port);
-  resolver_.async_resolve(
-      query, std::bind(&HTTPClient<T>::OnResolve, this, std::placeholders::_1,
-                       std::placeholders::_2));
+  server_ = server;
+  port_ = port;
+  origin_ = (std::is_same<T, ssl_socket_t>::value ? "https://" : "http://") +
+            server + ":" + port;
+
+  if (TakeIdleConnection()) {
+    reused_connection_ = true;
+    WriteRequestHeaders();
+    return;
+  }
+  Resolve();
+}
+
+template <typename T>
+bool URLLoaderImpl::HTTPClient<T>::TakeIdleConnection() {
+  if (!reusable_)
+    return false;
+
+  fxl::UniqueFD fd = loader_->connection_pool_->TakeConnection(origin_);
+  if (!fd.is_valid())
+    return false;
+
+  struct sockaddr_storage addr;
+  socklen_t addr_len = sizeof(addr);
+  if (getsockname(fd.get(), reinterpret_cast<struct sockaddr*>(&addr),
+                  &addr_len) != 0)
+    return false;
+
+  asio::error_code err;
+  socket_.lowest_layer().assign(
+      addr.ss_family == AF_INET6 ? tcp::v6() : tcp::v4(), fd.get(), err);
+  if (err) {
+    FXL_VLOG(1) << "TakeIdleConnection: " << err.message();
+    return false;
+  }
+  fd.release();
+  return true;
+}
+
+// The server may close an idle connection just as it is reused. Requests
+// without a body, which can be sent again, are then retried once on a new
+// connection.
+template <typename T>
+bool URLLoaderImpl::HTTPClient<T>::RetryOnNewConnection() {
+  if (!reused_connection_ || request_body_reader_ || response_buf_.size() > 0)
+    return false;
+
+  FXL_VLOG(1) << "Idle connection to " << origin_ << " was closed, retrying";
+  reused_connection_ = false;
+  asio::error_code err;
+  socket_.lowest_layer().close(err);
+  Resolve();
+  return true;
+}
+
+template <typename T>
+void URLLoaderImpl::HTTPClient<T>::ReleaseConnection() {
+  if (!body_decoder_.CanReuseConnection(response_buf_.size()))
+    return;
+
+  // The socket belongs to this request's io_service, so the pool keeps a
+  // duplicate of its descriptor instead.
+  fxl::UniqueFD fd(dup(socket_.lowest_layer().native_handle()));
+  asio::error_code err;
+  socket_.lowest_layer().close(err);
+  loader_->connection_pool_->ReturnConnection(origin_, std::move(fd));
+}
+
+template <typename T>
+void URLLoaderImpl::HTTPClient<T>::Resolve() {
+  // The lookup may be done by another request, on another thread, so keep
+  // this request's io_service running until its result is posted back.
+  asio::io_service& io_service = resolver_.get_io_service();
+  resolve_work_ = std::make_unique<asio::io_service::work>(io_service);
+
+  loader_->host_resolver_cache_->Resolve(
+      server_, port_,
+      [this](HostResolverCache::ResolveCallback callback) {
+        tcp::resolver::query query(server_, port_);
+        resolver_.async_resolve(
+            query, [callback](const asio::error_code& err,
+                              tcp::resolver::iterator it) {
+              auto endpoints =
+                  std::make_shared<HostResolverCache::Endpoints>();
+              for (; it != tcp::resolver::iterator(); ++it)
+                endpoints->push_back(*it);
+              callback(err, std::move(endpoints));
+            });
+      },
+      [this, &io_service](
+          const asio::error_code& err,
+          std::shared_ptr<const HostResolverCache::Endpoints> endpoints) {
+        io_service.post([this, err, endpoints] {
+          resolve_work_.reset();
+          OnResolve(err, endpoints);
+        });
+      });
 }
 
 template <>
 void URLLoaderImpl::HTTPClient<ssl_socket_t>::OnResolve(
     const asio::error_code& err,
-    tcp::resolver::iterator endpoint_iterator) {
+    std::shared_ptr<const HostResolverCache::Endpoints> endpoints) {
   if (!err) {
 #ifdef NETWORK_SERVICE_DISABLE_CERT_VERIFY
     socket_.set_verify_mode(asio::ssl::verify_none);
@@ -204,7 +364,13 @@ void URLLoaderImpl::HTTPClient<ssl_socket_t>::OnResolve(
     socket_.set_verify_callback(
         std::bind(&HTTPClient<ssl_socket_t>::OnVerifyCertificate, this,
                   std::placeholders::_1, std::placeholders::_2));
-    asio::async_connect(socket_.lowest_layer(), endpoint_iterator,
+    bssl::UniquePtr<SSL_SESSION> session =
+        loader_->connection_pool_->GetSession(origin_);
+    if (session)
+      SSL_set_session(socket_.native_handle(), session.get());
+    endpoints_ = std::move(endpoints);
+    asio::async_connect(socket_.lowest_layer(), endpoints_->begin(),
+                        endpoints_->end(),
                         std::bind(&HTTPClient<ssl_socket_t>::OnConnect, this,
                                   std::placeholders::_1));
   } else {
@@ -216,9 +382,10 @@ void URLLoaderImpl::HTTPClient<ssl_socket_t>::OnResolve(
 template <>
 void URLLoaderImpl::HTTPClient<nonssl_socket_t>::OnResolve(
     const asio::error_code& err,
-    tcp::resolver::iterator endpoint_iterator) {
+    std::shared_ptr<const HostResolverCache::Endpoints> endpoints) {
   if (!err) {
-    asio::async_connect(socket_, endpoint_iterator,
+    endpoints_ = std::move(endpoints);
+    asio::async_connect(socket_, endpoints_->begin(), endpoints_->end(),
                         std::bind(&HTTPClient<nonssl_socket_t>::OnConnect, this,
                                   std::placeholders::_1));
   } else {
@@ -260,10 +427,7 @@ template <>
 void URLLoaderImpl::HTTPClient<nonssl_socket_t>::OnConnect(
     const asio::error_code& err) {
   if (!err) {
-    asio::async_write(
-        socket_, request_header_buf_,
-        std::bind(&HTTPClient<nonssl_socket_t>::OnWriteRequestHeaders, this,
-                  std::placeholders::_1, std::placeholders::_2));
+    WriteRequestHeaders();
   } else {
     FXL_VLOG(1) << "Connect(NonSSL): " << err.message();
     SendError(network::NETWORK_ERR_CONNECTION_FAILED);
@@ -273,15 +437,26 @@ void URLLoaderImpl::HTTPClient<nonssl_socket_t>::OnConnect(
 template <typename T>
 void URLLoaderImpl::HTTPClient<T>::OnHandShake(const asio::error_code& err) {
   if (!err) {
-    asio::async_write(socket_, request_header_buf_,
-                      std::bind(&HTTPClient<T>::OnWriteRequestHeaders, this,
-                                std::placeholders::_1, std::placeholders::_2));
+    bssl::UniquePtr<SSL_SESSION> session(
+        SSL_get1_session(socket_.native_handle()));
+    loader_->connection_pool_->SetSession(origin_, std::move(session));
+    WriteRequestHeaders();
   } else {
     FXL_VLOG(1) << "HandShake: " << err.message();
     SendError(network::NETWORK_ERR_SSL_HANDSHAKE_NOT_COMPLETED);
   }
 }
 
+template <typename T>
+void URLLoaderImpl::HTTPClient<T>::WriteRequestHeaders() {
+  request_header_buf_.consume(request_header_buf_.size());
+  std::ostream request_header_stream(&request_header_buf_);
+  request_header_stream << request_header_;
+  asio::async_write(socket_, request_header_buf_,
+                    std::bind(&HTTPClient<T>::OnWriteRequestHeaders, this,
+                              std::placeholders::_1, std::placeholders::_2));
+}
+
 template <typename T>
 void URLLoaderImpl::HTTPClient<T>::OnWriteRequestHeaders(
     const asio::error_code& err,
@@ -297,7 +472,7 @@ void URLLoaderImpl::HTTPClient<T>::OnWriteRequestHeaders(
     } else {
       WriteRequestBody();
     }
-  } else {
+  } else if (!RetryOnNewConnection()) {
     FXL_VLOG(1) << "WriteRequestHeaders: " << err.message();
     // TODO(toshik): better error code?
     SendError(network::NETWORK_ERR_FAILED);
@@ -357,95 +532,134 @@ void URLLoaderImpl::HTTPClient<T>::OnReadStatusLine(
     asio::async_read_until(
         socket_, response_buf_, "\r\n\r\n",
         std::bind(&HTTPClient<T>::OnReadHeaders, this, std::placeholders::_1));
-  } else {
+  } else if (!RetryOnNewConnection()) {
     FXL_VLOG(1) << "ReadStatusLine: " << err.message();
   }
 }
 
 template <typename T>
-zx_status_t URLLoaderImpl::HTTPClient<T>::SendStreamedBody() {
-  size_t size = response_buf_.size();
+zx_status_t URLLoaderImpl::HTTPClient<T>::SendBody(const char* data,
+                                                   size_t size) {
+  if (store_response_ && status_code_ == 200) {
+    if (response_to_store_.body.size() + size >
+        loader_->http_cache_->max_entry_size()) {
+      // Too large to be stored, which leaves any response stored before out
+      // of date.
+      store_response_ = false;
+      response_to_store_ = HttpCache::Response();
+      loader_->http_cache_->Remove(loader_->current_url_.spec());
+    } else {
+      response_to_store_.body.append(data, size);
+    }
+  }
 
-  if (size > 0) {
-    std::istream response_stream(&response_buf_);
-    size_t done = 0;
-    do {
-      TransferBuffer buffer;
-      size_t todo = std::min(sizeof(buffer), size - done);
-      FXL_DCHECK(todo > 0);
-      response_stream.read(buffer, todo);
-      size_t written;
-      zx_status_t result =
-          response_body_stream_.write(0, buffer, todo, &written);
-      if (result == ZX_ERR_SHOULD_WAIT) {
-        result = response_body_stream_.wait_one(
-            ZX_SOCKET_WRITABLE | ZX_SOCKET_PEER_CLOSED, ZX_TIME_INFINITE,
-            nullptr);
-        if (result == ZX_OK)
-          continue;  // retry now that the socket is ready
-      }
-      if (result != ZX_OK) {
-        // If the other end closes the socket, ZX_ERR_PEER_CLOSED
-        // can happen.
-        if (result != ZX_ERR_PEER_CLOSED)
-          FXL_VLOG(1) << "SendStreamedBody: result=" << result;
-        return result;
-      }
-      done += written;
-    } while (done < size);
+  switch (loader_->response_body_mode_) {
+    case URLRequest::ResponseBodyMode::BUFFER:
+    case URLRequest::ResponseBodyMode::SIZED_BUFFER:
+      return SendBufferedBody(data, size);
+    case URLRequest::ResponseBodyMode::STREAM:
+    case URLRequest::ResponseBodyMode::BUFFER_OR_STREAM:
+      return SendStreamedBody(data, size);
+  }
+  return ZX_ERR_INTERNAL;
+}
+
+template <typename T>
+zx_status_t URLLoaderImpl::HTTPClient<T>::SendStreamedBody(const char* data,
+                                                           size_t size) {
+  zx_status_t result = WriteToStream(response_body_stream_,
+                                     fxl::StringView(data, size),
+                                     kStreamStallTimeout);
+  if (result == ZX_ERR_TIMED_OUT) {
+    FXL_LOG(WARNING) << "Abandoning " << loader_->current_url_.spec()
+                     << ": the response body is not being read";
+  } else if (result != ZX_OK && result != ZX_ERR_PEER_CLOSED) {
+    // The other end closing the socket is expected.
+    FXL_VLOG(1) << "SendStreamedBody: result=" << result;
   }
+  return result;
+}
+
+// Makes room for |capacity| bytes of body in |response_body_vmo_|. Pages are
+// only committed as they are written, so growing the VMO ahead of the body
+// costs nothing.
+template <typename T>
+zx_status_t URLLoaderImpl::HTTPClient<T>::ReserveBufferedBody(
+    uint64_t capacity) {
+  if (capacity <= response_body_capacity_)
+    return ZX_OK;
+
+  zx_status_t result = response_body_vmo_
+                           ? response_body_vmo_.set_size(capacity)
+                           : zx::vmo::create(capacity, 0u, &response_body_vmo_);
+  if (result != ZX_OK) {
+    FXL_VLOG(1) << "ReserveBufferedBody: Unable to size vmo: " << result;
+    return result;
+  }
+  response_body_capacity_ = capacity;
   return ZX_OK;
 }
 
 template <typename T>
-zx_status_t URLLoaderImpl::HTTPClient<T>::SendBufferedBody() {
-  size_t size = response_buf_.size();
+zx_status_t URLLoaderImpl::HTTPClient<T>::SendBufferedBody(const char* data,
+                                                           size_t size) {
+  if (size == 0)
+    return ZX_OK;
+
+  zx_status_t result = ReserveBufferedBody(std::max<uint64_t>(
+      response_body_size_ + size, 2 * response_body_capacity_));
+  if (result != ZX_OK)
+    return result;
+
+  size_t written;
+  result = response_body_vmo_.write(data, response_body_size_, size, &written);
+  if (result != ZX_OK) {
+    FXL_VLOG(1) << "SendBufferedBody: result=" << result;
+    return result;
+  }
+  if (written < size) {
+    FXL_VLOG(1) << "zx::vmo::write wrote " << written << " bytes instead of "
+                << size << " bytes.";
+    return ZX_ERR_IO;
+  }
+  response_body_size_ += size;
+  return ZX_OK;
+}
+
+template <typename T>
+zx_status_t URLLoaderImpl::HTTPClient<T>::FinishBufferedBody() {
+  if (!response_body_vmo_)
+    return ZX_OK;
 
-  if (size > 0) {
-    // TODO(rosswang): For now, wait until we have the entire body to begin
-    // writing to the VMO so that we know the size. Eventually to support larger
-    // VMOs without burdening the memory unduly, perhaps we'll want to create
-    // the VMO earlier and resize it as we buffer more to take advantage of
-    // VMO virtualization.
-    zx::vmo vmo;
-    zx_status_t result = zx::vmo::create(size, 0u, &vmo);
+  if (response_body_capacity_ != response_body_size_) {
+    zx_status_t result = response_body_vmo_.set_size(response_body_size_);
     if (result != ZX_OK) {
-      FXL_VLOG(1) << "SendBufferedBody: Unable to create vmo: " << result;
+      FXL_VLOG(1) << "FinishBufferedBody: Unable to size vmo: " << result;
       return result;
     }
+  }
 
-    std::istream response_stream(&response_buf_);
-    size_t done = 0;
-    do {
-      TransferBuffer buffer;
-      size_t todo = std::min(sizeof(buffer), size - done);
-      FXL_DCHECK(todo > 0);
-      response_stream.read(buffer, todo);
-      size_t written;
-      result = vmo.write(buffer, done, todo, &written);
-      if (result != ZX_OK) {
-        FXL_VLOG(1) << "SendBufferedBody: result=" << result;
-        return result;
-      }
-      if (written < todo) {
-        FXL_VLOG(1) << "zx::vmo::write wrote " << written
-                    << " bytes instead of " << todo << " bytes.";
-      }
-
-      done += written;
-    } while (done < size);
-
-    if (loader_->response_body_mode_ == URLRequest::ResponseBodyMode::BUFFER) {
-    response_->body->set_buffer(std::move(vmo));
-    } else {
-      FXL_DCHECK(loader_->response_body_mode_ == URLRequest::ResponseBodyMode::SIZED_BUFFER);
-      response_->body->set_sized_buffer(
-          fsl::SizedVmo(std::move(vmo), size).ToTransport());
-    }
+  if (loader_->response_body_mode_ == URLRequest::ResponseBodyMode::BUFFER) {
+    response_->body->set_buffer(std::move(response_body_vmo_));
+  } else {
+    FXL_DCHECK(loader_->response_body_mode_ ==
+               URLRequest::ResponseBodyMode::SIZED_BUFFER);
+    response_->body->set_sized_buffer(
+        fsl::SizedVmo(std::move(response_body_vmo_), response_body_size_)
+            .ToTransport());
   }
   return ZX_OK;
 }
 
+template <typename T>
+void URLLoaderImpl::HTTPClient<T>::StoreResponse() {
+  if (!store_response_)
+    return;
+  store_response_ = false;
+  loader_->http_cache_->Store(loader_->current_url_.spec(), response_to_store_,
+                              loader_->request_time_);
+}
+
 template <typename T>
 void URLLoaderImpl::HTTPClient<T>::ParseHeaderField(const std::string& header,
                                                     std::string* name,
@@ -491,21 +705,54 @@ void URLLoaderImpl::HTTPClient<T>::OnReadHeaders(const asio::error_code& err) {
         HttpHeaderPtr hdr = HttpHeader::New();
         std::string name, value;
         ParseHeaderField(header, &name, &value);
+        body_decoder_.AddHeader(name, value);
+        if (loader_->use_cache_)
+          response_to_store_.headers.emplace_back(name, value);
         hdr->name = name;
         hdr->value = value;
         response->headers.push_back(std::move(hdr));
       }
 
+      body_decoder_.EndHeaders(method_, status_code_, http_version_,
+                               reusable_);
+
+      if (status_code_ == 304 && loader_->cache_entry_) {
+        // The stored response is still good, and is sent instead.
+        ReleaseConnection();
+        std::unique_ptr<HttpCache::Response> updated =
+            loader_->http_cache_->Update(loader_->current_url_.spec(),
+                                         response_to_store_.headers,
+                                         loader_->request_time_);
+        loader_->SendCachedResponse(
+            updated ? *updated : loader_->cache_entry_->response);
+        return;
+      }
+      if (loader_->use_cache_) {
+        if (body_decoder_.framing() ==
+            ResponseBodyDecoder::Framing::kUntilClose) {
+          // A body cut short by the connection closing cannot be told from
+          // a complete one, so it is not stored.
+          loader_->http_cache_->Remove(loader_->current_url_.spec());
+        } else {
+          store_response_ = true;
+          response_to_store_.status_code = status_code_;
+          response_to_store_.status_line = response->status_line;
+        }
+      }
+
       response->body = network::URLBody::New();
 
       switch (loader_->response_body_mode_) {
         case URLRequest::ResponseBodyMode::BUFFER:
         case URLRequest::ResponseBodyMode::SIZED_BUFFER:
           response_ = std::move(response);
-
-          asio::async_read(socket_, response_buf_,
-                           std::bind(&HTTPClient<T>::OnBufferBody, this,
-                                     std::placeholders::_1));
+          if (body_decoder_.framing() ==
+                  ResponseBodyDecoder::Framing::kContentLength &&
+              ReserveBufferedBody(body_decoder_.content_length()) != ZX_OK) {
+            SendError(network::NETWORK_ERR_FAILED);
+            return;
+          }
+          ContinueBufferBody();
           break;
         case URLRequest::ResponseBodyMode::STREAM:
         case URLRequest::ResponseBodyMode::BUFFER_OR_STREAM:
@@ -521,15 +768,7 @@ void URLLoaderImpl::HTTPClient<T>::OnReadHeaders(const asio::error_code& err) {
           response->body->set_stream(std::move(consumer));
 
           loader_->SendResponse(std::move(response));
-
-          if (SendStreamedBody() != ZX_OK) {
-            response_body_stream_.reset();
-            return;
-          }
-
-          asio::async_read(socket_, response_buf_, asio::transfer_at_least(1),
-                           std::bind(&HTTPClient<T>::OnStreamBody, this,
-                                     std::placeholders::_1));
+          ContinueStreamBody();
           break;
       }
     }
@@ -538,28 +777,93 @@ void URLLoaderImpl::HTTPClient<T>::OnReadHeaders(const asio::error_code& err) {
   }
 }
 
+// Sends the body received so far from |response_buf_|, leaving anything that
+// follows the body in |response_buf_|. Returns ZX_ERR_IO_DATA_INTEGRITY if
+// the body is malformed.
+template <typename T>
+zx_status_t URLLoaderImpl::HTTPClient<T>::ConsumeBody() {
+  fxl::StringView data(asio::buffer_cast<const char*>(response_buf_.data()),
+                       response_buf_.size());
+  size_t consumed = 0;
+  zx_status_t result = body_decoder_.Consume(
+      data,
+      [this](const char* body, size_t size) { return SendBody(body, size); },
+      &consumed);
+  response_buf_.consume(consumed);
+  return result;
+}
+
 template <typename T>
-void URLLoaderImpl::HTTPClient<T>::OnBufferBody(const asio::error_code& err) {
-  if (err && err != asio::ssl::error::stream_truncated) {
+void URLLoaderImpl::HTTPClient<T>::ContinueBufferBody() {
+  zx_status_t result = ConsumeBody();
+  if (result == ZX_OK && body_decoder_.complete())
+    result = FinishBufferedBody();
+  if (result != ZX_OK) {
+    SendError(result == ZX_ERR_IO_DATA_INTEGRITY
+                  ? network::NETWORK_ERR_INVALID_CHUNKED_ENCODING
+                  : network::NETWORK_ERR_FAILED);
+    return;
+  }
+  if (body_decoder_.complete()) {
+    ReleaseConnection();
+    StoreResponse();
+    loader_->SendResponse(std::move(response_));
+    return;
+  }
+  socket_.async_read_some(
+      response_buf_.prepare(kBodyReadSize),
+      std::bind(&HTTPClient<T>::OnBufferBody, this, std::placeholders::_1,
+                std::placeholders::_2));
+}
+
+template <typename T>
+void URLLoaderImpl::HTTPClient<T>::OnBufferBody(const asio::error_code& err,
+                                                std::size_t transferred) {
+  response_buf_.commit(transferred);
+  if (err &&
+      body_decoder_.framing() == ResponseBodyDecoder::Framing::kUntilClose &&
+      (err == asio::error::eof || err == asio::ssl::error::stream_truncated)) {
+    body_decoder_.OnConnectionClosed();
+    ContinueBufferBody();
+  } else if (err) {
     FXL_VLOG(1) << "OnBufferBody: " << err.message() << " (" << err << ")";
     // TODO(somebody who knows asio/network errors): real translation
     SendError(network::NETWORK_ERR_FAILED);
   } else {
-    SendBufferedBody();
-    loader_->SendResponse(std::move(response_));
+    ContinueBufferBody();
   }
 }
 
 template <typename T>
-void URLLoaderImpl::HTTPClient<T>::OnStreamBody(const asio::error_code& err) {
-  if (!err && SendStreamedBody() == ZX_OK) {
-    asio::async_read(
-        socket_, response_buf_, asio::transfer_at_least(1),
-        std::bind(&HTTPClient<T>::OnStreamBody, this, std::placeholders::_1));
+void URLLoaderImpl::HTTPClient<T>::ContinueStreamBody() {
+  if (ConsumeBody() != ZX_OK) {
+    response_body_stream_.reset();
+    return;
+  }
+  if (body_decoder_.complete()) {
+    response_body_stream_.reset();
+    ReleaseConnection();
+    StoreResponse();
+    return;
+  }
+  socket_.async_read_some(
+      response_buf_.prepare(kBodyReadSize),
+      std::bind(&HTTPClient<T>::OnStreamBody, this, std::placeholders::_1,
+                std::placeholders::_2));
+}
+
+template <typename T>
+void URLLoaderImpl::HTTPClient<T>::OnStreamBody(const asio::error_code& err,
+                                                std::size_t transferred) {
+  response_buf_.commit(transferred);
+  if (!err) {
+    ContinueStreamBody();
   } else {
     // EOF is handled here.
     // TODO(toshik): print the error code if it is unexpected.
     // FXL_VLOG(1) << "OnStreamBody: " << err.message();
+    if (body_decoder_.framing() == ResponseBodyDecoder::Framing::kUntilClose)
+      ConsumeBody();
     response_body_stream_.reset();
   }
 }
@@ -4,6 +4,7 @@
 
 #include "network_service_impl.h"
 
+#include <unordered_set>
 #include <utility>
 #include <fdio/limits.h>
 
@@ -13,7 +14,6 @@
 #include "garnet/bin/network/url_loader_impl.h"
 #include "lib/fxl/logging.h"
 #include "lib/fxl/memory/ref_ptr.h"
-#include "lib/fxl/memory/weak_ptr.h"
 #include "lib/fsl/tasks/message_loop.h"
 #include "lib/fsl/threading/thread.h"
 
@@ -27,22 +27,33 @@ constexpr size_t kNumFDPerConnection = 3;
 constexpr size_t kNumFDReserved = 3;
 // This is some random margin.
 constexpr size_t kMargin = 4;
-// Maximum number of slots used to run network requests concurrently.
-constexpr size_t kMaxSlots = ((FDIO_MAX_FD - kNumFDReserved) / kNumFDPerConnection) - kMargin;
+// Maximum number of slots used to run network requests concurrently. Idle
+// connections kept by the connection pool hold a file descriptor each, and
+// so are left out of the slots.
+constexpr size_t kMaxSlots =
+    ((FDIO_MAX_FD - kNumFDReserved - ConnectionPool::kMaxIdleConnections) /
+     kNumFDPerConnection) -
+    kMargin;
+
+// Where responses are cached across restarts.
+constexpr char kHttpCachePath[] = "/data/network/http_cache";
 
 // Container for the url loader implementation. The loader is run on his own
 // thread.
 class NetworkServiceImpl::UrlLoaderContainer
     : public URLLoaderImpl::Coordinator {
  public:
-  UrlLoaderContainer(URLLoaderImpl::Coordinator* top_coordinator,
+  UrlLoaderContainer(RequestScheduler* request_scheduler,
+                     ConnectionPool* connection_pool,
+                     HostResolverCache* host_resolver_cache,
+                     HttpCache* http_cache,
                      fidl::InterfaceRequest<URLLoader> request)
       : request_(std::move(request)),
-        top_coordinator_(top_coordinator),
-        main_task_runner_(fsl::MessageLoop::GetCurrent()->task_runner()),
-        weak_ptr_factory_(this) {
-    weak_ptr_ = weak_ptr_factory_.GetWeakPtr();
-  }
+        request_scheduler_(request_scheduler),
+        connection_pool_(connection_pool),
+        host_resolver_cache_(host_resolver_cache),
+        http_cache_(http_cache),
+        main_task_runner_(fsl::MessageLoop::GetCurrent()->task_runner()) {}
 
   ~UrlLoaderContainer() { Stop(); }
 
@@ -58,41 +69,22 @@ class NetworkServiceImpl::UrlLoaderContainer
  private:
   // URLLoaderImpl::Coordinator:
   void RequestNetworkSlot(
+      URLRequest::Priority priority,
+      const std::string& origin,
       std::function<void(fxl::Closure)> slot_request) override {
-    // On IO Thread.
-    main_task_runner_->PostTask(
-        [ weak_this = weak_ptr_, slot_request = std::move(slot_request) ] {
-          // On Main Thread.
-          if (!weak_this)
-            return;
-
-          weak_this->top_coordinator_->RequestNetworkSlot([
-            weak_this, slot_request = std::move(slot_request)
-          ](fxl::Closure on_inactive) {
-            if (!weak_this) {
-              on_inactive();
-              return;
-            }
-            weak_this->on_inactive_ = std::move(on_inactive);
-            weak_this->io_task_runner_->PostTask([
-              weak_this, main_task_runner = weak_this->main_task_runner_,
-              slot_request = std::move(slot_request)
-            ] {
-              // On IO Thread.
-              slot_request([weak_this, main_task_runner]() {
-                main_task_runner->PostTask([weak_this]() {
-                  // On Main Thread.
-                  if (!weak_this)
-                    return;
-
-                  auto on_inactive = std::move(weak_this->on_inactive_);
-                  weak_this->on_inactive_ = nullptr;
-                  on_inactive();
-                });
-              });
-            });
+    // On IO Thread. The slot is granted on this thread too, so the request
+    // does not wait on the main thread.
+    RequestScheduler::Ticket ticket = request_scheduler_->RequestSlot(
+        priority, origin, io_task_runner_,
+        [ this, slot_request = std::move(slot_request) ](
+            RequestScheduler::Ticket ticket) {
+          // On IO Thread.
+          slot_request([this, ticket] {
+            tickets_.erase(ticket);
+            request_scheduler_->ReleaseSlot(ticket);
           });
         });
+    tickets_.insert(ticket);
   }
 
   void JoinAndNotify() {
@@ -100,8 +92,11 @@ class NetworkServiceImpl::UrlLoaderContainer
       return;
     joined_ = true;
     thread_.Join();
-    if (on_inactive_)
-      on_inactive_();
+    // The thread is gone, so the slots it still held or waited for can be
+    // returned from here.
+    for (RequestScheduler::Ticket ticket : tickets_)
+      request_scheduler_->ReleaseSlot(ticket);
+    tickets_.clear();
     if (on_done_)
       on_done_();
   }
@@ -114,7 +109,8 @@ class NetworkServiceImpl::UrlLoaderContainer
   }
 
   void StartOnIOThread() {
-    url_loader_ = std::make_unique<URLLoaderImpl>(this);
+    url_loader_ = std::make_unique<URLLoaderImpl>(
+        this, connection_pool_, host_resolver_cache_, http_cache_);
     binding_ = std::make_unique<fidl::Binding<URLLoader>>(url_loader_.get(),
                                                           std::move(request_));
     binding_->set_connection_error_handler([this] { StopOnIOThread(); });
@@ -129,10 +125,17 @@ class NetworkServiceImpl::UrlLoaderContainer
 
   // This is set on the constructor, and then accessed on the io thread.
   fidl::InterfaceRequest<URLLoader> request_;
+  // These outlive the container, and are safe to use on any thread.
+  RequestScheduler* const request_scheduler_;
+  ConnectionPool* const connection_pool_;
+  HostResolverCache* const host_resolver_cache_;
+  HttpCache* const http_cache_;
+
+  // The tickets of the slots requested by the loader. Accessed on the io
+  // thread, and on the main thread once the io thread is joined.
+  std::unordered_set<RequestScheduler::Ticket> tickets_;
 
   // These variables can only be accessed on the main thread.
-  URLLoaderImpl::Coordinator* top_coordinator_;
-  fxl::Closure on_inactive_;
   fxl::Closure on_done_;
   fsl::Thread thread_;
   bool stopped_ = true;
@@ -146,16 +149,11 @@ class NetworkServiceImpl::UrlLoaderContainer
   std::unique_ptr<fidl::Binding<URLLoader>> binding_;
   std::unique_ptr<URLLoaderImpl> url_loader_;
 
-  // Copyable on any thread, but can only be de-referenced on the main thread.
-  fxl::WeakPtr<UrlLoaderContainer> weak_ptr_;
-
-  // The weak ptr factory is only accessed on the main thread.
-  fxl::WeakPtrFactory<UrlLoaderContainer> weak_ptr_factory_;
-
   FXL_DISALLOW_COPY_AND_ASSIGN(UrlLoaderContainer);
 };
 
-NetworkServiceImpl::NetworkServiceImpl() : available_slots_(kMaxSlots) {}
+NetworkServiceImpl::NetworkServiceImpl()
+    : request_scheduler_(kMaxSlots), http_cache_(kHttpCachePath) {}
 
 NetworkServiceImpl::~NetworkServiceImpl() = default;
 
@@ -166,7 +164,9 @@ void NetworkServiceImpl::AddBinding(
 
 void NetworkServiceImpl::CreateURLLoader(
     fidl::InterfaceRequest<URLLoader> request) {
-  loaders_.emplace_back(this, std::move(request));
+  loaders_.emplace_back(&request_scheduler_, &connection_pool_,
+                        &host_resolver_cache_, &http_cache_,
+                        std::move(request));
   UrlLoaderContainer* container = &loaders_.back();
   container->set_on_done([this, container] {
     loaders_.erase(std::find_if(loaders_.begin(), loaders_.end(),
@@ -185,26 +185,4 @@ void NetworkServiceImpl::CreateWebSocket(zx::channel socket) {
   FXL_NOTIMPLEMENTED();
 }
 
-void NetworkServiceImpl::RequestNetworkSlot(
-    std::function<void(fxl::Closure)> slot_request) {
-  if (available_slots_ == 0) {
-    slot_requests_.push(std::move(slot_request));
-    return;
-  }
-  --available_slots_;
-  slot_request([this]() { OnSlotReturned(); });
-}
-
-void NetworkServiceImpl::OnSlotReturned() {
-  FXL_DCHECK(available_slots_ < kMaxSlots);
-
-  if (slot_requests_.empty()) {
-    ++available_slots_;
-    return;
-  }
-  auto request = std::move(slot_requests_.front());
-  slot_requests_.pop();
-  request([this] { OnSlotReturned(); });
-}
-
 }  // namespace network
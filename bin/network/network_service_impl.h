@@ -8,8 +8,11 @@
 #include "lib/network/fidl/network_service.fidl.h"
 
 #include <list>
-#include <queue>
 
+#include "garnet/bin/network/connection_pool.h"
+#include "garnet/bin/network/host_resolver_cache.h"
+#include "garnet/bin/network/http_cache.h"
+#include "garnet/bin/network/request_scheduler.h"
 #include "garnet/bin/network/url_loader_impl.h"
 #include "lib/fidl/cpp/bindings/binding_set.h"
 #include "lib/fidl/cpp/bindings/interface_request.h"
@@ -17,8 +20,7 @@
 
 namespace network {
 
-class NetworkServiceImpl : public NetworkService,
-                           public URLLoaderImpl::Coordinator {
+class NetworkServiceImpl : public NetworkService {
  public:
   NetworkServiceImpl();
   ~NetworkServiceImpl() override;
@@ -33,16 +35,13 @@ class NetworkServiceImpl : public NetworkService,
  private:
   class UrlLoaderContainer;
 
-  // URLLoaderImpl::Coordinator:
-  void RequestNetworkSlot(
-      std::function<void(fxl::Closure)> slot_request) override;
-
-  void OnSlotReturned();
-
-  size_t available_slots_;
+  // Shared by the loaders' threads.
+  RequestScheduler request_scheduler_;
+  ConnectionPool connection_pool_;
+  HostResolverCache host_resolver_cache_;
+  HttpCache http_cache_;
   fidl::BindingSet<NetworkService> bindings_;
   std::list<UrlLoaderContainer> loaders_;
-  std::queue<std::function<void(fxl::Closure)>> slot_requests_;
 };
 
 }  // namespace network
@@ -0,0 +1,144 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/request_scheduler.h"
+
+#include <algorithm>
+
+#include "lib/fxl/logging.h"
+
+namespace network {
+namespace {
+
+// Indexed by URLRequest::Priority.
+constexpr int64_t kWeights[] = {6, 3, 1};
+// The share of the slots, in percent, that requests of each priority may use.
+constexpr size_t kMaxSharePercent[] = {100, 75, 50};
+
+}  // namespace
+
+constexpr size_t RequestScheduler::kDefaultMaxSlotsPerOrigin;
+constexpr size_t RequestScheduler::kPriorityCount;
+
+RequestScheduler::RequestScheduler(size_t max_slots,
+                                   size_t max_slots_per_origin)
+    : max_slots_(max_slots), max_slots_per_origin_(max_slots_per_origin) {
+  FXL_DCHECK(max_slots_ > 0);
+  FXL_DCHECK(max_slots_per_origin_ > 0);
+}
+
+RequestScheduler::~RequestScheduler() = default;
+
+RequestScheduler::Ticket RequestScheduler::RequestSlot(
+    URLRequest::Priority priority,
+    const std::string& origin,
+    fxl::RefPtr<fxl::TaskRunner> task_runner,
+    GrantCallback on_granted) {
+  size_t index = static_cast<size_t>(priority);
+  if (index >= kPriorityCount) {
+    FXL_LOG(WARNING) << "Unknown request priority " << index
+                     << ", treating it as interactive";
+    index = static_cast<size_t>(URLRequest::Priority::INTERACTIVE);
+  }
+
+  Ticket ticket;
+  std::vector<PendingRequest> granted;
+  {
+    fxl::MutexLocker locker(&mutex_);
+    ticket = next_ticket_++;
+    classes_[index].pending.push_back(
+        {ticket, origin, std::move(task_runner), std::move(on_granted)});
+    GrantSlotsLocked(&granted);
+  }
+
+  PostGrants(std::move(granted));
+  return ticket;
+}
+
+void RequestScheduler::ReleaseSlot(Ticket ticket) {
+  std::vector<PendingRequest> granted;
+  {
+    fxl::MutexLocker locker(&mutex_);
+    auto it = granted_.find(ticket);
+    if (it != granted_.end()) {
+      --active_;
+      --classes_[it->second.first].active;
+      auto origin_it = active_per_origin_.find(it->second.second);
+      if (--origin_it->second == 0)
+        active_per_origin_.erase(origin_it);
+      granted_.erase(it);
+    } else {
+      for (auto& priority_class : classes_) {
+        auto& pending = priority_class.pending;
+        pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                     [ticket](const PendingRequest& request) {
+                                       return request.ticket == ticket;
+                                     }),
+                      pending.end());
+      }
+    }
+    GrantSlotsLocked(&granted);
+  }
+
+  PostGrants(std::move(granted));
+}
+
+void RequestScheduler::GrantSlotsLocked(std::vector<PendingRequest>* granted) {
+  while (active_ < max_slots_) {
+    std::deque<PendingRequest>::iterator runnable[kPriorityCount];
+    size_t best = kPriorityCount;
+    int64_t total_weight = 0;
+    for (size_t i = 0; i < kPriorityCount; ++i) {
+      runnable[i] = FindRunnableLocked(i);
+      if (runnable[i] == classes_[i].pending.end()) {
+        classes_[i].credit = 0;
+        continue;
+      }
+      classes_[i].credit += kWeights[i];
+      total_weight += kWeights[i];
+      if (best == kPriorityCount || classes_[i].credit > classes_[best].credit)
+        best = i;
+    }
+    if (best == kPriorityCount)
+      return;
+
+    PriorityClass& priority_class = classes_[best];
+    priority_class.credit -= total_weight;
+    PendingRequest request = std::move(*runnable[best]);
+    priority_class.pending.erase(runnable[best]);
+
+    ++active_;
+    ++priority_class.active;
+    ++active_per_origin_[request.origin];
+    granted_[request.ticket] = std::make_pair(best, request.origin);
+    granted->push_back(std::move(request));
+  }
+}
+
+void RequestScheduler::PostGrants(std::vector<PendingRequest> granted) {
+  for (auto& request : granted) {
+    request.task_runner->PostTask([
+      on_granted = std::move(request.on_granted), ticket = request.ticket
+    ] { on_granted(ticket); });
+  }
+}
+
+std::deque<RequestScheduler::PendingRequest>::iterator
+RequestScheduler::FindRunnableLocked(size_t priority) {
+  PriorityClass& priority_class = classes_[priority];
+  size_t max_active =
+      std::max<size_t>(1, max_slots_ * kMaxSharePercent[priority] / 100);
+  if (priority_class.active >= max_active)
+    return priority_class.pending.end();
+
+  return std::find_if(priority_class.pending.begin(),
+                      priority_class.pending.end(),
+                      [this](const PendingRequest& request) {
+                        auto it = active_per_origin_.find(request.origin);
+                        return it == active_per_origin_.end() ||
+                               it->second < max_slots_per_origin_;
+                      });
+}
+
+}  // namespace network
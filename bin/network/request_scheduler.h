@@ -0,0 +1,105 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_NETWORK_REQUEST_SCHEDULER_H_
+#define GARNET_BIN_NETWORK_REQUEST_SCHEDULER_H_
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lib/fxl/macros.h"
+#include "lib/fxl/memory/ref_ptr.h"
+#include "lib/fxl/synchronization/mutex.h"
+#include "lib/fxl/synchronization/thread_annotations.h"
+#include "lib/fxl/tasks/task_runner.h"
+#include "lib/network/fidl/url_request.fidl.h"
+
+namespace network {
+
+// Hands out the slots that limit how many requests a network service runs at
+// once. Every method may be called on any thread, so that the loaders, which
+// run on their own threads, get slots without going through the main thread.
+//
+// Waiting requests are granted slots by weighted round robin between their
+// priorities, so that interactive requests go first without starving the
+// others. Background and prefetch requests are also limited to a share of the
+// slots, which leaves room for interactive requests that arrive while bulk
+// requests are running. Requests to an origin that already has
+// |max_slots_per_origin| slots wait, without holding back requests to other
+// origins.
+class RequestScheduler {
+ public:
+  using Ticket = uint64_t;
+  using GrantCallback = std::function<void(Ticket ticket)>;
+
+  static constexpr size_t kDefaultMaxSlotsPerOrigin = 6;
+
+  explicit RequestScheduler(
+      size_t max_slots,
+      size_t max_slots_per_origin = kDefaultMaxSlotsPerOrigin);
+  ~RequestScheduler();
+
+  // Asks for a slot for a request to |origin|. |on_granted| is posted to
+  // |task_runner| once the slot is granted, which may be right away.
+  //
+  // The returned ticket must be passed to ReleaseSlot() once the request is
+  // done, or to give up on the slot before it is granted. A |priority| that is
+  // not one of URLRequest::Priority's values is treated as INTERACTIVE.
+  Ticket RequestSlot(URLRequest::Priority priority,
+                     const std::string& origin,
+                     fxl::RefPtr<fxl::TaskRunner> task_runner,
+                     GrantCallback on_granted);
+
+  // Returns the slot held by |ticket| or withdraws its request.
+  void ReleaseSlot(Ticket ticket);
+
+ private:
+  static constexpr size_t kPriorityCount = 3;
+
+  struct PendingRequest {
+    Ticket ticket;
+    std::string origin;
+    fxl::RefPtr<fxl::TaskRunner> task_runner;
+    GrantCallback on_granted;
+  };
+
+  struct PriorityClass {
+    std::deque<PendingRequest> pending;
+    size_t active = 0;
+    // Credit for smooth weighted round robin.
+    int64_t credit = 0;
+  };
+
+  static void PostGrants(std::vector<PendingRequest> granted);
+  // Moves the requests that can run now to |granted|.
+  void GrantSlotsLocked(std::vector<PendingRequest>* granted)
+      FXL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Returns the first request of |priority| that can run now, or
+  // |pending.end()|.
+  std::deque<PendingRequest>::iterator FindRunnableLocked(size_t priority)
+      FXL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const size_t max_slots_;
+  const size_t max_slots_per_origin_;
+
+  fxl::Mutex mutex_;
+  Ticket next_ticket_ FXL_GUARDED_BY(mutex_) = 1;
+  size_t active_ FXL_GUARDED_BY(mutex_) = 0;
+  PriorityClass classes_[kPriorityCount] FXL_GUARDED_BY(mutex_);
+  // The priority and origin of every granted ticket.
+  std::unordered_map<Ticket, std::pair<size_t, std::string>> granted_
+      FXL_GUARDED_BY(mutex_);
+  std::unordered_map<std::string, size_t> active_per_origin_
+      FXL_GUARDED_BY(mutex_);
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(RequestScheduler);
+};
+
+}  // namespace network
+
+#endif  // GARNET_BIN_NETWORK_REQUEST_SCHEDULER_H_
@@ -0,0 +1,164 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/request_scheduler.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lib/fxl/memory/ref_counted.h"
+
+namespace network {
+namespace {
+
+using Priority = URLRequest::Priority;
+
+// Runs posted tasks when told to.
+class FakeTaskRunner : public fxl::TaskRunner {
+ public:
+  void PostTask(fxl::TaskClosure task) override {
+    tasks_.push_back(std::move(task));
+  }
+  void PostTaskForTime(fxl::TaskClosure task,
+                       fxl::TimePoint target_time) override {
+    tasks_.push_back(std::move(task));
+  }
+  void PostDelayedTask(fxl::TaskClosure task, fxl::TimeDelta delay) override {
+    tasks_.push_back(std::move(task));
+  }
+  bool RunsTasksOnCurrentThread() override { return true; }
+
+  void RunUntilIdle() {
+    while (!tasks_.empty()) {
+      fxl::TaskClosure task = std::move(tasks_.front());
+      tasks_.pop_front();
+      task();
+    }
+  }
+
+ private:
+  std::deque<fxl::TaskClosure> tasks_;
+};
+
+class RequestSchedulerTest : public ::testing::Test {
+ protected:
+  RequestSchedulerTest() : task_runner_(fxl::AdoptRef(new FakeTaskRunner())) {}
+
+  // Asks |scheduler| for a slot, recording the name and ticket of the request
+  // in |started_| and |granted_| once it is granted.
+  RequestScheduler::Ticket Request(RequestScheduler* scheduler,
+                                   Priority priority,
+                                   const std::string& origin,
+                                   const std::string& name) {
+    return scheduler->RequestSlot(
+        priority, origin, task_runner_,
+        [this, name](RequestScheduler::Ticket ticket) {
+          started_.push_back(name);
+          granted_.push_back(ticket);
+        });
+  }
+
+  fxl::RefPtr<FakeTaskRunner> task_runner_;
+  std::vector<std::string> started_;
+  std::vector<RequestScheduler::Ticket> granted_;
+};
+
+TEST_F(RequestSchedulerTest, GrantsUpToMaxSlots) {
+  RequestScheduler scheduler(2);
+  auto a = Request(&scheduler, Priority::INTERACTIVE, "http://a:80", "a");
+  Request(&scheduler, Priority::INTERACTIVE, "http://b:80", "b");
+  Request(&scheduler, Priority::INTERACTIVE, "http://c:80", "c");
+  task_runner_->RunUntilIdle();
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), started_);
+
+  scheduler.ReleaseSlot(a);
+  task_runner_->RunUntilIdle();
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "c"}), started_);
+}
+
+TEST_F(RequestSchedulerTest, WithdrawnRequestIsNotGranted) {
+  RequestScheduler scheduler(1);
+  auto a = Request(&scheduler, Priority::INTERACTIVE, "http://a:80", "a");
+  auto b = Request(&scheduler, Priority::INTERACTIVE, "http://b:80", "b");
+  Request(&scheduler, Priority::INTERACTIVE, "http://c:80", "c");
+  scheduler.ReleaseSlot(b);
+  scheduler.ReleaseSlot(a);
+  task_runner_->RunUntilIdle();
+  EXPECT_EQ((std::vector<std::string>{"a", "c"}), started_);
+}
+
+TEST_F(RequestSchedulerTest, InteractiveGoesFirst) {
+  RequestScheduler scheduler(1);
+  auto first = Request(&scheduler, Priority::INTERACTIVE, "http://a:80", "0");
+  Request(&scheduler, Priority::PREFETCH, "http://a:80", "prefetch");
+  Request(&scheduler, Priority::BACKGROUND, "http://a:80", "background");
+  Request(&scheduler, Priority::INTERACTIVE, "http://a:80", "interactive");
+  scheduler.ReleaseSlot(first);
+  task_runner_->RunUntilIdle();
+  EXPECT_EQ((std::vector<std::string>{"0", "interactive"}), started_);
+}
+
+TEST_F(RequestSchedulerTest, LowerPrioritiesAreNotStarved) {
+  RequestScheduler scheduler(1);
+  for (int i = 0; i < 20; ++i)
+    Request(&scheduler, Priority::INTERACTIVE, "http://a:80", "i");
+  Request(&scheduler, Priority::PREFETCH, "http://a:80", "p");
+
+  for (int i = 0; i < 10; ++i) {
+    task_runner_->RunUntilIdle();
+    scheduler.ReleaseSlot(granted_.back());
+  }
+  task_runner_->RunUntilIdle();
+  EXPECT_NE(started_.end(), std::find(started_.begin(), started_.end(), "p"));
+}
+
+TEST_F(RequestSchedulerTest, PrefetchLeavesRoomForInteractive) {
+  RequestScheduler scheduler(4);
+  for (int i = 0; i < 4; ++i)
+    Request(&scheduler, Priority::PREFETCH, "http://a:80", "prefetch");
+  Request(&scheduler, Priority::INTERACTIVE, "http://b:80", "interactive");
+  task_runner_->RunUntilIdle();
+  EXPECT_EQ(
+      (std::vector<std::string>{"prefetch", "prefetch", "interactive"}),
+      started_);
+}
+
+TEST_F(RequestSchedulerTest, CapsSlotsPerOrigin) {
+  RequestScheduler scheduler(4, 2);
+  auto a1 = Request(&scheduler, Priority::INTERACTIVE, "http://a:80", "a1");
+  Request(&scheduler, Priority::INTERACTIVE, "http://a:80", "a2");
+  Request(&scheduler, Priority::INTERACTIVE, "http://a:80", "a3");
+  Request(&scheduler, Priority::INTERACTIVE, "http://b:80", "b1");
+  task_runner_->RunUntilIdle();
+  EXPECT_EQ((std::vector<std::string>{"a1", "a2", "b1"}), started_);
+
+  scheduler.ReleaseSlot(a1);
+  task_runner_->RunUntilIdle();
+  EXPECT_EQ((std::vector<std::string>{"a1", "a2", "b1", "a3"}), started_);
+}
+
+// Priorities come from clients, so values outside the enum must not index
+// past the scheduler's priority classes.
+TEST_F(RequestSchedulerTest, UnknownPriorityIsInteractive) {
+  RequestScheduler scheduler(1);
+  auto first = Request(&scheduler, Priority::INTERACTIVE, "http://a:80", "0");
+  Request(&scheduler, Priority::PREFETCH, "http://a:80", "prefetch");
+  Request(&scheduler, static_cast<Priority>(1000), "http://a:80", "unknown");
+  task_runner_->RunUntilIdle();
+  scheduler.ReleaseSlot(first);
+  task_runner_->RunUntilIdle();
+  ASSERT_EQ(2u, granted_.size());
+  EXPECT_EQ((std::vector<std::string>{"0", "unknown"}), started_);
+
+  scheduler.ReleaseSlot(granted_[1]);
+  task_runner_->RunUntilIdle();
+  EXPECT_EQ((std::vector<std::string>{"0", "unknown", "prefetch"}), started_);
+}
+
+}  // namespace
+}  // namespace network
@@ -0,0 +1,143 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/response_body_decoder.h"
+
+#include <algorithm>
+
+#include "lib/fxl/strings/ascii.h"
+#include "lib/fxl/strings/string_number_conversions.h"
+
+namespace network {
+
+ResponseBodyDecoder::ResponseBodyDecoder() = default;
+
+ResponseBodyDecoder::~ResponseBodyDecoder() = default;
+
+void ResponseBodyDecoder::AddHeader(const std::string& name,
+                                    const std::string& value) {
+  if (fxl::EqualsCaseInsensitiveASCII(name, "Content-Length")) {
+    has_content_length_ =
+        fxl::StringToNumberWithError(value, &content_length_);
+  } else if (fxl::EqualsCaseInsensitiveASCII(name, "Transfer-Encoding")) {
+    chunked_ = fxl::EqualsCaseInsensitiveASCII(value, "chunked");
+  } else if (fxl::EqualsCaseInsensitiveASCII(name, "Connection")) {
+    connection_close_ = fxl::EqualsCaseInsensitiveASCII(value, "close");
+  }
+}
+
+void ResponseBodyDecoder::EndHeaders(const std::string& method,
+                                     unsigned int status_code,
+                                     const std::string& http_version,
+                                     bool reusable) {
+  keep_alive_ = reusable && http_version == "HTTP/1.1" && !connection_close_;
+  if (method == "HEAD" || status_code == 204 || status_code == 304) {
+    framing_ = Framing::kNone;
+    complete_ = true;
+  } else if (chunked_) {
+    framing_ = Framing::kChunked;
+  } else if (has_content_length_) {
+    framing_ = Framing::kContentLength;
+    remaining_ = content_length_;
+    complete_ = remaining_ == 0;
+  } else {
+    framing_ = Framing::kUntilClose;
+    keep_alive_ = false;
+  }
+}
+
+zx_status_t ResponseBodyDecoder::Consume(fxl::StringView data,
+                                         const Callback& callback,
+                                         size_t* consumed) {
+  *consumed = 0;
+  if (complete_)
+    return ZX_OK;
+
+  size_t size = data.size();
+  switch (framing_) {
+    case Framing::kNone:
+      return ZX_OK;
+    case Framing::kContentLength:
+      size = std::min<uint64_t>(size, remaining_);
+      *consumed = size;
+      remaining_ -= size;
+      complete_ = remaining_ == 0;
+      return callback(data.data(), size);
+    case Framing::kChunked:
+      return ConsumeChunked(data, callback, consumed);
+    case Framing::kUntilClose:
+      *consumed = size;
+      return callback(data.data(), size);
+  }
+  return ZX_ERR_INTERNAL;
+}
+
+void ResponseBodyDecoder::OnConnectionClosed() {
+  if (framing_ == Framing::kUntilClose)
+    complete_ = true;
+}
+
+bool ResponseBodyDecoder::CanReuseConnection(size_t unused_bytes) const {
+  return keep_alive_ && complete_ && unused_bytes == 0;
+}
+
+zx_status_t ResponseBodyDecoder::ConsumeChunked(fxl::StringView data,
+                                                const Callback& callback,
+                                                size_t* consumed) {
+  size_t start = 0;
+  while (!complete_ && start < data.size()) {
+    fxl::StringView rest = data.substr(start);
+    switch (chunk_state_) {
+      case ChunkState::kSize: {
+        size_t line_end = rest.find("\r\n");
+        if (line_end == fxl::StringView::npos)
+          return ZX_OK;
+        // Chunk extensions are ignored.
+        fxl::StringView line = rest.substr(0, line_end);
+        size_t size_end = line.find_first_not_of("0123456789abcdefABCDEF");
+        if (size_end == 0 ||
+            !fxl::StringToNumberWithError(line.substr(0, size_end),
+                                          &remaining_, fxl::Base::k16))
+          return ZX_ERR_IO_DATA_INTEGRITY;
+        start += line_end + 2;
+        chunk_state_ =
+            remaining_ > 0 ? ChunkState::kData : ChunkState::kTrailer;
+        break;
+      }
+      case ChunkState::kData: {
+        size_t size = std::min<uint64_t>(rest.size(), remaining_);
+        start += size;
+        *consumed = start;
+        remaining_ -= size;
+        if (remaining_ == 0)
+          chunk_state_ = ChunkState::kDataEnd;
+        zx_status_t result = callback(rest.data(), size);
+        if (result != ZX_OK)
+          return result;
+        break;
+      }
+      case ChunkState::kDataEnd:
+        if (rest.size() < 2)
+          return ZX_OK;
+        if (rest.substr(0, 2) != "\r\n")
+          return ZX_ERR_IO_DATA_INTEGRITY;
+        start += 2;
+        chunk_state_ = ChunkState::kSize;
+        break;
+      case ChunkState::kTrailer: {
+        // Trailer fields are ignored, up to the empty line that ends them.
+        size_t line_end = rest.find("\r\n");
+        if (line_end == fxl::StringView::npos)
+          return ZX_OK;
+        start += line_end + 2;
+        complete_ = line_end == 0;
+        break;
+      }
+    }
+    *consumed = start;
+  }
+  return ZX_OK;
+}
+
+}  // namespace network
@@ -0,0 +1,105 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_NETWORK_RESPONSE_BODY_DECODER_H_
+#define GARNET_BIN_NETWORK_RESPONSE_BODY_DECODER_H_
+
+#include <zircon/types.h>
+
+#include <functional>
+#include <string>
+
+#include "lib/fxl/macros.h"
+#include "lib/fxl/strings/string_view.h"
+
+namespace network {
+
+// Finds the end of an HTTP/1.x response body, undoing the chunked transfer
+// coding, and tells whether the connection the response was read from can
+// carry another request.
+//
+// The header fields of the response are passed to AddHeader(), then
+// EndHeaders() picks how the body is framed. The body is then passed to
+// Consume() as it arrives, until complete().
+class ResponseBodyDecoder {
+ public:
+  // How the end of the body is found.
+  enum class Framing {
+    kNone,
+    kContentLength,
+    kChunked,
+    kUntilClose,
+  };
+
+  // Receives the decoded body. Decoding stops at a status other than ZX_OK,
+  // which Consume() returns.
+  using Callback = std::function<zx_status_t(const char* data, size_t size)>;
+
+  ResponseBodyDecoder();
+  ~ResponseBodyDecoder();
+
+  // Notes the response header field |name| if it frames the body or
+  // controls the connection.
+  void AddHeader(const std::string& name, const std::string& value);
+
+  // Picks the framing of the body of a response to |method|, once all its
+  // header fields have been added. |reusable| is whether the request allows
+  // its connection to be kept.
+  void EndHeaders(const std::string& method,
+                  unsigned int status_code,
+                  const std::string& http_version,
+                  bool reusable);
+
+  // Decodes the body at the start of |data|, passing its contents to
+  // |callback|, and sets |consumed| to the number of bytes of |data| used.
+  // The rest either follows the body, or is the start of a chunk size or
+  // trailer line to be passed again once more has arrived. Returns
+  // ZX_ERR_IO_DATA_INTEGRITY if the chunked coding is malformed.
+  zx_status_t Consume(fxl::StringView data,
+                      const Callback& callback,
+                      size_t* consumed);
+
+  // Ends a body framed by the connection closing.
+  void OnConnectionClosed();
+
+  // Whether the connection can carry another request, given the number of
+  // bytes read from it that Consume() did not use. Anything sent after the
+  // body leaves the connection in an unknown state.
+  bool CanReuseConnection(size_t unused_bytes) const;
+
+  Framing framing() const { return framing_; }
+  // The Content-Length of the response, if it has one.
+  uint64_t content_length() const { return content_length_; }
+  bool complete() const { return complete_; }
+
+ private:
+  enum class ChunkState {
+    kSize,
+    kData,
+    kDataEnd,
+    kTrailer,
+  };
+
+  zx_status_t ConsumeChunked(fxl::StringView data,
+                             const Callback& callback,
+                             size_t* consumed);
+
+  bool has_content_length_ = false;
+  bool chunked_ = false;
+  bool connection_close_ = false;
+  uint64_t content_length_ = 0;
+
+  Framing framing_ = Framing::kNone;
+  ChunkState chunk_state_ = ChunkState::kSize;
+  // Bytes left in the body or in the current chunk.
+  uint64_t remaining_ = 0;
+  bool complete_ = false;
+  bool keep_alive_ = false;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(ResponseBodyDecoder);
+};
+
+}  // namespace network
+
+#endif  // GARNET_BIN_NETWORK_RESPONSE_BODY_DECODER_H_
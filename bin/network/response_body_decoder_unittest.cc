@@ -0,0 +1,323 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/response_body_decoder.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace network {
+namespace {
+
+using Framing = ResponseBodyDecoder::Framing;
+
+constexpr char kChunkedBody[] = "5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n";
+
+void StartChunked(ResponseBodyDecoder* decoder) {
+  decoder->AddHeader("Transfer-Encoding", "chunked");
+  decoder->EndHeaders("GET", 200, "HTTP/1.1", true);
+}
+
+// Passes |reads| to |decoder| in turn, as they would arrive from the
+// network, keeping what it does not consume in front of the next read.
+// Appends the decoded body to |body| and leaves the unused bytes in |unused|.
+zx_status_t Decode(ResponseBodyDecoder* decoder,
+                   const std::vector<std::string>& reads,
+                   std::string* body,
+                   std::string* unused) {
+  unused->clear();
+  for (const std::string& read : reads) {
+    *unused += read;
+    size_t consumed = 0;
+    zx_status_t result = decoder->Consume(
+        *unused,
+        [body](const char* data, size_t size) {
+          body->append(data, size);
+          return ZX_OK;
+        },
+        &consumed);
+    EXPECT_LE(consumed, unused->size());
+    unused->erase(0, consumed);
+    if (result != ZX_OK)
+      return result;
+  }
+  return ZX_OK;
+}
+
+// Splits |data| into reads of |size| bytes.
+std::vector<std::string> Split(const std::string& data, size_t size) {
+  std::vector<std::string> reads;
+  for (size_t i = 0; i < data.size(); i += size)
+    reads.push_back(data.substr(i, size));
+  return reads;
+}
+
+TEST(ResponseBodyDecoderTest, Chunked) {
+  ResponseBodyDecoder decoder;
+  StartChunked(&decoder);
+  EXPECT_EQ(Framing::kChunked, decoder.framing());
+  EXPECT_FALSE(decoder.complete());
+
+  std::string body;
+  std::string unused;
+  EXPECT_EQ(ZX_OK, Decode(&decoder, {kChunkedBody}, &body, &unused));
+  EXPECT_EQ("hello world", body);
+  EXPECT_EQ("", unused);
+  EXPECT_TRUE(decoder.complete());
+  EXPECT_TRUE(decoder.CanReuseConnection(0));
+}
+
+TEST(ResponseBodyDecoderTest, ChunkedSplitAcrossReads) {
+  // Large enough for a chunk size of several digits.
+  std::string data(300, 'x');
+  std::string chunked = "12c\r\n" + data + "\r\n" + kChunkedBody;
+
+  for (size_t size = 1; size < 8; ++size) {
+    ResponseBodyDecoder decoder;
+    StartChunked(&decoder);
+    std::string body;
+    std::string unused;
+    EXPECT_EQ(ZX_OK, Decode(&decoder, Split(chunked, size), &body, &unused))
+        << size;
+    EXPECT_EQ(data + "hello world", body) << size;
+    EXPECT_EQ("", unused) << size;
+    EXPECT_TRUE(decoder.complete()) << size;
+  }
+
+  // Every split into two reads, including ones inside the size lines and
+  // between the "\r" and "\n" that end them.
+  for (size_t i = 1; i < chunked.size(); ++i) {
+    ResponseBodyDecoder decoder;
+    StartChunked(&decoder);
+    std::string body;
+    std::string unused;
+    EXPECT_EQ(ZX_OK,
+              Decode(&decoder, {chunked.substr(0, i), chunked.substr(i)},
+                     &body, &unused))
+        << i;
+    EXPECT_EQ(data + "hello world", body) << i;
+    EXPECT_TRUE(decoder.complete()) << i;
+  }
+}
+
+TEST(ResponseBodyDecoderTest, IncompleteSizeLineIsKept) {
+  ResponseBodyDecoder decoder;
+  StartChunked(&decoder);
+  std::string body;
+  std::string unused;
+  EXPECT_EQ(ZX_OK, Decode(&decoder, {"5\r\nhello\r\n1"}, &body, &unused));
+  EXPECT_EQ("hello", body);
+  EXPECT_EQ("1", unused);
+  EXPECT_FALSE(decoder.complete());
+  EXPECT_FALSE(decoder.CanReuseConnection(unused.size()));
+}
+
+TEST(ResponseBodyDecoderTest, ChunkExtensions) {
+  ResponseBodyDecoder decoder;
+  StartChunked(&decoder);
+  std::string body;
+  std::string unused;
+  EXPECT_EQ(ZX_OK,
+            Decode(&decoder,
+                   Split("5;name=value\r\nhello\r\n"
+                         "6;a;b=\"c;d\"\r\n world\r\n0;last\r\n\r\n",
+                         3),
+                   &body, &unused));
+  EXPECT_EQ("hello world", body);
+  EXPECT_TRUE(decoder.complete());
+}
+
+TEST(ResponseBodyDecoderTest, Trailers) {
+  const std::string chunked =
+      "5\r\nhello\r\n0\r\nExpires: never\r\nX-Checksum: 1234\r\n\r\n";
+  for (size_t size : {1u, 4u, 1000u}) {
+    ResponseBodyDecoder decoder;
+    StartChunked(&decoder);
+    std::string body;
+    std::string unused;
+    EXPECT_EQ(ZX_OK, Decode(&decoder, Split(chunked, size), &body, &unused));
+    EXPECT_EQ("hello", body);
+    EXPECT_EQ("", unused);
+    EXPECT_TRUE(decoder.complete());
+    EXPECT_TRUE(decoder.CanReuseConnection(0));
+  }
+
+  // The body is not complete until the line that ends the trailers.
+  ResponseBodyDecoder decoder;
+  StartChunked(&decoder);
+  std::string body;
+  std::string unused;
+  EXPECT_EQ(ZX_OK, Decode(&decoder, {"5\r\nhello\r\n0\r\nExpires: never\r\n"},
+                          &body, &unused));
+  EXPECT_FALSE(decoder.complete());
+  EXPECT_FALSE(decoder.CanReuseConnection(unused.size()));
+}
+
+TEST(ResponseBodyDecoderTest, LeavesWhatFollowsTheBody) {
+  ResponseBodyDecoder decoder;
+  StartChunked(&decoder);
+  std::string body;
+  std::string unused;
+  EXPECT_EQ(ZX_OK, Decode(&decoder, {std::string(kChunkedBody) + "HTTP/1.1"},
+                          &body, &unused));
+  EXPECT_EQ("hello world", body);
+  EXPECT_EQ("HTTP/1.1", unused);
+  EXPECT_TRUE(decoder.complete());
+  EXPECT_FALSE(decoder.CanReuseConnection(unused.size()));
+}
+
+TEST(ResponseBodyDecoderTest, MalformedChunks) {
+  for (const char* chunked : {
+           "x\r\n",
+           ";ext\r\n",
+           "\r\n",
+           "5\r\nhelloXY",
+           "10000000000000000\r\n",
+       }) {
+    ResponseBodyDecoder decoder;
+    StartChunked(&decoder);
+    std::string body;
+    std::string unused;
+    EXPECT_EQ(ZX_ERR_IO_DATA_INTEGRITY,
+              Decode(&decoder, {chunked}, &body, &unused))
+        << chunked;
+    EXPECT_FALSE(decoder.complete()) << chunked;
+  }
+}
+
+TEST(ResponseBodyDecoderTest, CallbackErrorStopsDecoding) {
+  ResponseBodyDecoder decoder;
+  StartChunked(&decoder);
+  size_t consumed = 0;
+  size_t calls = 0;
+  EXPECT_EQ(ZX_ERR_PEER_CLOSED,
+            decoder.Consume(kChunkedBody,
+                            [&calls](const char* data, size_t size) {
+                              ++calls;
+                              return ZX_ERR_PEER_CLOSED;
+                            },
+                            &consumed));
+  EXPECT_EQ(1u, calls);
+  EXPECT_EQ(strlen("5\r\nhello"), consumed);
+  EXPECT_FALSE(decoder.complete());
+}
+
+TEST(ResponseBodyDecoderTest, ContentLength) {
+  ResponseBodyDecoder decoder;
+  decoder.AddHeader("content-length", "11");
+  decoder.EndHeaders("GET", 200, "HTTP/1.1", true);
+  EXPECT_EQ(Framing::kContentLength, decoder.framing());
+  EXPECT_EQ(11u, decoder.content_length());
+
+  std::string body;
+  std::string unused;
+  EXPECT_EQ(ZX_OK, Decode(&decoder, {"hello", " world", "HTTP"}, &body,
+                          &unused));
+  EXPECT_EQ("hello world", body);
+  EXPECT_EQ("HTTP", unused);
+  EXPECT_TRUE(decoder.complete());
+}
+
+TEST(ResponseBodyDecoderTest, ChunkedTakesPrecedenceOverContentLength) {
+  ResponseBodyDecoder decoder;
+  decoder.AddHeader("Content-Length", "3");
+  StartChunked(&decoder);
+  EXPECT_EQ(Framing::kChunked, decoder.framing());
+
+  std::string body;
+  std::string unused;
+  EXPECT_EQ(ZX_OK, Decode(&decoder, {kChunkedBody}, &body, &unused));
+  EXPECT_EQ("hello world", body);
+}
+
+TEST(ResponseBodyDecoderTest, UntilClose) {
+  ResponseBodyDecoder decoder;
+  decoder.EndHeaders("GET", 200, "HTTP/1.1", true);
+  EXPECT_EQ(Framing::kUntilClose, decoder.framing());
+
+  std::string body;
+  std::string unused;
+  EXPECT_EQ(ZX_OK, Decode(&decoder, {"hello", " world"}, &body, &unused));
+  EXPECT_EQ("hello world", body);
+  EXPECT_FALSE(decoder.complete());
+  decoder.OnConnectionClosed();
+  EXPECT_TRUE(decoder.complete());
+  // The connection is gone.
+  EXPECT_FALSE(decoder.CanReuseConnection(0));
+}
+
+TEST(ResponseBodyDecoderTest, NoBody) {
+  struct {
+    const char* method;
+    unsigned int status_code;
+  } responses[] = {{"HEAD", 200}, {"GET", 204}, {"GET", 304}};
+  for (const auto& response : responses) {
+    ResponseBodyDecoder decoder;
+    decoder.AddHeader("Content-Length", "100");
+    decoder.EndHeaders(response.method, response.status_code, "HTTP/1.1",
+                       true);
+    EXPECT_EQ(Framing::kNone, decoder.framing());
+    EXPECT_TRUE(decoder.complete());
+    EXPECT_TRUE(decoder.CanReuseConnection(0));
+
+    std::string body;
+    std::string unused;
+    EXPECT_EQ(ZX_OK, Decode(&decoder, {"HTTP/1.1"}, &body, &unused));
+    EXPECT_EQ("", body);
+    EXPECT_EQ("HTTP/1.1", unused);
+  }
+}
+
+TEST(ResponseBodyDecoderTest, NotReusedAfterConnectionClose) {
+  ResponseBodyDecoder decoder;
+  decoder.AddHeader("Content-Length", "5");
+  decoder.AddHeader("Connection", "Close");
+  decoder.EndHeaders("GET", 200, "HTTP/1.1", true);
+
+  std::string body;
+  std::string unused;
+  EXPECT_EQ(ZX_OK, Decode(&decoder, {"hello"}, &body, &unused));
+  EXPECT_TRUE(decoder.complete());
+  EXPECT_FALSE(decoder.CanReuseConnection(0));
+}
+
+TEST(ResponseBodyDecoderTest, NotReusedAfterPartialBody) {
+  ResponseBodyDecoder decoder;
+  decoder.AddHeader("Content-Length", "11");
+  decoder.EndHeaders("GET", 200, "HTTP/1.1", true);
+
+  std::string body;
+  std::string unused;
+  EXPECT_EQ(ZX_OK, Decode(&decoder, {"hello"}, &body, &unused));
+  EXPECT_FALSE(decoder.complete());
+  EXPECT_FALSE(decoder.CanReuseConnection(0));
+
+  ResponseBodyDecoder chunked_decoder;
+  StartChunked(&chunked_decoder);
+  EXPECT_EQ(ZX_OK, Decode(&chunked_decoder, {"5\r\nhello\r\n"}, &body,
+                          &unused));
+  EXPECT_FALSE(chunked_decoder.complete());
+  EXPECT_FALSE(chunked_decoder.CanReuseConnection(0));
+}
+
+TEST(ResponseBodyDecoderTest, ReuseNeedsHTTP11AndReusableRequest) {
+  ResponseBodyDecoder http10;
+  http10.AddHeader("Content-Length", "0");
+  http10.EndHeaders("GET", 200, "HTTP/1.0", true);
+  EXPECT_TRUE(http10.complete());
+  EXPECT_FALSE(http10.CanReuseConnection(0));
+
+  ResponseBodyDecoder not_reusable;
+  not_reusable.AddHeader("Content-Length", "0");
+  not_reusable.EndHeaders("GET", 200, "HTTP/1.1", false);
+  EXPECT_TRUE(not_reusable.complete());
+  EXPECT_FALSE(not_reusable.CanReuseConnection(0));
+}
+
+}  // namespace
+}  // namespace network
@@ -0,0 +1,35 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/stream_writer.h"
+
+#include <zircon/syscalls.h>
+
+namespace network {
+
+zx_status_t WriteToStream(const zx::socket& stream,
+                          fxl::StringView data,
+                          fxl::TimeDelta stall_timeout) {
+  while (!data.empty()) {
+    size_t written;
+    zx_status_t result =
+        stream.write(0u, data.data(), data.size(), &written);
+    if (result == ZX_ERR_SHOULD_WAIT) {
+      zx_signals_t observed = 0u;
+      result = stream.wait_one(ZX_SOCKET_WRITABLE | ZX_SOCKET_PEER_CLOSED,
+                               zx_deadline_after(stall_timeout.ToNanoseconds()),
+                               &observed);
+      if (result == ZX_OK && (observed & ZX_SOCKET_WRITABLE))
+        continue;
+      if (result == ZX_OK)
+        result = ZX_ERR_PEER_CLOSED;
+    }
+    if (result != ZX_OK)
+      return result;
+    data = data.substr(written);
+  }
+  return ZX_OK;
+}
+
+}  // namespace network
@@ -0,0 +1,25 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_BIN_NETWORK_STREAM_WRITER_H_
+#define GARNET_BIN_NETWORK_STREAM_WRITER_H_
+
+#include <zx/socket.h>
+
+#include "lib/fxl/strings/string_view.h"
+#include "lib/fxl/time/time_delta.h"
+
+namespace network {
+
+// Writes all of |data| to |stream|, waiting whenever it is full. Returns
+// ZX_ERR_PEER_CLOSED if the reader closes it, and ZX_ERR_TIMED_OUT if it stays
+// full for |stall_timeout|, so that a reader that stops reading without
+// closing the stream cannot hold up the writer forever.
+zx_status_t WriteToStream(const zx::socket& stream,
+                          fxl::StringView data,
+                          fxl::TimeDelta stall_timeout);
+
+}  // namespace network
+
+#endif  // GARNET_BIN_NETWORK_STREAM_WRITER_H_
@@ -0,0 +1,95 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/bin/network/stream_writer.h"
+
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "lib/fxl/synchronization/sleep.h"
+
+namespace network {
+namespace {
+
+constexpr fxl::TimeDelta kShortTimeout = fxl::TimeDelta::FromMilliseconds(20);
+constexpr fxl::TimeDelta kLongTimeout = fxl::TimeDelta::FromSeconds(10);
+
+// Writes to |producer| until it is full.
+void Fill(const zx::socket& producer) {
+  char buffer[4096] = {};
+  size_t written;
+  while (producer.write(0u, buffer, sizeof(buffer), &written) == ZX_OK) {
+  }
+}
+
+// Reads from |consumer| until the other end is closed.
+std::string ReadAll(const zx::socket& consumer) {
+  std::string contents;
+  for (;;) {
+    char buffer[4096];
+    size_t read;
+    zx_status_t result = consumer.read(0u, buffer, sizeof(buffer), &read);
+    if (result == ZX_ERR_SHOULD_WAIT) {
+      consumer.wait_one(ZX_SOCKET_READABLE | ZX_SOCKET_PEER_CLOSED,
+                        ZX_TIME_INFINITE, nullptr);
+      continue;
+    }
+    if (result != ZX_OK)
+      return contents;
+    contents.append(buffer, read);
+  }
+}
+
+TEST(StreamWriter, WritesEverything) {
+  zx::socket producer;
+  zx::socket consumer;
+  ASSERT_EQ(ZX_OK, zx::socket::create(0u, &producer, &consumer));
+
+  // More than the socket holds, so that the writer waits for the reader.
+  std::string data;
+  for (int i = 0; data.size() < 1024 * 1024; ++i)
+    data += std::to_string(i) + ",";
+
+  std::string received;
+  std::thread reader([&consumer, &received] { received = ReadAll(consumer); });
+  EXPECT_EQ(ZX_OK, WriteToStream(producer, data, kLongTimeout));
+  producer.reset();
+  reader.join();
+  EXPECT_EQ(data, received);
+}
+
+TEST(StreamWriter, TimesOutWhenFull) {
+  zx::socket producer;
+  zx::socket consumer;
+  ASSERT_EQ(ZX_OK, zx::socket::create(0u, &producer, &consumer));
+  Fill(producer);
+
+  EXPECT_EQ(ZX_ERR_TIMED_OUT, WriteToStream(producer, "data", kShortTimeout));
+}
+
+TEST(StreamWriter, PeerClosed) {
+  zx::socket producer;
+  zx::socket consumer;
+  ASSERT_EQ(ZX_OK, zx::socket::create(0u, &producer, &consumer));
+  consumer.reset();
+
+  EXPECT_EQ(ZX_ERR_PEER_CLOSED, WriteToStream(producer, "data", kLongTimeout));
+}
+
+TEST(StreamWriter, PeerClosedWhileFull) {
+  zx::socket producer;
+  zx::socket consumer;
+  ASSERT_EQ(ZX_OK, zx::socket::create(0u, &producer, &consumer));
+  Fill(producer);
+
+  std::thread closer([&consumer] {
+    fxl::SleepFor(kShortTimeout);
+    consumer.reset();
+  });
+  EXPECT_EQ(ZX_ERR_PEER_CLOSED, WriteToStream(producer, "data", kLongTimeout));
+  closer.join();
+}
+
+}  // namespace
+}  // namespace network
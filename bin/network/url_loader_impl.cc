@@ -4,6 +4,7 @@
 
 #include "url_loader_impl.h"
 
+#include <algorithm>
 #include <istream>
 #include <memory>
 #include <ostream>
@@ -13,21 +14,52 @@
 #include "garnet/bin/network/http_client.h"
 #include "garnet/bin/network/net_adapters.h"
 #include "garnet/bin/network/net_errors.h"
+#include "lib/fsl/socket/strings.h"
+#include "lib/fsl/vmo/sized_vmo.h"
+#include "lib/fsl/vmo/strings.h"
 #include "lib/fxl/functional/make_copyable.h"
 #include "lib/fxl/logging.h"
+#include "lib/fxl/strings/ascii.h"
 #include "lib/url/gurl.h"
 
 namespace network {
 
-URLLoaderImpl::URLLoaderImpl(Coordinator* coordinator)
-    : coordinator_(coordinator) {}
+URLLoaderImpl::URLLoaderImpl(Coordinator* coordinator,
+                             ConnectionPool* connection_pool,
+                             HostResolverCache* host_resolver_cache,
+                             HttpCache* http_cache)
+    : coordinator_(coordinator),
+      connection_pool_(connection_pool),
+      host_resolver_cache_(host_resolver_cache),
+      http_cache_(http_cache) {}
 
 URLLoaderImpl::~URLLoaderImpl() {}
 
 void URLLoaderImpl::Start(URLRequestPtr request, const Callback& callback) {
   callback_ = std::move(callback);
-  coordinator_->RequestNetworkSlot(fxl::MakeCopyable(
-      [ this, request = std::move(request) ](fxl::Closure on_inactive) mutable {
+  URLRequest::Priority priority = request->priority;
+  switch (priority) {
+    case URLRequest::Priority::INTERACTIVE:
+    case URLRequest::Priority::BACKGROUND:
+    case URLRequest::Priority::PREFETCH:
+      break;
+    default:
+      // The priority comes straight from the client.
+      FXL_LOG(WARNING) << "Unknown priority " << static_cast<uint32_t>(priority)
+                       << " for " << request->url;
+      priority = URLRequest::Priority::INTERACTIVE;
+      break;
+  }
+  url::GURL url(request->url);
+  std::string origin;
+  if (url.is_valid()) {
+    origin = url.scheme() + "://" + url.host() + ":" +
+             std::to_string(url.EffectiveIntPort());
+  }
+  coordinator_->RequestNetworkSlot(
+      priority, origin,
+      fxl::MakeCopyable([ this, request = std::move(request) ](
+          fxl::Closure on_inactive) mutable {
         StartInternal(std::move(request));
         on_inactive();
       }));
@@ -65,6 +97,88 @@ void URLLoaderImpl::SendResponse(URLResponsePtr response) {
   callback(std::move(response));
 }
 
+void URLLoaderImpl::SendCachedResponse(const HttpCache::Response& cached) {
+  URLResponsePtr response = URLResponse::New();
+  response->status_code = cached.status_code;
+  response->status_line = cached.status_line;
+  response->url = current_url_.spec();
+  for (const auto& header : cached.headers) {
+    HttpHeaderPtr hdr = HttpHeader::New();
+    hdr->name = header.first;
+    hdr->value = header.second;
+    response->headers.push_back(std::move(hdr));
+  }
+  response->body = URLBody::New();
+
+  switch (response_body_mode_) {
+    case URLRequest::ResponseBodyMode::BUFFER:
+    case URLRequest::ResponseBodyMode::SIZED_BUFFER: {
+      fsl::SizedVmo vmo;
+      if (!fsl::VmoFromString(cached.body, &vmo)) {
+        SendError(network::NETWORK_ERR_CACHE_READ_FAILURE);
+        return;
+      }
+      if (response_body_mode_ == URLRequest::ResponseBodyMode::BUFFER)
+        response->body->set_buffer(std::move(vmo.vmo()));
+      else
+        response->body->set_sized_buffer(std::move(vmo).ToTransport());
+      SendResponse(std::move(response));
+      break;
+    }
+    case URLRequest::ResponseBodyMode::STREAM:
+    case URLRequest::ResponseBodyMode::BUFFER_OR_STREAM: {
+      zx::socket consumer;
+      zx::socket producer;
+      zx_status_t status = zx::socket::create(0u, &producer, &consumer);
+      if (status != ZX_OK) {
+        SendError(network::NETWORK_ERR_INSUFFICIENT_RESOURCES);
+        return;
+      }
+      response->body->set_stream(std::move(consumer));
+      SendResponse(std::move(response));
+      fsl::BlockingCopyFromString(cached.body, producer);
+      break;
+    }
+  }
+}
+
+// Answers the request for |current_url_| from the cache if it can. Otherwise
+// adds the validators of the stored response, if any, to |headers|, so that
+// the server answers with a 304 if the stored response is still good.
+// Returns whether the request was answered.
+bool URLLoaderImpl::StartFromCache(
+    URLRequest::CacheMode cache_mode,
+    std::map<std::string, std::string>* headers) {
+  cache_entry_.reset();
+  bool only_from_cache = cache_mode == URLRequest::CacheMode::ONLY_FROM_CACHE;
+  if (!use_cache_) {
+    if (only_from_cache)
+      SendError(network::NETWORK_ERR_CACHE_MISS);
+    return only_from_cache;
+  }
+
+  std::unique_ptr<HttpCache::Entry> entry = http_cache_->Lookup(
+      current_url_.spec(),
+      HttpCache::Headers(headers->begin(), headers->end()));
+  if (entry && (entry->fresh || only_from_cache)) {
+    SendCachedResponse(entry->response);
+    return true;
+  }
+  if (only_from_cache) {
+    SendError(network::NETWORK_ERR_CACHE_MISS);
+    return true;
+  }
+
+  if (entry && (!entry->etag.empty() || !entry->last_modified.empty())) {
+    if (!entry->etag.empty())
+      (*headers)["If-None-Match"] = entry->etag;
+    if (!entry->last_modified.empty())
+      (*headers)["If-Modified-Since"] = entry->last_modified;
+    cache_entry_ = std::move(entry);
+  }
+  return false;
+}
+
 void URLLoaderImpl::StartInternal(URLRequestPtr request) {
   std::string url_str(request->url);
   std::string method(request->method);
@@ -94,6 +208,22 @@ void URLLoaderImpl::StartInternal(URLRequestPtr request) {
 
   response_body_mode_ = request->response_body_mode;
 
+  // Requests that bypass the cache neither use nor update it, and ask the
+  // proxies on the way not to use theirs either.
+  use_cache_ =
+      request->cache_mode != URLRequest::CacheMode::BYPASS_CACHE &&
+      HttpCache::IsCacheableRequest(
+          method, HttpCache::Headers(extra_headers.begin(),
+                                     extra_headers.end()));
+  if (request->cache_mode == URLRequest::CacheMode::BYPASS_CACHE &&
+      std::none_of(extra_headers.begin(), extra_headers.end(),
+                   [](const std::pair<const std::string, std::string>& h) {
+                     return fxl::EqualsCaseInsensitiveASCII(h.first,
+                                                            "Cache-Control");
+                   })) {
+    extra_headers["Cache-Control"] = "no-cache";
+  }
+
   asio::io_service io_service;
   bool redirect = false;
 
@@ -103,12 +233,23 @@ void URLLoaderImpl::StartInternal(URLRequestPtr request) {
     return;
   }
 
+  if (method != "GET" && method != "HEAD") {
+    // The request may change the resource, which leaves its stored response
+    // out of date.
+    http_cache_->Remove(current_url_.spec());
+  }
+
   do {
     if (redirect) {
       io_service.reset();
       redirect = false;
     }
 
+    std::map<std::string, std::string> headers = extra_headers;
+    if (StartFromCache(request->cache_mode, &headers))
+      break;
+    request_time_ = time(nullptr);
+
     if (current_url_.SchemeIs("https")) {
 #ifdef NETWORK_SERVICE_USE_HTTPS
       asio::ssl::context ctx(asio::ssl::context::sslv23);
@@ -120,7 +261,7 @@ void URLLoaderImpl::StartInternal(URLRequestPtr request) {
           current_url_.host(),
           current_url_.path() +
               (current_url_.has_query() ? "?" + current_url_.query() : ""),
-          method, extra_headers, std::move(request_body_reader));
+          method, headers, std::move(request_body_reader));
       if (result != ZX_OK) {
         SendError(network::NETWORK_ERR_INVALID_ARGUMENT);
         break;
@@ -149,7 +290,7 @@ void URLLoaderImpl::StartInternal(URLRequestPtr request) {
           current_url_.host(),
           current_url_.path() +
               (current_url_.has_query() ? "?" + current_url_.query() : ""),
-          method, extra_headers, std::move(request_body_reader));
+          method, headers, std::move(request_body_reader));
       if (result != ZX_OK) {
         SendError(network::NETWORK_ERR_INVALID_ARGUMENT);
         break;
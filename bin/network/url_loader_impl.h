@@ -7,22 +7,39 @@
 
 #include "lib/network/fidl/url_loader.fidl.h"
 
+#include <time.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "garnet/bin/network/http_cache.h"
 #include "lib/fidl/cpp/bindings/binding.h"
 #include "lib/url/gurl.h"
 
 namespace network {
 
+class ConnectionPool;
+class HostResolverCache;
+
 class URLLoaderImpl : public URLLoader {
  public:
   // Coordinates requests to limit the number of concurrent active requests.
   class Coordinator {
    public:
     virtual ~Coordinator() {}
+    // Calls |slot_request| on the loader's thread once a request of
+    // |priority| to |origin| may run.
     virtual void RequestNetworkSlot(
+        URLRequest::Priority priority,
+        const std::string& origin,
         std::function<void(fxl::Closure)> slot_request) = 0;
   };
 
-  URLLoaderImpl(Coordinator* coordinator);
+  URLLoaderImpl(Coordinator* coordinator,
+                ConnectionPool* connection_pool,
+                HostResolverCache* host_resolver_cache,
+                HttpCache* http_cache);
   ~URLLoaderImpl() override;
 
  private:
@@ -39,13 +56,25 @@ class URLLoaderImpl : public URLLoader {
   void SendError(int error_code);
   void FollowRedirectInternal();
   void SendResponse(URLResponsePtr response);
+  void SendCachedResponse(const HttpCache::Response& cached);
+  bool StartFromCache(URLRequest::CacheMode cache_mode,
+                      std::map<std::string, std::string>* headers);
   void StartInternal(URLRequestPtr request);
 
   Coordinator* coordinator_;
+  ConnectionPool* connection_pool_;
+  HostResolverCache* host_resolver_cache_;
+  HttpCache* http_cache_;
   Callback callback_;
   URLRequest::ResponseBodyMode response_body_mode_;
   // bool auto_follow_redirects_;
   url::GURL current_url_;
+  // Whether the response to the current request goes through the cache.
+  bool use_cache_ = false;
+  // The stored response being revalidated by the current request, if any.
+  std::unique_ptr<HttpCache::Entry> cache_entry_;
+  // When the current request was sent, for the cache.
+  time_t request_time_ = 0;
   URLLoaderStatusPtr last_status_;
 };
 
@@ -2,13 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include <fstream>
-
 #include <rapidjson/document.h>
 #include <rapidjson/error/en.h>
-#include <rapidjson/istreamwrapper.h>
 
 #include "garnet/bin/trace_manager/config.h"
+#include "lib/fxl/files/mapped_file.h"
 #include "lib/fxl/logging.h"
 
 namespace tracing {
@@ -24,11 +22,15 @@ Config::Config() = default;
 Config::~Config() = default;
 
 bool Config::ReadFrom(const std::string& config_file) {
-  std::ifstream in(config_file);
-  rapidjson::IStreamWrapper isw(in);
-  rapidjson::Document document;
+  files::MappedFile file;
+  if (!file.Open(config_file)) {
+    FXL_LOG(ERROR) << "Failed to read: " << config_file;
+    return false;
+  }
+  file.Advise(files::MappedFile::Access::kSequential);
 
-  if (!document.ParseStream(isw).IsObject()) {
+  rapidjson::Document document;
+  if (!document.Parse(file.data(), file.size()).IsObject()) {
     FXL_LOG(ERROR) << "Failed to parse JSON object from: " << config_file;
     if (document.HasParseError()) {
       FXL_LOG(ERROR) << "Parse error "
@@ -0,0 +1,92 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <array>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <zircon/syscalls.h>
+
+#include "lib/fsl/tasks/message_loop.h"
+#include "lib/fsl/tasks/message_loop_handler.h"
+#include "lib/fsl/threading/thread.h"
+#include "lib/fxl/synchronization/waitable_event.h"
+#include "lib/fxl/tasks/task_runner.h"
+
+namespace {
+
+// Returns the task runner of a message loop that runs on its own thread for
+// the lifetime of the process.
+fxl::RefPtr<fxl::TaskRunner> GetLoopTaskRunner() {
+  static fsl::Thread* thread = [] {
+    auto thread = new fsl::Thread();
+    thread->Run();
+    return thread;
+  }();
+  return thread->TaskRunner();
+}
+
+// Measures the cost of posting tasks to a message loop running on another
+// thread while 1 to 16 threads are posting to it at the same time.
+void MessageLoop_CrossThreadPost(benchmark::State& state) {
+  fxl::RefPtr<fxl::TaskRunner> task_runner = GetLoopTaskRunner();
+
+  while (state.KeepRunning())
+    task_runner->PostTask([] {});
+
+  // All threads have stopped posting by now. Wait for the loop to catch up so
+  // that its backlog does not leak into the next run.
+  if (state.thread_index == 0) {
+    fxl::AutoResetWaitableEvent drained;
+    task_runner->PostTask([&drained] { drained.Signal(); });
+    drained.Wait();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(MessageLoop_CrossThreadPost)->ThreadRange(1, 16)->UseRealTime();
+
+// Measures the cost of posting a task to the current thread's message loop and
+// running it, for a task that captures |kCaptureSize| bytes.
+template <size_t kCaptureSize>
+void MessageLoop_PostAndRun(benchmark::State& state) {
+  fsl::MessageLoop loop;
+  std::array<char, kCaptureSize> capture{};
+
+  while (state.KeepRunning()) {
+    loop.task_runner()->PostTask(
+        [capture] { benchmark::DoNotOptimize(capture); });
+    loop.RunUntilIdle();
+  }
+}
+BENCHMARK_TEMPLATE(MessageLoop_PostAndRun, 8);
+BENCHMARK_TEMPLATE(MessageLoop_PostAndRun, 32);
+BENCHMARK_TEMPLATE(MessageLoop_PostAndRun, 56);
+
+class NullHandler : public fsl::MessageLoopHandler {};
+
+// Measures the cost of adding and removing a handler while |state.range(0)|
+// other handlers are registered with the message loop.
+void MessageLoop_AddRemoveHandler(benchmark::State& state) {
+  fsl::MessageLoop loop;
+  NullHandler handler;
+  zx_handle_t event;
+  if (zx_event_create(0, &event) != ZX_OK) {
+    state.SkipWithError("Failed to create event");
+    return;
+  }
+
+  std::vector<fsl::MessageLoop::HandlerKey> keys;
+  for (int i = 0; i < state.range(0); ++i)
+    keys.push_back(loop.AddHandler(&handler, event, ZX_USER_SIGNAL_0));
+
+  while (state.KeepRunning())
+    loop.RemoveHandler(loop.AddHandler(&handler, event, ZX_USER_SIGNAL_0));
+
+  for (auto key : keys)
+    loop.RemoveHandler(key);
+  zx_handle_close(event);
+}
+BENCHMARK(MessageLoop_AddRemoveHandler)->Arg(0)->Arg(100)->Arg(10000);
+
+}  // namespace
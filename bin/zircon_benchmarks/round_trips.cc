@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <pthread.h>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -370,6 +371,39 @@ class FidlTest {
   RoundTripServiceSyncPtr service_ptr_;
 };
 
+// Test the throughput of FIDL IPC using an asynchronous interface pointer
+// with many calls in flight at once, which is the pattern used by pipelined
+// clients.  Each run issues |calls_in_flight| requests back-to-back and then
+// waits for all of the responses, so this mostly measures the per-call
+// bookkeeping cost rather than the round-trip latency.
+class FidlPipelinedTest {
+ public:
+  FidlPipelinedTest(MultiProc multiproc, uint32_t calls_in_flight)
+      : calls_in_flight_(calls_in_flight) {
+    zx_handle_t server = service_ptr_.NewRequest().PassChannel().release();
+    thread_or_process_.Launch("FidlTest::ThreadFunc", &server, 1, multiproc);
+  }
+
+  void Run() {
+    pending_calls_ = calls_in_flight_;
+    for (uint32_t i = 0; i < calls_in_flight_; ++i) {
+      service_ptr_->RoundTripTest(123, [this](uint32_t result) {
+        FXL_CHECK(result == 456);
+        if (--pending_calls_ == 0)
+          loop_.QuitNow();
+      });
+    }
+    loop_.Run();
+  }
+
+ private:
+  fsl::MessageLoop loop_;
+  ThreadOrProcess thread_or_process_;
+  RoundTripServicePtr service_ptr_;
+  uint32_t calls_in_flight_;
+  uint32_t pending_calls_ = 0;
+};
+
 // Test the round trip time for waking up threads using Zircon futexes.
 // Note that Zircon does not support cross-process futexes, only
 // within-process futexes, so there is no multi-process version of this
@@ -528,6 +562,12 @@ void RegisterTests() {
   RegisterTestMultiProc<ChannelCallTest>("RoundTrip_ChannelCall");
   RegisterTestMultiProc<PortTest>("RoundTrip_Port");
   RegisterTestMultiProc<FidlTest>("RoundTrip_Fidl");
+  for (uint32_t calls_in_flight : {1, 16, 256}) {
+    fbenchmark::RegisterTest<FidlPipelinedTest>(
+        ("Pipelined_Fidl_" + std::to_string(calls_in_flight) +
+         "InFlight_SingleProcess").c_str(),
+        SingleProcess, calls_in_flight);
+  }
   fbenchmark::RegisterTest<FutexTest>("RoundTrip_Futex_SingleProcess");
   fbenchmark::RegisterTest<PthreadCondvarTest>(
       "RoundTrip_PthreadCondvar_SingleProcess");
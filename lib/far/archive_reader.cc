@@ -4,15 +4,19 @@
 
 #include "garnet/lib/far/archive_reader.h"
 
+#include <fcntl.h>
 #include <inttypes.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <limits>
 #include <utility>
 
+#include "garnet/lib/far/compressed_contents.h"
 #include "garnet/lib/far/file_operations.h"
 #include "garnet/lib/far/format.h"
 #include "lib/fxl/files/directory.h"
+#include "lib/fxl/files/file_descriptor.h"
 #include "lib/fxl/files/path.h"
 #include "lib/fxl/strings/concatenate.h"
 
@@ -34,6 +38,13 @@ ArchiveReader::ArchiveReader(fxl::UniqueFD fd) : fd_(std::move(fd)) {}
 ArchiveReader::~ArchiveReader() = default;
 
 bool ArchiveReader::Read() {
+  // Archives that cannot be mapped are read a chunk at a time instead.
+  if (allow_mapping_)
+    mapping_.MapFileDescriptor(fd_.get());
+  else
+    mapping_.Close();
+  if (mapping_.is_mapped())
+    mapping_.Advise(files::MappedFile::Access::kRandom);
   return ReadIndex() && ReadDirectory();
 }
 
@@ -46,11 +57,9 @@ bool ArchiveReader::Extract(fxl::StringView output_dir) const {
       fprintf(stderr, "error: Failed to create directory '%s'.\n", dir.c_str());
       return false;
     }
-    if (lseek(fd_.get(), entry.data_offset, SEEK_SET) < 0) {
-      fprintf(stderr, "error: Failed to seek to offset of file.\n");
-      return false;
-    }
-    if (!CopyFileToPath(fd_.get(), path.c_str(), entry.data_length)) {
+    fxl::UniqueFD dst_fd(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                              S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
+    if (!dst_fd.is_valid() || !CopyEntryToFile(entry, dst_fd.get())) {
       fprintf(stderr, "error: Failed write contents to '%s'.\n", path.c_str());
       return false;
     }
@@ -63,11 +72,9 @@ bool ArchiveReader::ExtractFile(fxl::StringView archive_path,
   DirectoryTableEntry entry;
   if (!GetDirectoryEntryByPath(archive_path, &entry))
     return false;
-  if (lseek(fd_.get(), entry.data_offset, SEEK_SET) < 0) {
-    fprintf(stderr, "error: Failed to seek to offset of file.\n");
-    return false;
-  }
-  if (!CopyFileToPath(fd_.get(), output_path, entry.data_length)) {
+  fxl::UniqueFD dst_fd(open(output_path, O_WRONLY | O_CREAT | O_TRUNC,
+                            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
+  if (!dst_fd.is_valid() || !CopyEntryToFile(entry, dst_fd.get())) {
     fprintf(stderr, "error: Failed write contents to '%s'.\n", output_path);
     return false;
   }
@@ -78,11 +85,7 @@ bool ArchiveReader::CopyFile(fxl::StringView archive_path, int dst_fd) const {
   DirectoryTableEntry entry;
   if (!GetDirectoryEntryByPath(archive_path, &entry))
     return false;
-  if (lseek(fd_.get(), entry.data_offset, SEEK_SET) < 0) {
-    fprintf(stderr, "error: Failed to seek to offset of file.\n");
-    return false;
-  }
-  if (!CopyFileToFile(fd_.get(), dst_fd, entry.data_length)) {
+  if (!CopyEntryToFile(entry, dst_fd)) {
     fprintf(stderr, "error: Failed write contents.\n");
     return false;
   }
@@ -91,9 +94,9 @@ bool ArchiveReader::CopyFile(fxl::StringView archive_path, int dst_fd) const {
 
 bool ArchiveReader::GetDirectoryEntryByIndex(uint64_t index,
                                              DirectoryTableEntry* entry) const {
-  if (index >= directory_table_.size())
+  if (index >= directory_table_.size)
     return false;
-  *entry = directory_table_[index];
+  *entry = directory_table_.data[index];
   return true;
 }
 
@@ -106,6 +109,9 @@ bool ArchiveReader::GetDirectoryEntryByPath(fxl::StringView archive_path,
 
 bool ArchiveReader::GetDirectoryIndexByPath(fxl::StringView archive_path,
                                             uint64_t* index) const {
+  if (path_hash_slots_.size)
+    return FindPathInHash(archive_path, index);
+
   PathComparator comparator;
   comparator.reader = this;
 
@@ -123,18 +129,63 @@ fxl::UniqueFD ArchiveReader::TakeFileDescriptor() {
 
 fxl::StringView ArchiveReader::GetPathView(
     const DirectoryTableEntry& entry) const {
-  return fxl::StringView(path_data_.data() + entry.name_offset,
+  if (entry.name_offset > path_data_.size ||
+      entry.name_length > path_data_.size - entry.name_offset)
+    return fxl::StringView();
+  return fxl::StringView(path_data_.data + entry.name_offset,
                          entry.name_length);
 }
 
-bool ArchiveReader::ReadIndex() {
-  if (lseek(fd_.get(), 0, SEEK_SET) < 0) {
-    fprintf(stderr, "error: Failed to seek to beginning of archive.\n");
+bool ArchiveReader::GetContentView(const DirectoryTableEntry& entry,
+                                   fxl::StringView* contents) const {
+  if (IsCompressed(entry) || !mapping_.is_mapped() ||
+      entry.data_offset > mapping_.size() ||
+      entry.data_length > mapping_.size() - entry.data_offset)
     return false;
+  *contents = mapping_.view().substr(entry.data_offset, entry.data_length);
+  return true;
+}
+
+bool ArchiveReader::GetContentLength(const DirectoryTableEntry& entry,
+                                     uint64_t* length) const {
+  if (!IsCompressed(entry)) {
+    *length = entry.data_length;
+    return true;
   }
 
+  std::string storage;
+  CompressedContents contents;
+  if (!InitCompressedContents(entry, &contents, &storage))
+    return false;
+  *length = contents.size();
+  return true;
+}
+
+bool ArchiveReader::ReadContents(const DirectoryTableEntry& entry,
+                                 uint64_t offset,
+                                 size_t length,
+                                 char* buffer) const {
+  if (IsCompressed(entry)) {
+    std::string storage;
+    CompressedContents contents;
+    return InitCompressedContents(entry, &contents, &storage) &&
+           contents.Read(offset, length, buffer);
+  }
+
+  if (offset > entry.data_length || length > entry.data_length - offset)
+    return false;
+  fxl::StringView contents;
+  if (GetContentView(entry, &contents)) {
+    memcpy(buffer, contents.data() + offset, length);
+    return true;
+  }
+  return fd_.is_valid() &&
+         ReadFromFileAt(fd_.get(), entry.data_offset + offset, buffer, length);
+}
+
+bool ArchiveReader::ReadIndex() {
   IndexChunk index_chunk;
-  if (!ReadObject(fd_.get(), &index_chunk)) {
+  if (!ReadObjectAt(0, &index_chunk)) {
     fprintf(stderr,
             "error: Failed read index chunk. Is this file an archive?\n");
     return false;
@@ -153,11 +204,13 @@ bool ArchiveReader::ReadIndex() {
     return false;
   }
 
-  index_.resize(index_chunk.length / sizeof(IndexEntry));
-  if (!ReadVector(fd_.get(), &index_)) {
+  Chunk<IndexEntry> index;
+  if (!ReadChunk(sizeof(IndexChunk), index_chunk.length / sizeof(IndexEntry),
+                 &index)) {
     fprintf(stderr, "error: Failed to read contents of index chunk.\n");
     return false;
   }
+  index_.assign(index.begin(), index.end());
 
   uint64_t next_offset = sizeof(IndexChunk) + index_chunk.length;
   for (const auto& entry : index_) {
@@ -198,14 +251,9 @@ bool ArchiveReader::ReadDirectory() {
             dir_entry->length);
     return false;
   }
-  uint64_t file_count = dir_entry->length / sizeof(DirectoryTableEntry);
-  directory_table_.resize(file_count);
-
-  if (lseek(fd_.get(), dir_entry->offset, SEEK_SET) < 0) {
-    fprintf(stderr, "error: Failed to seek to directory chunk.\n");
-    return false;
-  }
-  if (!ReadVector(fd_.get(), &directory_table_)) {
+  if (!ReadChunk(dir_entry->offset,
+                 dir_entry->length / sizeof(DirectoryTableEntry),
+                 &directory_table_)) {
     fprintf(stderr, "error: Failed to read directory table.\n");
     return false;
   }
@@ -215,20 +263,178 @@ bool ArchiveReader::ReadDirectory() {
     fprintf(stderr, "error: Cannot find directory names chunk.\n");
     return false;
   }
-  path_data_.resize(dirnames_entry->length);
+  if (!ReadChunk(dirnames_entry->offset, dirnames_entry->length,
+                 &path_data_)) {
+    fprintf(stderr, "error: Failed to read directory names.\n");
+    return false;
+  }
 
-  if (lseek(fd_.get(), dirnames_entry->offset, SEEK_SET) < 0) {
-    fprintf(stderr, "error: Failed to seek to directory names chunk.\n");
+  return ReadPathHash();
+}
+
+bool ArchiveReader::ReadPathHash() {
+  path_hash_slots_ = Chunk<PathHashSlot>();
+  const IndexEntry* path_hash_entry = GetIndexEntry(kPathHashType);
+  if (!path_hash_entry)
+    return true;
+
+  PathHashChunk path_hash;
+  if (path_hash_entry->length < sizeof(PathHashChunk) ||
+      !ReadObjectAt(path_hash_entry->offset, &path_hash)) {
+    fprintf(stderr, "error: Failed to read path hash chunk.\n");
     return false;
   }
-  if (!ReadVector(fd_.get(), &path_data_)) {
-    fprintf(stderr, "error: Failed to read directory names.\n");
+  // The table is only an accelerator, so fall back to searching the
+  // directory if it uses a hash function we do not know.
+  if (path_hash.algorithm != kPathHashAlgorithm)
+    return true;
+
+  uint64_t slot_count = path_hash.slot_count;
+  if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0 ||
+      path_hash_entry->length !=
+          sizeof(PathHashChunk) + slot_count * sizeof(PathHashSlot) ||
+      slot_count <= directory_table_.size) {
+    fprintf(stderr, "error: Invalid path hash chunk length.\n");
+    return false;
+  }
+
+  // Slots are checked as they are probed so that opening the archive need
+  // not touch the whole table.
+  if (!ReadChunk(path_hash_entry->offset + sizeof(PathHashChunk), slot_count,
+                 &path_hash_slots_)) {
+    fprintf(stderr, "error: Failed to read path hash table.\n");
+    path_hash_slots_ = Chunk<PathHashSlot>();
     return false;
   }
 
   return true;
 }
 
+template <typename T>
+bool ArchiveReader::ReadObjectAt(uint64_t offset, T* object) {
+  Chunk<char> chunk;
+  if (!ReadChunk(offset, sizeof(T), &chunk))
+    return false;
+  memcpy(object, chunk.data, sizeof(T));
+  return true;
+}
+
+template <typename T>
+bool ArchiveReader::ReadChunk(uint64_t offset,
+                              uint64_t count,
+                              Chunk<T>* chunk) {
+  if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+    return false;
+  size_t length = count * sizeof(T);
+
+  if (mapping_.is_mapped()) {
+    if (offset > mapping_.size() || length > mapping_.size() - offset)
+      return false;
+    // Chunks are 8-byte aligned within the archive, and the mapping is page
+    // aligned, so the entries can be used in place.
+    const char* data = mapping_.data() + offset;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0)
+      return false;
+    chunk->storage.clear();
+    chunk->data = reinterpret_cast<const T*>(data);
+    chunk->size = count;
+    return true;
+  }
+
+  if (lseek(fd_.get(), offset, SEEK_SET) < 0)
+    return false;
+  chunk->storage.resize(count);
+  if (!ReadVector(fd_.get(), &chunk->storage))
+    return false;
+  chunk->data = chunk->storage.data();
+  chunk->size = count;
+  return true;
+}
+
+bool ArchiveReader::FindPathInHash(fxl::StringView archive_path,
+                                   uint64_t* index) const {
+  uint32_t hash = HashPath(archive_path.data(), archive_path.size());
+  size_t mask = path_hash_slots_.size - 1;
+  size_t slot = hash & mask;
+  for (size_t probes = 0; probes < path_hash_slots_.size; ++probes) {
+    const PathHashSlot& entry = path_hash_slots_.data[slot];
+    if (entry.index == kEmptyPathHashSlot)
+      return false;
+    if (entry.index >= directory_table_.size)
+      return false;
+    if (entry.hash == hash &&
+        GetPathView(directory_table_.data[entry.index]) == archive_path) {
+      *index = entry.index;
+      return true;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return false;
+}
+
+bool ArchiveReader::InitCompressedContents(const DirectoryTableEntry& entry,
+                                           CompressedContents* contents,
+                                           std::string* storage) const {
+  fxl::StringView data;
+  return IsCompressed(entry) && GetStoredData(entry, &data, storage) &&
+         contents->Init(data);
+}
+
+bool ArchiveReader::GetStoredData(const DirectoryTableEntry& entry,
+                                  fxl::StringView* data,
+                                  std::string* storage) const {
+  if (mapping_.is_mapped()) {
+    if (entry.data_offset > mapping_.size() ||
+        entry.data_length > mapping_.size() - entry.data_offset)
+      return false;
+    *data = mapping_.view().substr(entry.data_offset, entry.data_length);
+    return true;
+  }
+
+  if (!fd_.is_valid() ||
+      entry.data_length > std::numeric_limits<size_t>::max())
+    return false;
+  storage->resize(entry.data_length);
+  if (!ReadFromFileAt(fd_.get(), entry.data_offset, &(*storage)[0],
+                      storage->size()))
+    return false;
+  *data = *storage;
+  return true;
+}
+
+bool ArchiveReader::CopyEntryToFile(const DirectoryTableEntry& entry,
+                                    int dst_fd) const {
+  if (IsCompressed(entry)) {
+    std::string storage;
+    CompressedContents contents;
+    if (!InitCompressedContents(entry, &contents, &storage))
+      return false;
+    std::vector<char> buffer(kDefaultCompressedFrameSize);
+    for (uint64_t offset = 0; offset < contents.size();) {
+      size_t length = std::min<uint64_t>(buffer.size(),
+                                         contents.size() - offset);
+      if (!contents.Read(offset, length, buffer.data()) ||
+          !fxl::WriteFileDescriptor(dst_fd, buffer.data(), length))
+        return false;
+      offset += length;
+    }
+    return true;
+  }
+
+#if defined(__linux__)
+  // The kernel can copy the contents without them passing through here.
+  if (fd_.is_valid()) {
+    return CopyFileRangeToFile(fd_.get(), entry.data_offset, dst_fd,
+                               entry.data_length);
+  }
+#endif
+  fxl::StringView contents;
+  if (GetContentView(entry, &contents))
+    return fxl::WriteFileDescriptor(dst_fd, contents.data(), contents.size());
+  return fd_.is_valid() && CopyFileRangeToFile(fd_.get(), entry.data_offset,
+                                               dst_fd, entry.data_length);
+}
+
 const IndexEntry* ArchiveReader::GetIndexEntry(uint64_t type) const {
   for (auto& entry : index_) {
     if (entry.type == type)
@@ -5,23 +5,40 @@
 #ifndef GARNET_LIB_FAR_ARCHIVE_READER_H_
 #define GARNET_LIB_FAR_ARCHIVE_READER_H_
 
+#include <string>
 #include <vector>
 
 #include "garnet/lib/far/format.h"
+#include "lib/fxl/files/mapped_file.h"
 #include "lib/fxl/files/unique_fd.h"
 #include "lib/fxl/strings/string_view.h"
 
 namespace archive {
 
+class CompressedContents;
+
+// Reads an archive from a file descriptor.
+//
+// Where the archive can be mapped into memory, the directory, path names and
+// file contents are used in place rather than copied out of the file, and
+// only the pages that are touched are read.
 class ArchiveReader {
  public:
   explicit ArchiveReader(fxl::UniqueFD fd);
   ~ArchiveReader();
   ArchiveReader(const ArchiveReader& other) = delete;
 
+  // Whether |Read| may map the archive into memory. On by default. Archives
+  // that are not mapped are read a chunk at a time, as are archives that
+  // cannot be mapped.
+  void set_allow_mapping(bool allow_mapping) { allow_mapping_ = allow_mapping; }
+
   bool Read();
 
-  uint64_t file_count() const { return directory_table_.size(); }
+  uint64_t file_count() const { return directory_table_.size; }
+
+  // Whether the archive is mapped into memory.
+  bool is_mapped() const { return mapping_.is_mapped(); }
 
   template <typename Callback>
   void ListPaths(Callback callback) const {
@@ -51,16 +68,83 @@ class ArchiveReader {
 
   fxl::StringView GetPathView(const DirectoryTableEntry& entry) const;
 
+  // Whether the data of the file described by |entry| is compressed, in
+  // which case it can only be read through |ReadContents| and the copying
+  // methods above.
+  static bool IsCompressed(const DirectoryTableEntry& entry) {
+    return !!(entry.flags & kDirectoryEntryCompressed);
+  }
+
+  // Sets |contents| to the contents of the file described by |entry|, which
+  // stay valid as long as the reader. Returns false if the archive is not
+  // mapped, the file is compressed, or |entry| lies outside of the archive.
+  bool GetContentView(const DirectoryTableEntry& entry,
+                      fxl::StringView* contents) const;
+
+  // Sets |length| to the length of the contents of the file described by
+  // |entry|, once decompressed.
+  bool GetContentLength(const DirectoryTableEntry& entry,
+                        uint64_t* length) const;
+
+  // Copies |length| bytes of the contents of the file described by |entry|,
+  // starting at |offset|, into |buffer|. Only the parts of a compressed file
+  // that overlap the range are decompressed.
+  bool ReadContents(const DirectoryTableEntry& entry,
+                    uint64_t offset,
+                    size_t length,
+                    char* buffer) const;
+
+  // Prepares |contents| to read the compressed file described by |entry|.
+  // The compressed data is used in place if the archive is mapped, and read
+  // into |storage| otherwise, in which case |storage| must outlive
+  // |contents|. Callers reading a file in many pieces should read them all
+  // through one |contents|, which reads the compressed data only once.
+  bool InitCompressedContents(const DirectoryTableEntry& entry,
+                              CompressedContents* contents,
+                              std::string* storage) const;
+
  private:
+  // The contents of a chunk. Points into |mapping_| if the archive is mapped,
+  // and into |storage| otherwise.
+  template <typename T>
+  struct Chunk {
+    const T* begin() const { return data; }
+    const T* end() const { return data + size; }
+
+    const T* data = nullptr;
+    size_t size = 0u;
+    std::vector<T> storage;
+  };
+
   bool ReadIndex();
   bool ReadDirectory();
+  bool ReadPathHash();
+
+  // Reads |count| objects of type |T| at |offset| into |chunk|.
+  template <typename T>
+  bool ReadChunk(uint64_t offset, uint64_t count, Chunk<T>* chunk);
+  template <typename T>
+  bool ReadObjectAt(uint64_t offset, T* object);
+
+  bool FindPathInHash(fxl::StringView archive_path, uint64_t* index) const;
+  // Sets |data| to the data stored for |entry|, using |storage| to hold it if
+  // the archive is not mapped.
+  bool GetStoredData(const DirectoryTableEntry& entry,
+                     fxl::StringView* data,
+                     std::string* storage) const;
+  bool CopyEntryToFile(const DirectoryTableEntry& entry, int dst_fd) const;
 
   const IndexEntry* GetIndexEntry(uint64_t type) const;
 
   fxl::UniqueFD fd_;
+  bool allow_mapping_ = true;
+  files::MappedFile mapping_;
   std::vector<IndexEntry> index_;
-  std::vector<DirectoryTableEntry> directory_table_;
-  std::vector<char> path_data_;
+  Chunk<DirectoryTableEntry> directory_table_;
+  Chunk<char> path_data_;
+  // Empty if the archive has no usable path hash table, in which case paths
+  // are found by binary search.
+  Chunk<PathHashSlot> path_hash_slots_;
 };
 
 }  // namespace archive
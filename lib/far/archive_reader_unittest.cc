@@ -0,0 +1,254 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/lib/far/archive_reader.h"
+
+#include <fcntl.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "garnet/lib/far/archive_writer.h"
+#include "garnet/lib/far/file_operations.h"
+#include "garnet/lib/far/format.h"
+#include "garnet/lib/far/test_archive.h"
+#include "gtest/gtest.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/strings/string_printf.h"
+
+namespace archive {
+namespace {
+
+uint32_t Hash(const std::string& path) {
+  return HashPath(path.data(), path.size());
+}
+
+// Returns |count| paths whose hashes all map to |slot| in a table of
+// |slot_count| slots.
+std::vector<std::string> PathsForSlot(uint32_t slot,
+                                      uint32_t slot_count,
+                                      size_t count) {
+  std::vector<std::string> paths;
+  for (uint32_t i = 0; paths.size() < count; ++i) {
+    std::string path = fxl::StringPrintf("slot/%u", i);
+    if ((Hash(path) & (slot_count - 1)) == slot)
+      paths.push_back(path);
+  }
+  return paths;
+}
+
+// Checks that every path in |files| is found at its index in the directory,
+// and that its contents can be read.
+void ExpectAllPathsFound(const ArchiveReader& reader, const TestFiles& files) {
+  uint64_t expected_index = 0;
+  for (const auto& file : files) {
+    uint64_t index = 0;
+    EXPECT_TRUE(reader.GetDirectoryIndexByPath(file.first, &index))
+        << file.first;
+    EXPECT_EQ(expected_index++, index) << file.first;
+    std::string contents;
+    EXPECT_TRUE(ReadTestFile(reader, file.first, &contents)) << file.first;
+    EXPECT_EQ(file.second, contents) << file.first;
+  }
+}
+
+// Returns the offset of the chunk of type |type| in the archive at |path|,
+// or zero if there is none.
+uint64_t FindChunk(const std::string& path, uint64_t type) {
+  fxl::UniqueFD fd(open(path.c_str(), O_RDONLY));
+  IndexChunk index;
+  if (!ReadFromFileAt(fd.get(), 0, reinterpret_cast<char*>(&index),
+                      sizeof(index)))
+    return 0;
+  for (uint64_t offset = sizeof(index); offset < sizeof(index) + index.length;
+       offset += sizeof(IndexEntry)) {
+    IndexEntry entry;
+    if (!ReadFromFileAt(fd.get(), offset, reinterpret_cast<char*>(&entry),
+                        sizeof(entry)))
+      return 0;
+    if (entry.type == type)
+      return entry.offset;
+  }
+  return 0;
+}
+
+TEST(ArchiveReaderTest, FindsPathsInHash) {
+  TestFiles files;
+  for (int i = 0; i < 100; ++i)
+    files[fxl::StringPrintf("dir%d/file%d", i % 7, i)] = std::to_string(i);
+
+  files::ScopedTempDir temp_dir;
+  ArchiveWriter writer;
+  std::string archive_path = WriteTestArchive(files, &temp_dir, &writer);
+  ASSERT_FALSE(archive_path.empty());
+  EXPECT_NE(0u, FindChunk(archive_path, kPathHashType));
+
+  ArchiveReader reader(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+  ASSERT_TRUE(reader.Read());
+  ExpectAllPathsFound(reader, files);
+
+  uint64_t index = 0;
+  EXPECT_FALSE(reader.GetDirectoryIndexByPath("dir0", &index));
+  EXPECT_FALSE(reader.GetDirectoryIndexByPath("dir0/file1", &index));
+  EXPECT_FALSE(reader.GetDirectoryIndexByPath("", &index));
+}
+
+TEST(ArchiveReaderTest, FindsPathsWithCollidingHashes) {
+  // Find two paths with the same hash.
+  std::unordered_map<uint32_t, std::string> paths_by_hash;
+  std::string first;
+  std::string second;
+  for (uint32_t i = 0; second.empty(); ++i) {
+    std::string path = fxl::StringPrintf("collide/%u", i);
+    auto result = paths_by_hash.emplace(Hash(path), path);
+    if (!result.second) {
+      first = result.first->second;
+      second = path;
+    }
+  }
+  ASSERT_EQ(Hash(first), Hash(second));
+
+  TestFiles files = {{first, "first"}, {second, "second"}, {"other", "x"}};
+  files::ScopedTempDir temp_dir;
+  ArchiveWriter writer;
+  std::string archive_path = WriteTestArchive(files, &temp_dir, &writer);
+  ASSERT_FALSE(archive_path.empty());
+
+  ArchiveReader reader(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+  ASSERT_TRUE(reader.Read());
+  ExpectAllPathsFound(reader, files);
+}
+
+TEST(ArchiveReaderTest, ProbesLinearlyFromCollidingSlots) {
+  // Four entries get a table of eight slots. Three paths that start probing
+  // at the last slot wrap around to the first ones, where the fourth path
+  // has to move along in turn.
+  constexpr uint32_t kSlotCount = 8;
+  std::vector<std::string> last_slot =
+      PathsForSlot(kSlotCount - 1, kSlotCount, 4);
+  std::vector<std::string> first_slot = PathsForSlot(0, kSlotCount, 2);
+
+  TestFiles files;
+  for (size_t i = 0; i < 3; ++i)
+    files[last_slot[i]] = last_slot[i];
+  files[first_slot[0]] = first_slot[0];
+
+  files::ScopedTempDir temp_dir;
+  ArchiveWriter writer;
+  std::string archive_path = WriteTestArchive(files, &temp_dir, &writer);
+  ASSERT_FALSE(archive_path.empty());
+
+  ArchiveReader reader(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+  ASSERT_TRUE(reader.Read());
+  ExpectAllPathsFound(reader, files);
+
+  // Paths that are not in the archive are probed for until an empty slot.
+  uint64_t index = 0;
+  EXPECT_FALSE(reader.GetDirectoryIndexByPath(last_slot[3], &index));
+  EXPECT_FALSE(reader.GetDirectoryIndexByPath(first_slot[1], &index));
+}
+
+TEST(ArchiveReaderTest, IgnoresPathHashWithUnknownAlgorithm) {
+  TestFiles files = {{"a", "1"}, {"b/c", "2"}, {"b/d", "3"}, {"e", "4"}};
+  files::ScopedTempDir temp_dir;
+  ArchiveWriter writer;
+  std::string archive_path = WriteTestArchive(files, &temp_dir, &writer);
+  ASSERT_FALSE(archive_path.empty());
+
+  // The path hash chunk is only an accelerator, so readers that do not
+  // understand it search the directory instead.
+  uint64_t path_hash_offset = FindChunk(archive_path, kPathHashType);
+  ASSERT_NE(0u, path_hash_offset);
+  {
+    fxl::UniqueFD fd(open(archive_path.c_str(), O_RDWR));
+    uint32_t algorithm = kPathHashAlgorithm + 1;
+    ASSERT_TRUE(WriteToFileAt(fd.get(), path_hash_offset,
+                              reinterpret_cast<const char*>(&algorithm),
+                              sizeof(algorithm)));
+  }
+
+  ArchiveReader reader(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+  ASSERT_TRUE(reader.Read());
+  ExpectAllPathsFound(reader, files);
+}
+
+TEST(ArchiveReaderTest, MappedAndUnmappedReadersAgree) {
+  TestFiles files = {
+      {"empty", ""},
+      {"small", "small"},
+      {"lib/large", std::string(3 * 4096 + 123, 'x')},
+      {"lib/page", std::string(4096, 'p')},
+  };
+  for (size_t i = 0; i < files["lib/large"].size(); i += 97)
+    files["lib/large"][i] = 'a' + i % 26;
+
+  files::ScopedTempDir temp_dir;
+  ArchiveWriter writer;
+  std::string archive_path = WriteTestArchive(files, &temp_dir, &writer);
+  ASSERT_FALSE(archive_path.empty());
+
+  ArchiveReader mapped(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+  ASSERT_TRUE(mapped.Read());
+  EXPECT_TRUE(mapped.is_mapped());
+  ArchiveReader unmapped(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+  unmapped.set_allow_mapping(false);
+  ASSERT_TRUE(unmapped.Read());
+  EXPECT_FALSE(unmapped.is_mapped());
+
+  ASSERT_EQ(files.size(), mapped.file_count());
+  ASSERT_EQ(files.size(), unmapped.file_count());
+  ExpectAllPathsFound(mapped, files);
+  ExpectAllPathsFound(unmapped, files);
+
+  for (uint64_t i = 0; i < files.size(); ++i) {
+    DirectoryTableEntry mapped_entry;
+    DirectoryTableEntry unmapped_entry;
+    ASSERT_TRUE(mapped.GetDirectoryEntryByIndex(i, &mapped_entry));
+    ASSERT_TRUE(unmapped.GetDirectoryEntryByIndex(i, &unmapped_entry));
+    EXPECT_EQ(mapped_entry.data_offset, unmapped_entry.data_offset);
+    EXPECT_EQ(mapped_entry.data_length, unmapped_entry.data_length);
+    fxl::StringView path = mapped.GetPathView(mapped_entry);
+    EXPECT_EQ(path, unmapped.GetPathView(unmapped_entry));
+    const std::string& contents = files[path.ToString()];
+
+    // Only mapped archives can hand out their contents in place.
+    fxl::StringView view;
+    EXPECT_TRUE(mapped.GetContentView(mapped_entry, &view));
+    EXPECT_EQ(contents, view);
+    EXPECT_FALSE(unmapped.GetContentView(unmapped_entry, &view));
+
+    // Reads of part of a file, and past its end.
+    if (contents.size() > 2) {
+      std::string mapped_part(contents.size() - 2, '\0');
+      std::string unmapped_part(contents.size() - 2, '\0');
+      EXPECT_TRUE(mapped.ReadContents(mapped_entry, 1, mapped_part.size(),
+                                      &mapped_part[0]));
+      EXPECT_TRUE(unmapped.ReadContents(unmapped_entry, 1,
+                                        unmapped_part.size(),
+                                        &unmapped_part[0]));
+      EXPECT_EQ(contents.substr(1, contents.size() - 2), mapped_part);
+      EXPECT_EQ(mapped_part, unmapped_part);
+    }
+    char byte;
+    EXPECT_FALSE(mapped.ReadContents(mapped_entry, contents.size(), 1, &byte));
+    EXPECT_FALSE(
+        unmapped.ReadContents(unmapped_entry, contents.size(), 1, &byte));
+
+    // Copies out of the archive.
+    for (const ArchiveReader* reader : {&mapped, &unmapped}) {
+      std::string output_path;
+      ASSERT_TRUE(temp_dir.NewTempFile(&output_path));
+      ASSERT_TRUE(reader->ExtractFile(path, output_path.c_str()));
+      std::string output;
+      ASSERT_TRUE(files::ReadFileToString(output_path, &output));
+      EXPECT_EQ(contents, output) << path;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace archive
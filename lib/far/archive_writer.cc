@@ -14,19 +14,82 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <limits>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "garnet/lib/far/alignment.h"
+#include "garnet/lib/far/compressed_contents.h"
 #include "garnet/lib/far/file_operations.h"
 #include "garnet/lib/far/format.h"
 #include "lib/fxl/files/file_descriptor.h"
+#include "lib/fxl/files/mapped_file.h"
 #include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/logging.h"
 
 namespace archive {
+namespace {
 
-ArchiveWriter::ArchiveWriter() = default;
+// Copying or compressing more files at once than this gains little.
+constexpr size_t kMaxThreads = 8;
+
+// Hashes file contents a word at a time. Only used to find candidates for
+// deduplication, which are then compared in full.
+uint64_t HashContents(fxl::StringView contents) {
+  constexpr uint64_t kMultiplier = 0x9e3779b97f4a7c15ull;
+  uint64_t hash = contents.size();
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= contents.size(); i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, contents.data() + i, sizeof(word));
+    hash = (hash ^ word) * kMultiplier;
+    hash ^= hash >> 29;
+  }
+  for (; i < contents.size(); ++i)
+    hash = (hash ^ static_cast<uint8_t>(contents[i])) * kMultiplier;
+  return hash ^ (hash >> 32);
+}
+
+// Runs |task| for each index below |count| on up to |thread_count| threads,
+// stopping early if any of them fails.
+bool RunInParallel(size_t count,
+                   size_t thread_count,
+                   const std::function<bool(size_t)>& task) {
+  std::atomic<size_t> next(0u);
+  std::atomic<bool> failed(false);
+  auto run_tasks = [&] {
+    for (size_t i = next++; i < count && !failed; i = next++) {
+      if (!task(i))
+        failed = true;
+    }
+  };
+
+  thread_count = std::min({thread_count, kMaxThreads, count});
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i)
+    threads.emplace_back(run_tasks);
+  run_tasks();
+  for (auto& thread : threads)
+    thread.join();
+  return !failed;
+}
+
+bool HaveSameContents(const std::string& lhs_path,
+                      const std::string& rhs_path) {
+  files::MappedFile lhs;
+  files::MappedFile rhs;
+  return lhs.Open(lhs_path) && rhs.Open(rhs_path) &&
+         lhs.view() == rhs.view();
+}
+
+}  // namespace
+
+ArchiveWriter::ArchiveWriter()
+    : copy_thread_count_(std::max(1u, std::thread::hardware_concurrency())) {}
 
 ArchiveWriter::~ArchiveWriter() = default;
 
@@ -57,7 +120,9 @@ bool ArchiveWriter::Write(int fd) {
     return false;
   }
 
-  uint64_t index_count = entries_.empty() ? 0 : 2;
+  // Very large archives get by without a path hash table, which is optional.
+  bool has_path_hash = entries_.size() <= kMaxPathHashEntries;
+  uint64_t index_count = entries_.empty() ? 0 : (has_path_hash ? 3 : 2);
   uint64_t next_chunk = 0;
 
   IndexChunk index;
@@ -81,6 +146,21 @@ bool ArchiveWriter::Write(int fd) {
     return false;
   }
 
+  std::vector<PathHashSlot> path_hash_slots;
+  if (has_path_hash) {
+    path_hash_slots = BuildPathHashSlots();
+    IndexEntry path_hash_entry;
+    path_hash_entry.type = kPathHashType;
+    path_hash_entry.offset = next_chunk;
+    path_hash_entry.length = sizeof(PathHashChunk) +
+                             path_hash_slots.size() * sizeof(PathHashSlot);
+    next_chunk += path_hash_entry.length;
+    if (!WriteObject(fd, path_hash_entry)) {
+      fprintf(stderr, "error: Failed to write path hash index chunk.\n");
+      return false;
+    }
+  }
+
   IndexEntry dirnames_entry;
   dirnames_entry.type = kDirnamesType;
   dirnames_entry.offset = next_chunk;
@@ -91,34 +171,93 @@ bool ArchiveWriter::Write(int fd) {
     return false;
   }
 
-  uint32_t name_offset = 0;
-  uint64_t data_offset = AlignToPage(next_chunk);
-  std::vector<DirectoryTableEntry> directory_table(entries_.size());
+  std::vector<uint64_t> data_lengths(entries_.size());
   for (size_t i = 0; i < entries_.size(); ++i) {
-    const ArchiveEntry& entry = entries_[i];
-    DirectoryTableEntry& directory_entry = directory_table[i];
-
     struct stat info;
-    if (stat(entry.src_path.c_str(), &info) != 0) {
+    if (stat(entries_[i].src_path.c_str(), &info) != 0) {
       fprintf(stderr, "error: Failed to read length of file: %s\n",
-              entry.src_path.c_str());
+              entries_[i].src_path.c_str());
       return false;
     }
-    uint64_t data_length = info.st_size;
+    data_lengths[i] = info.st_size;
+  }
 
-    if (data_length > std::numeric_limits<uint64_t>::max() - data_offset) {
-      fprintf(stderr, "error: File overflowed total archive size: %s\n",
-              entry.src_path.c_str());
-      return false;
+  // Entries whose contents are stored elsewhere in the archive point at the
+  // earlier entry with the same contents.
+  std::vector<size_t> sources(entries_.size());
+  for (size_t i = 0; i < entries_.size(); ++i)
+    sources[i] = i;
+  if (deduplicate_contents_ && !FindDuplicateContents(data_lengths, &sources))
+    return false;
+
+  // Offsets are assigned and contents written a batch of entries at a time.
+  // The length of compressed contents is only known once they have been
+  // compressed, so they are held in memory until written; batching bounds
+  // that to one file per thread. The contents are written with positioned
+  // writes, which leave the file position at the directory table.
+  size_t batch_size =
+      compress_contents_ ? copy_thread_count_ : entries_.size();
+  uint32_t name_offset = 0;
+  uint64_t data_offset = AlignToPage(next_chunk);
+  uint64_t data_end = data_offset;
+  std::vector<DirectoryTableEntry> directory_table(entries_.size());
+  for (size_t begin = 0; begin < entries_.size(); begin += batch_size) {
+    size_t end = std::min(entries_.size(), begin + batch_size);
+
+    // The entries in the batch whose contents are stored with them.
+    std::vector<size_t> copies;
+    for (size_t i = begin; i < end; ++i) {
+      if (sources[i] == i && data_lengths[i])
+        copies.push_back(i);
     }
 
-    directory_entry.name_offset = name_offset;
-    directory_entry.name_length = entry.dst_path.size();
-    directory_entry.data_offset = data_offset;
-    directory_entry.data_length = data_length;
+    // The data of the copies that are stored compressed.
+    std::vector<std::string> compressed(copies.size());
+    if (compress_contents_ &&
+        !CompressContents(data_lengths, copies, &compressed))
+      return false;
+
+    size_t copy = 0;
+    for (size_t i = begin; i < end; ++i) {
+      const ArchiveEntry& entry = entries_[i];
+      DirectoryTableEntry& directory_entry = directory_table[i];
 
-    name_offset += directory_entry.name_length;
-    data_offset = AlignToPage(data_offset + data_length);
+      directory_entry.name_offset = name_offset;
+      directory_entry.name_length = entry.dst_path.size();
+      name_offset += directory_entry.name_length;
+
+      if (sources[i] != i) {
+        // Sources come before their duplicates, so they are already placed.
+        const DirectoryTableEntry& source = directory_table[sources[i]];
+        directory_entry.flags = source.flags;
+        directory_entry.data_offset = source.data_offset;
+        directory_entry.data_length = source.data_length;
+        continue;
+      }
+
+      uint64_t data_length = data_lengths[i];
+      if (data_length) {
+        FXL_DCHECK(copies[copy] == i);
+        const std::string& data = compressed[copy++];
+        if (!data.empty()) {
+          directory_entry.flags |= kDirectoryEntryCompressed;
+          data_length = data.size();
+        }
+      }
+      directory_entry.data_length = data_length;
+
+      if (data_length > std::numeric_limits<uint64_t>::max() - data_offset) {
+        fprintf(stderr, "error: File overflowed total archive size: %s\n",
+                entry.src_path.c_str());
+        return false;
+      }
+      directory_entry.data_offset = data_offset;
+      data_end = data_offset + data_length;
+      data_offset = AlignToPage(data_end);
+    }
+
+    if (!WriteContents(fd, directory_table, copies, compressed))
+      return false;
   }
 
   if (!WriteVector(fd, directory_table)) {
@@ -126,6 +265,15 @@ bool ArchiveWriter::Write(int fd) {
     return false;
   }
 
+  if (has_path_hash) {
+    PathHashChunk path_hash;
+    path_hash.slot_count = path_hash_slots.size();
+    if (!WriteObject(fd, path_hash) || !WriteVector(fd, path_hash_slots)) {
+      fprintf(stderr, "error: Failed to write path hash table.\n");
+      return false;
+    }
+  }
+
   std::vector<char> path_data(total_path_length_);
   char* pos = path_data.data();
   for (const auto& entry : entries_) {
@@ -138,32 +286,117 @@ bool ArchiveWriter::Write(int fd) {
     return false;
   }
 
+  if (ftruncate(fd, AlignToPage(data_end)) < 0) {
+    fprintf(stderr, "error: Failed to truncate archive to proper length.\n");
+    return false;
+  }
+
+  return true;
+}
+
+bool ArchiveWriter::FindDuplicateContents(
+    const std::vector<uint64_t>& data_lengths,
+    std::vector<size_t>* sources) const {
+  // Only files of the same length can have the same contents, so most files
+  // need not be read at all.
+  std::unordered_map<uint64_t, size_t> length_counts;
+  for (uint64_t length : data_lengths)
+    ++length_counts[length];
+
+  // Entries with distinct contents, by contents hash.
+  std::unordered_map<uint64_t, std::vector<size_t>> originals;
   for (size_t i = 0; i < entries_.size(); ++i) {
-    const ArchiveEntry& entry = entries_[i];
-    const DirectoryTableEntry& directory_entry = directory_table[i];
+    if (!data_lengths[i] || length_counts[data_lengths[i]] < 2)
+      continue;
 
-    if (lseek(fd, directory_entry.data_offset, SEEK_SET) < 0) {
-      fprintf(stderr, "error: Failed to seek to data offset.\n");
-      return false;
+    uint64_t hash;
+    {
+      files::MappedFile file;
+      if (!file.Open(entries_[i].src_path)) {
+        fprintf(stderr, "error: Failed to read file: %s\n",
+                entries_[i].src_path.c_str());
+        return false;
+      }
+      hash = HashContents(file.view());
     }
-    if (!CopyPathToFile(entry.src_path.c_str(), fd,
-                        directory_entry.data_length)) {
-      fprintf(stderr, "error: Failed to write file data: %s\n",
-              entry.src_path.c_str());
-      return false;
+
+    std::vector<size_t>& candidates = originals[hash];
+    for (size_t candidate : candidates) {
+      if (data_lengths[candidate] == data_lengths[i] &&
+          HaveSameContents(entries_[candidate].src_path,
+                           entries_[i].src_path)) {
+        (*sources)[i] = candidate;
+        break;
+      }
     }
+    if ((*sources)[i] == i)
+      candidates.push_back(i);
   }
+  return true;
+}
 
-  if (!entries_.empty()) {
-    const DirectoryTableEntry& directory_entry = directory_table.back();
-    uint64_t end = directory_entry.data_offset + directory_entry.data_length;
-    if (ftruncate(fd, AlignToPage(end)) < 0) {
-      fprintf(stderr, "error: Failed to truncate archive to proper length.\n");
+bool ArchiveWriter::CompressContents(
+    const std::vector<uint64_t>& data_lengths,
+    const std::vector<size_t>& copies,
+    std::vector<std::string>* compressed) const {
+  return RunInParallel(copies.size(), copy_thread_count_, [&](size_t copy) {
+    size_t i = copies[copy];
+    files::MappedFile file;
+    if (!file.Open(entries_[i].src_path) || file.size() != data_lengths[i] ||
+        !archive::CompressContents(file.view(), kDefaultCompressedFrameSize,
+                                   &(*compressed)[copy])) {
+      fprintf(stderr, "error: Failed to compress file: %s\n",
+              entries_[i].src_path.c_str());
       return false;
     }
-  }
+    // Files that do not shrink are stored as they are.
+    if ((*compressed)[copy].size() >= data_lengths[i])
+      std::string().swap((*compressed)[copy]);
+    return true;
+  });
+}
 
-  return true;
+bool ArchiveWriter::WriteContents(
+    int fd,
+    const std::vector<DirectoryTableEntry>& directory_table,
+    const std::vector<size_t>& copies,
+    const std::vector<std::string>& compressed) const {
+  return RunInParallel(copies.size(), copy_thread_count_, [&](size_t copy) {
+    size_t i = copies[copy];
+    const ArchiveEntry& entry = entries_[i];
+    const DirectoryTableEntry& directory_entry = directory_table[i];
+    bool written =
+        compressed[copy].empty()
+            ? CopyPathToFileAt(entry.src_path.c_str(), fd,
+                               directory_entry.data_offset,
+                               directory_entry.data_length)
+            : WriteToFileAt(fd, directory_entry.data_offset,
+                            compressed[copy].data(), compressed[copy].size());
+    if (!written) {
+      fprintf(stderr, "error: Failed to write file data: %s\n",
+              entry.src_path.c_str());
+    }
+    return written;
+  });
+}
+
+std::vector<PathHashSlot> ArchiveWriter::BuildPathHashSlots() const {
+  // Keep the table at most half full so that probe sequences stay short.
+  uint32_t slot_count = 1;
+  while (slot_count < 2 * entries_.size())
+    slot_count *= 2;
+
+  std::vector<PathHashSlot> slots(slot_count);
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const std::string& path = entries_[i].dst_path;
+    uint32_t hash = HashPath(path.data(), path.size());
+    uint32_t slot = hash & (slot_count - 1);
+    while (slots[slot].index != kEmptyPathHashSlot)
+      slot = (slot + 1) & (slot_count - 1);
+    slots[slot].hash = hash;
+    slots[slot].index = i;
+  }
+  return slots;
 }
 
 bool ArchiveWriter::HasDuplicateEntries() {
@@ -5,11 +5,15 @@
 #ifndef GARNET_LIB_FAR_ARCHIVE_WRITER_H_
 #define GARNET_LIB_FAR_ARCHIVE_WRITER_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <string>
 #include <vector>
 
 #include "garnet/lib/far/archive_entry.h"
+#include "garnet/lib/far/format.h"
 
 namespace archive {
 
@@ -22,12 +26,53 @@ class ArchiveWriter {
   bool Add(ArchiveEntry entry);
   bool Write(int fd);
 
+  // Whether to store files with identical contents only once, with all of
+  // their directory entries pointing at the same data. Off by default.
+  void set_deduplicate_contents(bool deduplicate_contents) {
+    deduplicate_contents_ = deduplicate_contents;
+  }
+
+  // Whether to compress the contents of files that shrink when compressed.
+  // Compressed files can only be read through |ArchiveReader| and
+  // |FileSystem|, not mapped straight out of the archive. Off by default.
+  void set_compress_contents(bool compress_contents) {
+    compress_contents_ = compress_contents;
+  }
+
+  // How many threads may compress and copy file contents at once.
+  // Defaults to the number of processors.
+  void set_copy_thread_count(size_t copy_thread_count) {
+    copy_thread_count_ = std::max<size_t>(copy_thread_count, 1u);
+  }
+
  private:
+  // Archives with more entries than this are written without a path hash
+  // table, so that its slot count fits in 32 bits.
+  static constexpr size_t kMaxPathHashEntries = 1u << 30;
+
+  std::vector<PathHashSlot> BuildPathHashSlots() const;
   bool HasDuplicateEntries();
+  bool FindDuplicateContents(const std::vector<uint64_t>& data_lengths,
+                             std::vector<size_t>* sources) const;
+  // Compresses the contents of the entries at the indices in |copies| into
+  // the corresponding elements of |compressed|, leaving those that do not
+  // shrink empty.
+  bool CompressContents(const std::vector<uint64_t>& data_lengths,
+                        const std::vector<size_t>& copies,
+                        std::vector<std::string>* compressed) const;
+  // Writes the contents of the entries at the indices in |copies|, using the
+  // corresponding elements of |compressed| where they are not empty.
+  bool WriteContents(int fd,
+                     const std::vector<DirectoryTableEntry>& directory_table,
+                     const std::vector<size_t>& copies,
+                     const std::vector<std::string>& compressed) const;
 
   std::vector<ArchiveEntry> entries_;
   bool dirty_ = true;
   uint64_t total_path_length_ = 0;
+  bool deduplicate_contents_ = false;
+  bool compress_contents_ = false;
+  size_t copy_thread_count_;
 };
 
 }  // namespace archive
@@ -0,0 +1,126 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/lib/far/archive_writer.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <set>
+#include <string>
+
+#include "garnet/lib/far/archive_reader.h"
+#include "garnet/lib/far/test_archive.h"
+#include "gtest/gtest.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/strings/string_printf.h"
+
+namespace archive {
+namespace {
+
+// Files with repeated contents, including files of the same length but
+// different contents, which deduplication must tell apart.
+TestFiles MakeFilesWithDuplicates() {
+  std::string page(4096, 'p');
+  std::string other_page(4096, 'p');
+  other_page[4095] = 'q';
+
+  TestFiles files;
+  for (int i = 0; i < 20; ++i) {
+    files[fxl::StringPrintf("a/page%d", i)] = i % 2 ? page : other_page;
+    files[fxl::StringPrintf("b/unique%d", i)] = std::to_string(i);
+    files[fxl::StringPrintf("c/same%d", i)] = "same";
+    files[fxl::StringPrintf("d/empty%d", i)] = std::string();
+  }
+  return files;
+}
+
+uint64_t FileSize(const std::string& path) {
+  struct stat info;
+  return stat(path.c_str(), &info) == 0 ? info.st_size : 0u;
+}
+
+// Returns the number of distinct data offsets of non-empty files in the
+// archive read by |reader|.
+size_t CountStoredContents(const ArchiveReader& reader) {
+  std::set<uint64_t> offsets;
+  reader.ListDirectory([&offsets](const DirectoryTableEntry& entry) {
+    if (entry.data_length)
+      offsets.insert(entry.data_offset);
+  });
+  return offsets.size();
+}
+
+TEST(ArchiveWriterTest, DeduplicatesContents) {
+  TestFiles files = MakeFilesWithDuplicates();
+
+  files::ScopedTempDir temp_dir;
+  ArchiveWriter writer;
+  writer.set_deduplicate_contents(true);
+  writer.set_copy_thread_count(4);
+  std::string archive_path = WriteTestArchive(files, &temp_dir, &writer);
+  ASSERT_FALSE(archive_path.empty());
+
+  ArchiveReader reader(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+  ASSERT_TRUE(reader.Read());
+  ASSERT_EQ(files.size(), reader.file_count());
+  for (const auto& file : files) {
+    std::string contents;
+    EXPECT_TRUE(ReadTestFile(reader, file.first, &contents)) << file.first;
+    EXPECT_EQ(file.second, contents) << file.first;
+  }
+
+  // Two pages, twenty unique strings and "same".
+  EXPECT_EQ(23u, CountStoredContents(reader));
+}
+
+TEST(ArchiveWriterTest, DeduplicationOnlySavesSpace) {
+  TestFiles files = MakeFilesWithDuplicates();
+
+  files::ScopedTempDir temp_dir;
+  ArchiveWriter plain_writer;
+  std::string plain_path = WriteTestArchive(files, &temp_dir, &plain_writer);
+  ASSERT_FALSE(plain_path.empty());
+  ArchiveWriter dedup_writer;
+  dedup_writer.set_deduplicate_contents(true);
+  std::string dedup_path = WriteTestArchive(files, &temp_dir, &dedup_writer);
+  ASSERT_FALSE(dedup_path.empty());
+
+  EXPECT_LT(FileSize(dedup_path), FileSize(plain_path));
+
+  ArchiveReader plain(fxl::UniqueFD(open(plain_path.c_str(), O_RDONLY)));
+  ASSERT_TRUE(plain.Read());
+  ArchiveReader dedup(fxl::UniqueFD(open(dedup_path.c_str(), O_RDONLY)));
+  ASSERT_TRUE(dedup.Read());
+  EXPECT_EQ(60u, CountStoredContents(plain));
+  for (const auto& file : files) {
+    std::string plain_contents;
+    std::string dedup_contents;
+    EXPECT_TRUE(ReadTestFile(plain, file.first, &plain_contents));
+    EXPECT_TRUE(ReadTestFile(dedup, file.first, &dedup_contents));
+    EXPECT_EQ(plain_contents, dedup_contents) << file.first;
+  }
+}
+
+TEST(ArchiveWriterTest, ThreadCountDoesNotChangeArchive) {
+  TestFiles files = MakeFilesWithDuplicates();
+
+  files::ScopedTempDir temp_dir;
+  std::string archives[2];
+  size_t thread_counts[2] = {1, 8};
+  for (size_t i = 0; i < 2; ++i) {
+    ArchiveWriter writer;
+    writer.set_deduplicate_contents(true);
+    writer.set_copy_thread_count(thread_counts[i]);
+    std::string path = WriteTestArchive(files, &temp_dir, &writer);
+    ASSERT_FALSE(path.empty());
+    ASSERT_TRUE(files::ReadFileToString(path, &archives[i]));
+  }
+  EXPECT_TRUE(archives[0] == archives[1]);
+}
+
+}  // namespace
+}  // namespace archive
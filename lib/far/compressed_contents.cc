@@ -0,0 +1,161 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/lib/far/compressed_contents.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <zlib.h>
+
+namespace archive {
+namespace {
+
+// zlib counts bytes in |uInt|s, so frames must be no larger than this.
+constexpr uint32_t kMaxFrameSize = 1u << 30;
+
+// Raw deflate, without the zlib header and checksum around every frame.
+constexpr int kRawDeflateWindowBits = -15;
+
+uint64_t LoadUint64(const char* data) {
+  uint64_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+bool CompressContents(fxl::StringView contents,
+                      uint32_t frame_size,
+                      std::string* output) {
+  if (frame_size == 0 || frame_size > kMaxFrameSize)
+    return false;
+
+  CompressedContentHeader header;
+  header.frame_size = frame_size;
+  header.uncompressed_length = contents.size();
+  uint64_t frame_count = (contents.size() + frame_size - 1) / frame_size;
+
+  z_stream stream = {};
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                   kRawDeflateWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  std::vector<uint64_t> seek_table(frame_count);
+  std::string frames;
+  bool ok = true;
+  for (uint64_t frame = 0; frame < frame_count && ok; ++frame) {
+    fxl::StringView input = contents.substr(frame * frame_size, frame_size);
+    size_t start = frames.size();
+    frames.resize(start + deflateBound(&stream, input.size()));
+
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = input.size();
+    stream.next_out = reinterpret_cast<Bytef*>(&frames[start]);
+    stream.avail_out = frames.size() - start;
+    ok = deflate(&stream, Z_FINISH) == Z_STREAM_END &&
+         deflateReset(&stream) == Z_OK;
+
+    frames.resize(frames.size() - stream.avail_out);
+    seek_table[frame] = frames.size();
+  }
+  deflateEnd(&stream);
+  if (!ok)
+    return false;
+
+  output->clear();
+  output->reserve(sizeof(header) + frame_count * sizeof(uint64_t) +
+                  frames.size());
+  output->append(reinterpret_cast<const char*>(&header), sizeof(header));
+  output->append(reinterpret_cast<const char*>(seek_table.data()),
+                 frame_count * sizeof(uint64_t));
+  output->append(frames);
+  return true;
+}
+
+CompressedContents::CompressedContents() = default;
+
+CompressedContents::~CompressedContents() = default;
+
+bool CompressedContents::Init(fxl::StringView data) {
+  if (data.size() < sizeof(header_))
+    return false;
+  memcpy(&header_, data.data(), sizeof(header_));
+  if (header_.magic != kCompressedContentMagic ||
+      header_.algorithm != kCompressionDeflate || header_.frame_size == 0 ||
+      header_.frame_size > kMaxFrameSize)
+    return false;
+
+  frame_count_ = header_.uncompressed_length / header_.frame_size +
+                 (header_.uncompressed_length % header_.frame_size != 0);
+  if (frame_count_ > (data.size() - sizeof(header_)) / sizeof(uint64_t))
+    return false;
+
+  seek_table_ = data.data() + sizeof(header_);
+  frame_data_ =
+      data.substr(sizeof(header_) + frame_count_ * sizeof(uint64_t));
+  if (frame_count_ &&
+      LoadUint64(seek_table_ + (frame_count_ - 1) * sizeof(uint64_t)) !=
+          frame_data_.size())
+    return false;
+
+  loaded_frame_ = std::numeric_limits<uint64_t>::max();
+  compressed_bytes_read_ = 0;
+  return true;
+}
+
+bool CompressedContents::Read(uint64_t offset, size_t length, char* buffer) {
+  if (offset > size() || length > size() - offset)
+    return false;
+
+  while (length) {
+    uint64_t frame = offset / header_.frame_size;
+    if (!LoadFrame(frame))
+      return false;
+    size_t frame_offset = offset - frame * header_.frame_size;
+    size_t count = std::min(length, frame_buffer_.size() - frame_offset);
+    memcpy(buffer, frame_buffer_.data() + frame_offset, count);
+    buffer += count;
+    offset += count;
+    length -= count;
+  }
+  return true;
+}
+
+bool CompressedContents::LoadFrame(uint64_t frame) {
+  if (frame == loaded_frame_)
+    return true;
+
+  uint64_t begin =
+      frame ? LoadUint64(seek_table_ + (frame - 1) * sizeof(uint64_t)) : 0u;
+  uint64_t end = LoadUint64(seek_table_ + frame * sizeof(uint64_t));
+  if (begin > end || end > frame_data_.size() ||
+      end - begin > std::numeric_limits<uInt>::max())
+    return false;
+
+  uint64_t frame_start = frame * header_.frame_size;
+  frame_buffer_.resize(std::min<uint64_t>(
+      header_.frame_size, header_.uncompressed_length - frame_start));
+
+  z_stream stream = {};
+  if (inflateInit2(&stream, kRawDeflateWindowBits) != Z_OK)
+    return false;
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(frame_data_.data() + begin));
+  stream.avail_in = end - begin;
+  stream.next_out = reinterpret_cast<Bytef*>(frame_buffer_.data());
+  stream.avail_out = frame_buffer_.size();
+  bool ok = inflate(&stream, Z_FINISH) == Z_STREAM_END &&
+            stream.avail_out == 0;
+  inflateEnd(&stream);
+
+  compressed_bytes_read_ += end - begin;
+  loaded_frame_ = ok ? frame : std::numeric_limits<uint64_t>::max();
+  return ok;
+}
+
+}  // namespace archive
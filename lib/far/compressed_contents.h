@@ -0,0 +1,67 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_LIB_FAR_COMPRESSED_CONTENTS_H_
+#define GARNET_LIB_FAR_COMPRESSED_CONTENTS_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "garnet/lib/far/format.h"
+#include "lib/fxl/strings/string_view.h"
+
+namespace archive {
+
+constexpr uint32_t kDefaultCompressedFrameSize = 64 * 1024;
+
+// Compresses |contents| into the compressed content format described in
+// format.h, storing the result in |output|.
+bool CompressContents(fxl::StringView contents,
+                      uint32_t frame_size,
+                      std::string* output);
+
+// Reads a file stored in the compressed content format, decompressing only
+// the frames that are read. The most recently decompressed frame is kept, so
+// reading a file front to back in small pieces decompresses each frame once.
+class CompressedContents {
+ public:
+  CompressedContents();
+  ~CompressedContents();
+  CompressedContents(const CompressedContents& other) = delete;
+
+  // |data| is the data of a compressed file, and must outlive this object.
+  // Returns false if it is not valid compressed content.
+  bool Init(fxl::StringView data);
+
+  // The length of the file once decompressed.
+  uint64_t size() const { return header_.uncompressed_length; }
+
+  // The number of bytes of the file in each compressed frame. Reads that
+  // stay within one frame decompress at most that frame.
+  uint32_t frame_size() const { return header_.frame_size; }
+
+  // Copies |length| bytes of the file at |offset| into |buffer|.
+  bool Read(uint64_t offset, size_t length, char* buffer);
+
+  // The number of compressed bytes decompressed so far.
+  uint64_t compressed_bytes_read() const { return compressed_bytes_read_; }
+
+ private:
+  bool LoadFrame(uint64_t frame);
+
+  CompressedContentHeader header_;
+  uint64_t frame_count_ = 0;
+  const char* seek_table_ = nullptr;
+  fxl::StringView frame_data_;
+
+  uint64_t loaded_frame_ = UINT64_MAX;
+  std::vector<char> frame_buffer_;
+  uint64_t compressed_bytes_read_ = 0;
+};
+
+}  // namespace archive
+
+#endif  // GARNET_LIB_FAR_COMPRESSED_CONTENTS_H_
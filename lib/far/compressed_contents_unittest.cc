@@ -0,0 +1,253 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/lib/far/compressed_contents.h"
+
+#include <fcntl.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "garnet/lib/far/archive_reader.h"
+#include "garnet/lib/far/archive_writer.h"
+#include "garnet/lib/far/format.h"
+#include "garnet/lib/far/test_archive.h"
+#include "gtest/gtest.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+#include "lib/fxl/files/unique_fd.h"
+
+namespace archive {
+namespace {
+
+constexpr uint32_t kFrameSize = 1000;
+
+// Text that compresses well, but not so well that every frame is the same.
+std::string MakeCompressibleContents(size_t size) {
+  std::string contents;
+  for (size_t line = 0; contents.size() < size; ++line)
+    contents += "line " + std::to_string(line) + " of the file\n";
+  contents.resize(size);
+  return contents;
+}
+
+// Bytes that do not compress.
+std::string MakeRandomContents(size_t size) {
+  std::string contents(size, '\0');
+  uint32_t state = 12345u;
+  for (char& c : contents) {
+    state = state * 1103515245u + 12345u;
+    c = static_cast<char>(state >> 24);
+  }
+  return contents;
+}
+
+// Returns the seek table of the compressed content in |data|.
+std::vector<uint64_t> GetSeekTable(const std::string& data) {
+  CompressedContentHeader header;
+  memcpy(&header, data.data(), sizeof(header));
+  uint64_t frame_count =
+      (header.uncompressed_length + header.frame_size - 1) / header.frame_size;
+  std::vector<uint64_t> seek_table(frame_count);
+  memcpy(seek_table.data(), data.data() + sizeof(header),
+         frame_count * sizeof(uint64_t));
+  return seek_table;
+}
+
+TEST(CompressedContentsTest, RoundTrip) {
+  std::string original = MakeCompressibleContents(10 * kFrameSize + 123);
+  std::string compressed;
+  ASSERT_TRUE(CompressContents(original, kFrameSize, &compressed));
+  EXPECT_LT(compressed.size(), original.size());
+
+  CompressedContents contents;
+  ASSERT_TRUE(contents.Init(compressed));
+  EXPECT_EQ(original.size(), contents.size());
+  EXPECT_EQ(kFrameSize, contents.frame_size());
+
+  std::string result(original.size(), '\0');
+  ASSERT_TRUE(contents.Read(0, result.size(), &result[0]));
+  EXPECT_EQ(original, result);
+}
+
+TEST(CompressedContentsTest, EmptyRoundTrip) {
+  std::string compressed;
+  ASSERT_TRUE(CompressContents(fxl::StringView(), kFrameSize, &compressed));
+  EXPECT_EQ(sizeof(CompressedContentHeader), compressed.size());
+
+  CompressedContents contents;
+  ASSERT_TRUE(contents.Init(compressed));
+  EXPECT_EQ(0u, contents.size());
+  char byte;
+  EXPECT_TRUE(contents.Read(0, 0, &byte));
+  EXPECT_FALSE(contents.Read(0, 1, &byte));
+}
+
+TEST(CompressedContentsTest, SeekTable) {
+  std::string original = MakeCompressibleContents(4 * kFrameSize + 1);
+  std::string compressed;
+  ASSERT_TRUE(CompressContents(original, kFrameSize, &compressed));
+
+  // One entry per frame, the last of which holds a single byte. Each entry
+  // is the end of its frame, and the last is the end of the data.
+  std::vector<uint64_t> seek_table = GetSeekTable(compressed);
+  ASSERT_EQ(5u, seek_table.size());
+  for (size_t i = 1; i < seek_table.size(); ++i)
+    EXPECT_LT(seek_table[i - 1], seek_table[i]);
+  EXPECT_EQ(compressed.size(), sizeof(CompressedContentHeader) +
+                                   seek_table.size() * sizeof(uint64_t) +
+                                   seek_table.back());
+}
+
+TEST(CompressedContentsTest, ReadsOnlyOverlappingFrames) {
+  std::string original = MakeCompressibleContents(10 * kFrameSize);
+  std::string compressed;
+  ASSERT_TRUE(CompressContents(original, kFrameSize, &compressed));
+  std::vector<uint64_t> seek_table = GetSeekTable(compressed);
+
+  CompressedContents contents;
+  ASSERT_TRUE(contents.Init(compressed));
+
+  // A read within the fourth frame decompresses just that frame.
+  char buffer[3 * kFrameSize];
+  ASSERT_TRUE(contents.Read(3 * kFrameSize + 10, 100, buffer));
+  EXPECT_EQ(original.substr(3 * kFrameSize + 10, 100),
+            std::string(buffer, 100));
+  EXPECT_EQ(seek_table[3] - seek_table[2], contents.compressed_bytes_read());
+
+  // Reading more of it does not decompress it again.
+  ASSERT_TRUE(contents.Read(3 * kFrameSize + 500, 100, buffer));
+  EXPECT_EQ(seek_table[3] - seek_table[2], contents.compressed_bytes_read());
+
+  // A read that crosses from the fourth frame through the fifth into the
+  // sixth decompresses the fifth and sixth.
+  size_t offset = 4 * kFrameSize - 1;
+  size_t length = kFrameSize + 2;
+  ASSERT_TRUE(contents.Read(offset, length, buffer));
+  EXPECT_EQ(original.substr(offset, length), std::string(buffer, length));
+  EXPECT_EQ(seek_table[5] - seek_table[2], contents.compressed_bytes_read());
+}
+
+TEST(CompressedContentsTest, ReadsAcrossFrameBoundaries) {
+  std::string original = MakeCompressibleContents(5 * kFrameSize + 7);
+  std::string compressed;
+  ASSERT_TRUE(CompressContents(original, kFrameSize, &compressed));
+
+  CompressedContents contents;
+  ASSERT_TRUE(contents.Init(compressed));
+  std::string buffer(original.size(), '\0');
+  for (size_t offset : {0u, 1u, 999u, 1000u, 1001u, 2500u, 4999u, 5000u}) {
+    for (size_t length : {1u, 2u, 1000u, 1001u, 2001u}) {
+      if (offset + length > original.size())
+        continue;
+      ASSERT_TRUE(contents.Read(offset, length, &buffer[0]));
+      EXPECT_EQ(original.substr(offset, length), buffer.substr(0, length))
+          << offset << " " << length;
+    }
+  }
+  char byte;
+  EXPECT_TRUE(contents.Read(original.size() - 1, 1, &byte));
+  EXPECT_EQ(original.back(), byte);
+  EXPECT_FALSE(contents.Read(original.size(), 1, &byte));
+  EXPECT_FALSE(contents.Read(original.size() - 1, 2, &byte));
+}
+
+TEST(CompressedContentsTest, RejectsCorruptData) {
+  std::string original = MakeCompressibleContents(3 * kFrameSize);
+  std::string compressed;
+  ASSERT_TRUE(CompressContents(original, kFrameSize, &compressed));
+  CompressedContents contents;
+
+  std::string bad_magic = compressed;
+  bad_magic[0] ^= 1;
+  EXPECT_FALSE(contents.Init(bad_magic));
+
+  EXPECT_FALSE(contents.Init(fxl::StringView(compressed).substr(0, 4)));
+  EXPECT_FALSE(contents.Init(fxl::StringView(compressed).substr(
+      0, sizeof(CompressedContentHeader) + sizeof(uint64_t))));
+
+  // The frames must end where the seek table says.
+  EXPECT_FALSE(contents.Init(
+      fxl::StringView(compressed).substr(0, compressed.size() - 1)));
+
+  // A frame that does not decompress to a whole frame is an error.
+  std::string bad_frame = compressed;
+  size_t frames_start = sizeof(CompressedContentHeader) + 3 * sizeof(uint64_t);
+  for (size_t i = frames_start; i < frames_start + 8; ++i)
+    bad_frame[i] = 0;
+  ASSERT_TRUE(contents.Init(bad_frame));
+  char buffer[kFrameSize];
+  EXPECT_FALSE(contents.Read(0, kFrameSize, buffer));
+}
+
+TEST(CompressedContentsTest, ArchiveRoundTrip) {
+  std::string compressible =
+      MakeCompressibleContents(3 * kDefaultCompressedFrameSize + 4321);
+  TestFiles files = {
+      {"compressible", compressible},
+      {"copy", compressible},
+      {"empty", ""},
+      {"random", MakeRandomContents(10000)},
+      {"small", "x"},
+  };
+
+  files::ScopedTempDir temp_dir;
+  ArchiveWriter writer;
+  writer.set_compress_contents(true);
+  writer.set_deduplicate_contents(true);
+  writer.set_copy_thread_count(2);
+  std::string archive_path = WriteTestArchive(files, &temp_dir, &writer);
+  ASSERT_FALSE(archive_path.empty());
+
+  for (bool allow_mapping : {true, false}) {
+    ArchiveReader reader(fxl::UniqueFD(open(archive_path.c_str(), O_RDONLY)));
+    reader.set_allow_mapping(allow_mapping);
+    ASSERT_TRUE(reader.Read());
+
+    // Only files that shrink are stored compressed.
+    DirectoryTableEntry compressible;
+    DirectoryTableEntry copy;
+    DirectoryTableEntry random;
+    ASSERT_TRUE(reader.GetDirectoryEntryByPath("compressible", &compressible));
+    ASSERT_TRUE(reader.GetDirectoryEntryByPath("copy", &copy));
+    ASSERT_TRUE(reader.GetDirectoryEntryByPath("random", &random));
+    EXPECT_TRUE(ArchiveReader::IsCompressed(compressible));
+    EXPECT_TRUE(ArchiveReader::IsCompressed(copy));
+    EXPECT_EQ(compressible.data_offset, copy.data_offset);
+    EXPECT_FALSE(ArchiveReader::IsCompressed(random));
+    EXPECT_LT(compressible.data_length, files["compressible"].size());
+
+    uint64_t length = 0;
+    ASSERT_TRUE(reader.GetContentLength(compressible, &length));
+    EXPECT_EQ(files["compressible"].size(), length);
+    fxl::StringView view;
+    EXPECT_FALSE(reader.GetContentView(compressible, &view));
+
+    for (const auto& file : files) {
+      std::string contents;
+      EXPECT_TRUE(ReadTestFile(reader, file.first, &contents)) << file.first;
+      EXPECT_EQ(file.second, contents) << file.first;
+    }
+
+    // Part of a compressed file, crossing a frame boundary.
+    std::string part(100, '\0');
+    ASSERT_TRUE(reader.ReadContents(
+        compressible, kDefaultCompressedFrameSize - 50, part.size(), &part[0]));
+    EXPECT_EQ(files["compressible"].substr(kDefaultCompressedFrameSize - 50,
+                                           part.size()),
+              part);
+
+    // Extraction decompresses.
+    std::string output_path;
+    ASSERT_TRUE(temp_dir.NewTempFile(&output_path));
+    ASSERT_TRUE(reader.ExtractFile("compressible", output_path.c_str()));
+    std::string output;
+    ASSERT_TRUE(files::ReadFileToString(output_path, &output));
+    EXPECT_EQ(files["compressible"], output);
+  }
+}
+
+}  // namespace
+}  // namespace archive
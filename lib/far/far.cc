@@ -60,7 +60,8 @@ bool far_reader_get_content(far_reader_t reader,
                             uint64_t* offset,
                             uint64_t* length) {
   archive::DirectoryTableEntry entry;
-  if (!reader->impl->GetDirectoryEntryByIndex(index, &entry))
+  if (!reader->impl->GetDirectoryEntryByIndex(index, &entry) ||
+      archive::ArchiveReader::IsCompressed(entry))
     return false;
   *offset = entry.data_offset;
   *length = entry.data_length;
@@ -48,6 +48,7 @@ bool far_reader_get_path(far_reader_t reader,
                          const char** path,
                          size_t* path_length);
 
+// Returns false for compressed entries, whose contents cannot be read in place.
 bool far_reader_get_content(far_reader_t reader,
                             uint64_t index,
                             uint64_t* offset,
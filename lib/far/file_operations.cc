@@ -4,42 +4,97 @@
 
 #include "garnet/lib/far/file_operations.h"
 
-#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
 
 #include "garnet/lib/far/alignment.h"
-#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/files/eintr_wrapper.h"
+#include "lib/fxl/files/mapped_file.h"
+#include "lib/fxl/logging.h"
 
 namespace archive {
 
-bool CopyPathToFile(const char* src_path, int dst_fd, uint64_t length) {
-  fxl::UniqueFD src_fd(open(src_path, O_RDONLY));
-  if (!src_fd.is_valid()) {
+bool CopyPathToFileAt(const char* src_path,
+                      int dst_fd,
+                      uint64_t offset,
+                      uint64_t length) {
+  files::MappedFile src;
+  if (!src.Open(src_path)) {
     FXL_LOG(INFO) << "Failed to open " << src_path;
     return false;
   }
-  return CopyFileToFile(src_fd.get(), dst_fd, length);
+  if (src.size() != length)
+    return false;  // The file changed since it was measured.
+  src.Advise(files::MappedFile::Access::kSequential);
+  return WriteToFileAt(dst_fd, offset, src.data(), length);
 }
 
-bool CopyFileToPath(int src_fd, const char* dst_path, uint64_t length) {
-  fxl::UniqueFD dst_fd(open(dst_path, O_WRONLY | O_CREAT | O_TRUNC,
-                            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH));
-  if (!dst_fd.is_valid())
-    return false;
-  return CopyFileToFile(src_fd, dst_fd.get(), length);
+bool ReadFromFileAt(int src_fd, uint64_t offset, char* data, uint64_t length) {
+  uint64_t done = 0;
+  while (done < length) {
+    ssize_t actual = HANDLE_EINTR(
+        pread(src_fd, data + done, length - done, offset + done));
+    if (actual <= 0)
+      return false;
+    done += actual;
+  }
+  return true;
+}
+
+bool WriteToFileAt(int dst_fd,
+                   uint64_t offset,
+                   const char* data,
+                   uint64_t length) {
+  uint64_t written = 0;
+  while (written < length) {
+    ssize_t actual = HANDLE_EINTR(
+        pwrite(dst_fd, data + written, length - written, offset + written));
+    if (actual <= 0)
+      return false;
+    written += actual;
+  }
+  return true;
 }
 
-bool CopyFileToFile(int src_fd, int dst_fd, uint64_t length) {
+bool CopyFileRangeToFile(int src_fd,
+                         uint64_t offset,
+                         int dst_fd,
+                         uint64_t length) {
+  uint64_t copied = 0;
+
+#if defined(__linux__)
+  // Linux refuses to send more than this in one call.
+  constexpr uint64_t kMaxSendSize = 0x7ffff000;
+  while (copied < length) {
+    off_t src_offset = offset + copied;
+    ssize_t actual =
+        HANDLE_EINTR(sendfile(dst_fd, src_fd, &src_offset,
+                              std::min(kMaxSendSize, length - copied)));
+    if (actual < 0 && copied == 0 && (errno == EINVAL || errno == ENOSYS))
+      break;  // Not supported for these files; copy them by hand instead.
+    if (actual <= 0)
+      return false;
+    copied += actual;
+  }
+#endif
+
   constexpr uint64_t kBufferSize = 64 * 1024;
   char buffer[kBufferSize];
-  ssize_t actual = 0;
-  for (uint64_t copied = 0; copied < length; copied += actual) {
-    uint64_t requested =
-        std::min(kBufferSize, static_cast<uint64_t>(length - copied));
-    actual = read(src_fd, buffer, requested);
+  while (copied < length) {
+    uint64_t requested = std::min(kBufferSize, length - copied);
+    ssize_t actual =
+        HANDLE_EINTR(pread(src_fd, buffer, requested, offset + copied));
     if (actual <= 0)
       return false;
     if (!fxl::WriteFileDescriptor(dst_fd, buffer, actual))
       return false;
+    copied += actual;
   }
   return true;
 }
@@ -43,9 +43,32 @@ bool WriteVector(int fd, const std::vector<T>& vector) {
   return fxl::WriteFileDescriptor(fd, buffer, requested);
 }
 
-bool CopyPathToFile(const char* src_path, int dst_fd, uint64_t length);
-bool CopyFileToPath(int src_fd, const char* dst_path, uint64_t length);
-bool CopyFileToFile(int src_fd, int dst_fd, uint64_t length);
+// Copies the contents of |src_path|, which must be |length| bytes long, to
+// |offset| in |dst_fd|, leaving the offset of |dst_fd| alone. Safe to call on
+// several threads at once with the same |dst_fd|.
+bool CopyPathToFileAt(const char* src_path,
+                      int dst_fd,
+                      uint64_t offset,
+                      uint64_t length);
+
+// Reads |length| bytes at |offset| in |src_fd| into |data|, leaving the offset
+// of |src_fd| alone. Fails if the file ends first.
+bool ReadFromFileAt(int src_fd, uint64_t offset, char* data, uint64_t length);
+
+// Writes |length| bytes of |data| to |offset| in |dst_fd|, leaving the offset
+// of |dst_fd| alone.
+bool WriteToFileAt(int dst_fd,
+                   uint64_t offset,
+                   const char* data,
+                   uint64_t length);
+
+// Copies |length| bytes at |offset| in |src_fd| to the current position of
+// |dst_fd|, leaving the offset of |src_fd| alone. Where the platform allows,
+// the kernel copies the data without it passing through user space.
+bool CopyFileRangeToFile(int src_fd,
+                         uint64_t offset,
+                         int dst_fd,
+                         uint64_t length);
 
 }  // namespace archive
 
@@ -5,6 +5,7 @@
 #ifndef GARNET_LIB_FAR_FORMAT_H_
 #define GARNET_LIB_FAR_FORMAT_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace archive {
@@ -12,10 +13,14 @@ namespace archive {
 constexpr uint64_t kMagic = 0x11c5abad480bbfc8;
 constexpr uint64_t kDirType = 0x2d2d2d2d2d524944;
 constexpr uint64_t kDirnamesType = 0x53454d414e524944;
+constexpr uint64_t kPathHashType = 0x4853414848544150;
 
 constexpr uint32_t kHashAlgorithm = 1;
 constexpr uint32_t kHashLength = 32;
 
+// FNV-1a, 32 bits.
+constexpr uint32_t kPathHashAlgorithm = 1;
+
 struct IndexChunk {
   uint64_t magic = kMagic;
   uint64_t length = 0;
@@ -34,10 +39,16 @@ struct HashChunk {
   uint8_t hash_data[kHashLength] = {};
 };
 
+// Flags for |DirectoryTableEntry::flags|.
+//
+// The file's data is in the compressed content format below, rather than
+// being the file's contents as is.
+constexpr uint16_t kDirectoryEntryCompressed = 1 << 0;
+
 struct DirectoryTableEntry {
   uint32_t name_offset = 0;
   uint16_t name_length = 0;
-  uint16_t reserved0 = 0;
+  uint16_t flags = 0;
   uint64_t data_offset = 0;
   uint64_t data_length = 0;
   uint64_t reserved1 = 0;
@@ -49,6 +60,57 @@ struct DirectoryHashChunk {
   // Hashes
 };
 
+// Optional. Maps paths to their directory table entries without searching
+// the directory. The table has |slot_count| slots, a power of two, and at
+// least one of them is empty. A path is looked up by hashing it and probing
+// linearly from the slot at |hash % slot_count| until finding an entry with
+// that path or an empty slot.
+struct PathHashChunk {
+  uint32_t algorithm = kPathHashAlgorithm;
+  uint32_t slot_count = 0;
+  // Slots
+};
+
+constexpr uint32_t kEmptyPathHashSlot = 0xffffffff;
+
+struct PathHashSlot {
+  uint32_t hash = 0;
+  // The index of the directory table entry, or |kEmptyPathHashSlot|.
+  uint32_t index = kEmptyPathHashSlot;
+};
+
+inline uint32_t HashPath(const char* path, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<uint8_t>(path[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Compressed content format.
+//
+// The data of a compressed file starts with a |CompressedContentHeader|. A
+// seek table follows, with one |uint64_t| per frame: the offset just past the
+// end of that frame's compressed data, relative to the end of the seek
+// table. The frames follow back to back.
+//
+// Each frame holds |frame_size| bytes of the file, except the last, which
+// holds what remains. Frames are compressed independently of each other, so
+// reading part of the file only needs the frames that overlap it.
+constexpr uint64_t kCompressedContentMagic = 0x2d504d4f43524146;  // FARCOMP-
+
+// Raw deflate streams, as produced by zlib with negative window bits.
+constexpr uint32_t kCompressionDeflate = 1;
+
+struct CompressedContentHeader {
+  uint64_t magic = kCompressedContentMagic;
+  uint32_t algorithm = kCompressionDeflate;
+  uint32_t frame_size = 0;
+  uint64_t uncompressed_length = 0;
+  // Seek table
+};
+
 }  // namespace archive
 
 #endif  // GARNET_LIB_FAR_FORMAT_H_
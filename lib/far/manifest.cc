@@ -8,23 +8,24 @@
 
 #include "garnet/lib/far/archive_entry.h"
 #include "garnet/lib/far/archive_writer.h"
-#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/mapped_file.h"
 #include "lib/fxl/strings/split_string.h"
 
 namespace archive {
 
 bool ReadManifest(fxl::StringView path, ArchiveWriter* writer) {
-  std::string manifest;
-  if (!files::ReadFileToString(path.ToString(), &manifest)) {
+  files::MappedFile manifest;
+  if (!manifest.Open(path.ToString())) {
     fprintf(stderr, "error: Faile to read '%s'\n", path.ToString().c_str());
     return false;
   }
+  manifest.Advise(files::MappedFile::Access::kSequential);
 
-  std::vector<fxl::StringView> lines =
-      fxl::SplitString(manifest, "\n", fxl::WhiteSpaceHandling::kKeepWhitespace,
-                       fxl::SplitResult::kSplitWantNonEmpty);
-
-  for (const auto& line : lines) {
+  fxl::SplitStringIterator lines(manifest.view(), "\n",
+                                 fxl::WhiteSpaceHandling::kKeepWhitespace,
+                                 fxl::SplitResult::kSplitWantNonEmpty);
+  while (lines.Next()) {
+    fxl::StringView line = lines.piece();
     size_t offset = line.find('=');
     if (offset == std::string::npos)
       continue;
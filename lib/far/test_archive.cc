@@ -0,0 +1,46 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "garnet/lib/far/test_archive.h"
+
+#include <fcntl.h>
+
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/unique_fd.h"
+
+namespace archive {
+
+std::string WriteTestArchive(const TestFiles& files,
+                             files::ScopedTempDir* temp_dir,
+                             ArchiveWriter* writer) {
+  for (const auto& file : files) {
+    std::string src_path;
+    if (!temp_dir->NewTempFile(&src_path) ||
+        !files::WriteFile(src_path, file.second.data(), file.second.size()) ||
+        !writer->Add(ArchiveEntry(src_path, file.first)))
+      return std::string();
+  }
+
+  std::string archive_path;
+  if (!temp_dir->NewTempFile(&archive_path))
+    return std::string();
+  fxl::UniqueFD fd(open(archive_path.c_str(), O_RDWR));
+  if (!fd.is_valid() || !writer->Write(fd.get()))
+    return std::string();
+  return archive_path;
+}
+
+bool ReadTestFile(const ArchiveReader& reader,
+                  fxl::StringView path,
+                  std::string* contents) {
+  DirectoryTableEntry entry;
+  uint64_t length = 0;
+  if (!reader.GetDirectoryEntryByPath(path, &entry) ||
+      !reader.GetContentLength(entry, &length))
+    return false;
+  contents->resize(length);
+  return length == 0 || reader.ReadContents(entry, 0, length, &(*contents)[0]);
+}
+
+}  // namespace archive
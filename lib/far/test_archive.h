@@ -0,0 +1,36 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GARNET_LIB_FAR_TEST_ARCHIVE_H_
+#define GARNET_LIB_FAR_TEST_ARCHIVE_H_
+
+#include <map>
+#include <string>
+
+#include "garnet/lib/far/archive_reader.h"
+#include "garnet/lib/far/archive_writer.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+#include "lib/fxl/strings/string_view.h"
+
+namespace archive {
+
+// The contents of the files in a test archive, by path in the archive.
+using TestFiles = std::map<std::string, std::string>;
+
+// Writes |files| into |temp_dir|, then writes an archive of them into
+// |temp_dir| using |writer|. Returns the path of the archive, or the empty
+// string on failure.
+std::string WriteTestArchive(const TestFiles& files,
+                             files::ScopedTempDir* temp_dir,
+                             ArchiveWriter* writer);
+
+// Reads the whole contents of the file at |path| in the archive through
+// |reader|.
+bool ReadTestFile(const ArchiveReader& reader,
+                  fxl::StringView path,
+                  std::string* contents);
+
+}  // namespace archive
+
+#endif  // GARNET_LIB_FAR_TEST_ARCHIVE_H_
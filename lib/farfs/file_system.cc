@@ -6,6 +6,9 @@
 
 #include <fcntl.h>
 
+#include <algorithm>
+
+#include "garnet/lib/far/compressed_contents.h"
 #include "lib/fsl/tasks/message_loop.h"
 
 namespace archive {
@@ -95,12 +98,18 @@ FileSystem::FileSystem(zx::vmo vmo)
   if (!fd.is_valid())
     return;
   reader_ = std::make_unique<ArchiveReader>(std::move(fd));
-  CreateDirectory();
+  if (!reader_->Read())
+    reader_.reset();
 }
 
 FileSystem::~FileSystem() = default;
 
 bool FileSystem::Serve(zx::channel channel) {
+  // Building the directory decompresses every compressed file in full, so
+  // it waits until the archive is served. Archives that are only read
+  // through |GetFileAsVMO| and |GetFileAsString| never pay for it.
+  if (!directory_)
+    CreateDirectory();
   return directory_ &&
          vfs_.ServeDirectory(directory_, std::move(channel)) == ZX_OK;
 }
@@ -120,6 +129,8 @@ fsl::SizedVmo FileSystem::GetFileAsVMO(fxl::StringView path) {
   DirectoryTableEntry entry;
   if (!reader_->GetDirectoryEntryByPath(path, &entry))
     return nullptr;
+  if (ArchiveReader::IsCompressed(entry))
+    return DecompressToVMO(entry);
   zx_handle_t result = ZX_HANDLE_INVALID;
   zx_status_t status =
       zx_vmo_clone(vmo_, ZX_VMO_CLONE_COPY_ON_WRITE, entry.data_offset,
@@ -136,19 +147,54 @@ bool FileSystem::GetFileAsString(fxl::StringView path, std::string* result) {
   DirectoryTableEntry entry;
   if (!reader_->GetDirectoryEntryByPath(path, &entry))
     return false;
+  if (ArchiveReader::IsCompressed(entry)) {
+    std::string storage;
+    CompressedContents contents;
+    if (!reader_->InitCompressedContents(entry, &contents, &storage))
+      return false;
+    std::string data;
+    data.resize(contents.size());
+    if (!contents.Read(0, data.size(), &data[0]))
+      return false;
+    result->swap(data);
+    return true;
+  }
   std::string data;
   data.resize(entry.data_length);
-  size_t actual;
-  zx_status_t status = zx_vmo_read(vmo_, &data[0], entry.data_offset,
-                                   entry.data_length, &actual);
-  if (status != ZX_OK || actual != entry.data_length)
+  if (!reader_->ReadContents(entry, 0, data.size(), &data[0]))
     return false;
   result->swap(data);
   return true;
 }
 
+fsl::SizedVmo FileSystem::DecompressToVMO(const DirectoryTableEntry& entry) {
+  // The compressed data is read once, and each frame is decompressed once as
+  // the reads below walk the seek table front to back.
+  std::string storage;
+  CompressedContents contents;
+  zx::vmo vmo;
+  if (!reader_->InitCompressedContents(entry, &contents, &storage) ||
+      zx::vmo::create(contents.size(), 0, &vmo) != ZX_OK)
+    return nullptr;
+
+  // Copy a frame at a time so that only one is ever held in memory outside
+  // of the VMO.
+  std::vector<char> buffer(std::min<uint64_t>(contents.frame_size(),
+                                              contents.size()));
+  for (uint64_t offset = 0; offset < contents.size();) {
+    size_t count = std::min<uint64_t>(buffer.size(), contents.size() - offset);
+    size_t actual = 0;
+    if (!contents.Read(offset, count, buffer.data()) ||
+        vmo.write(buffer.data(), offset, count, &actual) != ZX_OK ||
+        actual != count)
+      return nullptr;
+    offset += count;
+  }
+  return fsl::SizedVmo(std::move(vmo), contents.size());
+}
+
 void FileSystem::CreateDirectory() {
-  if (!reader_ || !reader_->Read())
+  if (!reader_)
     return;
 
   std::vector<DirRecord> stack;
@@ -167,9 +213,24 @@ void FileSystem::CreateDirectory() {
 
     current_dir = path.substr(0, path.size() - remaining.size());
 
+    fbl::RefPtr<vmofs::VnodeFile> file;
+    if (ArchiveReader::IsCompressed(entry)) {
+      // vmofs serves files straight out of VMOs, so compressed files are
+      // decompressed up front. Files that fail to decompress are left out.
+      fsl::SizedVmo contents = DecompressToVMO(entry);
+      if (!contents)
+        return;
+      file = fbl::AdoptRef(
+          new vmofs::VnodeFile(contents.vmo().get(), 0, contents.size()));
+      decompressed_vmos_.push_back(std::move(contents.vmo()));
+    } else {
+      file = CreateFile(vmo_, entry);
+    }
+
+    // |names| and |children| must stay the same length.
     DirRecord& parent = stack.back();
     parent.names.push_back(ToStringPiece(remaining));
-    parent.children.push_back(CreateFile(vmo_, entry));
+    parent.children.push_back(std::move(file));
   });
 
   while (!current_dir.empty())
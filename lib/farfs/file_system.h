@@ -11,6 +11,7 @@
 #include <zx/vmo.h>
 
 #include <memory>
+#include <vector>
 
 #include "garnet/lib/far/archive_reader.h"
 #include "lib/fsl/vmo/sized_vmo.h"
@@ -37,6 +38,7 @@ class FileSystem {
   //
   // The VMO is a copy-on-write clone of the contents of the file, which means
   // writes to the VMO do not mutate the data in the underlying archive.
+  // Compressed files are decompressed into a new VMO when this is called.
   fsl::SizedVmo GetFileAsVMO(fxl::StringView path);
 
   // Returns the contents of the the given path as a string.
@@ -44,13 +46,17 @@ class FileSystem {
 
  private:
   void CreateDirectory();
+  fsl::SizedVmo DecompressToVMO(const DirectoryTableEntry& entry);
 
   // The owning reference to the vmo is stored inside |reader_| as a file
   /// descriptor.
   zx_handle_t vmo_;
   fs::ManagedVfs vfs_;
   std::unique_ptr<ArchiveReader> reader_;
+  // Created the first time the archive is served.
   fbl::RefPtr<vmofs::VnodeDir> directory_;
+  // Backs the compressed files in |directory_|.
+  std::vector<zx::vmo> decompressed_vmos_;
 };
 
 }  // namespace archive
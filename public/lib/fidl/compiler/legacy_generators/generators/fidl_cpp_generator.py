@@ -272,6 +272,25 @@ def GetCppConstWrapperType(kind):
     print "missing:", kind.spec
   return GetCppTypeForKind(kind)
 
+def IsViewKind(kind):
+  """Returns whether a method parameter of |kind| can be borrowed from the
+  message buffer instead of copied out of it."""
+  if mojom.IsStringKind(kind):
+    return True
+  # Arrays of bools are bit-packed on the wire, so they cannot be borrowed.
+  return (mojom.IsArrayKind(kind) and mojom.IsNumericalKind(kind.kind) and
+          not mojom.IsBoolKind(kind.kind))
+
+def GetCppViewType(kind):
+  if mojom.IsStringKind(kind):
+    return "::fidl::StringView"
+  return "::fidl::ArrayView<%s>" % GetCppType(kind.kind)
+
+def UsesViewParams(method):
+  """Returns whether |method| opted in, with the [ViewParams=true] attribute,
+  to receiving its string and primitive array parameters as views."""
+  return bool(method.attributes) and method.attributes.get("ViewParams") is True
+
 def GetCppFieldType(kind):
   if mojom.IsStructKind(kind):
     return ("::fidl::internal::StructPointer<%s_Data>" %
@@ -443,6 +462,7 @@ class Generator(generator.Generator):
     "cpp_result_type": GetCppResultWrapperType,
     "cpp_type": GetCppType,
     "cpp_union_getter_return_type": GetUnionGetterReturnType,
+    "cpp_view_type": GetCppViewType,
     "cpp_wrapper_type": GetCppWrapperType,
     "default_value": DefaultValue,
     "expression_to_text": ExpressionToText,
@@ -468,10 +488,12 @@ class Generator(generator.Generator):
     "is_string_kind": mojom.IsStringKind,
     "is_struct_kind": mojom.IsStructKind,
     "is_union_kind": mojom.IsUnionKind,
+    "is_view_kind": IsViewKind,
     "struct_size": lambda ps: ps.GetTotalSize() + _HEADER_SIZE,
     "stylize_method": generator.StudlyCapsToCamel,
     "to_all_caps": generator.CamelCaseToAllCaps,
     "under_to_camel": generator.UnderToCamel,
+    "uses_view_params": UsesViewParams,
   }
 
   def GetJinjaExports(self):
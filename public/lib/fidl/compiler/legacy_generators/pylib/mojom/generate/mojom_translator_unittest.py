@@ -711,6 +711,13 @@ class TestUserDefinedTypeFromMojom(unittest.TestCase):
     self.assertEquals(
         param1.decl_data.short_name, method.response_parameters[0].name)
 
+    # Method attributes are translated.
+    self.assertFalse(method.attributes)
+    mojom_method.decl_data.attributes = [fidl_types_fidl.Attribute(
+        key='ViewParams', value=self.literal_value(True))]
+    method = translator.MethodFromMojom(mojom_method, interface)
+    self.assertEquals({'ViewParams': True}, method.attributes)
+
   def test_parameter(self):
     # Parameters are encoded as fields in a struct.
     mojom_param = fidl_types_fidl.StructField(
@@ -0,0 +1,63 @@
+# Copyright 2017 The Fuchsia Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+import imp
+import os.path
+import sys
+import unittest
+
+def _GetDirAbove(dirname):
+  """Returns the directory "above" this file containing |dirname| (which must
+  also be "above" this file)."""
+  path = os.path.abspath(__file__)
+  while True:
+    path, tail = os.path.split(path)
+    assert tail
+    if tail == dirname:
+      return path
+
+try:
+  imp.find_module("mojom")
+except ImportError:
+  sys.path.append(os.path.join(_GetDirAbove("pylib"), "pylib"))
+sys.path.append(os.path.join(_GetDirAbove("pylib"), "generators"))
+from mojom.generate import module as mojom
+import fidl_cpp_generator
+
+
+class ViewParamsTest(unittest.TestCase):
+  """Tests the handling of the [ViewParams=true] method attribute."""
+
+  def _MakeMethod(self, attributes):
+    module = mojom.Module('test_module', 'test_namespace')
+    interface = mojom.Interface('TestInterface', module=module)
+    method = mojom.Method(interface, 'Echo', attributes=attributes)
+    method.AddParameter('a', mojom.NULLABLE_STRING)
+    method.AddParameter('b', mojom.Array(mojom.UINT8))
+    return method
+
+  def testUsesViewParams(self):
+    """Tests that only methods with [ViewParams=true] use views."""
+    self.assertTrue(fidl_cpp_generator.UsesViewParams(
+        self._MakeMethod({'ViewParams': True})))
+    self.assertFalse(fidl_cpp_generator.UsesViewParams(
+        self._MakeMethod({'ViewParams': False})))
+    self.assertFalse(fidl_cpp_generator.UsesViewParams(
+        self._MakeMethod({'MinVersion': 1})))
+    self.assertFalse(fidl_cpp_generator.UsesViewParams(self._MakeMethod(None)))
+
+  def testViewableKinds(self):
+    """Tests that strings and non-bool numeric arrays can be viewed."""
+    method = self._MakeMethod({'ViewParams': True})
+    self.assertEquals(
+        '::fidl::StringView',
+        fidl_cpp_generator.GetCppViewType(method.parameters[0].kind))
+    self.assertEquals(
+        '::fidl::ArrayView<uint8_t>',
+        fidl_cpp_generator.GetCppViewType(method.parameters[1].kind))
+    self.assertFalse(fidl_cpp_generator.IsViewKind(
+        mojom.Array(mojom.BOOL)))
+
+if __name__ == "__main__":
+  unittest.main()
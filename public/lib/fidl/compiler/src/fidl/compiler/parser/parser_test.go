@@ -323,6 +323,33 @@ func TestSuccessfulParsing(t *testing.T) {
 	}
 	endTestCase()
 
+	////////////////////////////////////////////////////////////
+	// Test Case (method attributes)
+	////////////////////////////////////////////////////////////
+	startTestCase("")
+	cases[testCaseNum].mojomContents = `
+    interface ViewProvider {
+      [ViewParams=true]
+      EchoView(string? a, array<uint8> b);
+    };
+
+	`
+	{
+		interfaceViewProvider := core.NewMojomInterface(core.DeclTestData("ViewProvider"))
+		interfaceViewProvider.InitAsScope(core.NewTestFileScope("test.scope"))
+
+		params := core.NewMojomStruct(core.DeclTestData("dummy"))
+		params.InitAsScope(core.NewTestFileScope("test.scope"))
+		params.AddField(core.NewStructField(core.DeclTestData("a"), core.BuiltInType("string?"), nil))
+		params.AddField(core.NewStructField(core.DeclTestData("b"), core.NewArrayTypeRef(core.SimpleTypeUInt8, -1, false), nil))
+
+		attributes := core.NewAttributes(lexer.Token{})
+		attributes.List = append(attributes.List, core.NewMojomAttribute("ViewParams", nil, core.MakeBoolLiteralValue(true, nil)))
+		interfaceViewProvider.AddMethod(core.NewMojomMethod(core.DeclTestDataA("EchoView", attributes), params, nil))
+		expectedFile.AddInterface(interfaceViewProvider)
+	}
+	endTestCase()
+
 	////////////////////////////////////////////////////////////
 	// Test Case
 	////////////////////////////////////////////////////////////
@@ -502,6 +529,20 @@ func TestErrorParsing(t *testing.T) {
 	expectError("Expecting module, import, interface, struct, union, enum or constant.")
 	endTestCase()
 
+	////////////////////////////////////////////////////////////
+	// Test Case (attribute without a value)
+	////////////////////////////////////////////////////////////
+	startTestCase("")
+	cases[testCaseNum].mojomContents = `
+	interface ViewProvider {
+		[ViewParams]
+		EchoView(string? a);
+	};
+	`
+	expectError("Unexpected ']'")
+	expectError("Expecting '='")
+	endTestCase()
+
 	////////////////////////////////////////////////////////////
 	// Test Case (import before module)
 	////////////////////////////////////////////////////////////
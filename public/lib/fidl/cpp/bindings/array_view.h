@@ -0,0 +1,95 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FIDL_CPP_BINDINGS_ARRAY_VIEW_H_
+#define LIB_FIDL_CPP_BINDINGS_ARRAY_VIEW_H_
+
+#include <stddef.h>
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "lib/fidl/cpp/bindings/array.h"
+
+namespace fidl {
+
+// A read-only view of an array of primitive values that it does not own. Like
+// |Array|, the view can be null, which is distinct from empty.
+//
+// Methods with the [ViewParams=true] attribute receive their primitive array
+// parameters as |ArrayView|s that point directly into the incoming message,
+// which avoids copying large payloads. The view is only valid until the method
+// returns; use |ToArray()| to keep the contents around for longer.
+//
+// Proxies accept an |ArrayView| for the same parameters. |Array|s and
+// |std::vector|s convert to it implicitly.
+template <typename T>
+class ArrayView {
+  static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+                "ArrayView only supports arrays of non-bool primitives.");
+
+ public:
+  using ConstIterator = const T*;
+
+  ArrayView() : data_(nullptr), size_(0u), is_null_(true) {}
+  ArrayView(std::nullptr_t) : ArrayView() {}
+  ArrayView(const T* data, size_t size)
+      : data_(data), size_(size), is_null_(false) {}
+  ArrayView(const Array<T>& array)
+      : data_(array.storage().data()),
+        size_(array.size()),
+        is_null_(array.is_null()) {}
+  ArrayView(const std::vector<T>& vector)
+      : data_(vector.data()), size_(vector.size()), is_null_(false) {}
+
+  // Tests as true if non-null, false if null.
+  explicit operator bool() const { return !is_null_; }
+
+  // Indicates whether the array is null (which is distinct from empty).
+  bool is_null() const { return is_null_; }
+
+  bool empty() const { return size_ == 0u; }
+
+  // Returns the number of elements, which will be zero if the array is null.
+  size_t size() const { return size_; }
+
+  const T* data() const { return data_; }
+
+  const T& operator[](size_t offset) const { return data_[offset]; }
+
+  ConstIterator begin() const { return data_; }
+  ConstIterator end() const { return data_ + size_; }
+
+  // Returns a copy of the viewed array that owns its contents.
+  Array<T> ToArray() const {
+    if (is_null_)
+      return nullptr;
+    std::vector<T> storage(data_, data_ + size_);
+    Array<T> result;
+    result.Swap(&storage);
+    return result;
+  }
+
+  // Indicates whether the contents of this array are equal to |other|. A null
+  // array is only equal to another null array.
+  bool Equals(const ArrayView& other) const {
+    if (is_null_ != other.is_null_ || size_ != other.size_)
+      return false;
+    for (size_t i = 0; i < size_; ++i) {
+      if (data_[i] != other.data_[i])
+        return false;
+    }
+    return true;
+  }
+
+ private:
+  const T* data_;
+  size_t size_;
+  bool is_null_;
+};
+
+}  // namespace fidl
+
+#endif  // LIB_FIDL_CPP_BINDINGS_ARRAY_VIEW_H_
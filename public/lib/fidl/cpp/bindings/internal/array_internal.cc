@@ -68,5 +68,33 @@ void ArraySerializationHelper<WrappedHandle, true, false>::
     DecodeHandle(&elements[i], handles);
 }
 
+// static
+ValidationError ArraySerializationHelper<WrappedHandle, true, false>::
+    ValidateAndDecodeElements(const ArrayHeader* header,
+                              ElementType* elements,
+                              BoundsChecker* bounds_checker,
+                              const ArrayValidateParams* validate_params,
+                              std::vector<zx_handle_t>* handles,
+                              std::string* err) {
+  // Handle type should not have array validate params.
+  ZX_DEBUG_ASSERT(!validate_params->element_validate_params);
+
+  for (uint32_t i = 0; i < header->num_elements; ++i) {
+    if (!validate_params->element_is_nullable &&
+        elements[i].value == kEncodedInvalidHandleValue) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err)
+          << "invalid handle in array expecting valid handles (array size="
+          << header->num_elements << ", index = " << i << ")";
+      return ValidationError::UNEXPECTED_INVALID_HANDLE;
+    }
+    if (!bounds_checker->ClaimHandle(elements[i])) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
+      return ValidationError::ILLEGAL_HANDLE;
+    }
+    DecodeHandle(&elements[i], handles);
+  }
+  return ValidationError::NONE;
+}
+
 }  // namespace internal
 }  // namespace fidl
@@ -195,6 +195,17 @@ struct ArraySerializationHelper<T, false, false> {
     ZX_DEBUG_ASSERT(!validate_params->element_validate_params);
     return ValidationError::NONE;
   }
+
+  static ValidationError ValidateAndDecodeElements(
+      const ArrayHeader* header,
+      ElementType* elements,
+      BoundsChecker* bounds_checker,
+      const ArrayValidateParams* validate_params,
+      std::vector<zx_handle_t>* handles,
+      std::string* err) {
+    return ValidateElements(header, elements, bounds_checker, validate_params,
+                            err);
+  }
 };
 
 template <>
@@ -233,6 +244,14 @@ struct ArraySerializationHelper<WrappedHandle, true, false> {
     }
     return ValidationError::NONE;
   }
+
+  static ValidationError ValidateAndDecodeElements(
+      const ArrayHeader* header,
+      ElementType* elements,
+      BoundsChecker* bounds_checker,
+      const ArrayValidateParams* validate_params,
+      std::vector<zx_handle_t>* handles,
+      std::string* err);
 };
 
 template <typename H>
@@ -267,6 +286,18 @@ struct ArraySerializationHelper<H, true, false> {
                                                              validate_params,
                                                              err);
   }
+
+  static ValidationError ValidateAndDecodeElements(
+      const ArrayHeader* header,
+      ElementType* elements,
+      BoundsChecker* bounds_checker,
+      const ArrayValidateParams* validate_params,
+      std::vector<zx_handle_t>* handles,
+      std::string* err) {
+    return ArraySerializationHelper<WrappedHandle, true, false>::
+        ValidateAndDecodeElements(header, elements, bounds_checker,
+                                  validate_params, handles, err);
+  }
 };
 
 template <typename P>
@@ -315,6 +346,36 @@ struct ArraySerializationHelper<P*, false, false> {
     return ValidationError::NONE;
   }
 
+  static ValidationError ValidateAndDecodeElements(
+      const ArrayHeader* header,
+      ElementType* elements,
+      BoundsChecker* bounds_checker,
+      const ArrayValidateParams* validate_params,
+      std::vector<zx_handle_t>* handles,
+      std::string* err) {
+    for (uint32_t i = 0; i < header->num_elements; ++i) {
+      if (!validate_params->element_is_nullable && !elements[i].offset) {
+        FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err)
+            << "null in array expecting valid pointers (size="
+            << header->num_elements << ", index = " << i << ")";
+        return ValidationError::UNEXPECTED_NULL_POINTER;
+      }
+
+      if (!ValidateEncodedPointer(&elements[i].offset)) {
+        FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
+        return ValidationError::ILLEGAL_POINTER;
+      }
+
+      DecodePointer(&elements[i].offset, &elements[i].ptr);
+      auto retval = ValidateAndDecodeCaller<P>::Run(
+          elements[i].ptr, bounds_checker,
+          validate_params->element_validate_params, handles, err);
+      if (retval != ValidationError::NONE)
+        return retval;
+    }
+    return ValidationError::NONE;
+  }
+
  private:
   template <typename T>
   struct ValidateCaller {
@@ -350,6 +411,44 @@ struct ArraySerializationHelper<P*, false, false> {
                                      err);
     }
   };
+
+  template <typename T>
+  struct ValidateAndDecodeCaller {
+    static ValidationError Run(T* data,
+                               BoundsChecker* bounds_checker,
+                               const ArrayValidateParams* validate_params,
+                               std::vector<zx_handle_t>* handles,
+                               std::string* err) {
+      // Struct type should not have array validate params.
+      ZX_DEBUG_ASSERT(!validate_params);
+
+      return T::ValidateAndDecode(data, bounds_checker, handles, err);
+    }
+  };
+
+  template <typename Key, typename Value>
+  struct ValidateAndDecodeCaller<Map_Data<Key, Value>> {
+    static ValidationError Run(Map_Data<Key, Value>* data,
+                               BoundsChecker* bounds_checker,
+                               const ArrayValidateParams* validate_params,
+                               std::vector<zx_handle_t>* handles,
+                               std::string* err) {
+      return Map_Data<Key, Value>::ValidateAndDecode(
+          data, bounds_checker, validate_params, handles, err);
+    }
+  };
+
+  template <typename T>
+  struct ValidateAndDecodeCaller<Array_Data<T>> {
+    static ValidationError Run(Array_Data<T>* data,
+                               BoundsChecker* bounds_checker,
+                               const ArrayValidateParams* validate_params,
+                               std::vector<zx_handle_t>* handles,
+                               std::string* err) {
+      return Array_Data<T>::ValidateAndDecode(data, bounds_checker,
+                                              validate_params, handles, err);
+    }
+  };
 };
 
 // Array Serialization Helper for unions.
@@ -394,6 +493,32 @@ struct ArraySerializationHelper<P, false, true> {
     }
     return ValidationError::NONE;
   }
+
+  static ValidationError ValidateAndDecodeElements(
+      const ArrayHeader* header,
+      ElementType* elements,
+      BoundsChecker* bounds_checker,
+      const ArrayValidateParams* validate_params,
+      std::vector<zx_handle_t>* handles,
+      std::string* err) {
+    // Union type should not have array validate params.
+    ZX_DEBUG_ASSERT(!validate_params->element_validate_params);
+    for (uint32_t i = 0; i < header->num_elements; ++i) {
+      if (!validate_params->element_is_nullable && elements[i].is_null()) {
+        FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err)
+            << "null union in array expecting non-null unions (size="
+            << header->num_elements << ", index = " << i << ")";
+        return ValidationError::UNEXPECTED_NULL_UNION;
+      }
+
+      auto retval = ElementType::ValidateAndDecode(
+          static_cast<void*>(&elements[i]), bounds_checker, true, handles,
+          err);
+      if (retval != ValidationError::NONE)
+        return retval;
+    }
+    return ValidationError::NONE;
+  }
 };
 
 template <typename T>
@@ -427,42 +552,40 @@ class Array_Data {
                                   std::string* err) {
     if (!data)
       return ValidationError::NONE;
-    if (!IsAligned(data)) {
-      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
-      return ValidationError::MISALIGNED_OBJECT;
-    }
-    if (!bounds_checker->IsValidRange(data, sizeof(ArrayHeader))) {
-      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
-      return ValidationError::ILLEGAL_MEMORY_RANGE;
-    }
-
-    const ArrayHeader* header = static_cast<const ArrayHeader*>(data);
-    if (header->num_elements > Traits::kMaxNumElements ||
-        header->num_bytes < Traits::GetStorageSize(header->num_elements)) {
-      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
-      return ValidationError::UNEXPECTED_ARRAY_HEADER;
-    }
-
-    if (validate_params->expected_num_elements != 0 &&
-        header->num_elements != validate_params->expected_num_elements) {
-      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err)
-          << "fixed-size array has wrong number of elements (size="
-          << header->num_elements
-          << ", expected size=" << validate_params->expected_num_elements
-          << ")";
-      return ValidationError::UNEXPECTED_ARRAY_HEADER;
-    }
 
-    if (!bounds_checker->ClaimMemory(data, header->num_bytes)) {
-      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
-      return ValidationError::ILLEGAL_MEMORY_RANGE;
-    }
+    ValidationError retval = ValidateHeaderAndClaimMemory(
+        data, bounds_checker, validate_params, err);
+    if (retval != ValidationError::NONE)
+      return retval;
 
     const Array_Data<T>* object = static_cast<const Array_Data<T>*>(data);
     return Helper::ValidateElements(&object->header_, object->storage(),
                                     bounds_checker, validate_params, err);
   }
 
+  // Like |Validate|, but also decodes pointers and handles in place while it
+  // walks the array, so that it is only touched once. Handles are taken out of
+  // |handles|. If validation fails, the contents of |data| are unspecified.
+  static ValidationError ValidateAndDecode(
+      void* data,
+      BoundsChecker* bounds_checker,
+      const ArrayValidateParams* validate_params,
+      std::vector<zx_handle_t>* handles,
+      std::string* err) {
+    if (!data)
+      return ValidationError::NONE;
+
+    ValidationError retval = ValidateHeaderAndClaimMemory(
+        data, bounds_checker, validate_params, err);
+    if (retval != ValidationError::NONE)
+      return retval;
+
+    Array_Data<T>* object = static_cast<Array_Data<T>*>(data);
+    return Helper::ValidateAndDecodeElements(&object->header_,
+                                             object->storage(), bounds_checker,
+                                             validate_params, handles, err);
+  }
+
   size_t size() const { return header_.num_elements; }
 
   Ref at(size_t offset) {
@@ -500,6 +623,45 @@ class Array_Data {
   }
   ~Array_Data() = delete;
 
+  static ValidationError ValidateHeaderAndClaimMemory(
+      const void* data,
+      BoundsChecker* bounds_checker,
+      const ArrayValidateParams* validate_params,
+      std::string* err) {
+    if (!IsAligned(data)) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
+      return ValidationError::MISALIGNED_OBJECT;
+    }
+    if (!bounds_checker->IsValidRange(data, sizeof(ArrayHeader))) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
+      return ValidationError::ILLEGAL_MEMORY_RANGE;
+    }
+
+    const ArrayHeader* header = static_cast<const ArrayHeader*>(data);
+    if (header->num_elements > Traits::kMaxNumElements ||
+        header->num_bytes < Traits::GetStorageSize(header->num_elements)) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
+      return ValidationError::UNEXPECTED_ARRAY_HEADER;
+    }
+
+    if (validate_params->expected_num_elements != 0 &&
+        header->num_elements != validate_params->expected_num_elements) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err)
+          << "fixed-size array has wrong number of elements (size="
+          << header->num_elements
+          << ", expected size=" << validate_params->expected_num_elements
+          << ")";
+      return ValidationError::UNEXPECTED_ARRAY_HEADER;
+    }
+
+    if (!bounds_checker->ClaimMemory(data, header->num_bytes)) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
+      return ValidationError::ILLEGAL_MEMORY_RANGE;
+    }
+
+    return ValidationError::NONE;
+  }
+
   internal::ArrayHeader header_;
 
   // Elements of type internal::ArrayDataTraits<T>::StorageType follow.
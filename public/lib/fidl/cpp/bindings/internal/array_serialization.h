@@ -18,6 +18,7 @@
 #include <type_traits>
 #include <vector>
 
+#include "lib/fidl/cpp/bindings/array_view.h"
 #include "lib/fidl/cpp/bindings/internal/array_internal.h"
 #include "lib/fidl/cpp/bindings/internal/bindings_internal.h"
 #include "lib/fidl/cpp/bindings/internal/iterator_util.h"
@@ -537,6 +538,57 @@ inline void Deserialize_(internal::Array_Data<F>* input, Array<E>* output) {
   }
 }
 
+template <typename E>
+inline size_t GetSerializedSize_(const ArrayView<E>& input) {
+  if (!input)
+    return 0;
+  return sizeof(internal::Array_Data<E>) +
+         internal::Align(input.size() * sizeof(E));
+}
+
+template <typename E>
+inline internal::ValidationError SerializeArray_(
+    ArrayView<E>* input,
+    internal::Buffer* buf,
+    internal::Array_Data<E>** output,
+    const internal::ArrayValidateParams* validate_params) {
+  ZX_DEBUG_ASSERT(input);
+  if (!*input) {
+    // It is up to the caller to make sure the given |ArrayView| is not null if
+    // it is not nullable.
+    *output = nullptr;
+    return internal::ValidationError::NONE;
+  }
+
+  if (validate_params->expected_num_elements != 0 &&
+      input->size() != validate_params->expected_num_elements) {
+    FIDL_INTERNAL_DLOG_SERIALIZATION_FAILURE(
+        internal::ValidationError::UNEXPECTED_ARRAY_HEADER,
+        internal::MakeMessageWithExpectedArraySize(
+            "fixed-size array has wrong number of elements", input->size(),
+            validate_params->expected_num_elements).c_str());
+    return internal::ValidationError::UNEXPECTED_ARRAY_HEADER;
+  }
+
+  internal::Array_Data<E>* result =
+      internal::Array_Data<E>::New(input->size(), buf);
+  if (result && input->size())
+    memcpy(result->storage(), input->data(), input->size() * sizeof(E));
+  *output = result;
+  return internal::ValidationError::NONE;
+}
+
+// Points |output| at the elements of |input| without copying them. |output| is
+// only valid for as long as |input| is.
+template <typename E>
+inline void Deserialize_(internal::Array_Data<E>* input, ArrayView<E>* output) {
+  if (input) {
+    *output = ArrayView<E>(input->storage(), input->size());
+  } else {
+    *output = ArrayView<E>();
+  }
+}
+
 }  // namespace fidl
 
 #endif  // LIB_FIDL_CPP_BINDINGS_INTERNAL_ARRAY_SERIALIZATION_H_
@@ -124,6 +124,74 @@ class Map_Data {
     return ValidationError::NONE;
   }
 
+  // Like |Validate|, but also decodes pointers and handles in place while it
+  // walks the map, so that it is only touched once. Handles are taken out of
+  // |handles|. If validation fails, the contents of |data| are unspecified.
+  static ValidationError ValidateAndDecode(
+      void* data,
+      BoundsChecker* bounds_checker,
+      const ArrayValidateParams* value_validate_params,
+      std::vector<zx_handle_t>* handles,
+      std::string* err) {
+    if (!data)
+      return ValidationError::NONE;
+
+    ValidationError retval =
+        ValidateStructHeaderAndClaimMemory(data, bounds_checker, err);
+    if (retval != ValidationError::NONE)
+      return retval;
+
+    Map_Data* object = static_cast<Map_Data*>(data);
+    if (object->header_.num_bytes != sizeof(Map_Data) ||
+        object->header_.version != 0) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
+      return ValidationError::UNEXPECTED_STRUCT_HEADER;
+    }
+
+    if (!ValidateEncodedPointer(&object->keys.offset)) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
+      return ValidationError::ILLEGAL_POINTER;
+    }
+
+    if (!object->keys.offset) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "null key array in map struct";
+      return ValidationError::UNEXPECTED_NULL_POINTER;
+    }
+
+    DecodePointer(&object->keys.offset, &object->keys.ptr);
+    const ArrayValidateParams* key_validate_params =
+        MapKeyValidateParamsFactory<Key>::Get();
+    retval = Array_Data<Key>::ValidateAndDecode(
+        object->keys.ptr, bounds_checker, key_validate_params, handles, err);
+    if (retval != ValidationError::NONE)
+      return retval;
+
+    if (!ValidateEncodedPointer(&object->values.offset)) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
+      return ValidationError::ILLEGAL_POINTER;
+    }
+
+    if (!object->values.offset) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err)
+          << "null value array in map struct";
+      return ValidationError::UNEXPECTED_NULL_POINTER;
+    }
+
+    DecodePointer(&object->values.offset, &object->values.ptr);
+    retval = Array_Data<Value>::ValidateAndDecode(
+        object->values.ptr, bounds_checker, value_validate_params, handles,
+        err);
+    if (retval != ValidationError::NONE)
+      return retval;
+
+    if (object->keys.ptr->size() != object->values.ptr->size()) {
+      FIDL_INTERNAL_DEBUG_SET_ERROR_MSG(err) << "";
+      return ValidationError::DIFFERENT_SIZED_ARRAYS_IN_MAP;
+    }
+
+    return ValidationError::NONE;
+  }
+
   StructHeader header_;
 
   ArrayPointer<Key> keys;
@@ -4,6 +4,8 @@
 
 #include "lib/fidl/cpp/bindings/internal/message_validation.h"
 
+#include <zircon/syscalls.h>
+
 #include <string>
 
 #include "lib/fidl/cpp/bindings/internal/validation_errors.h"
@@ -53,5 +55,16 @@ ValidationError ValidateMessageIsResponse(const Message* message,
   return ValidationError::NONE;
 }
 
+void CloseDecodedHandles(const zx_handle_t* original_handles,
+                         std::vector<zx_handle_t>* handles) {
+  for (size_t i = 0; i < handles->size(); ++i) {
+    // Decoding leaves a hole behind for every handle it takes.
+    if (original_handles[i] != ZX_HANDLE_INVALID &&
+        (*handles)[i] == ZX_HANDLE_INVALID) {
+      zx_handle_close(original_handles[i]);
+    }
+  }
+}
+
 }  // namespace internal
 }  // namespace fidl
@@ -5,7 +5,11 @@
 #ifndef LIB_FIDL_CPP_BINDINGS_INTERNAL_MESSAGE_VALIDATION_H_
 #define LIB_FIDL_CPP_BINDINGS_INTERNAL_MESSAGE_VALIDATION_H_
 
+#include <zircon/types.h>
+
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "lib/fidl/cpp/bindings/internal/bounds_checker.h"
 #include "lib/fidl/cpp/bindings/internal/validation_errors.h"
@@ -34,6 +38,48 @@ ValidationError ValidateMessagePayload(const Message* message,
   return ParamsType::Validate(message->payload(), &bounds_checker, err);
 }
 
+// Closes the handles in |original_handles| that a failed call to
+// |ValidateAndDecodeMessagePayload| already took out of |handles|.
+// |original_handles| holds |handles->size()| entries.
+void CloseDecodedHandles(const zx_handle_t* original_handles,
+                         std::vector<zx_handle_t>* handles);
+
+// Validates that the message payload is a valid struct of type ParamsType and
+// decodes its pointers and handles in place, walking the payload only once.
+// On success, the payload may be deserialized directly. On failure, the
+// payload contents are unspecified, but no handles are leaked.
+template <typename ParamsType>
+ValidationError ValidateAndDecodeMessagePayload(Message* message,
+                                                std::string* err) {
+  std::vector<zx_handle_t>* handles = message->mutable_handles();
+  BoundsChecker bounds_checker(message->payload(), message->payload_num_bytes(),
+                               handles->size());
+  if (handles->empty()) {
+    return ParamsType::ValidateAndDecode(message->mutable_payload(),
+                                         &bounds_checker, handles, err);
+  }
+
+  // Decoding moves handles out of |message|. Remember them so that the ones
+  // that were already moved can be closed if validation fails part way. A
+  // message read from a channel carries at most ZX_CHANNEL_MAX_MSG_HANDLES
+  // handles, so this normally stays off the heap.
+  zx_handle_t stack_handles[ZX_CHANNEL_MAX_MSG_HANDLES];
+  std::vector<zx_handle_t> heap_handles;
+  const zx_handle_t* original_handles = stack_handles;
+  if (handles->size() <= ZX_CHANNEL_MAX_MSG_HANDLES) {
+    std::copy(handles->begin(), handles->end(), stack_handles);
+  } else {
+    heap_handles = *handles;
+    original_handles = heap_handles.data();
+  }
+
+  ValidationError retval = ParamsType::ValidateAndDecode(
+      message->mutable_payload(), &bounds_checker, handles, err);
+  if (retval != ValidationError::NONE)
+    CloseDecodedHandles(original_handles, handles);
+  return retval;
+}
+
 }  // namespace internal
 }  // namespace fidl
 
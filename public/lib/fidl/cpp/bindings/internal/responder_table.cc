@@ -0,0 +1,68 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fidl/cpp/bindings/internal/responder_table.h"
+
+#include <zircon/assert.h>
+
+namespace fidl {
+namespace internal {
+namespace {
+
+constexpr uint64_t kSlotIndexMask = 0xffffffffu;
+constexpr int kGenerationShift = 32;
+
+}  // namespace
+
+ResponderTable::ResponderTable() = default;
+
+ResponderTable::~ResponderTable() {
+  for (const Slot& slot : slots_)
+    delete slot.responder;
+}
+
+uint64_t ResponderTable::Add(MessageReceiver* responder) {
+  ZX_DEBUG_ASSERT(responder);
+
+  uint32_t index;
+  if (free_slots_.empty()) {
+    ZX_ASSERT(slots_.size() <= kSlotIndexMask);
+    index = static_cast<uint32_t>(slots_.size());
+    slots_.emplace_back();
+  } else {
+    // Reuse the most recently released slot; it is the most likely to still
+    // be in cache.
+    index = free_slots_.back();
+    free_slots_.pop_back();
+  }
+
+  Slot& slot = slots_[index];
+  ZX_DEBUG_ASSERT(!slot.responder);
+  slot.responder = responder;
+  ++size_;
+  return (static_cast<uint64_t>(slot.generation) << kGenerationShift) | index;
+}
+
+MessageReceiver* ResponderTable::Remove(uint64_t request_id) {
+  uint64_t index = request_id & kSlotIndexMask;
+  uint32_t generation = static_cast<uint32_t>(request_id >> kGenerationShift);
+  if (index >= slots_.size())
+    return nullptr;
+
+  Slot& slot = slots_[index];
+  if (slot.generation != generation || !slot.responder)
+    return nullptr;
+
+  MessageReceiver* responder = slot.responder;
+  slot.responder = nullptr;
+  // Skip generation 0 on wrap-around so that request IDs stay non-zero.
+  if (++slot.generation == 0)
+    slot.generation = 1;
+  free_slots_.push_back(static_cast<uint32_t>(index));
+  --size_;
+  return responder;
+}
+
+}  // namespace internal
+}  // namespace fidl
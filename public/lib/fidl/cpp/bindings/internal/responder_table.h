@@ -0,0 +1,65 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FIDL_CPP_BINDINGS_INTERNAL_RESPONDER_TABLE_H_
+#define LIB_FIDL_CPP_BINDINGS_INTERNAL_RESPONDER_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "lib/fidl/cpp/bindings/message.h"
+
+namespace fidl {
+namespace internal {
+
+// ResponderTable holds the responders for requests that are waiting for a
+// response, indexed by request ID.
+//
+// Responders live in a flat array of slots. A request ID carries the index of
+// its slot in the low 32 bits and the slot's generation in the high 32 bits.
+// Slots are recycled as soon as their response arrives; bumping the generation
+// on every release means that a stale or forged request ID never matches a
+// recycled slot. Generations start at 1, so a request ID is never 0.
+//
+// Insertion and removal are O(1) and, once the table has grown to the number
+// of calls in flight, do not allocate.
+class ResponderTable {
+ public:
+  ResponderTable();
+  ~ResponderTable();
+
+  ResponderTable(const ResponderTable&) = delete;
+  ResponderTable& operator=(const ResponderTable&) = delete;
+
+  // Stores |responder| and returns the request ID that refers to it. The
+  // table takes ownership of |responder|.
+  uint64_t Add(MessageReceiver* responder);
+
+  // Removes the responder for |request_id| and returns it, passing ownership
+  // back to the caller. Returns nullptr if |request_id| does not refer to an
+  // outstanding request.
+  MessageReceiver* Remove(uint64_t request_id);
+
+  // Returns the number of outstanding requests.
+  size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+ private:
+  struct Slot {
+    MessageReceiver* responder = nullptr;
+    uint32_t generation = 1;
+  };
+
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+  size_t size_ = 0;
+};
+
+}  // namespace internal
+}  // namespace fidl
+
+#endif  // LIB_FIDL_CPP_BINDINGS_INTERNAL_RESPONDER_TABLE_H_
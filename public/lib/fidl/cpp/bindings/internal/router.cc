@@ -80,7 +80,6 @@ Router::Router(zx::channel channel, MessageValidatorList validators)
       connector_(std::move(channel)),
       weak_self_(this),
       incoming_receiver_(nullptr),
-      next_request_id_(0),
       testing_mode_(false) {
   // This receiver thunk redirects to Router::HandleIncomingMessage.
   connector_.set_incoming_receiver(&thunk_);
@@ -88,11 +87,6 @@ Router::Router(zx::channel channel, MessageValidatorList validators)
 
 Router::~Router() {
   weak_self_.set_value(nullptr);
-
-  for (ResponderMap::const_iterator i = responders_.begin();
-       i != responders_.end(); ++i) {
-    delete i->second;
-  }
 }
 
 bool Router::Accept(Message* message) {
@@ -103,17 +97,18 @@ bool Router::Accept(Message* message) {
 bool Router::AcceptWithResponder(Message* message, MessageReceiver* responder) {
   ZX_DEBUG_ASSERT(message->has_flag(kMessageExpectsResponse));
 
-  // Reserve 0 in case we want it to convey special meaning in the future.
-  uint64_t request_id = next_request_id_++;
-  if (request_id == 0)
-    request_id = next_request_id_++;
+  // The responder table never hands out 0, which stays reserved in case we
+  // want it to convey special meaning in the future.
+  uint64_t request_id = responders_.Add(responder);
 
   message->set_request_id(request_id);
-  if (!connector_.Accept(message))
+  if (!connector_.Accept(message)) {
+    // Ownership of |responder| stays with the caller on failure.
+    responders_.Remove(request_id);
     return false;
+  }
 
   // We assume ownership of |responder|.
-  responders_[request_id] = responder;
   return true;
 }
 
@@ -146,14 +141,11 @@ bool Router::HandleIncomingMessage(Message* message) {
     // listening, then we have no choice but to tear down the channel.
     connector_.CloseChannel();
   } else if (message->has_flag(kMessageIsResponse)) {
-    uint64_t request_id = message->request_id();
-    ResponderMap::iterator it = responders_.find(request_id);
-    if (it == responders_.end()) {
+    MessageReceiver* responder = responders_.Remove(message->request_id());
+    if (!responder) {
       ZX_DEBUG_ASSERT(testing_mode_);
       return false;
     }
-    MessageReceiver* responder = it->second;
-    responders_.erase(it);
     bool ok = responder->Accept(message);
     delete responder;
     return ok;
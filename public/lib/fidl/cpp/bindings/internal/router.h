@@ -5,9 +5,8 @@
 #ifndef LIB_FIDL_CPP_BINDINGS_INTERNAL_ROUTER_H_
 #define LIB_FIDL_CPP_BINDINGS_INTERNAL_ROUTER_H_
 
-#include <map>
-
 #include "lib/fidl/cpp/bindings/internal/connector.h"
+#include "lib/fidl/cpp/bindings/internal/responder_table.h"
 #include "lib/fidl/cpp/bindings/internal/shared_data.h"
 #include "lib/fidl/cpp/bindings/internal/validation_errors.h"
 #include "lib/fidl/cpp/bindings/message_validator.h"
@@ -73,8 +72,6 @@ class Router : public MessageReceiverWithResponder {
   zx_handle_t handle() const { return connector_.handle(); }
 
  private:
-  typedef std::map<uint64_t, MessageReceiver*> ResponderMap;
-
   // This class is registered for incoming messages from the |Connector|.  It
   // simply forwards them to |Router::HandleIncomingMessages|.
   class HandleIncomingMessageThunk : public MessageReceiver {
@@ -96,8 +93,7 @@ class Router : public MessageReceiverWithResponder {
   Connector connector_;
   SharedData<Router*> weak_self_;
   MessageReceiverWithResponderStatus* incoming_receiver_;
-  ResponderMap responders_;
-  uint64_t next_request_id_;
+  ResponderTable responders_;
   bool testing_mode_;
 };
 
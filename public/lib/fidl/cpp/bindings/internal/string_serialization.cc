@@ -9,12 +9,31 @@
 namespace fidl {
 
 size_t GetSerializedSize_(const String& input) {
+  return GetSerializedSize_(StringView(input));
+}
+
+void SerializeString_(const String& input,
+                      internal::Buffer* buf,
+                      internal::String_Data** output) {
+  SerializeString_(StringView(input), buf, output);
+}
+
+void Deserialize_(internal::String_Data* input, String* output) {
+  if (input) {
+    String result(input->storage(), input->size());
+    result.Swap(output);
+  } else {
+    output->reset();
+  }
+}
+
+size_t GetSerializedSize_(const StringView& input) {
   if (!input)
     return 0;
   return internal::Align(sizeof(internal::String_Data) + input.size());
 }
 
-void SerializeString_(const String& input,
+void SerializeString_(const StringView& input,
                       internal::Buffer* buf,
                       internal::String_Data** output) {
   if (input) {
@@ -28,12 +47,11 @@ void SerializeString_(const String& input,
   }
 }
 
-void Deserialize_(internal::String_Data* input, String* output) {
+void Deserialize_(internal::String_Data* input, StringView* output) {
   if (input) {
-    String result(input->storage(), input->size());
-    result.Swap(output);
+    *output = StringView(input->storage(), input->size());
   } else {
-    output->reset();
+    *output = StringView();
   }
 }
 
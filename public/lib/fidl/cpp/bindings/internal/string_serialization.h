@@ -7,6 +7,7 @@
 
 #include "lib/fidl/cpp/bindings/internal/array_internal.h"
 #include "lib/fidl/cpp/bindings/string.h"
+#include "lib/fidl/cpp/bindings/string_view.h"
 
 namespace fidl {
 
@@ -17,6 +18,15 @@ void SerializeString_(const String& input,
 
 void Deserialize_(internal::String_Data* input, String* output);
 
+size_t GetSerializedSize_(const StringView& input);
+void SerializeString_(const StringView& input,
+                      internal::Buffer* buffer,
+                      internal::String_Data** output);
+
+// Points |output| at the characters in |input| without copying them. |output|
+// is only valid for as long as |input| is.
+void Deserialize_(internal::String_Data* input, StringView* output);
+
 }  // namespace fidl
 
 #endif  // LIB_FIDL_CPP_BINDINGS_INTERNAL_STRING_SERIALIZATION_H_
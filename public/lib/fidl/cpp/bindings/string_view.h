@@ -0,0 +1,89 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FIDL_CPP_BINDINGS_STRING_VIEW_H_
+#define LIB_FIDL_CPP_BINDINGS_STRING_VIEW_H_
+
+#include <stddef.h>
+#include <string.h>
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+#include "lib/fidl/cpp/bindings/string.h"
+
+namespace fidl {
+
+// A read-only view of a UTF-8 encoded character string that it does not own.
+// Like |String|, the view can be null, which is distinct from empty. The
+// viewed characters are not necessarily followed by a terminating '\0'.
+//
+// Methods with the [ViewParams=true] attribute receive their string parameters
+// as |StringView|s that point directly into the incoming message, which avoids
+// copying large payloads. The view is only valid until the method returns; use
+// |ToString()| to keep the contents around for longer.
+//
+// Proxies accept a |StringView| for the same parameters. |String|s,
+// |std::string|s and C strings convert to it implicitly.
+class StringView {
+ public:
+  using ConstIterator = const char*;
+
+  StringView() : data_(nullptr), size_(0u), is_null_(true) {}
+  StringView(std::nullptr_t) : StringView() {}
+  StringView(const char* chars, size_t num_chars)
+      : data_(chars), size_(num_chars), is_null_(false) {}
+  // |chars| may be null, in which case the view is null.
+  StringView(const char* chars)
+      : data_(chars), size_(chars ? strlen(chars) : 0u), is_null_(!chars) {}
+  StringView(const std::string& str)
+      : data_(str.data()), size_(str.size()), is_null_(false) {}
+  StringView(const String& str)
+      : data_(str.data()), size_(str.size()), is_null_(str.is_null()) {}
+
+  // Tests as true if non-null, false if null.
+  explicit operator bool() const { return !is_null_; }
+
+  bool is_null() const { return is_null_; }
+
+  bool empty() const { return size_ == 0u; }
+
+  size_t size() const { return size_; }
+
+  const char* data() const { return data_; }
+
+  const char& operator[](size_t offset) const { return data_[offset]; }
+
+  ConstIterator begin() const { return data_; }
+  ConstIterator end() const { return data_ + size_; }
+
+  // Returns a copy of the viewed string that owns its contents.
+  String ToString() const {
+    if (is_null_)
+      return String();
+    return String(data_, size_);
+  }
+
+ private:
+  const char* data_;
+  size_t size_;
+  bool is_null_;
+};
+
+inline bool operator==(const StringView& a, const StringView& b) {
+  return a.is_null() == b.is_null() && a.size() == b.size() &&
+         (a.size() == 0u || memcmp(a.data(), b.data(), a.size()) == 0);
+}
+inline bool operator!=(const StringView& a, const StringView& b) {
+  return !(a == b);
+}
+
+inline std::ostream& operator<<(std::ostream& out, const StringView& s) {
+  return out.write(s.data(), s.size());
+}
+
+}  // namespace fidl
+
+#endif  // LIB_FIDL_CPP_BINDINGS_STRING_VIEW_H_
@@ -4,6 +4,7 @@
 
 #include "gtest/gtest.h"
 #include "lib/fidl/cpp/bindings/array.h"
+#include "lib/fidl/cpp/bindings/array_view.h"
 #include "lib/fidl/cpp/bindings/internal/array_internal.h"
 #include "lib/fidl/cpp/bindings/internal/array_serialization.h"
 #include "lib/fidl/cpp/bindings/internal/fixed_buffer.h"
@@ -242,6 +243,51 @@ TEST(ArrayTest, Serialization_EmptyArrayOfPOD) {
   EXPECT_EQ(0U, array2.size());
 }
 
+TEST(ArrayTest, Serialization_ArrayView) {
+  std::vector<int32_t> values = {1, 2, 3, 4};
+  ArrayView<int32_t> view(values);
+
+  size_t size = GetSerializedSize_(view);
+  EXPECT_EQ(8U + 4 * 4U, size);
+
+  FixedBufferForTesting buf(size);
+  Array_Data<int32_t>* data = nullptr;
+  ArrayValidateParams validate_params(0, false, nullptr);
+  EXPECT_EQ(fidl::internal::ValidationError::NONE,
+            SerializeArray_(&view, &buf, &data, &validate_params));
+
+  // Deserializing into a view borrows the serialized elements.
+  ArrayView<int32_t> view2;
+  Deserialize_(data, &view2);
+  EXPECT_FALSE(view2.is_null());
+  EXPECT_EQ(data->storage(), view2.data());
+  EXPECT_TRUE(view.Equals(view2));
+
+  Array<int32_t> array = view2.ToArray();
+  EXPECT_EQ(4U, array.size());
+  for (size_t i = 0; i < array.size(); ++i)
+    EXPECT_EQ(values[i], array[i]);
+}
+
+TEST(ArrayTest, Serialization_NullArrayView) {
+  ArrayView<uint8_t> view;
+  EXPECT_EQ(0U, GetSerializedSize_(view));
+
+  FixedBufferForTesting buf(8);
+  Array_Data<uint8_t>* data = nullptr;
+  ArrayValidateParams validate_params(0, true, nullptr);
+  EXPECT_EQ(fidl::internal::ValidationError::NONE,
+            SerializeArray_(&view, &buf, &data, &validate_params));
+  EXPECT_EQ(nullptr, data);
+
+  auto empty = Array<uint8_t>::New(0);
+  ArrayView<uint8_t> view2(empty);
+  EXPECT_FALSE(view2.is_null());
+  Deserialize_(data, &view2);
+  EXPECT_TRUE(view2.is_null());
+  EXPECT_TRUE(view2.ToArray().is_null());
+}
+
 TEST(ArrayTest, Serialization_ArrayOfArrayOfPOD) {
   auto array = Array<Array<int32_t>>::New(2);
   for (size_t j = 0; j < array.size(); ++j) {
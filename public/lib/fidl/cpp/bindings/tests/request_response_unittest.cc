@@ -50,6 +50,20 @@ class ProviderImpl : public sample::Provider {
   Binding<sample::Provider> binding_;
 };
 
+class ViewProviderImpl : public sample::ViewProvider {
+ public:
+  explicit ViewProviderImpl(InterfaceRequest<sample::ViewProvider> request)
+      : binding_(this, std::move(request)) {}
+
+  void EchoView(StringView a,
+                ArrayView<uint8_t> b,
+                const EchoViewCallback& callback) override {
+    callback(a.ToString(), b.ToArray());
+  }
+
+  Binding<sample::ViewProvider> binding_;
+};
+
 class StringRecorder {
  public:
   explicit StringRecorder(std::string* buf) : buf_(buf) {}
@@ -141,6 +155,44 @@ TEST_F(RequestResponseTest, EchoEnum) {
   EXPECT_EQ(sample::Enum::VALUE, value);
 }
 
+TEST_F(RequestResponseTest, EchoView) {
+  sample::ViewProviderPtr provider;
+  ViewProviderImpl provider_impl(provider.NewRequest());
+
+  String a;
+  Array<uint8_t> b;
+  std::vector<uint8_t> bytes = {1, 2, 3};
+  provider->EchoView("hello", bytes,
+                     [&a, &b](const String& out_a, Array<uint8_t> out_b) {
+                       a = out_a;
+                       b = std::move(out_b);
+                     });
+
+  PumpMessages();
+
+  EXPECT_EQ(std::string("hello"), a.get());
+  EXPECT_EQ(3u, b.size());
+  EXPECT_EQ(3u, b[2]);
+}
+
+TEST_F(RequestResponseTest, EchoNullView) {
+  sample::ViewProviderPtr provider;
+  ViewProviderImpl provider_impl(provider.NewRequest());
+
+  bool called = false;
+  String a("not null");
+  provider->EchoView(nullptr, Array<uint8_t>::New(0),
+                     [&called, &a](const String& out_a, Array<uint8_t> out_b) {
+                       called = true;
+                       a = out_a;
+                     });
+
+  PumpMessages();
+
+  EXPECT_TRUE(called);
+  EXPECT_TRUE(a.is_null());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace fidl
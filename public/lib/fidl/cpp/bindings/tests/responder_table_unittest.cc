@@ -0,0 +1,129 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fidl/cpp/bindings/internal/responder_table.h"
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace fidl {
+namespace test {
+namespace {
+
+// Counts how many instances have been destroyed.
+class CountingReceiver : public MessageReceiver {
+ public:
+  explicit CountingReceiver(int* destroyed) : destroyed_(destroyed) {}
+  ~CountingReceiver() override { ++*destroyed_; }
+
+  bool Accept(Message* message) override { return true; }
+
+ private:
+  int* destroyed_;
+};
+
+TEST(ResponderTableTest, AddRemove) {
+  int destroyed = 0;
+  internal::ResponderTable table;
+  EXPECT_TRUE(table.empty());
+
+  CountingReceiver* a = new CountingReceiver(&destroyed);
+  CountingReceiver* b = new CountingReceiver(&destroyed);
+  uint64_t id_a = table.Add(a);
+  uint64_t id_b = table.Add(b);
+  EXPECT_NE(0u, id_a);
+  EXPECT_NE(0u, id_b);
+  EXPECT_NE(id_a, id_b);
+  EXPECT_EQ(2u, table.size());
+
+  EXPECT_EQ(b, table.Remove(id_b));
+  EXPECT_EQ(a, table.Remove(id_a));
+  EXPECT_TRUE(table.empty());
+
+  // Removing hands ownership back to the caller.
+  EXPECT_EQ(0, destroyed);
+  delete a;
+  delete b;
+}
+
+TEST(ResponderTableTest, UnknownIdsAreRejected) {
+  int destroyed = 0;
+  internal::ResponderTable table;
+  EXPECT_EQ(nullptr, table.Remove(0u));
+  EXPECT_EQ(nullptr, table.Remove(12345u));
+
+  CountingReceiver* a = new CountingReceiver(&destroyed);
+  uint64_t id = table.Add(a);
+  EXPECT_EQ(nullptr, table.Remove(id + 1));
+  EXPECT_EQ(a, table.Remove(id));
+
+  // A second response with the same ID must not find anything.
+  EXPECT_EQ(nullptr, table.Remove(id));
+  delete a;
+}
+
+TEST(ResponderTableTest, RecycledSlotsGetFreshIds) {
+  int destroyed = 0;
+  internal::ResponderTable table;
+
+  CountingReceiver* a = new CountingReceiver(&destroyed);
+  uint64_t old_id = table.Add(a);
+  EXPECT_EQ(a, table.Remove(old_id));
+
+  // The slot is reused, but under a different request ID, so a stale response
+  // for the old request cannot steal the new responder.
+  uint64_t new_id = table.Add(a);
+  EXPECT_NE(old_id, new_id);
+  EXPECT_EQ(nullptr, table.Remove(old_id));
+  EXPECT_EQ(a, table.Remove(new_id));
+  delete a;
+}
+
+TEST(ResponderTableTest, ManyInFlight) {
+  int destroyed = 0;
+  internal::ResponderTable table;
+  constexpr size_t kCount = 1000;
+
+  for (int round = 0; round < 3; ++round) {
+    std::vector<std::pair<uint64_t, MessageReceiver*>> entries;
+    std::set<uint64_t> ids;
+    for (size_t i = 0; i < kCount; ++i) {
+      MessageReceiver* receiver = new CountingReceiver(&destroyed);
+      uint64_t id = table.Add(receiver);
+      EXPECT_TRUE(ids.insert(id).second);
+      entries.emplace_back(id, receiver);
+    }
+    EXPECT_EQ(kCount, table.size());
+
+    // Complete in a different order than issued.
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+      MessageReceiver* receiver = table.Remove(it->first);
+      EXPECT_EQ(it->second, receiver);
+      delete receiver;
+    }
+    EXPECT_TRUE(table.empty());
+  }
+  EXPECT_EQ(static_cast<int>(3 * kCount), destroyed);
+}
+
+TEST(ResponderTableTest, DestructorDeletesOutstandingResponders) {
+  int destroyed = 0;
+  {
+    internal::ResponderTable table;
+    table.Add(new CountingReceiver(&destroyed));
+    table.Add(new CountingReceiver(&destroyed));
+    MessageReceiver* removed =
+        table.Remove(table.Add(new CountingReceiver(&destroyed)));
+    delete removed;
+    EXPECT_EQ(1, destroyed);
+  }
+  EXPECT_EQ(3, destroyed);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace fidl
@@ -6,6 +6,7 @@
 
 #include "gtest/gtest.h"
 #include "lib/fidl/cpp/bindings/string.h"
+#include "lib/fidl/cpp/bindings/string_view.h"
 
 namespace fidl {
 namespace test {
@@ -127,5 +128,53 @@ TEST(StringTest, OutputFormatting) {
   EXPECT_EQ("s=abc, null=", so.str());
 }
 
+TEST(StringViewTest, Nullness) {
+  StringView view;
+  EXPECT_TRUE(view.is_null());
+  EXPECT_TRUE(StringView(nullptr).is_null());
+
+  const char* null = nullptr;
+  EXPECT_TRUE(StringView(null).is_null());
+  EXPECT_TRUE(StringView(String()).is_null());
+  EXPECT_TRUE(StringView(String()).ToString().is_null());
+
+  StringView empty("");
+  EXPECT_FALSE(empty.is_null());
+  EXPECT_TRUE(empty.empty());
+  EXPECT_NE(view, empty);
+}
+
+TEST(StringViewTest, ViewsWithoutCopying) {
+  String s("hello world");
+  StringView view(s);
+  EXPECT_FALSE(view.is_null());
+  EXPECT_EQ(s.data(), view.data());
+  EXPECT_EQ(11u, view.size());
+  EXPECT_EQ('w', view[6]);
+
+  std::string str("hello world");
+  EXPECT_EQ(str.data(), StringView(str).data());
+  EXPECT_EQ(view, StringView(str));
+  EXPECT_EQ(view, StringView("hello world"));
+  EXPECT_EQ(StringView("hello"), StringView("hello world", 5));
+  EXPECT_NE(view, StringView("hello"));
+}
+
+TEST(StringViewTest, ToString) {
+  std::string str("abc");
+  String copy = StringView(str).ToString();
+  str[0] = 'x';
+  EXPECT_EQ(std::string("abc"), copy.get());
+}
+
+TEST(StringViewTest, OutputFormatting) {
+  StringView s("abcdef", 3);
+  StringView null;
+
+  std::ostringstream so;
+  so << "s=" << s << ", null=" << null;
+  EXPECT_EQ("s=abc, null=", so.str());
+}
+
 }  // namespace test
 }  // namespace fidl
@@ -9,6 +9,7 @@
 #include <zx/channel.h>
 
 #include "gtest/gtest.h"
+#include "lib/fidl/cpp/bindings/internal/bounds_checker.h"
 #include "lib/fidl/cpp/bindings/internal/fixed_buffer.h"
 #include "lib/fidl/cpp/bindings/internal/validation_errors.h"
 #include "lib/fidl/compiler/interfaces/tests/test_structs.fidl.h"
@@ -460,5 +461,63 @@ TEST(StructTest, Versioning_NewToOld) {
   }
 }
 
+// Validating and decoding in a single pass yields the same struct as
+// validating and then decoding.
+TEST(StructTest, ValidateAndDecode) {
+  MultiVersionStructPtr input = MakeMultiVersionStruct();
+
+  size_t size = GetSerializedSize_(*input);
+  fidl::internal::FixedBufferForTesting buf(size);
+  internal::MultiVersionStruct_Data* data;
+  EXPECT_EQ(fidl::internal::ValidationError::NONE,
+            Serialize_(input.get(), &buf, &data));
+
+  std::vector<zx_handle_t> handles;
+  data->EncodePointersAndHandles(&handles);
+  ASSERT_EQ(1U, handles.size());
+
+  fidl::internal::BoundsChecker bounds_checker(
+      data, static_cast<uint32_t>(size), handles.size());
+  EXPECT_EQ(fidl::internal::ValidationError::NONE,
+            internal::MultiVersionStruct_Data::ValidateAndDecode(
+                data, &bounds_checker, &handles, nullptr));
+  // The handle has been moved into the struct.
+  EXPECT_EQ(static_cast<zx_handle_t>(ZX_HANDLE_INVALID), handles[0]);
+
+  MultiVersionStructPtr output(MultiVersionStruct::New());
+  Deserialize_(data, output.get());
+  EXPECT_EQ(123, output->f_int32);
+  CheckRect(*output->f_rect, 5);
+  EXPECT_EQ("hello", output->f_string);
+  ASSERT_EQ(3U, output->f_array.size());
+  EXPECT_EQ(8, output->f_array[2]);
+  EXPECT_TRUE(output->f_message_pipe);
+  EXPECT_EQ(42, output->f_int16);
+}
+
+TEST(StructTest, ValidateAndDecode_IllegalHandle) {
+  MultiVersionStructPtr input = MakeMultiVersionStruct();
+
+  size_t size = GetSerializedSize_(*input);
+  fidl::internal::FixedBufferForTesting buf(size);
+  internal::MultiVersionStruct_Data* data;
+  EXPECT_EQ(fidl::internal::ValidationError::NONE,
+            Serialize_(input.get(), &buf, &data));
+
+  std::vector<zx_handle_t> handles;
+  data->EncodePointersAndHandles(&handles);
+  ASSERT_EQ(1U, handles.size());
+  zx::channel handle(handles[0]);
+
+  // The message claims to carry no handles, so the handle index is out of
+  // range and nothing may be taken out of |handles|.
+  fidl::internal::BoundsChecker bounds_checker(
+      data, static_cast<uint32_t>(size), 0);
+  EXPECT_EQ(fidl::internal::ValidationError::ILLEGAL_HANDLE,
+            internal::MultiVersionStruct_Data::ValidateAndDecode(
+                data, &bounds_checker, &handles, nullptr));
+  EXPECT_EQ(handle.get(), handles[0]);
+}
+
 }  // namespace test
 }  // namespace fidl
@@ -770,6 +770,54 @@ TEST(UnionTest, StructInUnionSerialization) {
   EXPECT_EQ(8, obj2->get_f_dummy()->f_int8);
 }
 
+TEST(UnionTest, StructInUnionValidateAndDecode) {
+  DummyStructPtr dummy(DummyStruct::New());
+  dummy->f_int8 = 8;
+
+  ObjectUnionPtr obj(ObjectUnion::New());
+  obj->set_f_dummy(std::move(dummy));
+
+  size_t size = GetSerializedSize_(obj);
+  fidl::internal::FixedBufferForTesting buf(size);
+  auto* data = internal::ObjectUnion_Data::New(&buf);
+  SerializeUnion_(obj.get(), &buf, &data);
+
+  std::vector<zx_handle_t> handles;
+  data->EncodePointersAndHandles(&handles);
+
+  fidl::internal::BoundsChecker bounds_checker(data,
+                                               static_cast<uint32_t>(size), 0);
+  EXPECT_EQ(fidl::internal::ValidationError::NONE,
+            internal::ObjectUnion_Data::ValidateAndDecode(
+                data, &bounds_checker, false, &handles, nullptr));
+
+  ObjectUnionPtr obj2 = ObjectUnion::New();
+  Deserialize_(data, obj2.get());
+  EXPECT_EQ(8, obj2->get_f_dummy()->f_int8);
+}
+
+TEST(UnionTest, StringValidateAndDecodeOOB) {
+  size_t size = 32;
+  fidl::internal::FixedBufferForTesting buf(size);
+  internal::ObjectUnion_Data* data = internal::ObjectUnion_Data::New(&buf);
+  data->size = 16;
+  data->tag = internal::ObjectUnion_Data::ObjectUnion_Tag::F_STRING;
+
+  data->data.f_f_string.offset = 8;
+  char* ptr = reinterpret_cast<char*>(&data->data.f_f_string);
+  fidl::internal::ArrayHeader* array_header =
+      reinterpret_cast<fidl::internal::ArrayHeader*>(ptr + *ptr);
+  array_header->num_bytes = 20;  // This should go out of bounds.
+  array_header->num_elements = 20;
+  fidl::internal::BoundsChecker bounds_checker(data, 32, 0);
+  std::vector<zx_handle_t> handles;
+  void* raw_buf = buf.Leak();
+  EXPECT_NE(fidl::internal::ValidationError::NONE,
+            internal::ObjectUnion_Data::ValidateAndDecode(
+                raw_buf, &bounds_checker, false, &handles, nullptr));
+  free(raw_buf);
+}
+
 TEST(UnionTest, StructInUnionValidation) {
   DummyStructPtr dummy(DummyStruct::New());
   dummy->f_int8 = 8;
@@ -70,8 +70,23 @@ bool TestInputParser(const std::string& input,
   return !result && !error_message.empty();
 }
 
+// Validates and decodes the payload of a message that the validators have
+// accepted, the way the stub or response callback of the interface does.
+using PayloadValidator = ValidationError (*)(Message* message,
+                                             std::string* err);
+
+void InitMessage(const std::vector<uint8_t>& data,
+                 size_t num_handles,
+                 Message* message) {
+  message->AllocUninitializedData(data.size());
+  if (!data.empty())
+    memcpy(message->mutable_data(), &data[0], data.size());
+  message->mutable_handles()->resize(num_handles);
+}
+
 void RunValidationTests(const std::string& prefix,
                         const MessageValidatorList& validators,
+                        PayloadValidator payload_validator,
                         MessageReceiver* test_message_receiver) {
   std::vector<std::string> tests = validation_util::GetMatchingTests(prefix);
 
@@ -83,13 +98,18 @@ void RunValidationTests(const std::string& prefix,
                                               &expected));
 
     Message message;
-    message.AllocUninitializedData(data.size());
-    if (!data.empty())
-      memcpy(message.mutable_data(), &data[0], data.size());
-    message.mutable_handles()->resize(num_handles);
+    InitMessage(data, num_handles, &message);
 
     std::string actual;
     auto result = RunValidatorsOnMessage(validators, &message, nullptr);
+    if (result == ValidationError::NONE) {
+      // Decoding changes the payload in place, so check a copy and pass on
+      // |message| as it was received.
+      Message payload_message;
+      InitMessage(data, num_handles, &payload_message);
+      result = payload_validator(&payload_message, nullptr);
+    }
+
     if (result == ValidationError::NONE) {
       ignore_result(test_message_receiver->Accept(&message));
       actual = "PASS";
@@ -295,7 +315,10 @@ TEST(ValidationTest, Conformance) {
   validators.push_back(std::unique_ptr<MessageValidator>(
       new ConformanceTestInterface::RequestValidator_));
 
-  RunValidationTests("conformance_", validators, &dummy_receiver);
+  RunValidationTests("conformance_", validators,
+                     &ConformanceTestInterface::RequestValidator_::
+                         ValidateAndDecodePayload,
+                     &dummy_receiver);
 }
 
 // This test is similar to Conformance test but its goal is specifically
@@ -309,7 +332,10 @@ TEST(ValidationTest, BoundsCheck) {
   validators.push_back(std::unique_ptr<MessageValidator>(
       new BoundsCheckTestInterface::RequestValidator_));
 
-  RunValidationTests("boundscheck_", validators, &dummy_receiver);
+  RunValidationTests("boundscheck_", validators,
+                     &BoundsCheckTestInterface::RequestValidator_::
+                         ValidateAndDecodePayload,
+                     &dummy_receiver);
 }
 
 // This test is similar to the Conformance test but for responses.
@@ -321,7 +347,10 @@ TEST(ValidationTest, ResponseConformance) {
   validators.push_back(std::unique_ptr<MessageValidator>(
       new ConformanceTestInterface::ResponseValidator_));
 
-  RunValidationTests("resp_conformance_", validators, &dummy_receiver);
+  RunValidationTests("resp_conformance_", validators,
+                     &ConformanceTestInterface::ResponseValidator_::
+                         ValidateAndDecodePayload,
+                     &dummy_receiver);
 }
 
 // This test is similar to the BoundsCheck test but for responses.
@@ -333,7 +362,10 @@ TEST(ValidationTest, ResponseBoundsCheck) {
   validators.push_back(std::unique_ptr<MessageValidator>(
       new BoundsCheckTestInterface::ResponseValidator_));
 
-  RunValidationTests("resp_boundscheck_", validators, &dummy_receiver);
+  RunValidationTests("resp_boundscheck_", validators,
+                     &BoundsCheckTestInterface::ResponseValidator_::
+                         ValidateAndDecodePayload,
+                     &dummy_receiver);
 }
 
 // Test that InterfacePtr<X> applies the correct validators and they don't
@@ -352,9 +384,12 @@ TEST_F(ValidationIntegrationTest, InterfacePtr) {
   validators.push_back(std::unique_ptr<MessageValidator>(
       new typename IntegrationTestInterface::ResponseValidator_));
 
-  RunValidationTests("integration_intf_resp", validators,
+  PayloadValidator payload_validator =
+      &IntegrationTestInterface::ResponseValidator_::ValidateAndDecodePayload;
+  RunValidationTests("integration_intf_resp", validators, payload_validator,
+                     test_message_receiver());
+  RunValidationTests("integration_msghdr", validators, payload_validator,
                      test_message_receiver());
-  RunValidationTests("integration_msghdr", validators, test_message_receiver());
 }
 
 // Test that Binding<X> applies the correct validators and they don't
@@ -374,9 +409,12 @@ TEST_F(ValidationIntegrationTest, Binding) {
   validators.push_back(std::unique_ptr<MessageValidator>(
       new typename IntegrationTestInterface::RequestValidator_));
 
-  RunValidationTests("integration_intf_rqst", validators,
+  PayloadValidator payload_validator =
+      &IntegrationTestInterface::RequestValidator_::ValidateAndDecodePayload;
+  RunValidationTests("integration_intf_rqst", validators, payload_validator,
+                     test_message_receiver());
+  RunValidationTests("integration_msghdr", validators, payload_validator,
                      test_message_receiver());
-  RunValidationTests("integration_msghdr", validators, test_message_receiver());
 }
 
 // Test pointer validation (specifically, that the encoded offset is 32-bit)
@@ -4,41 +4,71 @@
 
 #include "lib/fsl/tasks/incoming_task_queue.h"
 
+#include <stdint.h>
+
+#include "lib/fxl/logging.h"
+
 namespace fsl {
 namespace internal {
+namespace {
+
+// Marks a queue that no longer accepts tasks. Never dereferenced.
+PendingTask* const kClosed =
+    reinterpret_cast<PendingTask*>(static_cast<uintptr_t>(1u));
+
+}  // namespace
 
 TaskQueueDelegate::~TaskQueueDelegate() {}
 
 IncomingTaskQueue::IncomingTaskQueue() {}
 
-IncomingTaskQueue::~IncomingTaskQueue() {}
+IncomingTaskQueue::~IncomingTaskQueue() {
+  PendingTask* head = head_.load(std::memory_order_acquire);
+  if (head != kClosed)
+    ReverseStack(head).Clear();
+}
 
-void IncomingTaskQueue::PostTask(fxl::Closure task) {
+void IncomingTaskQueue::PostTask(fxl::TaskClosure task) {
   AddTask(std::move(task), fxl::TimePoint());
 }
 
-void IncomingTaskQueue::PostTaskForTime(fxl::Closure task,
+void IncomingTaskQueue::PostTaskForTime(fxl::TaskClosure task,
                                         fxl::TimePoint target_time) {
   AddTask(std::move(task), target_time);
 }
 
-void IncomingTaskQueue::PostDelayedTask(fxl::Closure task,
+void IncomingTaskQueue::PostDelayedTask(fxl::TaskClosure task,
                                         fxl::TimeDelta delay) {
   AddTask(std::move(task), delay > fxl::TimeDelta::Zero()
                                ? fxl::TimePoint::Now() + delay
                                : fxl::TimePoint());
 }
 
-void IncomingTaskQueue::AddTask(fxl::Closure task, fxl::TimePoint target_time) {
-  fxl::MutexLocker locker(&mutex_);
-
-  if (drop_incoming_tasks_)
+void IncomingTaskQueue::AddTask(fxl::TaskClosure task,
+                                fxl::TimePoint target_time) {
+  std::unique_ptr<PendingTask> pending(
+      new PendingTask(std::move(task), target_time));
+
+  PendingTask* head = head_.load(std::memory_order_relaxed);
+  do {
+    // Drop the task if the delegate has gone away. Destroying it may post
+    // more tasks, which will be dropped in turn.
+    if (head == kClosed)
+      return;
+    pending->next = head;
+  } while (!head_.compare_exchange_weak(head, pending.get(),
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed));
+  pending.release();
+
+  // Whoever posted the task that is now at the bottom of the stack has
+  // already asked the delegate to drain the queue.
+  if (head)
     return;
-  if (delegate_) {
-    delegate_->PostTask(std::move(task), target_time);
-  } else {
-    incoming_queue_.emplace_back(std::move(task), target_time);
-  }
+
+  fxl::MutexLocker locker(&mutex_);
+  if (delegate_)
+    delegate_->ScheduleDrain();
 }
 
 bool IncomingTaskQueue::RunsTasksOnCurrentThread() {
@@ -50,21 +80,43 @@ void IncomingTaskQueue::InitDelegate(TaskQueueDelegate* delegate) {
   FXL_DCHECK(delegate);
 
   fxl::MutexLocker locker(&mutex_);
-  FXL_DCHECK(!drop_incoming_tasks_);
+  FXL_DCHECK(head_.load(std::memory_order_relaxed) != kClosed);
 
   delegate_ = delegate;
-  for (auto& task : incoming_queue_)
-    delegate_->PostTask(std::move(task.first), task.second);
-  incoming_queue_.clear();
+  if (head_.load(std::memory_order_acquire))
+    delegate_->ScheduleDrain();
 }
 
 void IncomingTaskQueue::ClearDelegate() {
-  fxl::MutexLocker locker(&mutex_);
+  PendingTask* head = head_.exchange(kClosed, std::memory_order_acq_rel);
+  FXL_DCHECK(head != kClosed);
+
+  // Destroy the remaining tasks while the delegate is still attached, so that
+  // their destructors can still ask whether they run on the current thread.
+  ReverseStack(head).Clear();
 
-  FXL_DCHECK(!drop_incoming_tasks_);
-  drop_incoming_tasks_ = true;
+  fxl::MutexLocker locker(&mutex_);
   delegate_ = nullptr;
 }
 
+PendingTaskList IncomingTaskQueue::ReverseStack(PendingTask* top) {
+  PendingTaskList tasks;
+  tasks.tail_ = top;
+  while (top) {
+    PendingTask* next = top->next;
+    top->next = tasks.head_;
+    tasks.head_ = top;
+    top = next;
+  }
+  return tasks;
+}
+
+PendingTaskList IncomingTaskQueue::TakeTasks() {
+  PendingTask* head = head_.exchange(nullptr, std::memory_order_acquire);
+  FXL_DCHECK(head != kClosed);
+
+  return ReverseStack(head);
+}
+
 }  // namespace internal
 }  // namespace fsl
@@ -5,11 +5,10 @@
 #ifndef LIB_FSL_TASKS_INCOMING_TASK_QUEUE_H_
 #define LIB_FSL_TASKS_INCOMING_TASK_QUEUE_H_
 
-#include <utility>
-#include <vector>
+#include <atomic>
 
+#include "lib/fsl/tasks/pending_task.h"
 #include "lib/fxl/fxl_export.h"
-#include "lib/fxl/functional/closure.h"
 #include "lib/fxl/macros.h"
 #include "lib/fxl/memory/ref_counted.h"
 #include "lib/fxl/synchronization/mutex.h"
@@ -22,7 +21,11 @@ namespace internal {
 
 class FXL_EXPORT TaskQueueDelegate {
  public:
-  virtual void PostTask(fxl::Closure task, fxl::TimePoint target_time) = 0;
+  // Called when tasks have been posted to an empty queue. The delegate should
+  // arrange for |IncomingTaskQueue::TakeTasks| to be called on its own
+  // thread. May be called on any thread, and may be called again before the
+  // delegate has taken the tasks.
+  virtual void ScheduleDrain() = 0;
   virtual bool RunsTasksOnCurrentThread() = 0;
 
  protected:
@@ -32,6 +35,12 @@ class FXL_EXPORT TaskQueueDelegate {
 // Receives tasks from multiple threads and buffers them until a delegate
 // is ready to receive them.
 //
+// Posting a task does not take a lock: producers push onto a lock-free
+// intrusive stack and the delegate takes the whole stack at once, reversing
+// it into posting order. Only the producer that finds the queue empty has to
+// wake the delegate up, so a busy queue costs each producer a single
+// compare-and-swap.
+//
 // This object is threadsafe.
 class FXL_EXPORT IncomingTaskQueue : public fxl::TaskRunner {
  public:
@@ -39,26 +48,35 @@ class FXL_EXPORT IncomingTaskQueue : public fxl::TaskRunner {
   ~IncomingTaskQueue() override;
 
   // |TaskRunner| implementation:
-  void PostTask(fxl::Closure task) override;
-  void PostTaskForTime(fxl::Closure task, fxl::TimePoint target_time) override;
-  void PostDelayedTask(fxl::Closure task, fxl::TimeDelta delay) override;
+  void PostTask(fxl::TaskClosure task) override;
+  void PostTaskForTime(fxl::TaskClosure task,
+                       fxl::TimePoint target_time) override;
+  void PostDelayedTask(fxl::TaskClosure task, fxl::TimeDelta delay) override;
   bool RunsTasksOnCurrentThread() override;
 
-  // Sets the delegate and schedules all pending tasks with it.
+  // Sets the delegate and, if any tasks are pending, asks it to drain them.
   void InitDelegate(TaskQueueDelegate* delegate);
 
-  // Clears the delegate and drops all later incoming tasks.
+  // Destroys all pending tasks, clears the delegate and drops all later
+  // incoming tasks. Must be called on the delegate's thread.
   void ClearDelegate();
 
+  // Removes and returns all pending tasks. Must be called on the delegate's
+  // thread.
+  PendingTaskList TakeTasks();
+
  private:
-  void AddTask(fxl::Closure task, fxl::TimePoint target_time);
+  void AddTask(fxl::TaskClosure task, fxl::TimePoint target_time);
+
+  // Turns a stack of tasks, most recent first, into a list in posting order.
+  static PendingTaskList ReverseStack(PendingTask* top);
 
-  using Task = std::pair<fxl::Closure, fxl::TimePoint>;
+  // The most recently posted task, or |kClosed| once the delegate has been
+  // cleared.
+  std::atomic<PendingTask*> head_{nullptr};
 
   fxl::Mutex mutex_;
-  std::vector<Task> incoming_queue_ FXL_GUARDED_BY(mutex_);
   TaskQueueDelegate* delegate_ FXL_GUARDED_BY(mutex_) = nullptr;
-  bool drop_incoming_tasks_ FXL_GUARDED_BY(mutex_) = false;
 
   FXL_DISALLOW_COPY_AND_ASSIGN(IncomingTaskQueue);
 };
@@ -6,8 +6,7 @@
 
 #include <utility>
 
-#include <async/task.h>
-#include <async/wait_with_timeout.h>
+#include <async/wait.h>
 #include <zircon/syscalls.h>
 
 #include "lib/fxl/logging.h"
@@ -19,38 +18,50 @@ thread_local MessageLoop* g_current;
 
 }  // namespace
 
-class MessageLoop::TaskRecord {
+class MessageLoop::HandlerRecord {
  public:
-  TaskRecord(zx_time_t deadline, fxl::Closure closure);
-  ~TaskRecord();
+  HandlerRecord(MessageLoop* loop, uint32_t slot);
+  ~HandlerRecord();
 
-  async::Task& task() { return task_; }
+  async::Wait& wait() { return wait_; }
+  async::Task& timeout_task() { return timeout_task_; }
+  bool is_registered() const { return !!handler_; }
 
- private:
-  async::Task task_;
-};
+  HandlerKey key() const {
+    return (static_cast<HandlerKey>(generation_) << 32) | (slot_ + 1u);
+  }
+  static uint32_t SlotForKey(HandlerKey key) {
+    return static_cast<uint32_t>(key) - 1u;
+  }
 
-class MessageLoop::HandlerRecord {
- public:
-  HandlerRecord(zx_handle_t object,
-                zx_signals_t trigger,
-                zx_time_t deadline,
-                MessageLoop* loop,
-                MessageLoopHandler* handler,
-                HandlerKey key);
-  ~HandlerRecord();
+  // Registers |handler| for signals on |object|.
+  void Register(MessageLoopHandler* handler,
+                zx_handle_t object,
+                zx_signals_t trigger);
 
-  async::WaitWithTimeout& wait() { return wait_; }
+  // Unregisters the handler, invalidating its key.
+  void Unregister();
 
- private:
   async_wait_result_t Handle(async_t* async,
                              zx_status_t status,
                              const zx_packet_signal_t* signal);
 
-  async::WaitWithTimeout wait_;
-  MessageLoop* loop_;
-  MessageLoopHandler* handler_;
-  HandlerKey key_;
+  // Schedules a timeout at |deadline|.
+  zx_status_t ScheduleTimeout(async_t* async, zx_time_t deadline);
+
+  // Cancels the timeout, if one is scheduled.
+  void CancelTimeout(async_t* async);
+
+ private:
+  async_task_result_t OnTimeout(async_t* async, zx_status_t status);
+
+  async::Wait wait_;
+  async::Task timeout_task_;
+  bool timeout_pending_ = false;
+  MessageLoop* const loop_;
+  const uint32_t slot_;
+  uint32_t generation_ = 0u;
+  MessageLoopHandler* handler_ = nullptr;
 };
 
 MessageLoop::MessageLoop()
@@ -62,10 +73,14 @@ MessageLoop::MessageLoop(
                    .epilogue = &MessageLoop::Epilogue,
                    .data = this},
       loop_(&loop_config_),
-      task_runner_(std::move(incoming_tasks)) {
+      task_runner_(std::move(incoming_tasks)),
+      drain_task_(0u, ASYNC_FLAG_HANDLE_SHUTDOWN) {
   FXL_DCHECK(!g_current) << "At most one message loop per thread.";
   g_current = this;
 
+  drain_task_.set_handler(fbl::BindMember(this, &MessageLoop::DrainTasks));
+  timer_task_.set_handler(fbl::BindMember(this, &MessageLoop::RunTimers));
+
   MessageLoop::incoming_tasks()->InitDelegate(this);
 }
 
@@ -74,8 +89,13 @@ MessageLoop::~MessageLoop() {
       << "Message loops must be destroyed on their own threads.";
 
   loop_.Shutdown();
-  FXL_DCHECK(handlers_.empty());
+  FXL_DCHECK(free_handlers_.size() == handlers_.size());
 
+  // Tasks that are destroyed here may post more tasks; those are destroyed by
+  // |ClearDelegate|, as is anything posted after it.
+  ready_tasks_.Clear();
+  due_timers_.Clear();
+  timers_.Clear();
   incoming_tasks()->ClearDelegate();
 
   g_current = nullptr;
@@ -85,22 +105,108 @@ MessageLoop* MessageLoop::GetCurrent() {
   return g_current;
 }
 
-void MessageLoop::PostTask(fxl::Closure task, fxl::TimePoint target_time) {
-  // TODO(jeffbrown): Consider allocating tasks from a pool.
-  auto record = new TaskRecord(target_time.ToEpochDelta().ToNanoseconds(),
-                               std::move(task));
+void MessageLoop::ScheduleDrain() {
+  if (drain_pending_.exchange(true))
+    return;
 
-  zx_status_t status = record->task().Post(loop_.async());
+  zx_status_t status = drain_task_.Post(loop_.async());
   if (status == ZX_ERR_BAD_STATE) {
     // Suppress request when shutting down.
-    delete record;
     return;
   }
-
-  // The record will be destroyed when the task runs.
   FXL_CHECK(status == ZX_OK) << "Failed to post task: status=" << status;
 }
 
+async_task_result_t MessageLoop::DrainTasks(async_t* async,
+                                            zx_status_t status) {
+  if (status != ZX_OK)
+    return ASYNC_TASK_FINISHED;
+
+  // Clear the flag before taking the tasks so that a task posted after this
+  // point schedules another drain.
+  drain_pending_.store(false);
+  ready_tasks_.Append(incoming_tasks()->TakeTasks());
+  RunReadyTasks();
+
+  skip_epilogue_ = true;
+  return ASYNC_TASK_FINISHED;
+}
+
+void MessageLoop::RunReadyTasks() {
+  while (!ready_tasks_.empty()) {
+    if (quit_pending_) {
+      // Pick up where we left off the next time the loop runs.
+      ScheduleDrain();
+      return;
+    }
+
+    std::unique_ptr<internal::PendingTask> task = ready_tasks_.TakeFront();
+    if (task->target_time != fxl::TimePoint()) {
+      AddTimer(std::move(task));
+    } else {
+      RunTask(std::move(task));
+    }
+  }
+}
+
+void MessageLoop::AddTimer(std::unique_ptr<internal::PendingTask> task) {
+  timers_.Add(std::move(task));
+  ArmTimer();
+}
+
+void MessageLoop::ArmTimer() {
+  zx_time_t deadline = ZX_TIME_INFINITE;
+  if (!due_timers_.empty()) {
+    deadline = 0;
+  } else {
+    fxl::TimePoint wake_up = timers_.GetNextWakeUp();
+    if (wake_up != fxl::TimePoint::Max())
+      deadline = wake_up.ToEpochDelta().ToNanoseconds();
+  }
+  if (deadline == timer_deadline_)
+    return;
+
+  if (timer_deadline_ != ZX_TIME_INFINITE) {
+    zx_status_t status = timer_task_.Cancel(loop_.async());
+    FXL_DCHECK(status == ZX_OK) << "Failed to cancel timer: status=" << status;
+    timer_deadline_ = ZX_TIME_INFINITE;
+  }
+  if (deadline == ZX_TIME_INFINITE)
+    return;
+
+  timer_task_.set_deadline(deadline);
+  zx_status_t status = timer_task_.Post(loop_.async());
+  if (status == ZX_ERR_BAD_STATE) {
+    // Suppress request when shutting down.
+    return;
+  }
+  FXL_CHECK(status == ZX_OK) << "Failed to post timer: status=" << status;
+  timer_deadline_ = deadline;
+}
+
+async_task_result_t MessageLoop::RunTimers(async_t* async, zx_status_t status) {
+  timer_deadline_ = ZX_TIME_INFINITE;
+  if (status != ZX_OK)
+    return ASYNC_TASK_FINISHED;
+
+  due_timers_.Append(timers_.TakeExpired(fxl::TimePoint::Now()));
+  while (!due_timers_.empty() && !quit_pending_)
+    RunTask(due_timers_.TakeFront());
+  ArmTimer();
+
+  skip_epilogue_ = true;
+  return ASYNC_TASK_FINISHED;
+}
+
+void MessageLoop::RunTask(std::unique_ptr<internal::PendingTask> task) {
+  task->closure();
+  // Destroy the task before notifying the callback, as if it had run in its
+  // own dispatch.
+  task.reset();
+  if (after_task_callback_)
+    after_task_callback_();
+}
+
 MessageLoop::HandlerKey MessageLoop::AddHandler(MessageLoopHandler* handler,
                                                 zx_handle_t handle,
                                                 zx_signals_t trigger,
@@ -109,50 +215,78 @@ MessageLoop::HandlerKey MessageLoop::AddHandler(MessageLoopHandler* handler,
   FXL_DCHECK(handler);
   FXL_DCHECK(handle != ZX_HANDLE_INVALID);
 
-  // TODO(jeffbrown): Consider allocating handlers from a pool.
-  HandlerKey key = next_handler_key_++;
-  auto record =
-      new HandlerRecord(handle, trigger,
-                        timeout == fxl::TimeDelta::Max()
-                            ? ZX_TIME_INFINITE
-                            : zx_deadline_after(timeout.ToNanoseconds()),
-                        this, handler, key);
+  HandlerRecord* record;
+  if (free_handlers_.empty()) {
+    handlers_.push_back(std::make_unique<HandlerRecord>(
+        this, static_cast<uint32_t>(handlers_.size())));
+    record = handlers_.back().get();
+  } else {
+    record = free_handlers_.back();
+    free_handlers_.pop_back();
+  }
+
+  record->Register(handler, handle, trigger);
+  HandlerKey key = record->key();
   zx_status_t status = record->wait().Begin(loop_.async());
   if (status == ZX_ERR_BAD_STATE) {
     // Suppress request when shutting down.
-    delete record;
+    record->Unregister();
+    FreeHandler(record);
     return key;
   }
 
-  // The record will be destroyed when the handler runs or is removed.
+  // The record will be freed when the handler fails or is removed.
   FXL_CHECK(status == ZX_OK) << "Failed to add handler: status=" << status;
-  handlers_.emplace(key, record);
+
+  if (timeout != fxl::TimeDelta::Max()) {
+    // The timeout is cancelled when the record is freed, however the handler
+    // goes away.
+    status = record->ScheduleTimeout(
+        loop_.async(), zx_deadline_after(timeout.ToNanoseconds()));
+    FXL_CHECK(status == ZX_OK || status == ZX_ERR_BAD_STATE)
+        << "Failed to schedule timeout: status=" << status;
+  }
   return key;
 }
 
 void MessageLoop::RemoveHandler(HandlerKey key) {
   FXL_DCHECK(g_current == this);
 
-  auto it = handlers_.find(key);
-  if (it == handlers_.end())
+  HandlerRecord* record = FindHandler(key);
+  if (!record)
     return;
 
-  HandlerRecord* record = it->second;
-  handlers_.erase(it);
-
+  record->Unregister();
   if (current_handler_ == record) {
     current_handler_removed_ = true;  // defer cleanup
   } else {
     zx_status_t status = record->wait().Cancel(loop_.async());
     FXL_CHECK(status == ZX_OK) << "Failed to cancel handler: status=" << status;
-    delete record;
+    FreeHandler(record);
   }
 }
 
 bool MessageLoop::HasHandler(HandlerKey key) const {
   FXL_DCHECK(g_current == this);
 
-  return handlers_.find(key) != handlers_.end();
+  return !!FindHandler(key);
+}
+
+MessageLoop::HandlerRecord* MessageLoop::FindHandler(HandlerKey key) const {
+  uint32_t slot = HandlerRecord::SlotForKey(key);
+  if (slot >= handlers_.size())
+    return nullptr;
+
+  HandlerRecord* record = handlers_[slot].get();
+  if (!record->is_registered() || record->key() != key)
+    return nullptr;
+  return record;
+}
+
+void MessageLoop::FreeHandler(HandlerRecord* record) {
+  FXL_DCHECK(!record->is_registered());
+  record->CancelTimeout(loop_.async());
+  free_handlers_.push_back(record);
 }
 
 void MessageLoop::Run(bool until_idle) {
@@ -168,6 +302,7 @@ void MessageLoop::Run(bool until_idle) {
   status = loop_.ResetQuit();
   FXL_DCHECK(status == ZX_OK)
       << "Failed to reset quit state: status=" << status;
+  quit_pending_ = false;
 
   FXL_DCHECK(is_running_);
   is_running_ = false;
@@ -184,8 +319,10 @@ void MessageLoop::RunUntilIdle() {
 void MessageLoop::QuitNow() {
   FXL_DCHECK(g_current == this);
 
-  if (is_running_)
+  if (is_running_) {
     loop_.Quit();
+    quit_pending_ = true;
+  }
 }
 
 void MessageLoop::PostQuitTask() {
@@ -210,39 +347,41 @@ void MessageLoop::ClearAfterTaskCallback() {
 
 void MessageLoop::Epilogue(async_t* async, void* data) {
   auto loop = static_cast<MessageLoop*>(data);
+  if (loop->skip_epilogue_) {
+    loop->skip_epilogue_ = false;
+    return;
+  }
   if (loop->after_task_callback_)
     loop->after_task_callback_();
 }
 
-MessageLoop::TaskRecord::TaskRecord(zx_time_t deadline, fxl::Closure closure)
-    : task_(deadline, ASYNC_FLAG_HANDLE_SHUTDOWN) {
-  task_.set_handler(
-      [ this, closure = std::move(closure) ](async_t*, zx_status_t status) {
-        if (status == ZX_OK)
-          closure();
-        delete this;
-        return ASYNC_TASK_FINISHED;
-      });
-}
-
-MessageLoop::TaskRecord::~TaskRecord() = default;
-
-MessageLoop::HandlerRecord::HandlerRecord(zx_handle_t object,
-                                          zx_signals_t trigger,
-                                          zx_time_t deadline,
-                                          MessageLoop* loop,
-                                          MessageLoopHandler* handler,
-                                          HandlerKey key)
-    : wait_(object, trigger, deadline, ASYNC_FLAG_HANDLE_SHUTDOWN),
+MessageLoop::HandlerRecord::HandlerRecord(MessageLoop* loop, uint32_t slot)
+    : wait_(ZX_HANDLE_INVALID, ZX_SIGNAL_NONE, ASYNC_FLAG_HANDLE_SHUTDOWN),
       loop_(loop),
-      handler_(handler),
-      key_(key) {
+      slot_(slot) {
   wait_.set_handler(
       fbl::BindMember(this, &MessageLoop::HandlerRecord::Handle));
+  timeout_task_.set_handler(
+      fbl::BindMember(this, &MessageLoop::HandlerRecord::OnTimeout));
 }
 
 MessageLoop::HandlerRecord::~HandlerRecord() = default;
 
+void MessageLoop::HandlerRecord::Register(MessageLoopHandler* handler,
+                                          zx_handle_t object,
+                                          zx_signals_t trigger) {
+  FXL_DCHECK(!handler_);
+  handler_ = handler;
+  wait_.set_object(object);
+  wait_.set_trigger(trigger);
+}
+
+void MessageLoop::HandlerRecord::Unregister() {
+  FXL_DCHECK(handler_);
+  handler_ = nullptr;
+  ++generation_;
+}
+
 async_wait_result_t MessageLoop::HandlerRecord::Handle(
     async_t* async,
     zx_status_t status,
@@ -256,9 +395,7 @@ async_wait_result_t MessageLoop::HandlerRecord::Handle(
     handler_->OnHandleError(wait_.object(), status);
 
     if (!loop_->current_handler_removed_) {
-      auto it = loop_->handlers_.find(key_);
-      FXL_DCHECK(it != loop_->handlers_.end());
-      loop_->handlers_.erase(it);
+      Unregister();
       loop_->current_handler_removed_ = true;
     }
   }
@@ -269,8 +406,39 @@ async_wait_result_t MessageLoop::HandlerRecord::Handle(
     return ASYNC_WAIT_AGAIN;
 
   loop_->current_handler_removed_ = false;
-  delete this;
+  loop_->FreeHandler(this);
   return ASYNC_WAIT_FINISHED;
 }
 
+zx_status_t MessageLoop::HandlerRecord::ScheduleTimeout(async_t* async,
+                                                        zx_time_t deadline) {
+  FXL_DCHECK(!timeout_pending_);
+  timeout_task_.set_deadline(deadline);
+  zx_status_t status = timeout_task_.Post(async);
+  timeout_pending_ = status == ZX_OK;
+  return status;
+}
+
+void MessageLoop::HandlerRecord::CancelTimeout(async_t* async) {
+  if (!timeout_pending_)
+    return;
+  timeout_pending_ = false;
+  zx_status_t status = timeout_task_.Cancel(async);
+  FXL_DCHECK(status == ZX_OK || status == ZX_ERR_NOT_FOUND)
+      << "Failed to cancel timeout: status=" << status;
+}
+
+async_task_result_t MessageLoop::HandlerRecord::OnTimeout(async_t* async,
+                                                          zx_status_t status) {
+  timeout_pending_ = false;
+  if (status != ZX_OK)
+    return ASYNC_TASK_FINISHED;
+
+  FXL_DCHECK(is_registered());
+  status = wait_.Cancel(async);
+  FXL_CHECK(status == ZX_OK) << "Failed to cancel handler: status=" << status;
+  Handle(async, ZX_ERR_TIMED_OUT, nullptr);
+  return ASYNC_TASK_FINISHED;
+}
+
 }  // namespace fsl
@@ -5,9 +5,12 @@
 #ifndef LIB_FSL_TASKS_MESSAGE_LOOP_H_
 #define LIB_FSL_TASKS_MESSAGE_LOOP_H_
 
-#include <map>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 #include <async/loop.h>
+#include <async/task.h>
 
 #include "lib/fxl/fxl_export.h"
 #include "lib/fxl/macros.h"
@@ -15,6 +18,7 @@
 #include "lib/fxl/tasks/task_runner.h"
 #include "lib/fsl/tasks/incoming_task_queue.h"
 #include "lib/fsl/tasks/message_loop_handler.h"
+#include "lib/fsl/tasks/timer_wheel.h"
 
 namespace fsl {
 
@@ -49,10 +53,12 @@ class FXL_EXPORT MessageLoop : private internal::TaskQueueDelegate {
   // of the given |trigger| or when |timeout| elapses, whichever happens first.
   //
   // The returned key can be used to remove the callback. The returned key will
-  // always be non-zero.
+  // always be non-zero, and is never reused for another handler.
   //
-  // TODO(jeffbrown): Bring the handler API in line with |AsyncDispatcher|
-  // and manage timeouts through cancelable tasks instead.
+  // Adding and removing handlers takes constant time, apart from scheduling
+  // and cancelling the timeout, if there is one.
+  //
+  // TODO(jeffbrown): Bring the handler API in line with |AsyncDispatcher|.
   HandlerKey AddHandler(MessageLoopHandler* handler,
                         zx_handle_t handle,
                         zx_signals_t trigger,
@@ -96,20 +102,38 @@ class FXL_EXPORT MessageLoop : private internal::TaskQueueDelegate {
 
  private:
   // |internal::TaskQueueDelegate| implementation:
-  void PostTask(fxl::Closure task, fxl::TimePoint target_time) override;
+  void ScheduleDrain() override;
   bool RunsTasksOnCurrentThread() override;
 
   void Run(bool until_idle);
 
+  // Moves incoming tasks to |ready_tasks_| and runs them.
+  async_task_result_t DrainTasks(async_t* async, zx_status_t status);
+  void RunReadyTasks();
+
+  // Runs the delayed tasks whose target time has passed.
+  async_task_result_t RunTimers(async_t* async, zx_status_t status);
+  void AddTimer(std::unique_ptr<internal::PendingTask> task);
+  void ArmTimer();
+
+  // Runs |task| followed by the after task callback.
+  void RunTask(std::unique_ptr<internal::PendingTask> task);
+
   static void Epilogue(async_t* async, void* data);
 
   internal::IncomingTaskQueue* incoming_tasks() {
     return static_cast<internal::IncomingTaskQueue*>(task_runner_.get());
   }
 
-  class TaskRecord;
   class HandlerRecord;
 
+  // Returns the handler registered with |key|, or null if there is none.
+  HandlerRecord* FindHandler(HandlerKey key) const;
+
+  // Returns |record| to the free list once its wait is no longer pending,
+  // cancelling its timeout.
+  void FreeHandler(HandlerRecord* record);
+
   async_loop_config_t loop_config_;
   async::Loop loop_;
 
@@ -117,8 +141,35 @@ class FXL_EXPORT MessageLoop : private internal::TaskQueueDelegate {
   fxl::Closure after_task_callback_;
   bool is_running_ = false;
 
-  HandlerKey next_handler_key_ = 1u;
-  std::map<HandlerKey, HandlerRecord*> handlers_;
+  // Set once |QuitNow| has been called until |Run| returns. Tasks that have
+  // already been drained but not yet run wait for the next |Run|.
+  bool quit_pending_ = false;
+
+  // Set by task batches, which invoke the after task callback themselves.
+  bool skip_epilogue_ = false;
+
+  // Posted, due immediately, whenever the incoming task queue becomes
+  // non-empty. |drain_pending_| is set while |drain_task_| is posted and has
+  // not started running yet; it may be set from any thread.
+  async::Task drain_task_;
+  std::atomic<bool> drain_pending_{false};
+  internal::PendingTaskList ready_tasks_;
+
+  // Delayed tasks, and a single async task scheduled for the earliest of them.
+  // Target times are coalesced to the wheel's resolution so that tasks due
+  // within the same millisecond share a wake-up. Expired tasks that have not
+  // run yet wait in |due_timers_|.
+  internal::TimerWheel timers_{fxl::TimeDelta::FromMilliseconds(1)};
+  internal::PendingTaskList due_timers_;
+  async::Task timer_task_;
+  zx_time_t timer_deadline_ = ZX_TIME_INFINITE;
+
+  // Handler records, indexed by slot. Records are recycled through
+  // |free_handlers_| rather than destroyed, so their waits never move. A key
+  // combines the slot with a generation that changes whenever the slot is
+  // released, so keys of removed handlers never match a later handler.
+  std::vector<std::unique_ptr<HandlerRecord>> handlers_;
+  std::vector<HandlerRecord*> free_handlers_;
 
   // Set while the handler is running.
   HandlerRecord* current_handler_ = nullptr;
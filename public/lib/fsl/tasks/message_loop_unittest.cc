@@ -10,6 +10,7 @@
 
 #include <poll.h>
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
@@ -64,6 +65,23 @@ TEST(MessageLoop, CanRunTasks) {
   EXPECT_TRUE(did_run);
 }
 
+TEST(MessageLoop, RunsTasksPostedFromOtherThreadWhileWaiting) {
+  bool did_run = false;
+  MessageLoop loop;
+  // Give the loop time to go idle in |Run| before the task arrives, so that
+  // only the drain scheduled by the post can wake it up.
+  std::thread thread([task_runner = loop.task_runner(), &did_run, &loop] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    task_runner->PostTask([&did_run, &loop] {
+      did_run = true;
+      loop.QuitNow();
+    });
+  });
+  loop.Run();
+  thread.join();
+  EXPECT_TRUE(did_run);
+}
+
 TEST(MessageLoop, CanPostTasksFromTasks) {
   bool did_run = false;
   MessageLoop loop;
@@ -96,6 +114,16 @@ TEST(MessageLoop, TriplyNestedTasks) {
   EXPECT_EQ("three", tasks[2]);
 }
 
+TEST(MessageLoop, CanPostMoveOnlyTasks) {
+  std::unique_ptr<int> value = std::make_unique<int>(42);
+  int result = 0;
+  MessageLoop loop;
+  loop.task_runner()->PostTask(
+      [&result, value = std::move(value)] { result = *value; });
+  loop.RunUntilIdle();
+  EXPECT_EQ(42, result);
+}
+
 TEST(MessageLoop, CanRunTasksInOrder) {
   std::vector<std::string> tasks;
   MessageLoop loop;
@@ -158,6 +186,79 @@ TEST(MessageLoop, RemoveAfterTaskCallbacksDuringCallback) {
   EXPECT_EQ("1", tasks[2]);
 }
 
+TEST(MessageLoop, ResumesAfterQuit) {
+  std::vector<std::string> tasks;
+  MessageLoop loop;
+  loop.task_runner()->PostTask([&tasks]() { tasks.push_back("0"); });
+  loop.PostQuitTask();
+  loop.task_runner()->PostTask([&tasks]() { tasks.push_back("1"); });
+  loop.task_runner()->PostTask([&tasks]() { tasks.push_back("2"); });
+  loop.RunUntilIdle();
+  EXPECT_EQ(1u, tasks.size());
+
+  loop.task_runner()->PostTask([&tasks]() { tasks.push_back("3"); });
+  loop.RunUntilIdle();
+  EXPECT_EQ(4u, tasks.size());
+  EXPECT_EQ("1", tasks[1]);
+  EXPECT_EQ("2", tasks[2]);
+  EXPECT_EQ("3", tasks[3]);
+}
+
+TEST(MessageLoop, DelayedTasksRunInTargetTimeOrder) {
+  std::vector<std::string> tasks;
+  MessageLoop loop;
+  auto task_runner = loop.task_runner();
+  fxl::TimePoint now = fxl::TimePoint::Now();
+  task_runner->PostTaskForTime([&tasks] { tasks.push_back("30"); },
+                               now + fxl::TimeDelta::FromMilliseconds(30));
+  task_runner->PostTaskForTime([&tasks] { tasks.push_back("10"); },
+                               now + fxl::TimeDelta::FromMilliseconds(10));
+  task_runner->PostTaskForTime([&tasks] { tasks.push_back("20a"); },
+                               now + fxl::TimeDelta::FromMilliseconds(20));
+  task_runner->PostTaskForTime([&tasks] { tasks.push_back("20b"); },
+                               now + fxl::TimeDelta::FromMilliseconds(20));
+  task_runner->PostTask([&tasks] { tasks.push_back("0"); });
+  task_runner->PostTaskForTime([&loop] { loop.QuitNow(); },
+                               now + fxl::TimeDelta::FromMilliseconds(40));
+  loop.Run();
+  EXPECT_EQ((std::vector<std::string>{"0", "10", "20a", "20b", "30"}), tasks);
+}
+
+TEST(MessageLoop, CanPostTasksFromManyThreads) {
+  constexpr int kThreadCount = 8;
+  constexpr int kTasksPerThread = 1000;
+
+  MessageLoop loop;
+  std::vector<int> next_task(kThreadCount, 0);
+  int tasks_run = 0;
+  bool in_order = true;
+
+  // Post while the loop is running so that draining races with posting.
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([
+      i, task_runner = loop.task_runner(), &loop, &next_task, &tasks_run,
+      &in_order
+    ] {
+      for (int j = 0; j < kTasksPerThread; ++j) {
+        task_runner->PostTask([i, j, &loop, &next_task, &tasks_run,
+                               &in_order] {
+          in_order = in_order && next_task[i] == j;
+          next_task[i] = j + 1;
+          if (++tasks_run == kThreadCount * kTasksPerThread)
+            loop.QuitNow();
+        });
+      }
+    });
+  }
+  loop.Run();
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(kThreadCount * kTasksPerThread, tasks_run);
+}
+
 class DestructorObserver {
  public:
   DestructorObserver(fxl::Closure callback) : callback_(std::move(callback)) {}
@@ -414,6 +515,87 @@ TEST(MessageLoop, QuitWhenDeadlineExpired) {
   EXPECT_FALSE(message_loop.HasHandler(key));
 }
 
+// Verifies that the timeout of a removed handler has no effect, even once its
+// key's slot has been reused.
+TEST(MessageLoop, RemoveHandlerBeforeDeadline) {
+  TestMessageLoopHandler handler;
+  zx::channel endpoint0;
+  zx::channel endpoint1;
+  zx::channel::create(0, &endpoint0, &endpoint1);
+
+  MessageLoop message_loop;
+  MessageLoop::HandlerKey key =
+      message_loop.AddHandler(&handler, endpoint0.get(), ZX_CHANNEL_READABLE,
+                              fxl::TimeDelta::FromMicroseconds(10000));
+  message_loop.RemoveHandler(key);
+  MessageLoop::HandlerKey new_key =
+      message_loop.AddHandler(&handler, endpoint0.get(), ZX_CHANNEL_READABLE,
+                              fxl::TimeDelta::Max());
+  EXPECT_NE(key, new_key);
+  EXPECT_FALSE(message_loop.HasHandler(key));
+
+  message_loop.task_runner()->PostDelayedTask(
+      [&message_loop] { message_loop.QuitNow(); },
+      fxl::TimeDelta::FromMicroseconds(15000));
+  message_loop.Run();
+  EXPECT_EQ(0, handler.error_count());
+  EXPECT_TRUE(message_loop.HasHandler(new_key));
+}
+
+// Verifies that the timeouts of removed handlers do not run the after task
+// callback.
+TEST(MessageLoop, RemovedHandlerTimeoutsDoNotRunAfterTaskCallback) {
+  TestMessageLoopHandler handler;
+  zx::channel endpoint0;
+  zx::channel endpoint1;
+  zx::channel::create(0, &endpoint0, &endpoint1);
+
+  MessageLoop message_loop;
+  for (int i = 0; i < 100; ++i) {
+    message_loop.RemoveHandler(message_loop.AddHandler(
+        &handler, endpoint0.get(), ZX_CHANNEL_READABLE,
+        fxl::TimeDelta::FromMicroseconds(10000)));
+  }
+  message_loop.task_runner()->PostDelayedTask(
+      [&message_loop] { message_loop.QuitNow(); },
+      fxl::TimeDelta::FromMicroseconds(15000));
+  int after_task_callback_count = 0;
+  message_loop.SetAfterTaskCallback(
+      [&after_task_callback_count] { ++after_task_callback_count; });
+  message_loop.Run();
+  EXPECT_EQ(1, after_task_callback_count);
+  EXPECT_EQ(0, handler.error_count());
+}
+
+TEST(MessageLoop, ManyHandlers) {
+  constexpr int kHandlerCount = 1000;
+
+  TestMessageLoopHandler handler;
+  zx::event event;
+  ASSERT_EQ(ZX_OK, zx::event::create(0u, &event));
+
+  MessageLoop message_loop;
+  std::vector<MessageLoop::HandlerKey> keys;
+  for (int i = 0; i < kHandlerCount; ++i) {
+    keys.push_back(message_loop.AddHandler(&handler, event.get(),
+                                           ZX_USER_SIGNAL_0,
+                                           fxl::TimeDelta::Max()));
+  }
+  for (int i = 0; i < kHandlerCount; i += 2)
+    message_loop.RemoveHandler(keys[i]);
+  for (int i = 0; i < kHandlerCount; ++i)
+    EXPECT_EQ(i % 2 == 1, message_loop.HasHandler(keys[i]));
+
+  // Slots of removed handlers are reused, but never their keys.
+  for (int i = 0; i < kHandlerCount; i += 2) {
+    MessageLoop::HandlerKey key = message_loop.AddHandler(
+        &handler, event.get(), ZX_USER_SIGNAL_0, fxl::TimeDelta::Max());
+    EXPECT_TRUE(std::find(keys.begin(), keys.end(), key) == keys.end());
+  }
+  for (int i = 0; i < kHandlerCount; i += 2)
+    EXPECT_FALSE(message_loop.HasHandler(keys[i]));
+}
+
 // Test that handlers are notified of loop destruction.
 TEST(MessageLoop, Destruction) {
   TestMessageLoopHandler handler;
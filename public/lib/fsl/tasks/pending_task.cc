@@ -0,0 +1,71 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fsl/tasks/pending_task.h"
+
+#include "lib/fxl/logging.h"
+
+namespace fsl {
+namespace internal {
+
+PendingTaskList::PendingTaskList(PendingTaskList&& other)
+    : head_(other.head_), tail_(other.tail_) {
+  other.head_ = nullptr;
+  other.tail_ = nullptr;
+}
+
+PendingTaskList::~PendingTaskList() {
+  Clear();
+}
+
+PendingTaskList& PendingTaskList::operator=(PendingTaskList&& other) {
+  Clear();
+  Append(std::move(other));
+  return *this;
+}
+
+void PendingTaskList::Append(PendingTaskList&& other) {
+  if (other.empty())
+    return;
+
+  if (empty()) {
+    head_ = other.head_;
+  } else {
+    tail_->next = other.head_;
+  }
+  tail_ = other.tail_;
+  other.head_ = nullptr;
+  other.tail_ = nullptr;
+}
+
+void PendingTaskList::PushBack(std::unique_ptr<PendingTask> task) {
+  FXL_DCHECK(!task->next);
+
+  PendingTask* raw = task.release();
+  if (empty()) {
+    head_ = raw;
+  } else {
+    tail_->next = raw;
+  }
+  tail_ = raw;
+}
+
+std::unique_ptr<PendingTask> PendingTaskList::TakeFront() {
+  FXL_DCHECK(head_);
+
+  std::unique_ptr<PendingTask> task(head_);
+  head_ = task->next;
+  if (!head_)
+    tail_ = nullptr;
+  task->next = nullptr;
+  return task;
+}
+
+void PendingTaskList::Clear() {
+  while (!empty())
+    TakeFront();
+}
+
+}  // namespace internal
+}  // namespace fsl
@@ -0,0 +1,67 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FSL_TASKS_PENDING_TASK_H_
+#define LIB_FSL_TASKS_PENDING_TASK_H_
+
+#include <memory>
+#include <utility>
+
+#include "lib/fxl/fxl_export.h"
+#include "lib/fxl/functional/task_closure.h"
+#include "lib/fxl/macros.h"
+#include "lib/fxl/time/time_point.h"
+
+namespace fsl {
+namespace internal {
+
+// A task waiting to run on a |MessageLoop|. Tasks are linked together
+// intrusively so that queueing one never has to allocate anything beyond the
+// task itself.
+struct PendingTask {
+  PendingTask(fxl::TaskClosure closure, fxl::TimePoint target_time)
+      : closure(std::move(closure)), target_time(target_time) {}
+
+  fxl::TaskClosure closure;
+  // |fxl::TimePoint()| if the task should run as soon as possible.
+  fxl::TimePoint target_time;
+  PendingTask* next = nullptr;
+};
+
+// A first-in, first-out list of tasks.
+class FXL_EXPORT PendingTaskList {
+ public:
+  PendingTaskList() = default;
+  PendingTaskList(PendingTaskList&& other);
+  ~PendingTaskList();
+
+  PendingTaskList& operator=(PendingTaskList&& other);
+
+  bool empty() const { return !head_; }
+
+  // Appends all the tasks in |other| to this list, leaving |other| empty.
+  void Append(PendingTaskList&& other);
+
+  // Adds |task| at the end of the list.
+  void PushBack(std::unique_ptr<PendingTask> task);
+
+  // Removes and returns the oldest task. The list must not be empty.
+  std::unique_ptr<PendingTask> TakeFront();
+
+  // Destroys all the tasks in the list, oldest first.
+  void Clear();
+
+ private:
+  friend class IncomingTaskQueue;
+
+  PendingTask* head_ = nullptr;
+  PendingTask* tail_ = nullptr;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(PendingTaskList);
+};
+
+}  // namespace internal
+}  // namespace fsl
+
+#endif  // LIB_FSL_TASKS_PENDING_TASK_H_
@@ -0,0 +1,144 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fsl/tasks/timer_wheel.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "lib/fxl/logging.h"
+
+namespace fsl {
+namespace internal {
+
+constexpr int TimerWheel::kSlotBits;
+constexpr uint32_t TimerWheel::kSlotCount;
+constexpr int TimerWheel::kLevels;
+constexpr uint64_t TimerWheel::kMaxTick;
+
+TimerWheel::TimerWheel(fxl::TimeDelta resolution)
+    : resolution_ns_(resolution.ToNanoseconds()) {
+  FXL_DCHECK(resolution >= fxl::TimeDelta::FromMilliseconds(1));
+}
+
+TimerWheel::~TimerWheel() = default;
+
+bool TimerWheel::empty() const {
+  if (!expired_.empty())
+    return false;
+  for (const Level& level : levels_) {
+    if (level.occupied)
+      return false;
+  }
+  return true;
+}
+
+void TimerWheel::Add(std::unique_ptr<PendingTask> task) {
+  uint64_t tick = TickForTime(task->target_time, true);
+  Insert(std::move(task), tick, &expired_);
+}
+
+fxl::TimePoint TimerWheel::GetNextWakeUp() const {
+  if (!expired_.empty())
+    return fxl::TimePoint();
+
+  uint64_t tick = NextEventTick();
+  if (!tick || tick > static_cast<uint64_t>(
+                          std::numeric_limits<int64_t>::max() / resolution_ns_))
+    return fxl::TimePoint::Max();
+  return fxl::TimePoint::FromEpochDelta(fxl::TimeDelta::FromNanoseconds(
+      static_cast<int64_t>(tick) * resolution_ns_));
+}
+
+PendingTaskList TimerWheel::TakeExpired(fxl::TimePoint now) {
+  PendingTaskList expired(std::move(expired_));
+  uint64_t now_tick = TickForTime(now, false);
+
+  for (uint64_t tick = NextEventTick(); tick && tick <= now_tick;
+       tick = NextEventTick()) {
+    current_tick_ = tick;
+
+    // Empty every slot that has just come around, starting at the top so that
+    // tasks can move down more than one level.
+    for (int i = kLevels - 1; i >= 0; --i) {
+      int shift = i * kSlotBits;
+      if (tick & ((1ull << shift) - 1u))
+        continue;
+
+      uint32_t slot = (tick >> shift) & (kSlotCount - 1u);
+      Level& level = levels_[i];
+      if (!(level.occupied & (1ull << slot)))
+        continue;
+
+      PendingTaskList tasks(std::move(level.slots[slot]));
+      level.occupied &= ~(1ull << slot);
+      while (!tasks.empty()) {
+        std::unique_ptr<PendingTask> task = tasks.TakeFront();
+        uint64_t task_tick = TickForTime(task->target_time, true);
+        Insert(std::move(task), task_tick, &expired);
+      }
+    }
+  }
+
+  current_tick_ = std::max(current_tick_, now_tick);
+  return expired;
+}
+
+void TimerWheel::Clear() {
+  expired_.Clear();
+  for (Level& level : levels_) {
+    for (PendingTaskList& slot : level.slots)
+      slot.Clear();
+    level.occupied = 0u;
+  }
+}
+
+uint64_t TimerWheel::TickForTime(fxl::TimePoint time, bool round_up) const {
+  int64_t ns = time.ToEpochDelta().ToNanoseconds();
+  if (ns <= 0)
+    return 0u;
+
+  uint64_t tick = static_cast<uint64_t>(ns / resolution_ns_);
+  if (round_up && ns % resolution_ns_)
+    ++tick;
+  return std::min(tick, kMaxTick);
+}
+
+uint64_t TimerWheel::NextEventTick() const {
+  // The lowest occupied level always comes around first: every slot on a
+  // level is reached before the level above it moves on.
+  for (int i = 0; i < kLevels; ++i) {
+    uint64_t occupied = levels_[i].occupied;
+    if (!occupied)
+      continue;
+
+    int shift = i * kSlotBits;
+    uint64_t slot = static_cast<uint64_t>(__builtin_ctzll(occupied));
+    uint64_t turn = current_tick_ >> (shift + kSlotBits)
+                                   << (shift + kSlotBits);
+    return turn | (slot << shift);
+  }
+  return 0u;
+}
+
+void TimerWheel::Insert(std::unique_ptr<PendingTask> task,
+                        uint64_t tick,
+                        PendingTaskList* expired) {
+  if (tick <= current_tick_) {
+    expired->PushBack(std::move(task));
+    return;
+  }
+
+  // The task goes on the level of the highest digit in which |tick| differs
+  // from |current_tick_|, in the slot for its digit on that level.
+  int level = (63 - __builtin_clzll(tick ^ current_tick_)) / kSlotBits;
+  FXL_DCHECK(level < kLevels);
+  uint32_t slot = (tick >> (level * kSlotBits)) & (kSlotCount - 1u);
+  levels_[level].slots[slot].PushBack(std::move(task));
+  levels_[level].occupied |= 1ull << slot;
+}
+
+}  // namespace internal
+}  // namespace fsl
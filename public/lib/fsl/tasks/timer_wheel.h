@@ -0,0 +1,98 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FSL_TASKS_TIMER_WHEEL_H_
+#define LIB_FSL_TASKS_TIMER_WHEEL_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "lib/fsl/tasks/pending_task.h"
+#include "lib/fxl/fxl_export.h"
+#include "lib/fxl/macros.h"
+#include "lib/fxl/time/time_delta.h"
+#include "lib/fxl/time/time_point.h"
+
+namespace fsl {
+namespace internal {
+
+// Holds delayed tasks until their target time.
+//
+// Target times are rounded up to a multiple of |resolution|, so tasks whose
+// target times fall within the same window of |resolution| expire together
+// and the owner only has to arm a single timer for all of them. A task never
+// expires before its target time and expires at most |resolution| after it.
+//
+// The wheel is hierarchical: level 0 has one slot per tick of |resolution|,
+// and each slot of level n covers a whole turn of level n - 1. Tasks move
+// down a level at a time as their slot comes around. Adding a task is O(1),
+// and so is expiring it, apart from moving down at most |kLevels| levels.
+//
+// Expired tasks are returned in tick order, and tasks that expire in the same
+// tick are returned in the order in which they were added. Tasks added after
+// their tick has already passed expire first, in the order they were added.
+//
+// This object is not threadsafe.
+class FXL_EXPORT TimerWheel {
+ public:
+  explicit TimerWheel(fxl::TimeDelta resolution);
+  ~TimerWheel();
+
+  bool empty() const;
+
+  // Adds |task|, which expires at |task->target_time|.
+  void Add(std::unique_ptr<PendingTask> task);
+
+  // Returns the earliest time at which |TakeExpired| may return tasks, or
+  // |fxl::TimePoint::Max()| if the wheel is empty. Calling |TakeExpired| at
+  // that time may return nothing if tasks only had to move down a level.
+  fxl::TimePoint GetNextWakeUp() const;
+
+  // Removes and returns the tasks that have expired as of |now|.
+  PendingTaskList TakeExpired(fxl::TimePoint now);
+
+  // Destroys all tasks.
+  void Clear();
+
+ private:
+  static constexpr int kSlotBits = 6;
+  static constexpr uint32_t kSlotCount = 1u << kSlotBits;
+  // Enough levels to cover any tick count, since ticks are at least 1 ms.
+  static constexpr int kLevels = 8;
+  static constexpr uint64_t kMaxTick = (1ull << (kSlotBits * kLevels)) - 1u;
+
+  struct Level {
+    // Bit |i| is set if |slots[i]| is non-empty.
+    uint64_t occupied = 0u;
+    PendingTaskList slots[kSlotCount];
+  };
+
+  uint64_t TickForTime(fxl::TimePoint time, bool round_up) const;
+
+  // Returns the next tick at which a slot comes around, or 0 if the wheel is
+  // empty. Slots only ever hold ticks later than |current_tick_|, so this is
+  // always later than |current_tick_| too.
+  uint64_t NextEventTick() const;
+
+  // Places |task|, which expires at |tick|, in the slot for |tick| relative
+  // to |current_tick_|, or in |expired| if |tick| has already passed.
+  void Insert(std::unique_ptr<PendingTask> task,
+              uint64_t tick,
+              PendingTaskList* expired);
+
+  const int64_t resolution_ns_;
+  // All ticks up to and including this one have been processed.
+  uint64_t current_tick_ = 0u;
+  Level levels_[kLevels];
+  // Tasks that were added after their tick had already been processed.
+  PendingTaskList expired_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(TimerWheel);
+};
+
+}  // namespace internal
+}  // namespace fsl
+
+#endif  // LIB_FSL_TASKS_TIMER_WHEEL_H_
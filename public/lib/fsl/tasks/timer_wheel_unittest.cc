@@ -0,0 +1,141 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fsl/tasks/timer_wheel.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace fsl {
+namespace internal {
+namespace {
+
+constexpr fxl::TimeDelta kResolution = fxl::TimeDelta::FromMilliseconds(1);
+
+fxl::TimePoint AtMilliseconds(int64_t ms) {
+  return fxl::TimePoint::FromEpochDelta(fxl::TimeDelta::FromMilliseconds(ms));
+}
+
+fxl::TimePoint AtMicroseconds(int64_t us) {
+  return fxl::TimePoint::FromEpochDelta(fxl::TimeDelta::FromMicroseconds(us));
+}
+
+class TimerWheelTest : public ::testing::Test {
+ protected:
+  void Add(std::string name, fxl::TimePoint target_time) {
+    wheel_.Add(std::make_unique<PendingTask>(
+        [this, name] { expired_.push_back(name); }, target_time));
+  }
+
+  // Returns the names of the tasks that have expired as of |now|.
+  std::vector<std::string> TakeExpired(fxl::TimePoint now) {
+    expired_.clear();
+    PendingTaskList tasks = wheel_.TakeExpired(now);
+    while (!tasks.empty())
+      tasks.TakeFront()->closure();
+    return expired_;
+  }
+
+  TimerWheel wheel_{kResolution};
+  std::vector<std::string> expired_;
+};
+
+TEST_F(TimerWheelTest, Empty) {
+  EXPECT_TRUE(wheel_.empty());
+  EXPECT_EQ(fxl::TimePoint::Max(), wheel_.GetNextWakeUp());
+  EXPECT_TRUE(TakeExpired(AtMilliseconds(1000)).empty());
+}
+
+TEST_F(TimerWheelTest, ExpiresInTargetTimeOrder) {
+  Add("30", AtMilliseconds(30));
+  Add("10", AtMilliseconds(10));
+  Add("20a", AtMilliseconds(20));
+  Add("20b", AtMilliseconds(20));
+  EXPECT_FALSE(wheel_.empty());
+  EXPECT_EQ(AtMilliseconds(10), wheel_.GetNextWakeUp());
+
+  EXPECT_TRUE(TakeExpired(AtMilliseconds(9)).empty());
+  EXPECT_EQ((std::vector<std::string>{"10"}),
+            TakeExpired(AtMilliseconds(10)));
+  EXPECT_EQ(AtMilliseconds(20), wheel_.GetNextWakeUp());
+  EXPECT_EQ((std::vector<std::string>{"20a", "20b", "30"}),
+            TakeExpired(AtMilliseconds(35)));
+  EXPECT_TRUE(wheel_.empty());
+}
+
+TEST_F(TimerWheelTest, CoalescesWithinResolution) {
+  Add("a", AtMicroseconds(10100));
+  Add("b", AtMicroseconds(10900));
+  Add("c", AtMicroseconds(11000));
+  Add("d", AtMicroseconds(11001));
+
+  // Target times are rounded up, so no task expires early.
+  EXPECT_EQ(AtMilliseconds(11), wheel_.GetNextWakeUp());
+  EXPECT_TRUE(TakeExpired(AtMicroseconds(10999)).empty());
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "c"}),
+            TakeExpired(AtMilliseconds(11)));
+  EXPECT_EQ(AtMilliseconds(12), wheel_.GetNextWakeUp());
+  EXPECT_EQ((std::vector<std::string>{"d"}), TakeExpired(AtMilliseconds(12)));
+}
+
+TEST_F(TimerWheelTest, CascadesFarTimers) {
+  // Far enough apart to land on different levels.
+  Add("hour", AtMilliseconds(3600 * 1000 + 7));
+  Add("minute", AtMilliseconds(60 * 1000 + 3));
+  Add("second", AtMilliseconds(1000 + 1));
+
+  fxl::TimePoint now;
+  std::vector<std::string> expired;
+  int wake_ups = 0;
+  while (!wheel_.empty()) {
+    now = wheel_.GetNextWakeUp();
+    ASSERT_NE(fxl::TimePoint::Max(), now);
+    for (const std::string& name : TakeExpired(now))
+      expired.push_back(name);
+    ++wake_ups;
+  }
+
+  EXPECT_EQ((std::vector<std::string>{"second", "minute", "hour"}), expired);
+  EXPECT_EQ(AtMilliseconds(3600 * 1000 + 7), now);
+  // Moving down a level takes a wake-up, but far fewer than one per tick.
+  EXPECT_LT(wake_ups, 3 * 8);
+}
+
+TEST_F(TimerWheelTest, JumpsOverEmptyTicks) {
+  Add("a", AtMilliseconds(100000));
+  EXPECT_EQ((std::vector<std::string>{"a"}),
+            TakeExpired(AtMilliseconds(200000)));
+
+  Add("b", AtMilliseconds(200005));
+  EXPECT_EQ(AtMilliseconds(200005), wheel_.GetNextWakeUp());
+  EXPECT_EQ((std::vector<std::string>{"b"}),
+            TakeExpired(AtMilliseconds(200005)));
+}
+
+TEST_F(TimerWheelTest, AddAfterTargetTime) {
+  EXPECT_TRUE(TakeExpired(AtMilliseconds(50)).empty());
+
+  Add("late", AtMilliseconds(40));
+  Add("now", AtMilliseconds(50));
+  Add("later", AtMilliseconds(51));
+  EXPECT_EQ(fxl::TimePoint(), wheel_.GetNextWakeUp());
+  EXPECT_EQ((std::vector<std::string>{"late", "now"}),
+            TakeExpired(AtMilliseconds(50)));
+  EXPECT_EQ((std::vector<std::string>{"later"}),
+            TakeExpired(AtMilliseconds(51)));
+}
+
+TEST_F(TimerWheelTest, Clear) {
+  Add("a", AtMilliseconds(1));
+  Add("b", AtMilliseconds(100000));
+  wheel_.Clear();
+  EXPECT_TRUE(wheel_.empty());
+  EXPECT_TRUE(TakeExpired(AtMilliseconds(200000)).empty());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace fsl
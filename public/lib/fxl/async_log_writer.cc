@@ -0,0 +1,270 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fxl/async_log_writer.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lib/fxl/logging.h"
+#include "lib/fxl/portable_unistd.h"
+
+namespace fxl {
+namespace internal {
+namespace {
+
+// The size of each thread's ring. Must be a power of two.
+constexpr size_t kRingSize = 16 * 1024;
+
+// Larger messages are written synchronously rather than taking up most of a
+// ring.
+constexpr size_t kMaxQueuedMessageSize = kRingSize / 4;
+
+// How long the writer thread sleeps at most. Waking it up is deliberately
+// racy so that logging threads never take a lock; this bounds the delay when
+// a wake-up is missed.
+constexpr std::chrono::milliseconds kWriterTimeout(250);
+
+// A ring of formatted messages with a single producer, the thread that owns
+// it, and a single consumer, whoever holds the writer's lock. Messages are
+// copied in whole before |write_pos| moves past them, so the consumer only
+// ever sees whole messages.
+struct LogRing {
+  // Called on the owning thread only.
+  bool Push(const std::string& message);
+
+  // Called with the writer's lock held. Appends all queued messages to |out|,
+  // followed by a note about any dropped messages.
+  void Drain(std::string* out);
+
+  std::atomic<uint64_t> write_pos{0};
+  std::atomic<uint64_t> read_pos{0};
+  std::atomic<uint64_t> dropped{0};
+  uint64_t dropped_reported = 0u;
+  // Set once the owning thread has exited.
+  std::atomic<bool> abandoned{false};
+  // Links rings that the writer has not picked up yet.
+  LogRing* next_registered = nullptr;
+  char data[kRingSize];
+};
+
+bool LogRing::Push(const std::string& message) {
+  uint64_t write = write_pos.load(std::memory_order_relaxed);
+  uint64_t read = read_pos.load(std::memory_order_acquire);
+  if (message.size() > kRingSize - (write - read))
+    return false;
+
+  size_t offset = write & (kRingSize - 1u);
+  size_t first = std::min(message.size(), kRingSize - offset);
+  memcpy(data + offset, message.data(), first);
+  memcpy(data, message.data() + first, message.size() - first);
+  write_pos.store(write + message.size(), std::memory_order_release);
+  return true;
+}
+
+void LogRing::Drain(std::string* out) {
+  uint64_t read = read_pos.load(std::memory_order_relaxed);
+  uint64_t write = write_pos.load(std::memory_order_acquire);
+  size_t size = static_cast<size_t>(write - read);
+  size_t offset = read & (kRingSize - 1u);
+  size_t first = std::min(size, kRingSize - offset);
+  out->append(data + offset, first);
+  out->append(data, size - first);
+  read_pos.store(write, std::memory_order_release);
+
+  uint64_t total_dropped = dropped.load(std::memory_order_relaxed);
+  if (total_dropped != dropped_reported) {
+    out->append("[WARNING:fxl] Dropped ");
+    out->append(std::to_string(total_dropped - dropped_reported));
+    out->append(" log messages: buffer full\n");
+    dropped_reported = total_dropped;
+  }
+}
+
+class AsyncLogWriter {
+ public:
+  AsyncLogWriter() : thread_([this] { Run(); }) { thread_.detach(); }
+
+  // Returns the ring for the calling thread, creating it if needed. Returns
+  // nullptr once the thread's ring has been abandoned, which happens when
+  // something logs from a thread-local destructor that runs after ours.
+  //
+  // Never blocks: new rings are registered without taking |mutex_|, which
+  // the writer thread holds while writing to stderr.
+  LogRing* GetRingForCurrentThread();
+
+  // Makes sure the writer thread drains the rings soon.
+  void Wake() {
+    if (!pending_.load(std::memory_order_relaxed) &&
+        !pending_.exchange(true, std::memory_order_acq_rel)) {
+      wake_.notify_one();
+    }
+  }
+
+  // Writes out everything queued so far.
+  void Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DrainLocked();
+  }
+
+ private:
+  struct ThreadRing {
+    ~ThreadRing();
+    LogRing* ring = nullptr;
+    bool destroyed = false;
+  };
+
+  void Run();
+  void DrainLocked();
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::atomic<bool> pending_{false};
+  // Rings registered since the last drain, linked through
+  // |LogRing::next_registered|. Any thread pushes onto it, and whoever holds
+  // |mutex_| takes the whole list.
+  std::atomic<LogRing*> registered_rings_{nullptr};
+  std::vector<LogRing*> rings_;  // guarded by |mutex_|
+  std::string buffer_;           // guarded by |mutex_|
+  std::thread thread_;
+
+  static thread_local ThreadRing thread_ring_;
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<AsyncLogWriter*> g_writer{nullptr};
+std::atomic<uint64_t> g_dropped{0u};
+
+thread_local AsyncLogWriter::ThreadRing AsyncLogWriter::thread_ring_;
+
+AsyncLogWriter::ThreadRing::~ThreadRing() {
+  destroyed = true;
+  if (ring) {
+    // The writer thread may delete the ring as soon as it sees it abandoned.
+    LogRing* abandoned_ring = ring;
+    ring = nullptr;
+    abandoned_ring->abandoned.store(true, std::memory_order_release);
+    g_writer.load(std::memory_order_acquire)->Wake();
+  }
+}
+
+LogRing* AsyncLogWriter::GetRingForCurrentThread() {
+  if (thread_ring_.destroyed)
+    return nullptr;
+  if (!thread_ring_.ring) {
+    auto ring = new LogRing();
+    ring->next_registered = registered_rings_.load(std::memory_order_relaxed);
+    while (!registered_rings_.compare_exchange_weak(
+        ring->next_registered, ring, std::memory_order_release,
+        std::memory_order_relaxed)) {
+    }
+    thread_ring_.ring = ring;
+  }
+  return thread_ring_.ring;
+}
+
+void AsyncLogWriter::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait_for(lock, kWriterTimeout, [this] {
+      return pending_.load(std::memory_order_acquire);
+    });
+    pending_.store(false, std::memory_order_release);
+    DrainLocked();
+  }
+}
+
+void AsyncLogWriter::DrainLocked() {
+  LogRing* registered =
+      registered_rings_.exchange(nullptr, std::memory_order_acquire);
+  while (registered) {
+    rings_.push_back(registered);
+    registered = registered->next_registered;
+  }
+
+  buffer_.clear();
+  for (auto it = rings_.begin(); it != rings_.end();) {
+    LogRing* ring = *it;
+    // Check before draining so that the thread's last messages are written.
+    bool abandoned = ring->abandoned.load(std::memory_order_acquire);
+    ring->Drain(&buffer_);
+    if (abandoned) {
+      delete ring;
+      it = rings_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  const char* data = buffer_.data();
+  size_t size = buffer_.size();
+  while (size) {
+    ssize_t written = write(STDERR_FILENO, data, size);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    data += written;
+    size -= written;
+  }
+}
+
+}  // namespace
+
+void SetAsyncLogging(bool enabled) {
+  if (enabled) {
+    static std::once_flag once;
+    std::call_once(once, [] {
+      // The writer is never destroyed, since logging may continue until the
+      // process exits. Make sure queued messages are written by then.
+      g_writer.store(new AsyncLogWriter(), std::memory_order_release);
+      atexit(&FlushLogMessages);
+    });
+  }
+
+  if (g_enabled.exchange(enabled) && !enabled)
+    FlushLogMessages();
+}
+
+bool QueueAsyncLogMessage(const std::string& message) {
+  if (!g_enabled.load(std::memory_order_relaxed) ||
+      message.size() > kMaxQueuedMessageSize)
+    return false;
+
+  AsyncLogWriter* writer = g_writer.load(std::memory_order_acquire);
+  LogRing* ring = writer->GetRingForCurrentThread();
+  if (!ring)
+    return false;
+  if (!ring->Push(message)) {
+    ring->dropped.fetch_add(1u, std::memory_order_relaxed);
+    g_dropped.fetch_add(1u, std::memory_order_relaxed);
+  }
+  writer->Wake();
+  return true;
+}
+
+}  // namespace internal
+
+void FlushLogMessages() {
+  internal::AsyncLogWriter* writer =
+      internal::g_writer.load(std::memory_order_acquire);
+  if (writer)
+    writer->Flush();
+}
+
+uint64_t GetDroppedLogMessageCount() {
+  return internal::g_dropped.load(std::memory_order_relaxed);
+}
+
+}  // namespace fxl
@@ -0,0 +1,38 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FXL_ASYNC_LOG_WRITER_H_
+#define LIB_FXL_ASYNC_LOG_WRITER_H_
+
+#include <string>
+
+#include "lib/fxl/fxl_export.h"
+
+namespace fxl {
+namespace internal {
+
+// Backs |LogSettings::async_logging|.
+//
+// Each thread that logs gets its own fixed-size ring of formatted messages,
+// which only it writes to and which a background thread drains to stderr.
+// Queueing a message never blocks or takes a lock. If a thread's ring is
+// full, the message is dropped and counted instead; the writer thread reports
+// the number of dropped messages the next time it drains the ring.
+//
+// Messages from one thread are written in order. Messages from different
+// threads may be written in a different order than they were logged.
+
+// Starts or stops queueing messages. Messages already queued are flushed
+// when stopping.
+FXL_EXPORT void SetAsyncLogging(bool enabled);
+
+// Queues |message| if asynchronous logging is enabled. Returns false if the
+// caller must write |message| itself: when asynchronous logging is disabled,
+// |message| is too large to queue, or the calling thread is exiting.
+FXL_EXPORT bool QueueAsyncLogMessage(const std::string& message);
+
+}  // namespace internal
+}  // namespace fxl
+
+#endif  // LIB_FXL_ASYNC_LOG_WRITER_H_
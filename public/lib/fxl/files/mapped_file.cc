@@ -0,0 +1,186 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fxl/files/mapped_file.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "lib/fxl/build_config.h"
+#include "lib/fxl/files/eintr_wrapper.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/logging.h"
+#include "lib/fxl/portable_unistd.h"
+
+#if !defined(OS_WIN)
+#include <sys/mman.h>
+#endif
+
+namespace files {
+namespace {
+
+#if !defined(OS_WIN)
+size_t GetPageSize() {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
+int ToPosixAdvice(MappedFile::Access access) {
+  switch (access) {
+    case MappedFile::Access::kNormal:
+      return POSIX_MADV_NORMAL;
+    case MappedFile::Access::kSequential:
+      return POSIX_MADV_SEQUENTIAL;
+    case MappedFile::Access::kRandom:
+      return POSIX_MADV_RANDOM;
+    case MappedFile::Access::kWillNeed:
+      return POSIX_MADV_WILLNEED;
+    case MappedFile::Access::kDontNeed:
+      return POSIX_MADV_DONTNEED;
+  }
+  return POSIX_MADV_NORMAL;
+}
+#endif
+
+}  // namespace
+
+MappedFile::MappedFile() = default;
+
+MappedFile::MappedFile(MappedFile&& other) {
+  *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this != &other) {
+    Close();
+    is_open_ = other.is_open_;
+    mapping_ = other.mapping_;
+    mapping_size_ = other.mapping_size_;
+    buffer_ = std::move(other.buffer_);
+    view_ = mapping_ ? other.view_ : fxl::StringView(buffer_);
+    other.is_open_ = false;
+    other.mapping_ = nullptr;
+    other.mapping_size_ = 0u;
+    other.buffer_.clear();
+    other.view_ = fxl::StringView();
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+bool MappedFile::Open(const std::string& path) {
+  Close();
+  fxl::UniqueFD fd(HANDLE_EINTR(open(path.c_str(), O_RDONLY)));
+  if (!fd.is_valid())
+    return false;
+  return OpenFileDescriptor(fd.get());
+}
+
+bool MappedFile::OpenFileDescriptor(int fd) {
+  if (MapFileDescriptor(fd))
+    return true;
+  if (fd < 0)
+    return false;
+
+  // Fall back to reading the whole file.
+  if (!ReadFileDescriptorToString(fd, &buffer_))
+    return false;
+  is_open_ = true;
+  view_ = fxl::StringView(buffer_);
+  return true;
+}
+
+bool MappedFile::MapFileDescriptor(int fd) {
+  Close();
+  if (fd < 0)
+    return false;
+
+#if !defined(OS_WIN)
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+      static_cast<uint64_t>(st.st_size) <= SIZE_MAX) {
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0u) {
+      // There is nothing to map; mmap rejects empty mappings.
+      is_open_ = true;
+      return true;
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      is_open_ = true;
+      mapping_ = mapping;
+      mapping_size_ = size;
+      view_ = fxl::StringView(static_cast<const char*>(mapping), size);
+      return true;
+    }
+  }
+#endif
+
+  return false;
+}
+
+void MappedFile::Close() {
+#if !defined(OS_WIN)
+  if (mapping_) {
+    int result = munmap(mapping_, mapping_size_);
+    FXL_DCHECK(result == 0);
+  }
+#endif
+  is_open_ = false;
+  mapping_ = nullptr;
+  mapping_size_ = 0u;
+  buffer_.clear();
+  view_ = fxl::StringView();
+}
+
+void MappedFile::Advise(Access access, size_t offset, size_t size) const {
+#if !defined(OS_WIN)
+  if (!mapping_ || offset >= mapping_size_)
+    return;
+  size = std::min(size, mapping_size_ - offset);
+
+  // The range must start on a page boundary.
+  size_t start = offset & ~(GetPageSize() - 1u);
+  posix_madvise(static_cast<char*>(mapping_) + start, size + (offset - start),
+                ToPosixAdvice(access));
+#endif
+}
+
+constexpr size_t MappedFileReader::kDefaultChunkSize;
+
+MappedFileReader::MappedFileReader(const MappedFile* file, size_t chunk_size)
+    : file_(file), chunk_size_(chunk_size) {
+  FXL_DCHECK(file_);
+  FXL_DCHECK(chunk_size_ > 0u);
+  file_->Advise(MappedFile::Access::kSequential);
+}
+
+bool MappedFileReader::Next(fxl::StringView* chunk) {
+  FXL_DCHECK(chunk);
+  if (offset_ >= file_->size())
+    return false;
+
+  size_t size = std::min(chunk_size_, file_->size() - offset_);
+  *chunk = file_->view().substr(offset_, size);
+
+  // Release the chunk before this one, which the caller is done with, and
+  // start reading in the one after it.
+  if (offset_ >= chunk_size_) {
+    file_->Advise(MappedFile::Access::kDontNeed, offset_ - chunk_size_,
+                  chunk_size_);
+  }
+  offset_ += size;
+  file_->Advise(MappedFile::Access::kWillNeed, offset_, chunk_size_);
+  return true;
+}
+
+}  // namespace files
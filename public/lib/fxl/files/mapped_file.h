@@ -0,0 +1,104 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FXL_FILES_MAPPED_FILE_H_
+#define LIB_FXL_FILES_MAPPED_FILE_H_
+
+#include <stddef.h>
+
+#include <string>
+
+#include "lib/fxl/fxl_export.h"
+#include "lib/fxl/macros.h"
+#include "lib/fxl/strings/string_view.h"
+
+namespace files {
+
+// The read-only contents of a file, mapped into memory where possible.
+//
+// Regular files are mapped rather than copied, so the contents are paged in
+// as they are touched. Files that cannot be mapped, such as pipes, are read
+// into memory instead. Either way, the contents stay valid until the
+// |MappedFile| is closed or destroyed, and must not be written to.
+class FXL_EXPORT MappedFile {
+ public:
+  // How the contents are going to be accessed, as a hint to the kernel.
+  enum class Access {
+    kNormal,
+    kSequential,
+    kRandom,
+    kWillNeed,
+    kDontNeed,
+  };
+
+  MappedFile();
+  MappedFile(MappedFile&& other);
+  MappedFile& operator=(MappedFile&& other);
+  ~MappedFile();
+
+  // Maps the file at |path| or |fd|, closing any file that was open before.
+  // |fd| is not taken over and may be closed once this returns. Returns false
+  // if the file could not be read, in which case this is left closed.
+  bool Open(const std::string& path);
+  bool OpenFileDescriptor(int fd);
+
+  // Like |OpenFileDescriptor|, but fails instead of reading files that cannot
+  // be mapped, for callers that would rather read them piecemeal.
+  bool MapFileDescriptor(int fd);
+
+  void Close();
+
+  bool is_open() const { return is_open_; }
+  bool is_mapped() const { return mapping_ != nullptr; }
+
+  const char* data() const { return view_.data(); }
+  size_t size() const { return view_.size(); }
+  fxl::StringView view() const { return view_; }
+
+  // Hints how the bytes in [|offset|, |offset| + |size|) are going to be
+  // accessed. Does nothing if the file is not mapped.
+  void Advise(Access access) const { Advise(access, 0u, size()); }
+  void Advise(Access access, size_t offset, size_t size) const;
+
+ private:
+  bool is_open_ = false;
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0u;
+  // Holds the contents of files that could not be mapped.
+  std::string buffer_;
+  fxl::StringView view_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+// Reads a |MappedFile| front to back in chunks of at most |chunk_size| bytes.
+//
+// The chunk after the current one is prefetched, and chunks already returned
+// are released, so that streaming through a large file keeps only a couple
+// of chunks resident.
+class FXL_EXPORT MappedFileReader {
+ public:
+  static constexpr size_t kDefaultChunkSize = 256 * 1024;
+
+  // |file| must outlive the reader.
+  explicit MappedFileReader(const MappedFile* file,
+                            size_t chunk_size = kDefaultChunkSize);
+
+  // Sets |chunk| to the next chunk. Returns false once the file is exhausted.
+  bool Next(fxl::StringView* chunk);
+
+  // The offset in the file of the next chunk.
+  size_t offset() const { return offset_; }
+
+ private:
+  const MappedFile* const file_;
+  const size_t chunk_size_;
+  size_t offset_ = 0u;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(MappedFileReader);
+};
+
+}  // namespace files
+
+#endif  // LIB_FXL_FILES_MAPPED_FILE_H_
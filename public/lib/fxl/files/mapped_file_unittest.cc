@@ -0,0 +1,147 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fxl/files/mapped_file.h"
+
+#include <fcntl.h>
+
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/portable_unistd.h"
+
+namespace files {
+namespace {
+
+TEST(MappedFile, Open) {
+  ScopedTempDir dir;
+  std::string path;
+  ASSERT_TRUE(dir.NewTempFile(&path));
+  std::string content = "Hello World";
+  ASSERT_TRUE(WriteFile(path, content.data(), content.size()));
+
+  MappedFile file;
+  EXPECT_FALSE(file.is_open());
+  ASSERT_TRUE(file.Open(path));
+  EXPECT_TRUE(file.is_open());
+  EXPECT_EQ(content, file.view());
+  EXPECT_EQ(content.size(), file.size());
+  file.Advise(MappedFile::Access::kRandom);
+
+  file.Close();
+  EXPECT_FALSE(file.is_open());
+  EXPECT_EQ(0u, file.size());
+}
+
+TEST(MappedFile, OpenEmpty) {
+  ScopedTempDir dir;
+  std::string path;
+  ASSERT_TRUE(dir.NewTempFile(&path));
+
+  MappedFile file;
+  ASSERT_TRUE(file.Open(path));
+  EXPECT_TRUE(file.is_open());
+  EXPECT_FALSE(file.is_mapped());
+  EXPECT_EQ(0u, file.size());
+  EXPECT_EQ("", file.view());
+}
+
+TEST(MappedFile, OpenMissing) {
+  ScopedTempDir dir;
+  MappedFile file;
+  EXPECT_FALSE(file.Open(dir.path() + "/missing"));
+  EXPECT_FALSE(file.is_open());
+}
+
+TEST(MappedFile, OpenFileDescriptor) {
+  ScopedTempDir dir;
+  std::string path;
+  ASSERT_TRUE(dir.NewTempFile(&path));
+  std::string content(100000, 'x');
+  content[12345] = 'y';
+  ASSERT_TRUE(WriteFile(path, content.data(), content.size()));
+
+  MappedFile file;
+  {
+    fxl::UniqueFD fd(open(path.c_str(), O_RDONLY));
+    ASSERT_TRUE(fd.is_valid());
+    ASSERT_TRUE(file.OpenFileDescriptor(fd.get()));
+  }
+  EXPECT_EQ(content, file.view());
+}
+
+TEST(MappedFile, OpenPipe) {
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  fxl::UniqueFD read_fd(fds[0]);
+  std::string content = "Hello World";
+  {
+    fxl::UniqueFD write_fd(fds[1]);
+    ASSERT_EQ(static_cast<ssize_t>(content.size()),
+              write(write_fd.get(), content.data(), content.size()));
+  }
+
+  // Pipes cannot be mapped, so they are read instead.
+  MappedFile file;
+  ASSERT_TRUE(file.OpenFileDescriptor(read_fd.get()));
+  EXPECT_FALSE(file.is_mapped());
+  EXPECT_EQ(content, file.view());
+}
+
+TEST(MappedFile, Move) {
+  ScopedTempDir dir;
+  std::string path;
+  ASSERT_TRUE(dir.NewTempFile(&path));
+  std::string content = "Hello World";
+  ASSERT_TRUE(WriteFile(path, content.data(), content.size()));
+
+  MappedFile file;
+  ASSERT_TRUE(file.Open(path));
+  MappedFile other(std::move(file));
+  EXPECT_FALSE(file.is_open());
+  EXPECT_TRUE(other.is_open());
+  EXPECT_EQ(content, other.view());
+
+  file = std::move(other);
+  EXPECT_TRUE(file.is_open());
+  EXPECT_FALSE(other.is_open());
+  EXPECT_EQ(content, file.view());
+}
+
+TEST(MappedFileReader, Chunks) {
+  ScopedTempDir dir;
+  std::string path;
+  ASSERT_TRUE(dir.NewTempFile(&path));
+  std::string content;
+  for (int i = 0; i < 10000; ++i)
+    content += std::to_string(i);
+  ASSERT_TRUE(WriteFile(path, content.data(), content.size()));
+
+  MappedFile file;
+  ASSERT_TRUE(file.Open(path));
+  MappedFileReader reader(&file, 4096);
+  std::string read_content;
+  fxl::StringView chunk;
+  while (reader.Next(&chunk)) {
+    EXPECT_LE(chunk.size(), 4096u);
+    EXPECT_FALSE(chunk.empty());
+    read_content += chunk.ToString();
+  }
+  EXPECT_EQ(content, read_content);
+  EXPECT_EQ(content.size(), reader.offset());
+  EXPECT_FALSE(reader.Next(&chunk));
+}
+
+TEST(MappedFileReader, Empty) {
+  MappedFile file;
+  MappedFileReader reader(&file);
+  fxl::StringView chunk;
+  EXPECT_FALSE(reader.Next(&chunk));
+}
+
+}  // namespace
+}  // namespace files
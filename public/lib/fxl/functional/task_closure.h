@@ -0,0 +1,180 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FXL_FUNCTIONAL_TASK_CLOSURE_H_
+#define LIB_FXL_FUNCTIONAL_TASK_CLOSURE_H_
+
+#include <stddef.h>
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "lib/fxl/macros.h"
+
+namespace fxl {
+
+// A move-only callable taking no arguments and returning nothing, used for
+// tasks posted to a |TaskRunner|.
+//
+// Unlike |Closure| (std::function), a |TaskClosure| does not require the
+// callable to be copyable, so lambdas that capture move-only values can be
+// posted directly without |MakeCopyable|. Callables of up to |kInlineSize|
+// bytes are stored inline; larger ones are moved to the heap.
+//
+// Any callable converts to a |TaskClosure| implicitly, including a |Closure|.
+// Converting an empty |Closure| or a null function pointer yields an empty
+// |TaskClosure|.
+class TaskClosure {
+ public:
+  static constexpr size_t kInlineSize = 64u;
+
+  TaskClosure() = default;
+  TaskClosure(std::nullptr_t) {}
+
+  template <typename Callable,
+            typename Decayed = typename std::decay<Callable>::type,
+            typename = typename std::enable_if<
+                !std::is_same<Decayed, TaskClosure>::value>::type,
+            typename = decltype(std::declval<Decayed&>()())>
+  TaskClosure(Callable&& callable) {
+    if (IsNull(callable))
+      return;
+    Init<Decayed>(std::forward<Callable>(callable),
+                  std::integral_constant<bool, FitsInline<Decayed>()>());
+  }
+
+  TaskClosure(TaskClosure&& other) { MoveFrom(&other); }
+
+  ~TaskClosure() { reset(); }
+
+  TaskClosure& operator=(TaskClosure&& other) {
+    if (this != &other) {
+      reset();
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+
+  TaskClosure& operator=(std::nullptr_t) {
+    reset();
+    return *this;
+  }
+
+  // Tests as true if the closure holds a callable.
+  explicit operator bool() const { return !!ops_; }
+
+  // Invokes the callable. The closure must not be empty.
+  void operator()() { ops_->invoke(&storage_); }
+
+  // Destroys the callable, leaving the closure empty.
+  void reset() {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  void swap(TaskClosure& other) {
+    TaskClosure temp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temp);
+  }
+
+ private:
+  struct Ops {
+    void (*invoke)(void* storage);
+    // Move-constructs the callable in |to| from the one in |from|, then
+    // destroys the one in |from|.
+    void (*relocate)(void* from, void* to);
+    void (*destroy)(void* storage);
+  };
+
+  template <typename Callable>
+  struct InlineOps {
+    static void Invoke(void* storage) {
+      (*static_cast<Callable*>(storage))();
+    }
+    static void Relocate(void* from, void* to) {
+      Callable* callable = static_cast<Callable*>(from);
+      new (to) Callable(std::move(*callable));
+      callable->~Callable();
+    }
+    static void Destroy(void* storage) {
+      static_cast<Callable*>(storage)->~Callable();
+    }
+    static constexpr Ops kOps = {&Invoke, &Relocate, &Destroy};
+  };
+
+  template <typename Callable>
+  struct HeapOps {
+    static Callable*& Get(void* storage) {
+      return *static_cast<Callable**>(storage);
+    }
+    static void Invoke(void* storage) { (*Get(storage))(); }
+    static void Relocate(void* from, void* to) {
+      new (to) Callable*(Get(from));
+    }
+    static void Destroy(void* storage) { delete Get(storage); }
+    static constexpr Ops kOps = {&Invoke, &Relocate, &Destroy};
+  };
+
+  template <typename Callable>
+  static constexpr bool FitsInline() {
+    return sizeof(Callable) <= kInlineSize &&
+           alignof(Callable) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible<Callable>::value;
+  }
+
+  template <typename Callable>
+  static bool IsNull(const Callable&) {
+    return false;
+  }
+  template <typename Result, typename... Args>
+  static bool IsNull(const std::function<Result(Args...)>& function) {
+    return !function;
+  }
+  template <typename Result, typename... Args>
+  static bool IsNull(Result (*function)(Args...)) {
+    return !function;
+  }
+
+  template <typename Decayed, typename Callable>
+  void Init(Callable&& callable, std::true_type /* fits inline */) {
+    new (&storage_) Decayed(std::forward<Callable>(callable));
+    ops_ = &InlineOps<Decayed>::kOps;
+  }
+
+  template <typename Decayed, typename Callable>
+  void Init(Callable&& callable, std::false_type /* fits inline */) {
+    new (&storage_) Decayed*(new Decayed(std::forward<Callable>(callable)));
+    ops_ = &HeapOps<Decayed>::kOps;
+  }
+
+  void MoveFrom(TaskClosure* other) {
+    if (other->ops_) {
+      other->ops_->relocate(&other->storage_, &storage_);
+      ops_ = other->ops_;
+      other->ops_ = nullptr;
+    }
+  }
+
+  const Ops* ops_ = nullptr;
+  typename std::aligned_storage<kInlineSize, alignof(std::max_align_t)>::type
+      storage_;
+
+  FXL_DISALLOW_COPY_AND_ASSIGN(TaskClosure);
+};
+
+template <typename Callable>
+constexpr TaskClosure::Ops TaskClosure::InlineOps<Callable>::kOps;
+
+template <typename Callable>
+constexpr TaskClosure::Ops TaskClosure::HeapOps<Callable>::kOps;
+
+}  // namespace fxl
+
+#endif  // LIB_FXL_FUNCTIONAL_TASK_CLOSURE_H_
@@ -0,0 +1,121 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fxl/functional/task_closure.h"
+
+#include <array>
+#include <memory>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "lib/fxl/functional/closure.h"
+
+namespace fxl {
+namespace {
+
+int g_calls = 0;
+
+void CountCall() {
+  ++g_calls;
+}
+
+// Counts live instances so that tests can check for leaks and double
+// destruction.
+class Counted {
+ public:
+  explicit Counted(int* live) : live_(live) { ++*live_; }
+  Counted(Counted&& other) : live_(other.live_) { ++*live_; }
+  ~Counted() { --*live_; }
+
+ private:
+  int* live_;
+};
+
+TEST(TaskClosureTest, Empty) {
+  TaskClosure closure;
+  EXPECT_FALSE(closure);
+  EXPECT_FALSE(TaskClosure(nullptr));
+  EXPECT_FALSE(TaskClosure(Closure()));
+
+  void (*null_function)() = nullptr;
+  EXPECT_FALSE(TaskClosure(null_function));
+}
+
+TEST(TaskClosureTest, Call) {
+  int value = 0;
+  TaskClosure closure([&value] { ++value; });
+  EXPECT_TRUE(closure);
+  closure();
+  closure();
+  EXPECT_EQ(2, value);
+
+  g_calls = 0;
+  TaskClosure function_closure(&CountCall);
+  function_closure();
+  EXPECT_EQ(1, g_calls);
+
+  Closure std_closure = [&value] { value = 42; };
+  TaskClosure from_std_closure(std_closure);
+  from_std_closure();
+  EXPECT_EQ(42, value);
+}
+
+TEST(TaskClosureTest, MoveOnlyCapture) {
+  std::unique_ptr<int> src(new int(42));
+  std::unique_ptr<int> dest;
+  TaskClosure closure(
+      [&dest, src = std::move(src) ]() mutable { dest = std::move(src); });
+  TaskClosure moved(std::move(closure));
+  EXPECT_FALSE(closure);
+  EXPECT_TRUE(moved);
+  moved();
+  ASSERT_TRUE(dest);
+  EXPECT_EQ(42, *dest);
+}
+
+TEST(TaskClosureTest, InlineAndHeapStorage) {
+  int live = 0;
+  int value = 0;
+  {
+    TaskClosure small([&value, c = Counted(&live) ] { value += 1; });
+    std::array<char, TaskClosure::kInlineSize> padding{};
+    TaskClosure large([&value, padding, c = Counted(&live) ] {
+      value += 2 + padding[0];
+    });
+    EXPECT_EQ(2, live);
+
+    TaskClosure small_moved(std::move(small));
+    TaskClosure large_moved(std::move(large));
+    EXPECT_EQ(2, live);
+    small_moved();
+    large_moved();
+    EXPECT_EQ(3, value);
+
+    small_moved.swap(large_moved);
+    small_moved();
+    EXPECT_EQ(5, value);
+    EXPECT_EQ(2, live);
+  }
+  EXPECT_EQ(0, live);
+}
+
+TEST(TaskClosureTest, Reset) {
+  int live = 0;
+  TaskClosure closure([c = Counted(&live)]{});
+  EXPECT_EQ(1, live);
+  closure = nullptr;
+  EXPECT_FALSE(closure);
+  EXPECT_EQ(0, live);
+
+  closure = [c = Counted(&live)]{};
+  TaskClosure other([c = Counted(&live)]{});
+  EXPECT_EQ(2, live);
+  closure = std::move(other);
+  EXPECT_EQ(1, live);
+  closure.reset();
+  EXPECT_EQ(0, live);
+}
+
+}  // namespace
+}  // namespace fxl
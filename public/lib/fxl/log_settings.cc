@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <iostream>
 
+#include "lib/fxl/async_log_writer.h"
 #include "lib/fxl/logging.h"
 #include "lib/fxl/portable_unistd.h"
 
@@ -43,6 +44,11 @@ void SetLogSettings(const LogSettings& settings) {
       }
     }
   }
+
+  if (state::g_log_settings.async_logging != settings.async_logging) {
+    internal::SetAsyncLogging(settings.async_logging);
+    state::g_log_settings.async_logging = settings.async_logging;
+  }
 }
 
 LogSettings GetLogSettings() {
@@ -31,6 +31,14 @@ struct LogSettings {
   // redirected to the specified file.  It is not possible to revert to
   // the previous log output through this interface.
   std::string log_file;
+
+  // When true, messages are written out by a background thread instead of by
+  // the thread that logs them, so that logging does not block on output.
+  // Each thread queues its messages in a fixed-size buffer; messages logged
+  // while it is full are dropped, and counted by
+  // |GetDroppedLogMessageCount()| (see lib/fxl/logging.h). Fatal messages are
+  // always written synchronously, after all queued messages.
+  bool async_logging = false;
 };
 
 // Gets the active log settings for the current process.
@@ -44,6 +44,19 @@ bool ParseLogSettings(const fxl::CommandLine& command_line,
     settings.log_file = file;
   }
 
+  // --log-async=<true|false>
+  std::string async;
+  if (command_line.GetOptionValue("log-async", &async)) {
+    if (async.empty() || async == "true") {
+      settings.async_logging = true;
+    } else if (async == "false") {
+      settings.async_logging = false;
+    } else {
+      FXL_LOG(ERROR) << "Error parsing --log-async option.";
+      return false;
+    }
+  }
+
   *out_settings = settings;
   return true;
 }
@@ -21,6 +21,8 @@ struct LogSettings;
 //   --quiet           : sets |min_log_level| to +1 (LOG_WARNING)
 //   --quiet=<level>   : sets |min_log_level| to +level
 //   --log-file=<file> : sets |log_file| to file, uses default output if empty
+//   --log-async       : sets |async_logging| to true
+//   --log-async=false : sets |async_logging| to false
 //
 // Quiet supersedes verbose if both are specified.
 //
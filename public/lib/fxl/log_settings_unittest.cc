@@ -4,6 +4,14 @@
 
 #include "lib/fxl/log_settings.h"
 
+#include <fcntl.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "lib/fxl/command_line.h"
 #include "lib/fxl/files/file.h"
@@ -33,6 +41,7 @@ TEST(LogSettings, DefaultOptions) {
   LogSettings settings;
   EXPECT_EQ(LOG_INFO, settings.min_log_level);
   EXPECT_EQ(std::string(), settings.log_file);
+  EXPECT_FALSE(settings.async_logging);
 }
 
 TEST(LogSettings, ParseValidOptions) {
@@ -71,6 +80,20 @@ TEST(LogSettings, ParseValidOptions) {
       CommandLineFromInitializerList({"argv0", "--log-file=custom.log"}),
       &settings));
   EXPECT_EQ("custom.log", settings.log_file);
+
+  EXPECT_TRUE(ParseLogSettings(
+      CommandLineFromInitializerList({"argv0", "--log-async"}), &settings));
+  EXPECT_TRUE(settings.async_logging);
+
+  EXPECT_TRUE(ParseLogSettings(
+      CommandLineFromInitializerList({"argv0", "--log-async=false"}),
+      &settings));
+  EXPECT_FALSE(settings.async_logging);
+
+  EXPECT_TRUE(ParseLogSettings(
+      CommandLineFromInitializerList({"argv0", "--log-async=true"}),
+      &settings));
+  EXPECT_TRUE(settings.async_logging);
 }
 
 TEST(LogSettings, ParseInvalidOptions) {
@@ -94,6 +117,11 @@ TEST(LogSettings, ParseInvalidOptions) {
       CommandLineFromInitializerList({"argv0", "--quiet=123garbage"}),
       &settings));
   EXPECT_EQ(LOG_FATAL, settings.min_log_level);
+
+  EXPECT_FALSE(ParseLogSettings(
+      CommandLineFromInitializerList({"argv0", "--log-async=maybe"}),
+      &settings));
+  EXPECT_FALSE(settings.async_logging);
 }
 
 TEST_F(LogSettingsFixture, SetAndGet) {
@@ -157,5 +185,131 @@ TEST_F(LogSettingsFixture, SetInvalidLogFile) {
   EXPECT_NE(0, access(new_settings.log_file.c_str(), R_OK));
 }
 
+TEST_F(LogSettingsFixture, AsyncLogging) {
+  constexpr int kThreadCount = 4;
+  constexpr int kMessagesPerThread = 1000;
+
+  LogSettings new_settings;
+  files::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.NewTempFile(&new_settings.log_file));
+  new_settings.async_logging = true;
+  SetLogSettings(new_settings);
+  EXPECT_TRUE(GetLogSettings().async_logging);
+
+  uint64_t dropped_before = GetDroppedLogMessageCount();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([i] {
+      for (int j = 0; j < kMessagesPerThread; ++j)
+        FXL_LOG(INFO) << "ASYNC " << i << " " << j;
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  FlushLogMessages();
+
+  std::string log;
+  ASSERT_TRUE(files::ReadFileToString(new_settings.log_file, &log));
+
+  // Every message was either written, in order for each thread, or dropped.
+  int written = 0;
+  std::vector<int> next_message(kThreadCount, 0);
+  for (size_t pos = log.find("ASYNC "); pos != std::string::npos;
+       pos = log.find("ASYNC ", pos + 1)) {
+    int thread = 0;
+    int message = 0;
+    ASSERT_EQ(2, sscanf(log.c_str() + pos, "ASYNC %d %d", &thread, &message));
+    ASSERT_LT(thread, kThreadCount);
+    EXPECT_LE(next_message[thread], message);
+    next_message[thread] = message + 1;
+    ++written;
+  }
+  EXPECT_EQ(kThreadCount * kMessagesPerThread,
+            written + static_cast<int>(GetDroppedLogMessageCount() -
+                                       dropped_before));
+}
+
+// Logs from its destructor, which runs during thread exit. Flushing first
+// makes the writer release the thread's abandoned ring.
+struct LogOnThreadExit {
+  ~LogOnThreadExit() {
+    FlushLogMessages();
+    FXL_LOG(INFO) << "EXITING";
+  }
+};
+
+TEST_F(LogSettingsFixture, AsyncLoggingDuringThreadExit) {
+  LogSettings new_settings;
+  files::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.NewTempFile(&new_settings.log_file));
+  new_settings.async_logging = true;
+  SetLogSettings(new_settings);
+
+  std::thread thread([] {
+    // Thread-locals are destroyed in reverse order of construction, so this
+    // one logs after the thread's ring has been abandoned.
+    static thread_local LogOnThreadExit log_on_exit;
+    (void)log_on_exit;
+    FXL_LOG(INFO) << "RUNNING";
+  });
+  thread.join();
+  FlushLogMessages();
+
+  std::string log;
+  ASSERT_TRUE(files::ReadFileToString(new_settings.log_file, &log));
+  EXPECT_NE(std::string::npos, log.find("RUNNING"));
+  EXPECT_NE(std::string::npos, log.find("EXITING"));
+}
+
+// A thread that logs for the first time must not wait for the writer thread,
+// even while it is blocked writing to stderr.
+TEST_F(LogSettingsFixture, AsyncLoggingFromNewThreadWhileWriterBlocked) {
+  int pipe_fds[2];
+  ASSERT_EQ(0, pipe(pipe_fds));
+  int saved_stderr = dup(STDERR_FILENO);
+  ASSERT_GE(dup2(pipe_fds[1], STDERR_FILENO), 0);
+
+  LogSettings new_settings;
+  new_settings.async_logging = true;
+  SetLogSettings(new_settings);
+
+  // Fill the pipe, so that the writer thread blocks on its next write.
+  int flags = fcntl(pipe_fds[1], F_GETFL);
+  fcntl(pipe_fds[1], F_SETFL, flags | O_NONBLOCK);
+  char filler[4096] = {};
+  while (write(pipe_fds[1], filler, sizeof(filler)) > 0) {
+  }
+  fcntl(pipe_fds[1], F_SETFL, flags);
+  FXL_LOG(INFO) << "BLOCKED";
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  std::promise<void> logged;
+  std::thread thread([&logged] {
+    FXL_LOG(INFO) << "NEW THREAD";
+    logged.set_value();
+  });
+  EXPECT_EQ(std::future_status::ready,
+            logged.get_future().wait_for(std::chrono::seconds(5)));
+
+  // Unblock the writer thread.
+  std::string output;
+  std::thread reader([&output, &pipe_fds] {
+    char buffer[4096];
+    ssize_t size;
+    while ((size = read(pipe_fds[0], buffer, sizeof(buffer))) > 0)
+      output.append(buffer, size);
+  });
+  thread.join();
+  FlushLogMessages();
+  dup2(saved_stderr, STDERR_FILENO);
+  close(saved_stderr);
+  close(pipe_fds[1]);
+  reader.join();
+  close(pipe_fds[0]);
+
+  EXPECT_NE(std::string::npos, output.find("BLOCKED"));
+  EXPECT_NE(std::string::npos, output.find("NEW THREAD"));
+}
+
 }  // namespace
 }  // namespace fxl
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <iostream>
 
+#include "lib/fxl/async_log_writer.h"
 #include "lib/fxl/build_config.h"
 #include "lib/fxl/debug/debugger.h"
 #include "lib/fxl/log_settings.h"
@@ -85,8 +86,14 @@ LogMessage::~LogMessage() {
 #elif defined(OS_IOS)
   syslog(LOG_ALERT, "%s", stream_.str().c_str());
 #else
-  std::cerr << stream_.str();
-  std::cerr.flush();
+  std::string message = stream_.str();
+  if (severity_ >= LOG_FATAL || !internal::QueueAsyncLogMessage(message)) {
+    // Write out anything queued earlier first, so that messages from this
+    // thread stay in order and nothing is lost if this one is fatal.
+    FlushLogMessages();
+    std::cerr << message;
+    std::cerr.flush();
+  }
 #endif
 
   if (severity_ >= LOG_FATAL)
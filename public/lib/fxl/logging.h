@@ -5,6 +5,8 @@
 #ifndef LIB_FXL_LOGGING_H_
 #define LIB_FXL_LOGGING_H_
 
+#include <stdint.h>
+
 #include <sstream>
 
 #include "lib/fxl/fxl_export.h"
@@ -44,6 +46,16 @@ FXL_EXPORT int GetVlogVerbosity();
 // LOG_FATAL and above is always true.
 FXL_EXPORT bool ShouldCreateLogMessage(LogSeverity severity);
 
+// Waits until all messages logged so far have been written out. Only needed
+// when |LogSettings::async_logging| is enabled. Fatal messages always flush
+// earlier messages before they are written.
+FXL_EXPORT void FlushLogMessages();
+
+// Returns the number of messages that were dropped because the thread that
+// logged them was logging faster than they could be written out. Only
+// |LogSettings::async_logging| ever drops messages.
+FXL_EXPORT uint64_t GetDroppedLogMessageCount();
+
 }  // namespace fxl
 
 #define FXL_LOG_STREAM(severity) \
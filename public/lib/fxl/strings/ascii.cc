@@ -4,12 +4,24 @@
 
 #include "lib/fxl/strings/ascii.h"
 
+#include "lib/fxl/strings/string_scan_internal.h"
+
 namespace fxl {
 
 bool EqualsCaseInsensitiveASCII(fxl::StringView v1, fxl::StringView v2) {
   if (v1.size() != v2.size())
     return false;
-  for (size_t i = 0; i < v1.size(); ++i) {
+
+  size_t i = 0;
+  for (; i + sizeof(internal::ScanWord) <= v1.size();
+       i += sizeof(internal::ScanWord)) {
+    internal::ScanWord w1 = internal::LoadScanWord(v1.data() + i);
+    internal::ScanWord w2 = internal::LoadScanWord(v2.data() + i);
+    if (w1 != w2 &&
+        internal::ToLowerASCIIWord(w1) != internal::ToLowerASCIIWord(w2))
+      return false;
+  }
+  for (; i < v1.size(); ++i) {
     if (ToLowerASCII(v1[i]) != ToLowerASCII(v2[i]))
       return false;
   }
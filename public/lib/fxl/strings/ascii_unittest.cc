@@ -31,6 +31,19 @@ TEST(StringUtil, EqualsCaseInsensitiveASCII) {
   EXPECT_FALSE(EqualsCaseInsensitiveASCII("abcd", "abc"));
   EXPECT_FALSE(EqualsCaseInsensitiveASCII("abcd", "ABC"));
   EXPECT_FALSE(EqualsCaseInsensitiveASCII("abcd", "ABCDE"));
+
+  // Long enough to be compared a word at a time.
+  EXPECT_TRUE(EqualsCaseInsensitiveASCII("Content-Type: Text/HTML",
+                                         "content-type: text/html"));
+  EXPECT_FALSE(EqualsCaseInsensitiveASCII("Content-Type: Text/HTML",
+                                          "content-type: text/htmm"));
+  EXPECT_FALSE(EqualsCaseInsensitiveASCII("content-type", "content_type"));
+  // Only ASCII letters compare equal to their other case.
+  EXPECT_FALSE(EqualsCaseInsensitiveASCII("@[`{@[`{", "`{@[`{@["));
+  EXPECT_FALSE(EqualsCaseInsensitiveASCII("\xc1\xc1\xc1\xc1\xc1\xc1\xc1\xc1",
+                                          "\xe1\xe1\xe1\xe1\xe1\xe1\xe1\xe1"));
+  EXPECT_TRUE(EqualsCaseInsensitiveASCII("\xc1\xc1\xc1\xc1\xc1\xc1\xc1\xc1",
+                                         "\xc1\xc1\xc1\xc1\xc1\xc1\xc1\xc1"));
 }
 
 }  // namespace
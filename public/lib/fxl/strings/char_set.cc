@@ -0,0 +1,54 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fxl/strings/char_set.h"
+
+#include <string.h>
+
+namespace fxl {
+
+CharSet::CharSet(StringView chars) {
+  for (char c : chars) {
+    unsigned char index = static_cast<unsigned char>(c);
+    bits_[index / 64] |= 1ull << (index % 64);
+  }
+  if (chars.size() == 1)
+    single_char_ = static_cast<unsigned char>(chars[0]);
+}
+
+size_t CharSet::FindFirstIn(StringView str, size_t pos) const {
+  if (pos >= str.size())
+    return StringView::npos;
+
+  if (single_char_ >= 0) {
+    const void* found =
+        memchr(str.data() + pos, single_char_, str.size() - pos);
+    return found ? static_cast<const char*>(found) - str.data()
+                 : StringView::npos;
+  }
+
+  for (size_t i = pos; i < str.size(); ++i) {
+    if (Contains(str[i]))
+      return i;
+  }
+  return StringView::npos;
+}
+
+size_t CharSet::FindFirstNotIn(StringView str, size_t pos) const {
+  for (size_t i = pos; i < str.size(); ++i) {
+    if (!Contains(str[i]))
+      return i;
+  }
+  return StringView::npos;
+}
+
+size_t CharSet::FindLastNotIn(StringView str) const {
+  for (size_t i = str.size(); i > 0; --i) {
+    if (!Contains(str[i - 1]))
+      return i - 1;
+  }
+  return StringView::npos;
+}
+
+}  // namespace fxl
@@ -0,0 +1,45 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_FXL_STRINGS_CHAR_SET_H_
+#define LIB_FXL_STRINGS_CHAR_SET_H_
+
+#include <stdint.h>
+
+#include "lib/fxl/fxl_export.h"
+#include "lib/fxl/strings/string_view.h"
+
+namespace fxl {
+
+// A set of bytes, for finding any of several characters in a single pass.
+// Building the set once and reusing it avoids rescanning the characters for
+// every position searched.
+class FXL_EXPORT CharSet {
+ public:
+  explicit CharSet(StringView chars);
+
+  bool Contains(char c) const {
+    unsigned char index = static_cast<unsigned char>(c);
+    return !!(bits_[index / 64] & (1ull << (index % 64)));
+  }
+
+  // Returns the index of the first character of |str| at or after |pos| that
+  // is (or is not) in the set, or |StringView::npos| if there is none.
+  size_t FindFirstIn(StringView str, size_t pos) const;
+  size_t FindFirstNotIn(StringView str, size_t pos) const;
+
+  // Returns the index of the last character of |str| that is not in the set,
+  // or |StringView::npos| if there is none.
+  size_t FindLastNotIn(StringView str) const;
+
+ private:
+  uint64_t bits_[4] = {};
+  // The only character in the set, if it has exactly one, which allows
+  // searching with memchr.
+  int single_char_ = -1;
+};
+
+}  // namespace fxl
+
+#endif  // LIB_FXL_STRINGS_CHAR_SET_H_
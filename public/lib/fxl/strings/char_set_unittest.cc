@@ -0,0 +1,48 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fxl/strings/char_set.h"
+
+#include "gtest/gtest.h"
+
+namespace fxl {
+namespace {
+
+TEST(CharSet, Contains) {
+  CharSet set(",; \xff");
+  EXPECT_TRUE(set.Contains(','));
+  EXPECT_TRUE(set.Contains(';'));
+  EXPECT_TRUE(set.Contains(' '));
+  EXPECT_TRUE(set.Contains('\xff'));
+  EXPECT_FALSE(set.Contains('a'));
+  EXPECT_FALSE(set.Contains('\0'));
+  EXPECT_FALSE(CharSet("").Contains('\0'));
+}
+
+TEST(CharSet, FindFirstIn) {
+  CharSet set(",;");
+  EXPECT_EQ(1u, set.FindFirstIn("a;b,c", 0));
+  EXPECT_EQ(3u, set.FindFirstIn("a;b,c", 2));
+  EXPECT_EQ(StringView::npos, set.FindFirstIn("a;b,c", 4));
+  EXPECT_EQ(StringView::npos, set.FindFirstIn("a;b,c", 10));
+  EXPECT_EQ(StringView::npos, set.FindFirstIn("", 0));
+
+  // A single character is searched for differently.
+  CharSet comma(",");
+  EXPECT_EQ(3u, comma.FindFirstIn("a;b,c", 0));
+  EXPECT_EQ(StringView::npos, comma.FindFirstIn("a;b,c", 4));
+}
+
+TEST(CharSet, FindNotIn) {
+  CharSet set(" \t");
+  EXPECT_EQ(2u, set.FindFirstNotIn(" \tab\t ", 0));
+  EXPECT_EQ(3u, set.FindFirstNotIn(" \tab\t ", 3));
+  EXPECT_EQ(StringView::npos, set.FindFirstNotIn(" \tab\t ", 4));
+  EXPECT_EQ(3u, set.FindLastNotIn(" \tab\t "));
+  EXPECT_EQ(StringView::npos, set.FindLastNotIn(" \t "));
+  EXPECT_EQ(StringView::npos, set.FindLastNotIn(""));
+}
+
+}  // namespace
+}  // namespace fxl
@@ -4,12 +4,17 @@
 
 #include "lib/fxl/strings/split_string.h"
 
+#include "lib/fxl/strings/string_scan_internal.h"
 #include "lib/fxl/strings/string_view.h"
-#include "lib/fxl/strings/trim.h"
 
 namespace fxl {
 namespace {
 
+const CharSet& Whitespace() {
+  static const CharSet whitespace(" \t\r\n");
+  return whitespace;
+}
+
 template <typename OutputType>
 OutputType PieceToOutputType(StringView view) {
   return view;
@@ -20,42 +25,15 @@ std::string PieceToOutputType<std::string>(StringView view) {
   return view.ToString();
 }
 
-size_t FindFirstOf(StringView view, char c, size_t pos) {
-  return view.find(c, pos);
-}
-
-size_t FindFirstOf(StringView view, StringView one_of, size_t pos) {
-  return view.find_first_of(one_of, pos);
-}
-
-template <typename Str, typename OutputStringType, typename DelimiterType>
-std::vector<OutputStringType> SplitStringT(Str src,
-                                           DelimiterType delimiter,
+template <typename OutputStringType>
+std::vector<OutputStringType> SplitStringT(StringView src,
+                                           StringView separators,
                                            WhiteSpaceHandling whitespace,
                                            SplitResult result_type) {
   std::vector<OutputStringType> result;
-  if (src.empty())
-    return result;
-
-  size_t start = 0;
-  while (start != Str::npos) {
-    size_t end = FindFirstOf(src, delimiter, start);
-
-    StringView view;
-    if (end == Str::npos) {
-      view = src.substr(start);
-      start = Str::npos;
-    } else {
-      view = src.substr(start, end - start);
-      start = end + 1;
-    }
-    if (whitespace == kTrimWhitespace) {
-      view = TrimString(view, " \t\r\n");
-    }
-    if (result_type == kSplitWantAll || !view.empty()) {
-      result.push_back(PieceToOutputType<OutputStringType>(view));
-    }
-  }
+  SplitStringIterator it(src, separators, whitespace, result_type);
+  while (it.Next())
+    result.push_back(PieceToOutputType<OutputStringType>(it.piece()));
   return result;
 }
 
@@ -65,23 +43,48 @@ std::vector<std::string> SplitStringCopy(StringView input,
                                          StringView separators,
                                          WhiteSpaceHandling whitespace,
                                          SplitResult result_type) {
-  if (separators.size() == 1) {
-    return SplitStringT<StringView, std::string, char>(input, separators[0],
-                                                       whitespace, result_type);
-  }
-  return SplitStringT<StringView, std::string, StringView>(
-      input, separators, whitespace, result_type);
+  return SplitStringT<std::string>(input, separators, whitespace, result_type);
 }
+
 std::vector<StringView> SplitString(StringView input,
                                     StringView separators,
                                     WhiteSpaceHandling whitespace,
                                     SplitResult result_type) {
-  if (separators.size() == 1) {
-    return SplitStringT<StringView, StringView, char>(input, separators[0],
-                                                      whitespace, result_type);
+  return SplitStringT<StringView>(input, separators, whitespace, result_type);
+}
+
+SplitStringIterator::SplitStringIterator(StringView input,
+                                         StringView separators,
+                                         WhiteSpaceHandling whitespace,
+                                         SplitResult result_type)
+    : input_(input),
+      separators_(separators),
+      whitespace_(whitespace),
+      result_type_(result_type),
+      next_start_(input.empty() ? StringView::npos : 0) {}
+
+bool SplitStringIterator::Next() {
+  while (next_start_ != StringView::npos) {
+    size_t start = next_start_;
+    size_t end = separators_.FindFirstIn(input_, start);
+
+    StringView view;
+    if (end == StringView::npos) {
+      view = input_.substr(start);
+      next_start_ = StringView::npos;
+    } else {
+      view = input_.substr(start, end - start);
+      next_start_ = end + 1;
+    }
+    if (whitespace_ == kTrimWhitespace) {
+      view = internal::TrimString(view, Whitespace());
+    }
+    if (result_type_ == kSplitWantAll || !view.empty()) {
+      piece_ = view;
+      return true;
+    }
   }
-  return SplitStringT<StringView, StringView, StringView>(
-      input, separators, whitespace, result_type);
+  return false;
 }
 
 }  // namespace fxl
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "lib/fxl/fxl_export.h"
+#include "lib/fxl/strings/char_set.h"
 #include "lib/fxl/strings/string_view.h"
 
 namespace fxl {
@@ -41,6 +42,39 @@ FXL_EXPORT std::vector<StringView> SplitString(StringView input,
                                                WhiteSpaceHandling whitespace,
                                                SplitResult result_type);
 
+// Yields the same pieces as SplitString above, one at a time and without
+// allocating:
+//
+//   fxl::SplitStringIterator it(input, ",", fxl::kTrimWhitespace,
+//                               fxl::kSplitWantNonEmpty);
+//   while (it.Next())
+//     DoSomething(it.piece());
+//
+// The pieces reference |input|, which must outlive the iterator.
+class FXL_EXPORT SplitStringIterator {
+ public:
+  SplitStringIterator(StringView input,
+                      StringView separators,
+                      WhiteSpaceHandling whitespace,
+                      SplitResult result_type);
+
+  // Moves to the next piece. Returns false if there are no more pieces.
+  bool Next();
+
+  // Returns the current piece. Only valid once |Next| has returned true.
+  StringView piece() const { return piece_; }
+
+ private:
+  StringView input_;
+  CharSet separators_;
+  WhiteSpaceHandling whitespace_;
+  SplitResult result_type_;
+  // Where the next piece starts, or |StringView::npos| once the last piece
+  // has been returned.
+  size_t next_start_;
+  StringView piece_;
+};
+
 }  // namespace fxl
 
 #endif  // LIB_FXL_STRINGS_SPLIT_STRING_H_
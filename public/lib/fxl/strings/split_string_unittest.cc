@@ -22,5 +22,37 @@ TEST(StringUtil, SplitString) {
   EXPECT_EQ(r4, SplitStringCopy(sw, ",", kKeepWhitespace, kSplitWantNonEmpty));
 }
 
+TEST(StringUtil, SplitStringMultipleSeparators) {
+  StringView sw = "a,b;c,;d";
+  std::vector<StringView> r1 = {"a", "b", "c", "", "d"};
+  std::vector<StringView> r2 = {"a,b", "c,", "d"};
+  std::vector<StringView> r3 = {"a,b;c,;d"};
+
+  EXPECT_EQ(r1, SplitString(sw, ",;", kKeepWhitespace, kSplitWantAll));
+  EXPECT_EQ(r2, SplitString(sw, ";", kKeepWhitespace, kSplitWantAll));
+  EXPECT_EQ(r3, SplitString(sw, "", kKeepWhitespace, kSplitWantAll));
+  EXPECT_TRUE(SplitString("", ",", kKeepWhitespace, kSplitWantAll).empty());
+}
+
+TEST(StringUtil, SplitStringIterator) {
+  StringView sw = "First,\tSecond,Third\t ,, ";
+  std::vector<StringView> pieces;
+  SplitStringIterator it(sw, ",", kTrimWhitespace, kSplitWantNonEmpty);
+  while (it.Next())
+    pieces.push_back(it.piece());
+  EXPECT_EQ((std::vector<StringView>{"First", "Second", "Third"}), pieces);
+  EXPECT_FALSE(it.Next());
+
+  // Pieces point into the input.
+  EXPECT_EQ(sw.data(), pieces[0].data());
+
+  SplitStringIterator empty("", ",", kKeepWhitespace, kSplitWantAll);
+  EXPECT_FALSE(empty.Next());
+
+  SplitStringIterator separators_only(",,", ",", kKeepWhitespace,
+                                      kSplitWantNonEmpty);
+  EXPECT_FALSE(separators_only.Next());
+}
+
 }  // namespace
 }  // namespace fxl
@@ -0,0 +1,59 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Internal helpers for scanning strings quickly. Do not use these directly.
+
+#ifndef LIB_FXL_STRINGS_STRING_SCAN_INTERNAL_H_
+#define LIB_FXL_STRINGS_STRING_SCAN_INTERNAL_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lib/fxl/fxl_export.h"
+#include "lib/fxl/strings/char_set.h"
+#include "lib/fxl/strings/string_view.h"
+
+namespace fxl {
+namespace internal {
+
+// Strings are scanned a machine word at a time where possible, treating the
+// word as a vector of bytes. This is portable across the architectures fxl
+// builds for and needs no alignment: loads go through memcpy, which compiles
+// to a single unaligned load.
+using ScanWord = uint64_t;
+
+constexpr ScanWord kScanWordOnes = 0x0101010101010101ull;
+constexpr ScanWord kScanWordHighBits = 0x8080808080808080ull;
+
+inline ScanWord LoadScanWord(const char* data) {
+  ScanWord word;
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+// Returns true if any byte of |word| is not ASCII.
+inline bool HasNonASCIIByte(ScanWord word) {
+  return !!(word & kScanWordHighBits);
+}
+
+// Converts the ASCII uppercase bytes of |word| to lowercase, leaving all other
+// bytes unchanged.
+inline ScanWord ToLowerASCIIWord(ScanWord word) {
+  // Adding to the low seven bits of each byte cannot carry into the next one.
+  // The high bit of each sum then tells whether the byte is >= 'A', and
+  // > 'Z', respectively.
+  ScanWord low_bits = word & ~kScanWordHighBits;
+  ScanWord at_least_a = low_bits + (0x80 - 'A') * kScanWordOnes;
+  ScanWord above_z = low_bits + (0x80 - 'Z' - 1) * kScanWordOnes;
+  ScanWord is_upper = (at_least_a ^ above_z) & ~word & kScanWordHighBits;
+  return word | (is_upper >> 2);
+}
+
+// Like |fxl::TrimString|, for a set that has already been built.
+FXL_EXPORT StringView TrimString(StringView str, const CharSet& chars_to_trim);
+
+}  // namespace internal
+}  // namespace fxl
+
+#endif  // LIB_FXL_STRINGS_STRING_SCAN_INTERNAL_H_
@@ -91,13 +91,13 @@ size_t StringView::find(StringView s, size_t pos) const {
 }
 
 size_t StringView::find(char c, size_t pos) const {
-  if (pos > size_)
+  if (pos >= size_)
     return npos;
 
-  auto result = std::find(begin() + pos, end(), c);
-  if (result == end())
+  const void* result = memchr(data_ + pos, c, size_ - pos);
+  if (!result)
     return npos;
-  return result - begin();
+  return static_cast<const char*>(result) - data_;
 }
 
 size_t StringView::rfind(StringView s, size_t pos) const {
@@ -0,0 +1,87 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "lib/fxl/strings/ascii.h"
+#include "lib/fxl/strings/split_string.h"
+#include "lib/fxl/strings/trim.h"
+#include "lib/fxl/strings/utf_codecs.h"
+
+namespace fxl {
+namespace {
+
+// Returns a comma-separated list of |state.range(0)| short fields.
+std::string MakeFields(const benchmark::State& state) {
+  std::string fields;
+  for (int i = 0; i < state.range(0); ++i) {
+    if (i)
+      fields += ", ";
+    fields += "field" + std::to_string(i);
+  }
+  return fields;
+}
+
+void Strings_SplitString(benchmark::State& state) {
+  std::string input = MakeFields(state);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        SplitString(input, ",", kTrimWhitespace, kSplitWantNonEmpty));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(Strings_SplitString)->Arg(4)->Arg(64)->Arg(1024);
+
+void Strings_SplitStringIterator(benchmark::State& state) {
+  std::string input = MakeFields(state);
+  while (state.KeepRunning()) {
+    SplitStringIterator it(input, ",", kTrimWhitespace, kSplitWantNonEmpty);
+    while (it.Next())
+      benchmark::DoNotOptimize(it.piece());
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(Strings_SplitStringIterator)->Arg(4)->Arg(64)->Arg(1024);
+
+void Strings_SplitStringMultipleSeparators(benchmark::State& state) {
+  std::string input = MakeFields(state);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        SplitString(input, ",;:", kKeepWhitespace, kSplitWantAll));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(Strings_SplitStringMultipleSeparators)->Arg(4)->Arg(64)->Arg(1024);
+
+void Strings_TrimString(benchmark::State& state) {
+  std::string input = "\t  " + std::string(state.range(0), 'x') + "  \n";
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(TrimString(input, " \t\r\n"));
+}
+BENCHMARK(Strings_TrimString)->Arg(8)->Arg(1024);
+
+void Strings_IsStringUTF8(benchmark::State& state) {
+  std::string input(state.range(0), 'x');
+  // One multi-byte character per kilobyte, as in mostly-ASCII text.
+  for (size_t i = 512; i + 3 < input.size(); i += 1024)
+    input.replace(i, 3, "\xe1\x80\xbf");
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(IsStringUTF8(input));
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+BENCHMARK(Strings_IsStringUTF8)->Arg(16)->Arg(1024)->Arg(64 * 1024);
+
+void Strings_EqualsCaseInsensitiveASCII(benchmark::State& state) {
+  std::string lower(state.range(0), 'x');
+  std::string upper(state.range(0), 'X');
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(EqualsCaseInsensitiveASCII(lower, upper));
+  state.SetBytesProcessed(state.iterations() * lower.size());
+}
+BENCHMARK(Strings_EqualsCaseInsensitiveASCII)->Arg(16)->Arg(1024);
+
+}  // namespace
+}  // namespace fxl
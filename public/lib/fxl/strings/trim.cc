@@ -4,15 +4,25 @@
 
 #include "lib/fxl/strings/trim.h"
 
+#include "lib/fxl/strings/string_scan_internal.h"
+
 namespace fxl {
 
 fxl::StringView TrimString(fxl::StringView str, fxl::StringView chars_to_trim) {
-  size_t start_index = str.find_first_not_of(chars_to_trim);
+  return internal::TrimString(str, CharSet(chars_to_trim));
+}
+
+namespace internal {
+
+fxl::StringView TrimString(fxl::StringView str, const CharSet& chars_to_trim) {
+  size_t start_index = chars_to_trim.FindFirstNotIn(str, 0);
   if (start_index == fxl::StringView::npos) {
     return fxl::StringView();
   }
-  size_t end_index = str.find_last_not_of(chars_to_trim);
+  size_t end_index = chars_to_trim.FindLastNotIn(str);
   return str.substr(start_index, end_index - start_index + 1);
 }
 
+}  // namespace internal
+
 }  // namespace fxl
@@ -4,6 +4,7 @@
 
 #include "lib/fxl/strings/utf_codecs.h"
 
+#include "lib/fxl/strings/string_scan_internal.h"
 #include "lib/fxl/third_party/icu/icu_utf.h"
 
 namespace fxl {
@@ -14,6 +15,15 @@ bool IsStringUTF8(fxl::StringView str) {
   size_t char_index = 0;
 
   while (char_index < src_len) {
+    // Skip over ASCII a word at a time; it is always valid.
+    while (char_index + sizeof(internal::ScanWord) <= src_len &&
+           !internal::HasNonASCIIByte(
+               internal::LoadScanWord(src + char_index))) {
+      char_index += sizeof(internal::ScanWord);
+    }
+    if (char_index == src_len)
+      break;
+
     int32_t code_point;
     FXL_U8_NEXT(src, char_index, src_len, code_point);
     if (!IsValidCharacter(code_point))
@@ -0,0 +1,53 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/fxl/strings/utf_codecs.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace fxl {
+namespace {
+
+TEST(UtfCodecs, IsStringUTF8) {
+  EXPECT_TRUE(IsStringUTF8(""));
+  EXPECT_TRUE(IsStringUTF8("abc"));
+  EXPECT_TRUE(IsStringUTF8(StringView("a\0b", 3)));
+  EXPECT_TRUE(IsStringUTF8("\xc2\x81"));
+  EXPECT_TRUE(IsStringUTF8("\xe1\x80\xbf"));
+  EXPECT_TRUE(IsStringUTF8("\xf1\x80\xa0\xbf"));
+
+  // Truncated and overlong sequences.
+  EXPECT_FALSE(IsStringUTF8("\xc2"));
+  EXPECT_FALSE(IsStringUTF8("\xe1\x80"));
+  EXPECT_FALSE(IsStringUTF8("\xc0\x80"));
+  // Stray continuation byte.
+  EXPECT_FALSE(IsStringUTF8("\x80"));
+  // Surrogate code point and non-character.
+  EXPECT_FALSE(IsStringUTF8("\xed\xa0\x80"));
+  EXPECT_FALSE(IsStringUTF8("\xef\xbf\xbe"));
+}
+
+TEST(UtfCodecs, IsStringUTF8Long) {
+  // Long runs of ASCII are checked a word at a time; make sure invalid bytes
+  // are found at every offset and in the trailing bytes.
+  for (size_t length = 1; length < 40; ++length) {
+    std::string ascii(length, 'a');
+    EXPECT_TRUE(IsStringUTF8(ascii)) << length;
+
+    for (size_t i = 0; i < length; ++i) {
+      std::string invalid = ascii;
+      invalid[i] = '\x80';
+      EXPECT_FALSE(IsStringUTF8(invalid)) << length << " " << i;
+
+      std::string valid = ascii;
+      valid.insert(i, "\xe1\x80\xbf");
+      EXPECT_TRUE(IsStringUTF8(valid)) << length << " " << i;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace fxl
@@ -15,13 +15,13 @@ OneShotTimer::~OneShotTimer() {
 }
 
 void OneShotTimer::Start(TaskRunner* task_runner,
-                         const Closure& task,
+                         TaskClosure task,
                          TimeDelta delay) {
   FXL_DCHECK(task_runner);
   FXL_DCHECK(task);
 
   Stop();
-  task_ = task;
+  task_ = std::move(task);
   auto weak_ptr = weak_ptr_factory_.GetWeakPtr();
   task_runner->PostDelayedTask(
       [weak_ptr] {
@@ -33,15 +33,14 @@ void OneShotTimer::Start(TaskRunner* task_runner,
 
 void OneShotTimer::Stop() {
   if (task_) {
-    task_ = Closure();
+    task_ = nullptr;
     weak_ptr_factory_.InvalidateWeakPtrs();
   }
 }
 
 void OneShotTimer::RunTask() {
   if (task_) {
-    Closure task;
-    task_.swap(task);
+    TaskClosure task(std::move(task_));
     task();
   }
 }
@@ -6,7 +6,7 @@
 #define LIB_FXL_TASKS_ONE_SHOT_TIMER_H_
 
 #include "lib/fxl/fxl_export.h"
-#include "lib/fxl/functional/closure.h"
+#include "lib/fxl/functional/task_closure.h"
 #include "lib/fxl/macros.h"
 #include "lib/fxl/memory/weak_ptr.h"
 #include "lib/fxl/tasks/task_runner.h"
@@ -26,7 +26,7 @@ class FXL_EXPORT OneShotTimer {
 
   // Posts |task| to |task_runner| to run after the given |delay| unless
   // the timer is stopped before the task runs.
-  void Start(TaskRunner* task_runner, const Closure& task, TimeDelta delay);
+  void Start(TaskRunner* task_runner, TaskClosure task, TimeDelta delay);
 
   // Stops the timer.
   // Does nothing if not started.
@@ -35,7 +35,7 @@ class FXL_EXPORT OneShotTimer {
  private:
   void RunTask();
 
-  Closure task_;
+  TaskClosure task_;
   WeakPtrFactory<OneShotTimer> weak_ptr_factory_;
 
   FXL_DISALLOW_COPY_AND_ASSIGN(OneShotTimer);
@@ -17,12 +17,12 @@ class FakeTaskRunner : public TaskRunner {
   bool has_tasks() const { return !tasks_.empty(); }
   TimeDelta last_delay() const { return last_delay_; }
 
-  void PostTask(Closure task) override {}
+  void PostTask(TaskClosure task) override {}
 
-  void PostTaskForTime(Closure task, TimePoint target_time) override {}
+  void PostTaskForTime(TaskClosure task, TimePoint target_time) override {}
 
-  void PostDelayedTask(Closure task, TimeDelta delay) override {
-    tasks_.push(task);
+  void PostDelayedTask(TaskClosure task, TimeDelta delay) override {
+    tasks_.push(std::move(task));
     last_delay_ = delay;
   }
 
@@ -30,13 +30,13 @@ class FakeTaskRunner : public TaskRunner {
 
   void RunOneTask() {
     ASSERT_TRUE(has_tasks());
-    Closure task = tasks_.front();
+    TaskClosure task = std::move(tasks_.front());
     tasks_.pop();
     task();
   }
 
  private:
-  std::queue<Closure> tasks_;
+  std::queue<TaskClosure> tasks_;
   TimeDelta last_delay_;
 };
 
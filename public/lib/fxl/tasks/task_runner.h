@@ -7,6 +7,7 @@
 
 #include "lib/fxl/fxl_export.h"
 #include "lib/fxl/functional/closure.h"
+#include "lib/fxl/functional/task_closure.h"
 #include "lib/fxl/memory/ref_counted.h"
 #include "lib/fxl/time/time_delta.h"
 #include "lib/fxl/time/time_point.h"
@@ -17,13 +18,13 @@ namespace fxl {
 class FXL_EXPORT TaskRunner : public RefCountedThreadSafe<TaskRunner> {
  public:
   // Posts a task to run as soon as possible.
-  virtual void PostTask(Closure task) = 0;
+  virtual void PostTask(TaskClosure task) = 0;
 
   // Posts a task to run as soon as possible after the specified |target_time|.
-  virtual void PostTaskForTime(Closure task, TimePoint target_time) = 0;
+  virtual void PostTaskForTime(TaskClosure task, TimePoint target_time) = 0;
 
   // Posts a task to run as soon as possible after the specified |delay|.
-  virtual void PostDelayedTask(Closure task, TimeDelta delay) = 0;
+  virtual void PostDelayedTask(TaskClosure task, TimeDelta delay) = 0;
 
   // Returns true if the task runner runs tasks on the current thread.
   virtual bool RunsTasksOnCurrentThread() = 0;
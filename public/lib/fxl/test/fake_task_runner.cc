@@ -10,15 +10,15 @@ FakeTaskRunner::FakeTaskRunner() {}
 
 FakeTaskRunner::~FakeTaskRunner() {}
 
-void FakeTaskRunner::PostTask(Closure task) {
+void FakeTaskRunner::PostTask(TaskClosure task) {
   task_queue_.push(std::move(task));
 }
 
-void FakeTaskRunner::PostTaskForTime(Closure task, TimePoint target_time) {
+void FakeTaskRunner::PostTaskForTime(TaskClosure task, TimePoint target_time) {
   FXL_NOTIMPLEMENTED();
 }
 
-void FakeTaskRunner::PostDelayedTask(Closure task, TimeDelta delay) {
+void FakeTaskRunner::PostDelayedTask(TaskClosure task, TimeDelta delay) {
   FXL_NOTIMPLEMENTED();
 }
 
@@ -31,7 +31,7 @@ void FakeTaskRunner::Run() {
   running_ = true;
 
   while (!should_quit_ && !task_queue_.empty()) {
-    Closure task = std::move(task_queue_.front());
+    TaskClosure task = std::move(task_queue_.front());
     task_queue_.pop();
     task();
   }
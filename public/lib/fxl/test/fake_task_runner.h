@@ -14,9 +14,9 @@ namespace fxl {
 // TaskRunner that stores tasks in a queue, to be run when requested.
 class FakeTaskRunner : public TaskRunner {
  public:
-  void PostTask(Closure task) override;
-  void PostTaskForTime(Closure task, TimePoint target_time) override;
-  void PostDelayedTask(Closure task, TimeDelta delay) override;
+  void PostTask(TaskClosure task) override;
+  void PostTaskForTime(TaskClosure task, TimePoint target_time) override;
+  void PostDelayedTask(TaskClosure task, TimeDelta delay) override;
   bool RunsTasksOnCurrentThread() override;
 
   // Run the tasks in the queue until it's empty or until QuitNow() is called.
@@ -29,7 +29,7 @@ class FakeTaskRunner : public TaskRunner {
   FakeTaskRunner();
   ~FakeTaskRunner() override;
 
-  std::queue<Closure> task_queue_;
+  std::queue<TaskClosure> task_queue_;
   bool should_quit_ = false;
   bool running_ = false;
 
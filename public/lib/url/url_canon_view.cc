@@ -0,0 +1,36 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/url/url_canon_view.h"
+
+#include "lib/url/url_util.h"
+#include "lib/url/url_util_internal.h"
+
+namespace url {
+
+CanonicalURLView::CanonicalURLView(fxl::StringView input, CanonOutput* output) {
+  output->set_length(0);
+  is_valid_ = Canonicalize(input.data(), input.size(), true, nullptr, output, &parsed_);
+  spec_ = fxl::StringView(output->data(), output->length());
+}
+
+bool CanonicalURLView::SchemeIs(const char* lower_ascii_scheme) const {
+  if (parsed_.scheme.is_invalid_or_empty()) return lower_ascii_scheme == nullptr;
+  return LowerCaseEqualsASCII(scheme(), fxl::StringView(lower_ascii_scheme));
+}
+
+bool CanonicalURLView::SchemeIsHTTPOrHTTPS() const {
+  return SchemeIs(kHttpScheme) || SchemeIs(kHttpsScheme);
+}
+
+GURL CanonicalURLView::ToGURL() const {
+  return GURL(spec_.data(), spec_.size(), parsed_, is_valid_);
+}
+
+fxl::StringView CanonicalURLView::Component(const url::Component& component) const {
+  if (component.is_invalid_or_empty()) return fxl::StringView();
+  return spec_.substr(component.begin, component.len());
+}
+
+}  // namespace url
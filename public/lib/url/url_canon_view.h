@@ -0,0 +1,62 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_URL_URL_CANON_VIEW_H_
+#define LIB_URL_URL_CANON_VIEW_H_
+
+#include "lib/fxl/strings/string_view.h"
+#include "lib/url/gurl.h"
+#include "lib/url/third_party/mozilla/url_parse.h"
+#include "lib/url/url_canon.h"
+#include "lib/url/url_constants.h"
+#include "lib/url/url_export.h"
+
+namespace url {
+
+// Canonicalizes a URL into a caller-supplied CanonOutput and provides views
+// of its components. With a RawCanonOutput on the stack, URLs shorter than
+// the output's fixed capacity are canonicalized without touching the heap:
+//
+//   url::RawCanonOutput<> output;
+//   url::CanonicalURLView url("FILE:///system/apps/foo", &output);
+//   if (url.is_valid() && url.SchemeIsFile())
+//     Open(url.path());
+//
+// The view refers to the output's buffer, so it must not be used once the
+// output is modified or destroyed. Use ToGURL() to keep the URL around.
+class URL_EXPORT CanonicalURLView {
+ public:
+  // Replaces the contents of |output| with the canonical form of |input|.
+  CanonicalURLView(fxl::StringView input, CanonOutput* output);
+
+  // See the GURL methods of the same names.
+  bool is_valid() const { return is_valid_; }
+  fxl::StringView spec() const { return spec_; }
+  const Parsed& parsed() const { return parsed_; }
+
+  bool SchemeIs(const char* lower_ascii_scheme) const;
+  bool SchemeIsFile() const { return SchemeIs(kFileScheme); }
+  bool SchemeIsHTTPOrHTTPS() const;
+
+  fxl::StringView scheme() const { return Component(parsed_.scheme); }
+  fxl::StringView host() const { return Component(parsed_.host); }
+  fxl::StringView port() const { return Component(parsed_.port); }
+  fxl::StringView path() const { return Component(parsed_.path); }
+  fxl::StringView query() const { return Component(parsed_.query); }
+  fxl::StringView ref() const { return Component(parsed_.ref); }
+
+  // Copies the URL into a GURL without parsing it again.
+  GURL ToGURL() const;
+
+ private:
+  fxl::StringView Component(const url::Component& component) const;
+
+  fxl::StringView spec_;
+  Parsed parsed_;
+  bool is_valid_;
+};
+
+}  // namespace url
+
+#endif  // LIB_URL_URL_CANON_VIEW_H_
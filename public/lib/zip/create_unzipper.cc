@@ -4,6 +4,7 @@
 
 #include "lib/zip/create_unzipper.h"
 
+#include "lib/zip/file_descriptor_io.h"
 #include "lib/zip/memory_io.h"
 #include "third_party/zlib/contrib/minizip/unzip.h"
 
@@ -15,4 +16,16 @@ UniqueUnzipper CreateUnzipper(std::vector<char>* buffer) {
   return UniqueUnzipper(unzOpen2(nullptr, &io));
 }
 
+UniqueUnzipper CreateUnzipper(fxl::StringView* contents) {
+  zlib_filefunc_def io = internal::kReadOnlyMemoryIO;
+  io.opaque = contents;
+  return UniqueUnzipper(unzOpen2(nullptr, &io));
+}
+
+UniqueUnzipper CreateUnzipper(fxl::UniqueFD* fd) {
+  zlib_filefunc_def io = internal::kFileDescriptorIO;
+  io.opaque = fd;
+  return UniqueUnzipper(unzOpen2(nullptr, &io));
+}
+
 }  // namespace zip
@@ -7,6 +7,8 @@
 
 #include <vector>
 
+#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/strings/string_view.h"
 #include "lib/zip/unique_unzipper.h"
 
 namespace zip {
@@ -16,6 +18,14 @@ namespace zip {
 // to use the returned UniqueUnzipper after the given buffer has been destroyed.
 UniqueUnzipper CreateUnzipper(std::vector<char>* buffer);
 
+// Like the above, but unzips the memory the given view refers to, such as a
+// mapped file. Both the view and the memory must outlive the UniqueUnzipper.
+UniqueUnzipper CreateUnzipper(fxl::StringView* contents);
+
+// Returns a UniqueUnzipper that reads the archive from the given file
+// descriptor as needed. The file descriptor must outlive the UniqueUnzipper.
+UniqueUnzipper CreateUnzipper(fxl::UniqueFD* fd);
+
 }  // namespace zip
 
 #endif  // LIB_ZIP_CREATE_UNZIPPER_H_
@@ -0,0 +1,120 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/zip/file_descriptor_io.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "lib/fxl/files/eintr_wrapper.h"
+#include "lib/fxl/files/unique_fd.h"
+
+namespace zip {
+namespace internal {
+namespace {
+
+struct FileStream {
+  int fd = -1;
+  off_t offset = 0;
+  bool error = false;
+};
+
+void* OpenFile(void* opaque, const char* filename, int mode) {
+  fxl::UniqueFD* fd = static_cast<fxl::UniqueFD*>(opaque);
+  if (!fd->is_valid())
+    return nullptr;
+  FileStream* fstream = new FileStream();
+  fstream->fd = fd->get();
+  return fstream;
+}
+
+unsigned long ReadFile(void* opaque,
+                       void* stream,
+                       void* buffer,
+                       unsigned long size) {
+  FileStream* fstream = static_cast<FileStream*>(stream);
+  unsigned long bytes_read = 0;
+  while (bytes_read < size) {
+    ssize_t result =
+        HANDLE_EINTR(pread(fstream->fd, static_cast<char*>(buffer) + bytes_read,
+                           size - bytes_read, fstream->offset));
+    if (result < 0)
+      fstream->error = true;
+    if (result <= 0)
+      break;
+    bytes_read += result;
+    fstream->offset += result;
+  }
+  return bytes_read;
+}
+
+unsigned long WriteFile(void* opaque,
+                        void* stream,
+                        const void* buffer,
+                        unsigned long size) {
+  FileStream* fstream = static_cast<FileStream*>(stream);
+  unsigned long bytes_written = 0;
+  while (bytes_written < size) {
+    ssize_t result = HANDLE_EINTR(
+        pwrite(fstream->fd, static_cast<const char*>(buffer) + bytes_written,
+               size - bytes_written, fstream->offset));
+    if (result <= 0) {
+      fstream->error = true;
+      break;
+    }
+    bytes_written += result;
+    fstream->offset += result;
+  }
+  return bytes_written;
+}
+
+long TellFile(void* opaque, void* stream) {
+  FileStream* fstream = static_cast<FileStream*>(stream);
+  return fstream->offset;
+}
+
+long SeekFile(void* opaque, void* stream, unsigned long offset, int origin) {
+  FileStream* fstream = static_cast<FileStream*>(stream);
+  switch (origin) {
+    case SEEK_SET:
+      fstream->offset = offset;
+      return 0;
+    case SEEK_CUR:
+      fstream->offset += offset;
+      return 0;
+    case SEEK_END: {
+      struct stat st;
+      if (fstat(fstream->fd, &st) != 0 ||
+          offset > static_cast<unsigned long>(st.st_size))
+        break;
+      fstream->offset = st.st_size - offset;
+      return 0;
+    }
+    default:
+      break;
+  }
+  return -1;
+}
+
+int CloseFile(void* opaque, void* stream) {
+  FileStream* fstream = static_cast<FileStream*>(stream);
+  delete fstream;
+  return 0;
+}
+
+int ErrorFile(void* opaque, void* stream) {
+  FileStream* fstream = static_cast<FileStream*>(stream);
+  return fstream->error;
+}
+
+}  // namespace
+
+const zlib_filefunc_def kFileDescriptorIO = {
+    &OpenFile, &ReadFile,  &WriteFile, &TellFile,
+    &SeekFile, &CloseFile, &ErrorFile, nullptr,
+};
+
+}  // namespace internal
+}  // namespace zip
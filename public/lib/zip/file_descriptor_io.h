@@ -0,0 +1,23 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_ZIP_FILE_DESCRIPTOR_IO_H_
+#define LIB_ZIP_FILE_DESCRIPTOR_IO_H_
+
+#include "third_party/zlib/contrib/minizip/ioapi.h"
+
+namespace zip {
+namespace internal {
+
+// An implementation of the zlib file interface that reads and writes a file
+// descriptor at explicit offsets, so that only the data zlib asks for is held
+// in memory. This implementation expects an fxl::UniqueFD as the |opaque|
+// field of the struct and ignores the filename and mode parameters. The file
+// descriptor is not closed along with the file.
+extern const zlib_filefunc_def kFileDescriptorIO;
+
+}  // namespace internal
+}  // namespace zip
+
+#endif  // LIB_ZIP_FILE_DESCRIPTOR_IO_H_
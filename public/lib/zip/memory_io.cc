@@ -10,16 +10,20 @@
 #include <algorithm>
 #include <vector>
 
+#include "lib/fxl/strings/string_view.h"
+
 namespace zip {
 namespace internal {
 namespace {
 
 struct FileStream {
+  // Null for read-only streams, which read |contents| instead.
   std::vector<char>* buffer = nullptr;
+  fxl::StringView contents;
   size_t offset = 0u;
 
-  char* begin() { return buffer->data(); }
-  size_t size() { return buffer->size(); }
+  const char* begin() { return buffer ? buffer->data() : contents.data(); }
+  size_t size() { return buffer ? buffer->size() : contents.size(); }
 };
 
 void* OpenFile(void* opaque, const char* filename, int mode) {
@@ -28,6 +32,12 @@ void* OpenFile(void* opaque, const char* filename, int mode) {
   return fstream;
 }
 
+void* OpenReadOnlyFile(void* opaque, const char* filename, int mode) {
+  FileStream* fstream = new FileStream();
+  fstream->contents = *static_cast<fxl::StringView*>(opaque);
+  return fstream;
+}
+
 unsigned long ReadFile(void* opaque,
                        void* stream,
                        void* buffer,
@@ -45,10 +55,12 @@ unsigned long WriteFile(void* opaque,
                         const void* buffer,
                         unsigned long size) {
   FileStream* fstream = static_cast<FileStream*>(stream);
+  if (!fstream->buffer)
+    return 0;
   size_t end = fstream->offset + size;
   if (end > fstream->size())
     fstream->buffer->resize(end);
-  memcpy(fstream->begin() + fstream->offset, buffer, size);
+  memcpy(fstream->buffer->data() + fstream->offset, buffer, size);
   fstream->offset += size;
   return size;
 }
@@ -107,5 +119,10 @@ const zlib_filefunc_def kMemoryIO = {
     &SeekFile, &CloseFile, &ErrorFile, nullptr,
 };
 
+const zlib_filefunc_def kReadOnlyMemoryIO = {
+    &OpenReadOnlyFile, &ReadFile,  &WriteFile, &TellFile,
+    &SeekFile,         &CloseFile, &ErrorFile, nullptr,
+};
+
 }  // namespace internal
 }  // namespace zip
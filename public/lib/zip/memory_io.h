@@ -15,6 +15,10 @@ namespace internal {
 // the filename and mode parameters.
 extern const zlib_filefunc_def kMemoryIO;
 
+// Like |kMemoryIO|, but expects an fxl::StringView as the |opaque| field and
+// fails all writes. The contents of the view must outlive the file.
+extern const zlib_filefunc_def kReadOnlyMemoryIO;
+
 }  // namespace internal
 }  // namespace zip
 
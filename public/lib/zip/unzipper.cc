@@ -8,50 +8,151 @@
 
 #include <utility>
 
+#include "lib/fxl/files/file_descriptor.h"
 #include "lib/fxl/logging.h"
 #include "lib/zip/create_unzipper.h"
-#include "third_party/zlib/contrib/minizip/unzip.h"
 
 namespace zip {
+namespace {
+
+constexpr size_t kExtractBufferSize = 64 * 1024;
+
+}  // namespace
 
 Unzipper::Unzipper(std::vector<char> buffer)
-    : buffer_(std::move(buffer)), decoder_(CreateUnzipper(&buffer_)) {}
+    : buffer_(std::move(buffer)), decoder_(CreateUnzipper(&buffer_)) {
+  BuildIndex();
+}
+
+Unzipper::Unzipper(fxl::UniqueFD fd) : fd_(std::move(fd)) {
+  if (mapping_.MapFileDescriptor(fd_.get())) {
+    contents_ = mapping_.view();
+    decoder_ = CreateUnzipper(&contents_);
+  } else {
+    decoder_ = CreateUnzipper(&fd_);
+  }
+  BuildIndex();
+}
 
 Unzipper::~Unzipper() {}
 
-std::vector<char> Unzipper::Extract(const std::string& path) {
-  std::vector<char> buffer;
+void Unzipper::BuildIndex() {
+  if (!decoder_.is_valid())
+    return;
 
-  int result = unzLocateFile(decoder_.get(), path.c_str(), 0);
-  if (result != UNZ_OK) {
+  std::string path;
+  int result = unzGoToFirstFile(decoder_.get());
+  for (; result == UNZ_OK; result = unzGoToNextFile(decoder_.get())) {
+    unz_file_info file_info;
+    result = unzGetCurrentFileInfo(decoder_.get(), &file_info, nullptr, 0,
+                                   nullptr, 0, nullptr, 0);
+    if (result != UNZ_OK)
+      break;
+    path.resize(file_info.size_filename);
+    result = unzGetCurrentFileInfo(decoder_.get(), nullptr, &path[0],
+                                   path.size(), nullptr, 0, nullptr, 0);
+    unz_file_pos position;
+    if (result != UNZ_OK ||
+        (result = unzGetFilePos(decoder_.get(), &position)) != UNZ_OK)
+      break;
+    // Like unzLocateFile, prefer the first of several files with one path.
+    index_.emplace(path, position);
+  }
+
+  if (result != UNZ_END_OF_LIST_OF_FILE)
+    FXL_LOG(WARNING) << "Unable to read archive directory, error=" << result;
+}
+
+bool Unzipper::Contains(const std::string& path) const {
+  return index_.count(path) != 0;
+}
+
+bool Unzipper::OpenFile(const std::string& path, unz_file_info* file_info) {
+  auto it = index_.find(path);
+  if (it == index_.end()) {
     FXL_LOG(WARNING) << "Unable to locate '" << path << "' in archive.";
-    return buffer;
+    return false;
+  }
+
+  unz_file_pos position = it->second;
+  int result = unzGoToFilePos(decoder_.get(), &position);
+  if (result != UNZ_OK) {
+    FXL_LOG(WARNING) << "unzGoToFilePos failed, error=" << result;
+    return false;
   }
 
   result = unzOpenCurrentFile(decoder_.get());
   if (result != UNZ_OK) {
     FXL_LOG(WARNING) << "unzOpenCurrentFile failed, error=" << result;
-    return buffer;
+    return false;
   }
 
-  unz_file_info file_info;
-  result = unzGetCurrentFileInfo(decoder_.get(), &file_info, nullptr, 0,
+  result = unzGetCurrentFileInfo(decoder_.get(), file_info, nullptr, 0,
                                  nullptr, 0, nullptr, 0);
   if (result != UNZ_OK) {
     FXL_LOG(WARNING) << "unzGetCurrentFileInfo failed, error=" << result;
-    return buffer;
+    return false;
   }
 
+  return true;
+}
+
+std::vector<char> Unzipper::Extract(const std::string& path) {
+  std::vector<char> buffer;
+
+  unz_file_info file_info;
+  if (!OpenFile(path, &file_info))
+    return buffer;
+
   buffer.resize(file_info.uncompressed_size);
 
-  result = unzReadCurrentFile(decoder_.get(), buffer.data(), buffer.size());
+  int result =
+      unzReadCurrentFile(decoder_.get(), buffer.data(), buffer.size());
   if (result < 0 || static_cast<size_t>(result) != buffer.size()) {
     FXL_LOG(WARNING) << "Unzip failed, error=" << result;
+    unzCloseCurrentFile(decoder_.get());
     buffer.clear();
     return buffer;
   }
 
+  // Having read the whole file, this also checks its CRC.
+  result = unzCloseCurrentFile(decoder_.get());
+  if (result != UNZ_OK) {
+    FXL_LOG(WARNING) << "Unzip failed, error=" << result;
+    buffer.clear();
+  }
+
   return buffer;
 }
 
+bool Unzipper::ExtractToFileDescriptor(const std::string& path, int fd) {
+  unz_file_info file_info;
+  if (!OpenFile(path, &file_info))
+    return false;
+
+  std::vector<char> buffer(kExtractBufferSize);
+  int result;
+  while ((result = unzReadCurrentFile(decoder_.get(), buffer.data(),
+                                      buffer.size())) > 0) {
+    if (!fxl::WriteFileDescriptor(fd, buffer.data(), result)) {
+      FXL_LOG(WARNING) << "Unable to write '" << path << "' from archive.";
+      unzCloseCurrentFile(decoder_.get());
+      return false;
+    }
+  }
+  if (result < 0) {
+    FXL_LOG(WARNING) << "Unzip failed, error=" << result;
+    unzCloseCurrentFile(decoder_.get());
+    return false;
+  }
+
+  // Having read the whole file, this also checks its CRC.
+  result = unzCloseCurrentFile(decoder_.get());
+  if (result != UNZ_OK) {
+    FXL_LOG(WARNING) << "Unzip failed, error=" << result;
+    return false;
+  }
+  return true;
+}
+
 }  // namespace zip
@@ -6,25 +6,58 @@
 #define LIB_ZIP_UNZIPPER_H_
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "lib/fxl/files/mapped_file.h"
+#include "lib/fxl/files/unique_fd.h"
+#include "lib/fxl/strings/string_view.h"
 #include "lib/zip/unique_unzipper.h"
 #include "lib/fxl/macros.h"
+#include "third_party/zlib/contrib/minizip/unzip.h"
 
 namespace zip {
 
 class Unzipper {
  public:
   explicit Unzipper(std::vector<char> buffer);
+
+  // Unzips the archive in the given file without reading it into memory. The
+  // file is mapped if possible and otherwise read piecemeal as entries are
+  // extracted.
+  explicit Unzipper(fxl::UniqueFD fd);
+
   ~Unzipper();
 
+  // Returns the decompressed contents of the file at |path| in the archive,
+  // or an empty vector if the file is missing or corrupt.
   std::vector<char> Extract(const std::string& path);
 
+  // Decompresses the file at |path| in the archive into |fd| a buffer at a
+  // time, rather than holding all of it in memory. Returns false if the file
+  // is missing, corrupt or could not be written.
+  bool ExtractToFileDescriptor(const std::string& path, int fd);
+
+  // Returns whether the archive contains a file at |path|.
+  bool Contains(const std::string& path) const;
+
+  // Empty unless this Unzipper was constructed from a buffer.
   const std::vector<char>& buffer() const { return buffer_; }
 
  private:
+  // Records where each file's entry is in the central directory, so that
+  // files can be located without scanning it.
+  void BuildIndex();
+
+  // Opens the file at |path| in the archive for reading.
+  bool OpenFile(const std::string& path, unz_file_info* file_info);
+
   std::vector<char> buffer_;
+  fxl::UniqueFD fd_;
+  files::MappedFile mapping_;
+  fxl::StringView contents_;
   UniqueUnzipper decoder_;
+  std::unordered_map<std::string, unz_file_pos> index_;
 
   FXL_DISALLOW_COPY_AND_ASSIGN(Unzipper);
 };
@@ -0,0 +1,202 @@
+// Copyright 2017 The Fuchsia Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "lib/zip/unzipper.h"
+
+#include <fcntl.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lib/fxl/files/file.h"
+#include "lib/fxl/files/scoped_temp_dir.h"
+#include "lib/fxl/files/unique_fd.h"
+#include "lib/zip/create_unzipper.h"
+#include "lib/zip/zipper.h"
+
+namespace zip {
+namespace {
+
+// Larger than the buffers used to add and extract files a piece at a time.
+std::string LargeContents() {
+  std::string contents;
+  for (int i = 0; contents.size() < 200 * 1024; ++i)
+    contents += "line " + std::to_string(i * 7919 % 10007) + "\n";
+  return contents;
+}
+
+std::string ToString(const std::vector<char>& data) {
+  return std::string(data.data(), data.size());
+}
+
+fxl::UniqueFD OpenFile(const std::string& path, int flags) {
+  return fxl::UniqueFD(open(path.c_str(), flags, 0644));
+}
+
+// Reads the file at |path| in the archive through the given UniqueUnzipper,
+// checking its CRC.
+bool ReadFile(const UniqueUnzipper& decoder,
+              const std::string& path,
+              std::string* contents) {
+  if (unzLocateFile(decoder.get(), path.c_str(), 0) != UNZ_OK ||
+      unzOpenCurrentFile(decoder.get()) != UNZ_OK)
+    return false;
+  contents->clear();
+  char buffer[4096];
+  int result;
+  while ((result = unzReadCurrentFile(decoder.get(), buffer, sizeof(buffer))) >
+         0)
+    contents->append(buffer, result);
+  return unzCloseCurrentFile(decoder.get()) == UNZ_OK && result == 0;
+}
+
+// Flips the bits of the CRC of the first file in |archive|, in both its local
+// header and its central directory entry.
+void CorruptCRC(std::vector<char>* archive) {
+  const struct {
+    const char* signature;
+    size_t crc_offset;
+  } kHeaders[] = {
+      {"PK\x03\x04", 14},
+      {"PK\x01\x02", 16},
+  };
+  for (const auto& header : kHeaders) {
+    auto it = std::search(archive->begin(), archive->end(), header.signature,
+                          header.signature + 4);
+    ASSERT_NE(archive->end(), it);
+    size_t offset = (it - archive->begin()) + header.crc_offset;
+    ASSERT_LE(offset + 4, archive->size());
+    for (size_t i = 0; i < 4; ++i)
+      (*archive)[offset + i] ^= 0xff;
+  }
+}
+
+TEST(Unzipper, FileDescriptorRoundTrip) {
+  files::ScopedTempDir temp_dir;
+  std::string archive_path;
+  std::string source_path;
+  std::string output_path;
+  ASSERT_TRUE(temp_dir.NewTempFile(&archive_path));
+  ASSERT_TRUE(temp_dir.NewTempFile(&source_path));
+  ASSERT_TRUE(temp_dir.NewTempFile(&output_path));
+
+  std::string large = LargeContents();
+  ASSERT_TRUE(files::WriteFile(source_path, large.data(), large.size()));
+
+  {
+    Zipper zipper(OpenFile(archive_path, O_RDWR | O_TRUNC));
+    ASSERT_TRUE(zipper.AddCompressedFile("small", "hello", 5));
+    fxl::UniqueFD source = OpenFile(source_path, O_RDONLY);
+    ASSERT_TRUE(source.is_valid());
+    ASSERT_TRUE(zipper.AddCompressedFileFromFileDescriptor("dir/large",
+                                                           source.get()));
+    ASSERT_TRUE(zipper.Close());
+    EXPECT_TRUE(zipper.Finish().empty());
+  }
+
+  Unzipper unzipper(OpenFile(archive_path, O_RDONLY));
+  EXPECT_TRUE(unzipper.buffer().empty());
+  EXPECT_EQ("hello", ToString(unzipper.Extract("small")));
+  EXPECT_EQ(large, ToString(unzipper.Extract("dir/large")));
+
+  {
+    fxl::UniqueFD output = OpenFile(output_path, O_WRONLY | O_TRUNC);
+    ASSERT_TRUE(unzipper.ExtractToFileDescriptor("dir/large", output.get()));
+  }
+  std::string extracted;
+  ASSERT_TRUE(files::ReadFileToString(output_path, &extracted));
+  EXPECT_EQ(large, extracted);
+}
+
+TEST(Unzipper, MappedAndReadArchivesMatch) {
+  files::ScopedTempDir temp_dir;
+  std::string archive_path;
+  ASSERT_TRUE(temp_dir.NewTempFile(&archive_path));
+
+  std::string large = LargeContents();
+  Zipper zipper;
+  ASSERT_TRUE(zipper.AddCompressedFile("small", "hello", 5));
+  ASSERT_TRUE(zipper.AddCompressedFile("large", large.data(), large.size()));
+  std::vector<char> archive = zipper.Finish();
+  ASSERT_TRUE(files::WriteFile(archive_path, archive.data(), archive.size()));
+
+  // Unzipper maps the file; the file descriptor decoder reads it with pread.
+  Unzipper mapped(OpenFile(archive_path, O_RDONLY));
+  fxl::UniqueFD fd = OpenFile(archive_path, O_RDONLY);
+  UniqueUnzipper read = CreateUnzipper(&fd);
+  ASSERT_TRUE(read.is_valid());
+  Unzipper in_memory(std::move(archive));
+
+  for (const char* path : {"small", "large"}) {
+    std::string contents;
+    ASSERT_TRUE(ReadFile(read, path, &contents)) << path;
+    EXPECT_EQ(contents, ToString(mapped.Extract(path))) << path;
+    EXPECT_EQ(contents, ToString(in_memory.Extract(path))) << path;
+  }
+  std::string contents;
+  EXPECT_TRUE(ReadFile(read, "large", &contents));
+  EXPECT_EQ(large, contents);
+}
+
+TEST(Unzipper, RejectsBadCRC) {
+  Zipper zipper;
+  ASSERT_TRUE(zipper.AddCompressedFile("file", "hello", 5));
+  std::vector<char> archive = zipper.Finish();
+  CorruptCRC(&archive);
+
+  files::ScopedTempDir temp_dir;
+  std::string archive_path;
+  std::string output_path;
+  ASSERT_TRUE(temp_dir.NewTempFile(&archive_path));
+  ASSERT_TRUE(temp_dir.NewTempFile(&output_path));
+  ASSERT_TRUE(files::WriteFile(archive_path, archive.data(), archive.size()));
+
+  Unzipper in_memory(std::move(archive));
+  EXPECT_TRUE(in_memory.Contains("file"));
+  EXPECT_TRUE(in_memory.Extract("file").empty());
+
+  Unzipper mapped(OpenFile(archive_path, O_RDONLY));
+  EXPECT_TRUE(mapped.Contains("file"));
+  EXPECT_TRUE(mapped.Extract("file").empty());
+  fxl::UniqueFD output = OpenFile(output_path, O_WRONLY | O_TRUNC);
+  EXPECT_FALSE(mapped.ExtractToFileDescriptor("file", output.get()));
+}
+
+TEST(Unzipper, FindsFilesByName) {
+  Zipper zipper;
+  for (int i = 0; i < 100; ++i) {
+    std::string contents = "contents " + std::to_string(i);
+    ASSERT_TRUE(zipper.AddCompressedFile("dir/file" + std::to_string(i),
+                                         contents.data(), contents.size()));
+  }
+  Unzipper unzipper(zipper.Finish());
+
+  // Files are found regardless of the order they are asked for in.
+  for (int i = 99; i >= 0; i -= 3) {
+    std::string path = "dir/file" + std::to_string(i);
+    EXPECT_TRUE(unzipper.Contains(path));
+    EXPECT_EQ("contents " + std::to_string(i),
+              ToString(unzipper.Extract(path)));
+  }
+  EXPECT_EQ("contents 0", ToString(unzipper.Extract("dir/file0")));
+
+  EXPECT_FALSE(unzipper.Contains("dir/file100"));
+  EXPECT_FALSE(unzipper.Contains("file0"));
+  EXPECT_FALSE(unzipper.Contains("dir/"));
+  EXPECT_TRUE(unzipper.Extract("dir/file100").empty());
+}
+
+TEST(Unzipper, InvalidArchive) {
+  std::string garbage = "not a zip archive";
+  Unzipper unzipper(std::vector<char>(garbage.begin(), garbage.end()));
+  EXPECT_FALSE(unzipper.Contains("file"));
+  EXPECT_TRUE(unzipper.Extract("file").empty());
+}
+
+}  // namespace
+}  // namespace zip
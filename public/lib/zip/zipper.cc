@@ -8,11 +8,18 @@
 
 #include <utility>
 
+#include "lib/fxl/files/file_descriptor.h"
+#include "lib/zip/file_descriptor_io.h"
 #include "lib/zip/memory_io.h"
 #include "lib/fxl/logging.h"
 #include "third_party/zlib/contrib/minizip/zip.h"
 
 namespace zip {
+namespace {
+
+constexpr size_t kAddBufferSize = 64 * 1024;
+
+}  // namespace
 
 Zipper::Zipper() {
   zlib_filefunc_def io = internal::kMemoryIO;
@@ -20,11 +27,15 @@ Zipper::Zipper() {
   encoder_.reset(zipOpen2(nullptr, APPEND_STATUS_CREATE, nullptr, &io));
 }
 
+Zipper::Zipper(fxl::UniqueFD fd) : fd_(std::move(fd)) {
+  zlib_filefunc_def io = internal::kFileDescriptorIO;
+  io.opaque = &fd_;
+  encoder_.reset(zipOpen2(nullptr, APPEND_STATUS_CREATE, nullptr, &io));
+}
+
 Zipper::~Zipper() {}
 
-bool Zipper::AddCompressedFile(const std::string& path,
-                               const char* data,
-                               size_t size) {
+bool Zipper::OpenFile(const std::string& path) {
   FXL_DCHECK(encoder_.is_valid());
 
   zip_fileinfo file_info;
@@ -36,8 +47,27 @@ bool Zipper::AddCompressedFile(const std::string& path,
     FXL_LOG(WARNING) << "Unable to create '" << path << "' in archive.";
     return false;
   }
+  return true;
+}
+
+bool Zipper::CloseFile(const std::string& path) {
+  int result = zipCloseFileInZip(encoder_.get());
+
+  if (result != ZIP_OK) {
+    FXL_LOG(WARNING) << "Unable to close '" << path << "' in archive.";
+    return false;
+  }
+
+  return true;
+}
 
-  result = zipWriteInFileInZip(encoder_.get(), data, size);
+bool Zipper::AddCompressedFile(const std::string& path,
+                               const char* data,
+                               size_t size) {
+  if (!OpenFile(path))
+    return false;
+
+  int result = zipWriteInFileInZip(encoder_.get(), data, size);
 
   if (result < 0) {
     FXL_LOG(WARNING) << "Unable to write data into '" << path
@@ -45,18 +75,45 @@ bool Zipper::AddCompressedFile(const std::string& path,
     return false;
   }
 
-  result = zipCloseFileInZip(encoder_.get());
+  return CloseFile(path);
+}
 
-  if (result != ZIP_OK) {
-    FXL_LOG(WARNING) << "Unable to close '" << path << "' in archive.";
+bool Zipper::AddCompressedFileFromFileDescriptor(const std::string& path,
+                                                 int fd) {
+  if (!OpenFile(path))
+    return false;
+
+  std::vector<char> buffer(kAddBufferSize);
+  ssize_t size;
+  while ((size = fxl::ReadFileDescriptor(fd, buffer.data(), buffer.size())) >
+         0) {
+    if (zipWriteInFileInZip(encoder_.get(), buffer.data(), size) < 0) {
+      FXL_LOG(WARNING) << "Unable to write data into '" << path
+                       << "' in archive.";
+      return false;
+    }
+  }
+  if (size < 0) {
+    FXL_LOG(WARNING) << "Unable to read data for '" << path << "'.";
     return false;
   }
 
+  return CloseFile(path);
+}
+
+bool Zipper::Close() {
+  if (!encoder_.is_valid())
+    return false;
+  int result = zipClose(encoder_.release(), nullptr);
+  if (result != ZIP_OK) {
+    FXL_LOG(WARNING) << "Unable to finish archive, error=" << result;
+    return false;
+  }
   return true;
 }
 
 std::vector<char> Zipper::Finish() {
-  encoder_.reset();
+  Close();
   return std::move(buffer_);
 }
 
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 
+#include "lib/fxl/files/unique_fd.h"
 #include "lib/zip/unique_zipper.h"
 #include "lib/fxl/macros.h"
 
@@ -15,17 +16,36 @@ namespace zip {
 
 class Zipper {
  public:
+  // Builds the archive in memory, to be returned by |Finish|.
   Zipper();
+
+  // Writes the archive to the given file as files are added, holding no more
+  // than a compression buffer of output in memory.
+  explicit Zipper(fxl::UniqueFD fd);
+
   ~Zipper();
 
   bool AddCompressedFile(const std::string& path,
                          const char* data,
                          size_t size);
 
+  // Adds the remaining contents of |fd|, reading them a buffer at a time.
+  bool AddCompressedFileFromFileDescriptor(const std::string& path, int fd);
+
+  // Writes the archive's central directory. Returns false if the archive
+  // could not be written.
+  bool Close();
+
+  // Closes the archive and returns it. The result is empty if this Zipper
+  // was constructed from a file descriptor.
   std::vector<char> Finish();
 
  private:
+  bool OpenFile(const std::string& path);
+  bool CloseFile(const std::string& path);
+
   std::vector<char> buffer_;
+  fxl::UniqueFD fd_;
   UniqueZipper encoder_;
 
   FXL_DISALLOW_COPY_AND_ASSIGN(Zipper);